@@ -32,6 +32,8 @@
 #include <vpp/app/version.h>
 #include <gtpu/gtpu.h>
 #include <vnet/flow/flow.h>
+#include <vnet/interface_output.h>
+#include <vlib/bihash_resize.h>
 
 gtpu_main_t gtpu_main;
 
@@ -107,6 +109,9 @@ format_gtpu_tunnel (u8 * s, va_list * args)
   if (PREDICT_FALSE (ip46_address_is_multicast (&t->dst)))
     s = format (s, "mcast-sw-if-idx %d ", t->mcast_sw_if_index);
 
+  if (t->flags & GTPU_TUNNEL_F_UDP_ZERO_CSUM)
+    s = format (s, "zero-checksum ");
+
   return s;
 }
 
@@ -230,7 +235,8 @@ _(mcast_sw_if_index)                            \
 _(encap_fib_index)                              \
 _(decap_next_index)                             \
 _(src)                                          \
-_(dst)
+_(dst)                                          \
+_(flags)
 
 static void
 ip_udp_gtpu_rewrite (gtpu_tunnel_t * t, bool is_ip6)
@@ -295,6 +301,43 @@ ip_udp_gtpu_rewrite (gtpu_tunnel_t * t, bool is_ip6)
   return;
 }
 
+/*
+ * The part of the IPv6 UDP pseudo-header sum which does not change from
+ * packet to packet: the addresses and the next header.
+ */
+static ip_csum_t
+gtpu6_phdr_sum (gtpu_tunnel_t * t)
+{
+  ip_csum_t sum = clib_host_to_net_u16 (IP_PROTOCOL_UDP);
+  int i;
+
+  for (i = 0; i < ARRAY_LEN (t->src.ip6.as_uword); i++)
+    {
+      sum = ip_csum_with_carry (sum, t->src.ip6.as_uword[i]);
+      sum = ip_csum_with_carry (sum, t->dst.ip6.as_uword[i]);
+    }
+
+  return sum;
+}
+
+/* bind the GTPU port to the decap node, or to the handoff node before it */
+static void
+gtpu_register_udp_port (gtpu_main_t * gtm, u8 is_ip6)
+{
+  u32 node_index;
+
+  if (is_ip6)
+    node_index = gtm->handoff_mode[1] != GTPU_HANDOFF_NONE ?
+      gtpu6_handoff_node.index : gtpu6_input_node.index;
+  else
+    node_index = gtm->handoff_mode[0] != GTPU_HANDOFF_NONE ?
+      gtpu4_handoff_node.index : gtpu4_input_node.index;
+
+  udp_register_dst_port (gtm->vlib_main,
+			 is_ip6 ? UDP_DST_PORT_GTPU6 : UDP_DST_PORT_GTPU,
+			 node_index, !is_ip6);
+}
+
 static bool
 gtpu_decap_next_is_valid (gtpu_main_t * gtm, u32 is_ip6, u32 decap_next_index)
 {
@@ -353,24 +396,27 @@ int vnet_gtpu_add_del_tunnel
   gtpu_main_t *gtm = &gtpu_main;
   gtpu_tunnel_t *t = 0;
   vnet_main_t *vnm = gtm->vnet_main;
-  uword *p;
   u32 hw_if_index = ~0;
   u32 sw_if_index = ~0;
-  gtpu4_tunnel_key_t key4;
-  gtpu6_tunnel_key_t key6;
+  clib_bihash_kv_8_8_t kv4;
+  clib_bihash_kv_24_8_t kv6;
   bool is_ip6 = !ip46_address_is_ip4 (&a->dst);
+  bool exists;
 
+  /* decap src in key is encap dst in config */
   if (!is_ip6)
     {
-      key4.src = a->dst.ip4.as_u32;	/* decap src in key is encap dst in config */
-      key4.teid = clib_host_to_net_u32 (a->teid);
-      p = hash_get (gtm->gtpu4_tunnel_by_key, key4.as_u64);
+      gtpu4_tunnel_make_key (&kv4, a->dst.ip4.as_u32,
+			     clib_host_to_net_u32 (a->teid));
+      exists = !clib_bihash_search_inline_8_8 (&gtm->gtpu4_tunnel_by_key,
+					       &kv4);
     }
   else
     {
-      key6.src = a->dst.ip6;
-      key6.teid = clib_host_to_net_u32 (a->teid);
-      p = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6);
+      gtpu6_tunnel_make_key (&kv6, &a->dst.ip6,
+			     clib_host_to_net_u32 (a->teid));
+      exists = !clib_bihash_search_inline_24_8 (&gtm->gtpu6_tunnel_by_key,
+						&kv6);
     }
 
   if (a->is_add)
@@ -378,7 +424,7 @@ int vnet_gtpu_add_del_tunnel
       l2input_main_t *l2im = &l2input_main;
 
       /* adding a tunnel: tunnel must not already exist */
-      if (p)
+      if (exists)
 	return VNET_API_ERROR_TUNNEL_EXIST;
 
       /*if not set explicitly, default to l2 */
@@ -396,16 +442,25 @@ int vnet_gtpu_add_del_tunnel
 #undef _
 
       ip_udp_gtpu_rewrite (t, is_ip6);
+      if (is_ip6)
+	t->ip6_phdr_sum = gtpu6_phdr_sum (t);
 
       /* clear the flow index */
       t->flow_index = ~0;
 
       /* copy the key */
       if (is_ip6)
-	hash_set_mem_alloc (&gtm->gtpu6_tunnel_by_key, &key6,
-			    t - gtm->tunnels);
+	{
+	  kv6.value = t - gtm->tunnels;
+	  clib_bihash_add_del_24_8 (&gtm->gtpu6_tunnel_by_key, &kv6,
+				    1 /* is_add */ );
+	}
       else
-	hash_set (gtm->gtpu4_tunnel_by_key, key4.as_u64, t - gtm->tunnels);
+	{
+	  kv4.value = t - gtm->tunnels;
+	  clib_bihash_add_del_8_8 (&gtm->gtpu4_tunnel_by_key, &kv4,
+				   1 /* is_add */ );
+	}
 
       vnet_hw_interface_t *hi;
       if (vec_len (gtm->free_gtpu_tunnel_hw_if_indices) > 0)
@@ -560,10 +615,10 @@ int vnet_gtpu_add_del_tunnel
   else
     {
       /* deleting a tunnel: tunnel must exist */
-      if (!p)
+      if (!exists)
 	return VNET_API_ERROR_NO_SUCH_ENTRY;
 
-      t = pool_elt_at_index (gtm->tunnels, p[0]);
+      t = pool_elt_at_index (gtm->tunnels, is_ip6 ? kv6.value : kv4.value);
       sw_if_index = t->sw_if_index;
 
       vnet_sw_interface_set_flags (vnm, t->sw_if_index, 0 /* down */ );
@@ -578,9 +633,11 @@ int vnet_gtpu_add_del_tunnel
       gtm->tunnel_index_by_sw_if_index[t->sw_if_index] = ~0;
 
       if (!is_ip6)
-	hash_unset (gtm->gtpu4_tunnel_by_key, key4.as_u64);
+	clib_bihash_add_del_8_8 (&gtm->gtpu4_tunnel_by_key, &kv4,
+				 0 /* is_add */ );
       else
-	hash_unset_mem_free (&gtm->gtpu6_tunnel_by_key, &key6);
+	clib_bihash_add_del_24_8 (&gtm->gtpu6_tunnel_by_key, &kv6,
+				  0 /* is_add */ );
 
       if (!ip46_address_is_multicast (&t->dst))
 	{
@@ -608,11 +665,9 @@ int vnet_gtpu_add_del_tunnel
     {
       /* register udp ports */
       if (!is_ip6 && !udp_is_valid_dst_port (UDP_DST_PORT_GTPU, 1))
-	udp_register_dst_port (gtm->vlib_main, UDP_DST_PORT_GTPU,
-			       gtpu4_input_node.index, /* is_ip4 */ 1);
+	gtpu_register_udp_port (gtm, /* is_ip6 */ 0);
       if (is_ip6 && !udp_is_valid_dst_port (UDP_DST_PORT_GTPU6, 0))
-	udp_register_dst_port (gtm->vlib_main, UDP_DST_PORT_GTPU6,
-			       gtpu6_input_node.index, /* is_ip4 */ 0);
+	gtpu_register_udp_port (gtm, /* is_ip6 */ 1);
     }
 
   return 0;
@@ -672,6 +727,7 @@ gtpu_add_del_tunnel_command_fn (vlib_main_t * vm,
   u32 mcast_sw_if_index = ~0;
   u32 decap_next_index = GTPU_INPUT_NEXT_L2_INPUT;
   u32 teid = 0;
+  u8 flags = 0;
   u32 tmp;
   int rv;
   vnet_gtpu_add_del_tunnel_args_t _a, *a = &_a;
@@ -747,6 +803,8 @@ gtpu_add_del_tunnel_command_fn (vlib_main_t * vm,
 	;
       else if (unformat (line_input, "teid %d", &teid))
 	;
+      else if (unformat (line_input, "zero-checksum"))
+	flags |= GTPU_TUNNEL_F_UDP_ZERO_CSUM;
       else
 	{
 	  error = clib_error_return (0, "parse error: '%U'",
@@ -803,6 +861,12 @@ gtpu_add_del_tunnel_command_fn (vlib_main_t * vm,
       goto done;
     }
 
+  if (ipv4_set && (flags & GTPU_TUNNEL_F_UDP_ZERO_CSUM))
+    {
+      error = clib_error_return (0, "zero-checksum applies to IPv6 only");
+      goto done;
+    }
+
   clib_memset (a, 0, sizeof (*a));
 
   a->is_add = is_add;
@@ -860,6 +924,17 @@ done:
  * @cliexcmd{create gtpu tunnel src 10.0.3.1 dst 10.0.3.3 teid 13 encap-vrf-id 7}
  * Example of how to delete a GTPU Tunnel:
  * @cliexcmd{create gtpu tunnel src 10.0.3.1 dst 10.0.3.3 teid 13 del}
+ *
+ * IPv6 tunnels send UDP checksums. With zero-checksum they send none and
+ * accept packets without one, as RFC 6935 and RFC 6936 allow for tunnels
+ * whose both ends agreed to it.
+ *
+ * Note that IPv6 tunnels without zero-checksum, which is the default and
+ * includes every tunnel created before the option existed, drop the
+ * packets they receive with a zero UDP checksum (counted as "zero udp
+ * checksum on a tunnel not allowing it"). Such tunnels used to accept
+ * them; recreate them with zero-checksum if the peer sends none.
+ * @cliexcmd{create gtpu tunnel src 2001::1 dst 2001::2 teid 13 zero-checksum}
  ?*/
 /* *INDENT-OFF* */
 VLIB_CLI_COMMAND (create_gtpu_tunnel_command, static) = {
@@ -867,7 +942,9 @@ VLIB_CLI_COMMAND (create_gtpu_tunnel_command, static) = {
   .short_help =
   "create gtpu tunnel src <local-vtep-addr>"
   " {dst <remote-vtep-addr>|group <mcast-vtep-addr> <intf-name>} teid <nn>"
-  " [encap-vrf-id <nn>] [decap-next [l2|ip4|ip6|node <name>]] [del]",
+  " [encap-vrf-id <nn>] [decap-next [l2|ip4|ip6|node <name>]]"
+  " [zero-checksum] [del]\n"
+  "IPv6 tunnels without zero-checksum drop zero UDP checksum packets",
   .function = gtpu_add_del_tunnel_command_fn,
 };
 /* *INDENT-ON* */
@@ -1209,6 +1286,392 @@ VLIB_CLI_COMMAND (gtpu_offload_command, static) = {
 };
 /* *INDENT-ON* */
 
+u8 *
+format_gtpu_handoff_mode (u8 * s, va_list * args)
+{
+  gtpu_handoff_mode_t mode = va_arg (*args, int);
+
+  switch (mode)
+    {
+#define _(sym,str) case GTPU_HANDOFF_##sym: return format (s, str);
+      foreach_gtpu_handoff_mode
+#undef _
+    default:
+      return format (s, "unknown");
+    }
+}
+
+static uword
+unformat_gtpu_handoff_mode (unformat_input_t * input, va_list * args)
+{
+  gtpu_handoff_mode_t *mode = va_arg (*args, gtpu_handoff_mode_t *);
+
+  if (0)
+    ;
+#define _(sym,str) else if (unformat (input, str)) *mode = GTPU_HANDOFF_##sym;
+  foreach_gtpu_handoff_mode
+#undef _
+  else
+    return 0;
+
+  return 1;
+}
+
+int
+vnet_gtpu_set_handoff (u8 is_ip6, gtpu_handoff_mode_t mode)
+{
+  gtpu_main_t *gtm = &gtpu_main;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_thread_registration_t *tr;
+  uword *p;
+
+  if (mode >= GTPU_HANDOFF_N_MODE)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (mode != GTPU_HANDOFF_NONE)
+    {
+      /* Only the standard vnet worker threads are supported */
+      p = hash_get_mem (tm->thread_registrations_by_name, "workers");
+      tr = p ? (vlib_thread_registration_t *) p[0] : 0;
+      if (!tr || tr->count < 2)
+	return VNET_API_ERROR_INVALID_WORKER;
+
+      gtm->handoff_first_worker_index = tr->first_index;
+      gtm->handoff_n_workers = tr->count;
+
+      if (gtm->handoff_fq_index[is_ip6] == ~0)
+	gtm->handoff_fq_index[is_ip6] =
+	  vlib_frame_queue_main_init (is_ip6 ? gtpu6_input_node.index :
+				      gtpu4_input_node.index, 0);
+    }
+
+  gtm->handoff_mode[is_ip6] = mode;
+
+  /* rebind the port if tunnels already use it */
+  if (udp_is_valid_dst_port (is_ip6 ? UDP_DST_PORT_GTPU6 : UDP_DST_PORT_GTPU,
+			     !is_ip6))
+    gtpu_register_udp_port (gtm, is_ip6);
+
+  return 0;
+}
+
+static clib_error_t *
+gtpu_handoff_command_fn (vlib_main_t * vm,
+			 unformat_input_t * input, vlib_cli_command_t * cmd)
+{
+  gtpu_handoff_mode_t mode = GTPU_HANDOFF_N_MODE;
+  u8 is_ip6 = 0;
+  int rv;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "ip4"))
+	is_ip6 = 0;
+      else if (unformat (input, "ip6"))
+	is_ip6 = 1;
+      else if (unformat (input, "%U", unformat_gtpu_handoff_mode, &mode))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (mode == GTPU_HANDOFF_N_MODE)
+    return clib_error_return (0, "missing handoff mode");
+
+  rv = vnet_gtpu_set_handoff (is_ip6, mode);
+
+  switch (rv)
+    {
+    case 0:
+      break;
+    case VNET_API_ERROR_INVALID_WORKER:
+      return clib_error_return (0, "handoff needs at least 2 workers");
+    default:
+      return clib_error_return (0, "vnet_gtpu_set_handoff returned %d", rv);
+    }
+
+  return 0;
+}
+
+/*?
+ * Spread the decapsulation of GTPU packets over the workers. All the
+ * traffic of a gNB has the same outer addresses and ports, so without
+ * a NIC hashing on the inner headers it lands on a single worker. With
+ * handoff the worker is picked by the TEID of the packet, or by the hash
+ * of the inner IP flow so that even a single tunnel uses all the
+ * workers. Packets dropped because the queue of the chosen worker was
+ * full are counted as "congestion drop" by gtpu4-handoff or
+ * gtpu6-handoff.
+ *
+ * @cliexpar
+ * @cliexcmd{set gtpu handoff ip4 teid}
+ * @cliexcmd{set gtpu handoff ip6 inner-flow}
+ * @cliexcmd{set gtpu handoff ip4 disabled}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (gtpu_handoff_command, static) = {
+    .path = "set gtpu handoff",
+    .short_help = "set gtpu handoff [ip4|ip6] [teid|inner-flow|disabled]",
+    .function = gtpu_handoff_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+show_gtpu_handoff_command_fn (vlib_main_t * vm,
+			      unformat_input_t * input,
+			      vlib_cli_command_t * cmd)
+{
+  gtpu_main_t *gtm = &gtpu_main;
+
+  vlib_cli_output (vm, "ip4: %U", format_gtpu_handoff_mode,
+		   gtm->handoff_mode[0]);
+  vlib_cli_output (vm, "ip6: %U", format_gtpu_handoff_mode,
+		   gtm->handoff_mode[1]);
+  if (gtm->handoff_n_workers)
+    vlib_cli_output (vm, "workers: %u from thread %u",
+		     gtm->handoff_n_workers,
+		     gtm->handoff_first_worker_index);
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_gtpu_handoff_command, static) = {
+    .path = "show gtpu handoff",
+    .short_help = "show gtpu handoff",
+    .function = show_gtpu_handoff_command_fn,
+};
+/* *INDENT-ON* */
+
+#define foreach_gtpu_encap_csum_mode			\
+  _(COMPUTE, "compute")					\
+  _(OFFLOAD, "offload")					\
+  _(OFFLOAD_SW, "offload+sw")				\
+  _(ZERO, "zero")
+
+typedef enum
+{
+#define _(sym,str) GTPU_ENCAP_CSUM_##sym,
+  foreach_gtpu_encap_csum_mode
+#undef _
+    GTPU_ENCAP_CSUM_N_MODE,
+} gtpu_encap_csum_mode_t;
+
+static char *gtpu_encap_csum_mode_strings[] = {
+#define _(sym,str) str,
+  foreach_gtpu_encap_csum_mode
+#undef _
+};
+
+/*
+ * What gtpu6-encap does to a packet, with the UDP checksum produced the
+ * given way: computed in full, as before checksum offload, seeded for
+ * the NIC, seeded and then finished by the interface-output software
+ * fallback, or left at zero.
+ */
+static_always_inline void
+gtpu6_test_encap_one (vlib_main_t * vm, vlib_buffer_t * b,
+		      gtpu_tunnel_t * t, u16 payload_length,
+		      gtpu_encap_csum_mode_t mode)
+{
+  ip6_header_t *ip6;
+  udp_header_t *udp;
+  gtpu_header_t *gtpu;
+  int bogus;
+
+  b->current_data = 0;
+  b->current_length = payload_length;
+  b->flags &= ~(VNET_BUFFER_F_IS_IP6 | VNET_BUFFER_F_OFFLOAD_UDP_CKSUM);
+
+  vlib_buffer_advance (b, -(word) _vec_len (t->rewrite));
+  ip6 = vlib_buffer_get_current (b);
+  clib_memcpy_fast (ip6, t->rewrite, _vec_len (t->rewrite));
+
+  ip6->payload_length = clib_host_to_net_u16 (b->current_length -
+					      sizeof (*ip6));
+  udp = (udp_header_t *) (ip6 + 1);
+  udp->length = ip6->payload_length;
+  gtpu = (gtpu_header_t *) (udp + 1);
+  gtpu->length = clib_host_to_net_u16 (payload_length);
+
+  switch (mode)
+    {
+    case GTPU_ENCAP_CSUM_COMPUTE:
+      udp->checksum = ip6_tcp_udp_icmp_compute_checksum (vm, b, ip6, &bogus);
+      if (udp->checksum == 0)
+	udp->checksum = 0xffff;
+      break;
+    case GTPU_ENCAP_CSUM_OFFLOAD:
+      gtpu6_encap_udp_checksum (b, t, ip6, udp);
+      break;
+    case GTPU_ENCAP_CSUM_OFFLOAD_SW:
+      gtpu6_encap_udp_checksum (b, t, ip6, udp);
+      vnet_calc_checksums_inline (vm, b, 0 /* is_ip4 */ , 1 /* is_ip6 */ ,
+				  0 /* with_gso */ );
+      break;
+    default:
+      break;
+    }
+}
+
+/*
+ * Check the seeded checksum, finished by the interface-output software
+ * fallback, gives the checksum computed in full. Then again with the
+ * first payload word changed so that the checksum computes to zero,
+ * which must go out as 0xffff. The payload is restored on return.
+ */
+static int
+gtpu6_test_verify_seed (vlib_main_t * vm, vlib_buffer_t * b,
+			gtpu_tunnel_t * t, u16 payload_length)
+{
+  ip6_header_t *ip6;
+  udp_header_t *udp;
+  u16 expected, word, *payload = (u16 *) b->data;
+  ip_csum_t sum;
+  int ok;
+
+  gtpu6_test_encap_one (vm, b, t, payload_length, GTPU_ENCAP_CSUM_COMPUTE);
+  ip6 = vlib_buffer_get_current (b);
+  udp = (udp_header_t *) (ip6 + 1);
+  expected = udp->checksum;
+
+  gtpu6_test_encap_one (vm, b, t, payload_length,
+			GTPU_ENCAP_CSUM_OFFLOAD_SW);
+  if (udp->checksum != expected)
+    return 0;
+
+  if (payload_length < sizeof (u16))
+    return 1;
+
+  /* adding the checksum to the sum makes it all ones, a zero checksum */
+  word = payload[0];
+  sum = ip_csum_with_carry (word, expected);
+  payload[0] = ip_csum_fold (sum);
+
+  gtpu6_test_encap_one (vm, b, t, payload_length, GTPU_ENCAP_CSUM_COMPUTE);
+  ok = udp->checksum == 0xffff;
+  gtpu6_test_encap_one (vm, b, t, payload_length,
+			GTPU_ENCAP_CSUM_OFFLOAD_SW);
+  ok &= udp->checksum == 0xffff;
+
+  payload[0] = word;
+  return ok;
+}
+
+static clib_error_t *
+gtpu_test_encap_checksum_command_fn (vlib_main_t * vm,
+				     unformat_input_t * input,
+				     vlib_cli_command_t * cmd)
+{
+  u32 n_buffers = 256, rounds = 1000, payload_length = 1400;
+  u32 *buffer_indices = 0, n_alloc = 0;
+  u64 seed = clib_cpu_time_now ();
+  gtpu_tunnel_t _t, *t = &_t;
+  clib_error_t *err = 0;
+  u64 t0, t1;
+  int i, j, mode;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "size %u", &payload_length))
+	;
+      else if (unformat (input, "buffers %u", &n_buffers))
+	;
+      else if (unformat (input, "rounds %u", &rounds))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (payload_length + sizeof (ip6_gtpu_header_t) >
+      vlib_buffer_get_default_data_size (vm) || payload_length == 0)
+    return clib_error_return (0, "size must be between 1 and %u",
+			      vlib_buffer_get_default_data_size (vm) -
+			      sizeof (ip6_gtpu_header_t));
+  if (n_buffers == 0 || rounds == 0)
+    return clib_error_return (0, "buffers and rounds must be non-zero");
+
+  clib_memset (t, 0, sizeof (*t));
+  t->src.ip6.as_u64[0] = clib_host_to_net_u64 (0x20010db800000000ULL);
+  t->src.ip6.as_u64[1] = clib_host_to_net_u64 (1);
+  t->dst.ip6.as_u64[0] = clib_host_to_net_u64 (0x20010db800000000ULL);
+  t->dst.ip6.as_u64[1] = clib_host_to_net_u64 (2);
+  t->teid = 1;
+  ip_udp_gtpu_rewrite (t, 1 /* is_ip6 */ );
+  t->ip6_phdr_sum = gtpu6_phdr_sum (t);
+
+  vec_validate_aligned (buffer_indices, n_buffers - 1, CLIB_CACHE_LINE_BYTES);
+  n_alloc = vlib_buffer_alloc (vm, buffer_indices, n_buffers);
+  if (n_alloc != n_buffers)
+    {
+      err = clib_error_return (0, "buffer alloc failure");
+      goto done;
+    }
+
+  for (i = 0; i < n_buffers; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, buffer_indices[i]);
+      for (j = 0; j < payload_length; j += 8)
+	*(u64 *) (b->data + j) = random_u64 (&seed);
+    }
+
+  if (!gtpu6_test_verify_seed (vm, vlib_get_buffer (vm, buffer_indices[0]),
+			       t, payload_length))
+    {
+      err = clib_error_return (0, "seeded checksum does not verify");
+      goto done;
+    }
+
+  vlib_cli_output (vm, "gtpu6 encap: payload %u bytes, %u buffers, "
+		   "%u rounds, cpu-freq %.2f GHz", payload_length, n_buffers,
+		   rounds, (f64) vm->clib_time.clocks_per_second * 1e-9);
+
+  for (mode = 0; mode < GTPU_ENCAP_CSUM_N_MODE; mode++)
+    {
+      t0 = clib_cpu_time_now ();
+      for (i = 0; i < rounds; i++)
+	for (j = 0; j < n_buffers; j++)
+	  gtpu6_test_encap_one (vm, vlib_get_buffer (vm, buffer_indices[j]),
+				t, payload_length, mode);
+      t1 = clib_cpu_time_now ();
+
+      vlib_cli_output (vm, "  %-12s %.2f clocks/packet",
+		       gtpu_encap_csum_mode_strings[mode],
+		       (f64) (t1 - t0) / ((f64) n_buffers * rounds));
+    }
+
+done:
+  if (n_alloc)
+    vlib_buffer_free (vm, buffer_indices, n_alloc);
+  vec_free (buffer_indices);
+  vec_free (t->rewrite);
+  return err;
+}
+
+/*?
+ * Benchmark the IPv6 encapsulation of gtpu tunnels with each way of
+ * producing the UDP checksum: computed in full, seeded for NIC checksum
+ * offload, seeded and finished by the interface-output software fallback
+ * and, for zero-checksum tunnels, not at all.
+ *
+ * The seeded checksum, finished by the software fallback, is first
+ * checked against the one computed in full, including for a packet whose
+ * checksum computes to zero and must be sent as 0xffff.
+ *
+ * @cliexpar
+ * @cliexcmd{test gtpu encap-checksum size 1400 buffers 256 rounds 1000}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (gtpu_test_encap_checksum_command, static) = {
+    .path = "test gtpu encap-checksum",
+    .short_help = "test gtpu encap-checksum [size <n>] [buffers <n>] "
+      "[rounds <n>]",
+    .function = gtpu_test_encap_checksum_command_fn,
+};
+/* *INDENT-ON* */
+
 clib_error_t *
 gtpu_init (vlib_main_t * vm)
 {
@@ -1220,10 +1683,9 @@ gtpu_init (vlib_main_t * vm)
   vnet_flow_get_range (gtm->vnet_main, "gtpu", 1024 * 1024,
 		       &gtm->flow_id_start);
 
-  /* initialize the ip6 hash */
-  gtm->gtpu6_tunnel_by_key = hash_create_mem (0,
-					      sizeof (gtpu6_tunnel_key_t),
-					      sizeof (uword));
+  gtm->tunnel_by_key_buckets = GTPU_TUNNEL_BY_KEY_NUM_BUCKETS;
+  gtm->tunnel_by_key_memory = GTPU_TUNNEL_BY_KEY_MEMORY_SIZE;
+
   gtm->vtep_table = vtep_table_create ();
   gtm->mcast_shared = hash_create_mem (0,
 				       sizeof (ip46_address_t),
@@ -1231,11 +1693,66 @@ gtpu_init (vlib_main_t * vm)
 
   gtm->fib_node_type = fib_node_register_new_type (&gtpu_vft);
 
+  gtm->handoff_fq_index[0] = gtm->handoff_fq_index[1] = ~0;
+
   return 0;
 }
 
 VLIB_INIT_FUNCTION (gtpu_init);
 
+static clib_error_t *
+gtpu_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  gtpu_main_t *gtm = &gtpu_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "tunnel-hash-buckets %u",
+		    &gtm->tunnel_by_key_buckets))
+	;
+      else if (unformat (input, "tunnel-hash-memory %U",
+			 unformat_memory_size, &gtm->tunnel_by_key_memory))
+	;
+      else if (unformat (input, "tunnel-hash-max-buckets %u",
+			 &gtm->tunnel_by_key_max_buckets))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  /* config functions run after init and are called without a stanza too */
+  {
+    clib_bihash_init2_args_8_8_t a4 = {
+      .h = &gtm->gtpu4_tunnel_by_key,
+      .name = "gtpu4 tunnel by key",
+      .nbuckets = gtm->tunnel_by_key_buckets,
+      .memory_size = gtm->tunnel_by_key_memory,
+      .max_nbuckets = gtm->tunnel_by_key_max_buckets,
+    };
+    clib_bihash_init2_args_24_8_t a6 = {
+      .h = &gtm->gtpu6_tunnel_by_key,
+      .name = "gtpu6 tunnel by key",
+      .nbuckets = gtm->tunnel_by_key_buckets,
+      .memory_size = gtm->tunnel_by_key_memory,
+      .max_nbuckets = gtm->tunnel_by_key_max_buckets,
+    };
+
+    clib_bihash_init2_8_8 (&a4);
+    clib_bihash_init2_24_8 (&a6);
+  }
+
+  if (gtm->tunnel_by_key_max_buckets > gtm->tunnel_by_key_buckets)
+    {
+      vlib_bihash_resize_register_type (&gtm->gtpu4_tunnel_by_key, 8_8);
+      vlib_bihash_resize_register_type (&gtm->gtpu6_tunnel_by_key, 24_8);
+    }
+
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (gtpu_config, "gtpu");
+
 /* *INDENT-OFF* */
 VLIB_PLUGIN_REGISTER () = {
     .version = VPP_BUILD_VER,
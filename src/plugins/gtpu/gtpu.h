@@ -21,6 +21,8 @@
 #include <vppinfra/lock.h>
 #include <vppinfra/error.h>
 #include <vppinfra/hash.h>
+#include <vppinfra/bihash_8_8.h>
+#include <vppinfra/bihash_24_8.h>
 #include <vnet/vnet.h>
 #include <vnet/ip/ip.h>
 #include <vnet/ip/vtep.h>
@@ -112,17 +114,34 @@ typedef CLIB_PACKED
 }) gtpu4_tunnel_key_t;
 /* *INDENT-ON* */
 
-/* *INDENT-OFF* */
-typedef CLIB_PACKED
-(struct {
-  /*
-   * Key fields: ip src and gtpu teid on incoming gtpu packet
-   * all fields in NET byte order
-   */
-  ip6_address_t src;
-  u32 teid;
-}) gtpu6_tunnel_key_t;
-/* *INDENT-ON* */
+always_inline void
+gtpu4_tunnel_make_key (clib_bihash_kv_8_8_t * kv, u32 src, u32 teid)
+{
+  gtpu4_tunnel_key_t key4 = {.src = src,.teid = teid };
+
+  kv->key = key4.as_u64;
+  kv->value = ~0ULL;
+}
+
+/*
+ * IPv6 tunnels are keyed in a clib_bihash_24_8_t: key[0] and key[1] hold
+ * the ip src, key[2] the gtpu teid, all fields in NET byte order.
+ */
+always_inline void
+gtpu6_tunnel_make_key (clib_bihash_kv_24_8_t * kv,
+		       const ip6_address_t * src, u32 teid)
+{
+  kv->key[0] = src->as_u64[0];
+  kv->key[1] = src->as_u64[1];
+  kv->key[2] = teid;
+  kv->value = ~0ULL;
+}
+
+typedef enum
+{
+  /* send, and accept, IPv6 UDP checksums of zero (RFC 6935/6936) */
+  GTPU_TUNNEL_F_UDP_ZERO_CSUM = (1 << 0),
+} gtpu_tunnel_flags_t;
 
 typedef struct
 {
@@ -138,6 +157,12 @@ typedef struct
   /* gtpu teid in HOST byte order */
   u32 teid;
 
+  /* gtpu_tunnel_flags_t */
+  u8 flags;
+
+  /* IPv6 pseudo-header sum of the fixed fields: addresses and protocol */
+  ip_csum_t ip6_phdr_sum;
+
   /* tunnel src and dst addresses */
   ip46_address_t src;
   ip46_address_t dst;
@@ -200,14 +225,41 @@ typedef enum
   GTPU_N_ERROR,
 } gtpu_input_error_t;
 
+/*
+ * Default sizing of the tunnel lookup tables, overridden with
+ * "gtpu { tunnel-hash-buckets <n> tunnel-hash-memory <size> }".
+ * With "tunnel-hash-max-buckets <n>" the tables start at
+ * tunnel-hash-buckets and double in the background as tunnels are
+ * added, up to <n> buckets.
+ */
+#define GTPU_TUNNEL_BY_KEY_NUM_BUCKETS (256 * 1024)
+#define GTPU_TUNNEL_BY_KEY_MEMORY_SIZE (256 << 20)
+
+#define foreach_gtpu_handoff_mode		\
+  _(NONE, "disabled")				\
+  _(TEID, "teid")				\
+  _(INNER, "inner-flow")
+
+/* how gtpu4/6-handoff picks the worker decapsulating a packet */
+typedef enum
+{
+#define _(sym,str) GTPU_HANDOFF_##sym,
+  foreach_gtpu_handoff_mode
+#undef _
+    GTPU_HANDOFF_N_MODE,
+} gtpu_handoff_mode_t;
+
 typedef struct
 {
   /* vector of encap tunnel instances */
   gtpu_tunnel_t *tunnels;
 
   /* lookup tunnel by key */
-  uword *gtpu4_tunnel_by_key;	/* keyed on ipv4.dst + teid */
-  uword *gtpu6_tunnel_by_key;	/* keyed on ipv6.dst + teid */
+  clib_bihash_8_8_t gtpu4_tunnel_by_key;	/* keyed on ipv4.dst + teid */
+  clib_bihash_24_8_t gtpu6_tunnel_by_key;	/* keyed on ipv6.dst + teid */
+  u32 tunnel_by_key_buckets;
+  u32 tunnel_by_key_max_buckets;
+  uword tunnel_by_key_memory;
 
   /* local VTEP IPs ref count used by gtpu-bypass node to check if
      received gtpu packet DIP matches any local VTEP address */
@@ -234,6 +286,12 @@ typedef struct
   vlib_main_t *vlib_main;
   vnet_main_t *vnet_main;
   u32 flow_id_start;
+
+  /* decap worker handoff, indexed by is_ip6 */
+  gtpu_handoff_mode_t handoff_mode[2];
+  u32 handoff_fq_index[2];
+  u32 handoff_first_worker_index;
+  u32 handoff_n_workers;
 } gtpu_main_t;
 
 extern gtpu_main_t gtpu_main;
@@ -243,9 +301,31 @@ extern vlib_node_registration_t gtpu6_input_node;
 extern vlib_node_registration_t gtpu4_encap_node;
 extern vlib_node_registration_t gtpu6_encap_node;
 extern vlib_node_registration_t gtpu4_flow_input_node;
+extern vlib_node_registration_t gtpu4_handoff_node;
+extern vlib_node_registration_t gtpu6_handoff_node;
 
 u8 *format_gtpu_encap_trace (u8 * s, va_list * args);
 
+/**
+ * Seed the UDP checksum of an IPv6 encapsulated packet with its
+ * pseudo-header sum and flag it for checksum offload, so the NIC, or
+ * interface-output when the NIC cannot, fills in the rest. Tunnels in
+ * zero-checksum mode keep the zero checksum of their rewrite.
+ */
+always_inline void
+gtpu6_encap_udp_checksum (vlib_buffer_t * b, gtpu_tunnel_t * t,
+			  ip6_header_t * ip6, udp_header_t * udp)
+{
+  if (t->flags & GTPU_TUNNEL_F_UDP_ZERO_CSUM)
+    return;
+
+  udp->checksum = ip_csum_fold (ip_csum_with_carry (t->ip6_phdr_sum,
+						    udp->length));
+  b->flags |= VNET_BUFFER_F_IS_IP6 | VNET_BUFFER_F_OFFLOAD_UDP_CKSUM;
+  vnet_buffer (b)->l3_hdr_offset = (u8 *) ip6 - b->data;
+  vnet_buffer (b)->l4_hdr_offset = (u8 *) udp - b->data;
+}
+
 typedef struct
 {
   u8 is_add;
@@ -254,6 +334,7 @@ typedef struct
   u32 encap_fib_index;
   u32 decap_next_index;
   u32 teid;
+  u8 flags;
 } vnet_gtpu_add_del_tunnel_args_t;
 
 int vnet_gtpu_add_del_tunnel
@@ -268,6 +349,8 @@ typedef struct
 void vnet_int_gtpu_bypass_mode (u32 sw_if_index, u8 is_ip6, u8 is_enable);
 u32 vnet_gtpu_get_tunnel_index (u32 sw_if_index);
 int vnet_gtpu_add_del_rx_flow (u32 hw_if_index, u32 t_imdex, int is_add);
+int vnet_gtpu_set_handoff (u8 is_ip6, gtpu_handoff_mode_t mode);
+format_function_t format_gtpu_handoff_mode;
 
 #endif /* included_vnet_gtpu_h */
 
@@ -54,6 +54,87 @@ validate_gtpu_fib (vlib_buffer_t *b, gtpu_tunnel_t *t, u32 is_ip4)
   return t->encap_fib_index == vlib_buffer_get_ip_fib_index (b, is_ip4);
 }
 
+/* RFC 6936: a zero UDP checksum is only accepted on tunnels agreeing to it */
+always_inline u32
+gtpu6_zero_checksum_denied (gtpu_tunnel_t *t, ip6_header_t *ip6)
+{
+  udp_header_t *udp = (udp_header_t *) (ip6 + 1);
+  return udp->checksum == 0 && !(t->flags & GTPU_TUNNEL_F_UDP_ZERO_CSUM);
+}
+
+/* How many packets ahead of the lookup the tunnel key/value page is
+   prefetched; its bucket was already prefetched by the hashing pass. */
+#define GTPU_LOOKUP_PREFETCH_STRIDE 4
+
+/*
+ * Hash the tunnel key of every packet in the frame and prefetch its
+ * bucket, so that with a large tunnel table the lookups in gtpu_input()
+ * find both the bucket and (see GTPU_LOOKUP_PREFETCH_STRIDE) the
+ * key/value page in cache.
+ */
+always_inline void
+gtpu_input_hash_keys (vlib_main_t * vm, gtpu_main_t * gtm, u32 * from,
+		      u64 * hashes, u32 n_left, u32 is_ip4)
+{
+  while (n_left > 0)
+    {
+      vlib_buffer_t *b0;
+      gtpu_header_t *gtpu0;
+
+      if (n_left > GTPU_LOOKUP_PREFETCH_STRIDE)
+	{
+	  vlib_buffer_t *pb;
+
+	  pb = vlib_get_buffer (vm, from[GTPU_LOOKUP_PREFETCH_STRIDE]);
+	  vlib_prefetch_buffer_header (pb, LOAD);
+	  CLIB_PREFETCH (pb->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      /* udp leaves current_data pointing at the gtpu header */
+      b0 = vlib_get_buffer (vm, from[0]);
+      gtpu0 = vlib_buffer_get_current (b0);
+
+      if (is_ip4)
+	{
+	  ip4_header_t *ip4_0;
+	  clib_bihash_kv_8_8_t kv4_0;
+
+	  ip4_0 = (void *) ((u8 *) gtpu0 - sizeof (udp_header_t) -
+			    sizeof (ip4_header_t));
+	  gtpu4_tunnel_make_key (&kv4_0, ip4_0->src_address.as_u32,
+				 gtpu0->teid);
+	  hashes[0] = clib_bihash_hash_8_8 (&kv4_0);
+	  clib_bihash_prefetch_bucket_8_8 (&gtm->gtpu4_tunnel_by_key,
+					   hashes[0]);
+	}
+      else
+	{
+	  ip6_header_t *ip6_0;
+	  clib_bihash_kv_24_8_t kv6_0;
+
+	  ip6_0 = (void *) ((u8 *) gtpu0 - sizeof (udp_header_t) -
+			    sizeof (ip6_header_t));
+	  gtpu6_tunnel_make_key (&kv6_0, &ip6_0->src_address, gtpu0->teid);
+	  hashes[0] = clib_bihash_hash_24_8 (&kv6_0);
+	  clib_bihash_prefetch_bucket_24_8 (&gtm->gtpu6_tunnel_by_key,
+					    hashes[0]);
+	}
+
+      from += 1;
+      hashes += 1;
+      n_left -= 1;
+    }
+}
+
+always_inline void
+gtpu_input_prefetch_kvp (gtpu_main_t * gtm, u64 hash, u32 is_ip4)
+{
+  if (is_ip4)
+    clib_bihash_prefetch_data_8_8 (&gtm->gtpu4_tunnel_by_key, hash);
+  else
+    clib_bihash_prefetch_data_24_8 (&gtm->gtpu6_tunnel_by_key, hash);
+}
+
 always_inline uword
 gtpu_input (vlib_main_t * vm,
              vlib_node_runtime_t * node,
@@ -65,20 +146,24 @@ gtpu_input (vlib_main_t * vm,
   vnet_main_t * vnm = gtm->vnet_main;
   vnet_interface_main_t * im = &vnm->interface_main;
   u32 last_tunnel_index = ~0;
-  gtpu4_tunnel_key_t last_key4;
-  gtpu6_tunnel_key_t last_key6;
+  clib_bihash_kv_8_8_t last_kv4;
+  clib_bihash_kv_24_8_t last_kv6;
+  u64 hashes[VLIB_FRAME_SIZE], * hash;
   u32 pkts_decapsulated = 0;
   u32 thread_index = vlib_get_thread_index();
   u32 stats_sw_if_index, stats_n_packets, stats_n_bytes;
 
   if (is_ip4)
-    last_key4.as_u64 = ~0;
+    last_kv4.key = ~0;
   else
-    clib_memset (&last_key6, 0xff, sizeof (last_key6));
+    clib_memset (&last_kv6, 0xff, sizeof (last_kv6));
 
   from = vlib_frame_vector_args (from_frame);
   n_left_from = from_frame->n_vectors;
 
+  hash = hashes;
+  gtpu_input_hash_keys (vm, gtm, from, hashes, n_left_from, is_ip4);
+
   next_index = node->cached_next_index;
   stats_sw_if_index = node->runtime_data[0];
   stats_n_packets = stats_n_bytes = 0;
@@ -98,11 +183,11 @@ gtpu_input (vlib_main_t * vm,
           ip6_header_t * ip6_0, * ip6_1;
           gtpu_header_t * gtpu0, * gtpu1;
           u32 gtpu_hdr_len0, gtpu_hdr_len1;
-	  uword * p0, * p1;
+	  u64 hash0, hash1;
           u32 tunnel_index0, tunnel_index1;
           gtpu_tunnel_t * t0, * t1, * mt0 = NULL, * mt1 = NULL;
-          gtpu4_tunnel_key_t key4_0, key4_1;
-          gtpu6_tunnel_key_t key6_0, key6_1;
+          clib_bihash_kv_8_8_t kv4_0, kv4_1;
+          clib_bihash_kv_24_8_t kv6_0, kv6_1;
           u32 error0, error1;
 	  u32 sw_if_index0, sw_if_index1, len0, len1;
           u8 has_space0, has_space1;
@@ -120,13 +205,25 @@ gtpu_input (vlib_main_t * vm,
 
 	    CLIB_PREFETCH (p2->data, 2*CLIB_CACHE_LINE_BYTES, LOAD);
 	    CLIB_PREFETCH (p3->data, 2*CLIB_CACHE_LINE_BYTES, LOAD);
+
+	    if (n_left_from > GTPU_LOOKUP_PREFETCH_STRIDE + 1)
+	      {
+		gtpu_input_prefetch_kvp (gtm, hash[GTPU_LOOKUP_PREFETCH_STRIDE],
+					 is_ip4);
+		gtpu_input_prefetch_kvp (gtm,
+					 hash[GTPU_LOOKUP_PREFETCH_STRIDE + 1],
+					 is_ip4);
+	      }
 	  }
 
 	  bi0 = from[0];
 	  bi1 = from[1];
+	  hash0 = hash[0];
+	  hash1 = hash[1];
 	  to_next[0] = bi0;
 	  to_next[1] = bi1;
 	  from += 2;
+	  hash += 2;
 	  to_next += 2;
 	  n_left_to_next -= 2;
 	  n_left_from -= 2;
@@ -178,22 +275,22 @@ gtpu_input (vlib_main_t * vm,
 
 	  /* Manipulate packet 0 */
           if (is_ip4) {
-            key4_0.src = ip4_0->src_address.as_u32;
-            key4_0.teid = gtpu0->teid;
+            gtpu4_tunnel_make_key (&kv4_0, ip4_0->src_address.as_u32,
+                                   gtpu0->teid);
 
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
  	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-           if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
+           if (PREDICT_FALSE (kv4_0.key != last_kv4.key))
               {
-                p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-                if (PREDICT_FALSE (p0 == NULL))
+                if (PREDICT_FALSE (clib_bihash_search_inline_with_hash_8_8
+                                   (&gtm->gtpu4_tunnel_by_key, hash0, &kv4_0)))
                   {
                     error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
                     next0 = GTPU_INPUT_NEXT_DROP;
                     goto trace0;
                   }
-                last_key4.as_u64 = key4_0.as_u64;
-                tunnel_index0 = last_tunnel_index = p0[0];
+                last_kv4.key = kv4_0.key;
+                tunnel_index0 = last_tunnel_index = kv4_0.value;
               }
             else
               tunnel_index0 = last_tunnel_index;
@@ -212,13 +309,13 @@ gtpu_input (vlib_main_t * vm,
 	      goto next0; /* valid packet */
 	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_0->dst_address)))
 	      {
-		key4_0.src = ip4_0->dst_address.as_u32;
-		key4_0.teid = gtpu0->teid;
+		gtpu4_tunnel_make_key (&kv4_0, ip4_0->dst_address.as_u32,
+		                       gtpu0->teid);
 		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-		if (PREDICT_TRUE (p0 != NULL))
+		if (PREDICT_TRUE (!clib_bihash_search_inline_8_8
+		                  (&gtm->gtpu4_tunnel_by_key, &kv4_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv4_0.value);
 		    goto next0; /* valid packet */
 		  }
 	      }
@@ -227,23 +324,22 @@ gtpu_input (vlib_main_t * vm,
 	    goto trace0;
 
          } else /* !is_ip4 */ {
-            key6_0.src.as_u64[0] = ip6_0->src_address.as_u64[0];
-            key6_0.src.as_u64[1] = ip6_0->src_address.as_u64[1];
-            key6_0.teid = gtpu0->teid;
+            gtpu6_tunnel_make_key (&kv6_0, &ip6_0->src_address, gtpu0->teid);
 
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
  	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_0, &last_key6, sizeof(last_key6)) != 0))
+            if (PREDICT_FALSE (!clib_bihash_key_compare_24_8 (kv6_0.key,
+                                                                last_kv6.key)))
               {
-                p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-                if (PREDICT_FALSE (p0 == NULL))
+                if (PREDICT_FALSE (clib_bihash_search_inline_with_hash_24_8
+                                   (&gtm->gtpu6_tunnel_by_key, hash0, &kv6_0)))
                   {
                     error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
                     next0 = GTPU_INPUT_NEXT_DROP;
                     goto trace0;
                   }
-                clib_memcpy_fast (&last_key6, &key6_0, sizeof(key6_0));
-                tunnel_index0 = last_tunnel_index = p0[0];
+                clib_memcpy_fast (&last_kv6, &kv6_0, sizeof(kv6_0));
+                tunnel_index0 = last_tunnel_index = kv6_0.value;
               }
             else
               tunnel_index0 = last_tunnel_index;
@@ -257,19 +353,24 @@ gtpu_input (vlib_main_t * vm,
 		goto trace0;
 	      }
 
+	    if (PREDICT_FALSE (gtpu6_zero_checksum_denied (t0, ip6_0)))
+	      {
+		error0 = GTPU_ERROR_ZERO_CHECKSUM;
+		next0 = GTPU_INPUT_NEXT_DROP;
+		goto trace0;
+	      }
+
 	    /* Validate GTPU tunnel SIP against packet DIP */
 	    if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
 						    &t0->src.ip6)))
 		goto next0; /* valid packet */
 	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_0->dst_address)))
 	      {
-		key6_0.src.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		key6_0.src.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		key6_0.teid = gtpu0->teid;
-		p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-		if (PREDICT_TRUE (p0 != NULL))
+		gtpu6_tunnel_make_key (&kv6_0, &ip6_0->dst_address, gtpu0->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_24_8
+		                  (&gtm->gtpu6_tunnel_by_key, &kv6_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv6_0.value);
 		    goto next0; /* valid packet */
 		  }
 	      }
@@ -336,22 +437,22 @@ gtpu_input (vlib_main_t * vm,
 
           /* Manipulate packet 1 */
           if (is_ip4) {
-            key4_1.src = ip4_1->src_address.as_u32;
-            key4_1.teid = gtpu1->teid;
+            gtpu4_tunnel_make_key (&kv4_1, ip4_1->src_address.as_u32,
+                                   gtpu1->teid);
 
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
  	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-	    if (PREDICT_FALSE (key4_1.as_u64 != last_key4.as_u64))
+	    if (PREDICT_FALSE (kv4_1.key != last_kv4.key))
               {
-                p1 = hash_get (gtm->gtpu4_tunnel_by_key, key4_1.as_u64);
-                if (PREDICT_FALSE (p1 == NULL))
+                if (PREDICT_FALSE (clib_bihash_search_inline_with_hash_8_8
+                                   (&gtm->gtpu4_tunnel_by_key, hash1, &kv4_1)))
                   {
                     error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
                     next1 = GTPU_INPUT_NEXT_DROP;
                     goto trace1;
                   }
-                last_key4.as_u64 = key4_1.as_u64;
-                tunnel_index1 = last_tunnel_index = p1[0];
+                last_kv4.key = kv4_1.key;
+                tunnel_index1 = last_tunnel_index = kv4_1.value;
               }
             else
               tunnel_index1 = last_tunnel_index;
@@ -370,13 +471,13 @@ gtpu_input (vlib_main_t * vm,
 	      goto next1; /* valid packet */
 	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_1->dst_address)))
 	      {
-		key4_1.src = ip4_1->dst_address.as_u32;
-		key4_1.teid = gtpu1->teid;
+		gtpu4_tunnel_make_key (&kv4_1, ip4_1->dst_address.as_u32,
+		                       gtpu1->teid);
 		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p1 = hash_get (gtm->gtpu4_tunnel_by_key, key4_1.as_u64);
-		if (PREDICT_TRUE (p1 != NULL))
+		if (PREDICT_TRUE (!clib_bihash_search_inline_8_8
+		                  (&gtm->gtpu4_tunnel_by_key, &kv4_1)))
 		  {
-		    mt1 = pool_elt_at_index (gtm->tunnels, p1[0]);
+		    mt1 = pool_elt_at_index (gtm->tunnels, kv4_1.value);
 		    goto next1; /* valid packet */
 		  }
 	      }
@@ -385,25 +486,23 @@ gtpu_input (vlib_main_t * vm,
 	    goto trace1;
 
          } else /* !is_ip4 */ {
-            key6_1.src.as_u64[0] = ip6_1->src_address.as_u64[0];
-            key6_1.src.as_u64[1] = ip6_1->src_address.as_u64[1];
-            key6_1.teid = gtpu1->teid;
+            gtpu6_tunnel_make_key (&kv6_1, &ip6_1->src_address, gtpu1->teid);
 
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
  	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_1, &last_key6, sizeof(last_key6)) != 0))
+            if (PREDICT_FALSE (!clib_bihash_key_compare_24_8 (kv6_1.key,
+                                                                last_kv6.key)))
               {
-                p1 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_1);
-
-                if (PREDICT_FALSE (p1 == NULL))
+                if (PREDICT_FALSE (clib_bihash_search_inline_with_hash_24_8
+                                   (&gtm->gtpu6_tunnel_by_key, hash1, &kv6_1)))
                   {
                     error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
                     next1 = GTPU_INPUT_NEXT_DROP;
                     goto trace1;
                   }
 
-                clib_memcpy_fast (&last_key6, &key6_1, sizeof(key6_1));
-                tunnel_index1 = last_tunnel_index = p1[0];
+                clib_memcpy_fast (&last_kv6, &kv6_1, sizeof(kv6_1));
+                tunnel_index1 = last_tunnel_index = kv6_1.value;
               }
             else
               tunnel_index1 = last_tunnel_index;
@@ -417,19 +516,24 @@ gtpu_input (vlib_main_t * vm,
 		goto trace1;
 	      }
 
+	    if (PREDICT_FALSE (gtpu6_zero_checksum_denied (t1, ip6_1)))
+	      {
+		error1 = GTPU_ERROR_ZERO_CHECKSUM;
+		next1 = GTPU_INPUT_NEXT_DROP;
+		goto trace1;
+	      }
+
 	    /* Validate GTPU tunnel SIP against packet DIP */
 	    if (PREDICT_TRUE (ip6_address_is_equal (&ip6_1->dst_address,
 						    &t1->src.ip6)))
 		goto next1; /* valid packet */
 	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_1->dst_address)))
 	      {
-		key6_1.src.as_u64[0] = ip6_1->dst_address.as_u64[0];
-		key6_1.src.as_u64[1] = ip6_1->dst_address.as_u64[1];
-		key6_1.teid = gtpu1->teid;
-		p1 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_1);
-		if (PREDICT_TRUE (p1 != NULL))
+		gtpu6_tunnel_make_key (&kv6_1, &ip6_1->dst_address, gtpu1->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_24_8
+		                  (&gtm->gtpu6_tunnel_by_key, &kv6_1)))
 		  {
-		    mt1 = pool_elt_at_index (gtm->tunnels, p1[0]);
+		    mt1 = pool_elt_at_index (gtm->tunnels, kv6_1.value);
 		    goto next1; /* valid packet */
 		  }
 	      }
@@ -501,19 +605,25 @@ gtpu_input (vlib_main_t * vm,
           ip6_header_t * ip6_0;
           gtpu_header_t * gtpu0;
           u32 gtpu_hdr_len0;
-	  uword * p0;
+	  u64 hash0;
           u32 tunnel_index0;
           gtpu_tunnel_t * t0, * mt0 = NULL;
-          gtpu4_tunnel_key_t key4_0;
-          gtpu6_tunnel_key_t key6_0;
+          clib_bihash_kv_8_8_t kv4_0;
+          clib_bihash_kv_24_8_t kv6_0;
           u32 error0;
 	  u32 sw_if_index0, len0;
           u8 has_space0;
           u8 ver0;
 
+	  if (n_left_from > GTPU_LOOKUP_PREFETCH_STRIDE)
+	    gtpu_input_prefetch_kvp (gtm, hash[GTPU_LOOKUP_PREFETCH_STRIDE],
+				     is_ip4);
+
 	  bi0 = from[0];
+	  hash0 = hash[0];
 	  to_next[0] = bi0;
 	  from += 1;
+	  hash += 1;
 	  to_next += 1;
 	  n_left_from -= 1;
 	  n_left_to_next -= 1;
@@ -551,22 +661,22 @@ gtpu_input (vlib_main_t * vm,
             }
 
           if (is_ip4) {
-            key4_0.src = ip4_0->src_address.as_u32;
-            key4_0.teid = gtpu0->teid;
+            gtpu4_tunnel_make_key (&kv4_0, ip4_0->src_address.as_u32,
+                                   gtpu0->teid);
 
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
  	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
+            if (PREDICT_FALSE (kv4_0.key != last_kv4.key))
               {
-                p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-                if (PREDICT_FALSE (p0 == NULL))
+                if (PREDICT_FALSE (clib_bihash_search_inline_with_hash_8_8
+                                   (&gtm->gtpu4_tunnel_by_key, hash0, &kv4_0)))
                   {
                     error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
                     next0 = GTPU_INPUT_NEXT_DROP;
                     goto trace00;
                   }
-                last_key4.as_u64 = key4_0.as_u64;
-                tunnel_index0 = last_tunnel_index = p0[0];
+                last_kv4.key = kv4_0.key;
+                tunnel_index0 = last_tunnel_index = kv4_0.value;
               }
             else
               tunnel_index0 = last_tunnel_index;
@@ -585,13 +695,13 @@ gtpu_input (vlib_main_t * vm,
 	      goto next00; /* valid packet */
 	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_0->dst_address)))
 	      {
-		key4_0.src = ip4_0->dst_address.as_u32;
-		key4_0.teid = gtpu0->teid;
+		gtpu4_tunnel_make_key (&kv4_0, ip4_0->dst_address.as_u32,
+		                       gtpu0->teid);
 		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-		if (PREDICT_TRUE (p0 != NULL))
+		if (PREDICT_TRUE (!clib_bihash_search_inline_8_8
+		                  (&gtm->gtpu4_tunnel_by_key, &kv4_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv4_0.value);
 		    goto next00; /* valid packet */
 		  }
 	      }
@@ -600,23 +710,22 @@ gtpu_input (vlib_main_t * vm,
 	    goto trace00;
 
           } else /* !is_ip4 */ {
-            key6_0.src.as_u64[0] = ip6_0->src_address.as_u64[0];
-            key6_0.src.as_u64[1] = ip6_0->src_address.as_u64[1];
-            key6_0.teid = gtpu0->teid;
+            gtpu6_tunnel_make_key (&kv6_0, &ip6_0->src_address, gtpu0->teid);
 
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
  	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_0, &last_key6, sizeof(last_key6)) != 0))
+            if (PREDICT_FALSE (!clib_bihash_key_compare_24_8 (kv6_0.key,
+                                                                last_kv6.key)))
               {
-                p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-                if (PREDICT_FALSE (p0 == NULL))
+                if (PREDICT_FALSE (clib_bihash_search_inline_with_hash_24_8
+                                   (&gtm->gtpu6_tunnel_by_key, hash0, &kv6_0)))
                   {
                     error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
                     next0 = GTPU_INPUT_NEXT_DROP;
                     goto trace00;
                   }
-                clib_memcpy_fast (&last_key6, &key6_0, sizeof(key6_0));
-                tunnel_index0 = last_tunnel_index = p0[0];
+                clib_memcpy_fast (&last_kv6, &kv6_0, sizeof(kv6_0));
+                tunnel_index0 = last_tunnel_index = kv6_0.value;
               }
             else
               tunnel_index0 = last_tunnel_index;
@@ -630,19 +739,24 @@ gtpu_input (vlib_main_t * vm,
 		goto trace00;
 	      }
 
+	    if (PREDICT_FALSE (gtpu6_zero_checksum_denied (t0, ip6_0)))
+	      {
+		error0 = GTPU_ERROR_ZERO_CHECKSUM;
+		next0 = GTPU_INPUT_NEXT_DROP;
+		goto trace00;
+	      }
+
 	    /* Validate GTPU tunnel SIP against packet DIP */
 	    if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
 						    &t0->src.ip6)))
 		goto next00; /* valid packet */
 	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_0->dst_address)))
 	      {
-		key6_0.src.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		key6_0.src.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		key6_0.teid = gtpu0->teid;
-		p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-		if (PREDICT_TRUE (p0 != NULL))
+		gtpu6_tunnel_make_key (&kv6_0, &ip6_0->dst_address, gtpu0->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_24_8
+		                  (&gtm->gtpu6_tunnel_by_key, &kv6_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv6_0.value);
 		    goto next00; /* valid packet */
 		  }
 	      }
@@ -788,6 +902,7 @@ VLIB_REGISTER_NODE (gtpu6_input_node) = {
 typedef enum {
   IP_GTPU_BYPASS_NEXT_DROP,
   IP_GTPU_BYPASS_NEXT_GTPU,
+  IP_GTPU_BYPASS_NEXT_HANDOFF,
   IP_GTPU_BYPASS_N_NEXT,
 } ip_vxan_bypass_next_t;
 
@@ -804,6 +919,8 @@ ip_gtpu_bypass_inline (vlib_main_t * vm,
 				   matching a local VTEP address */
   vtep6_key_t last_vtep6;	/* last IPv6 address / fib index
 				   matching a local VTEP address */
+  u32 next_gtpu = gtm->handoff_mode[!is_ip4] != GTPU_HANDOFF_NONE ?
+    IP_GTPU_BYPASS_NEXT_HANDOFF : IP_GTPU_BYPASS_NEXT_GTPU;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
@@ -948,7 +1065,7 @@ ip_gtpu_bypass_inline (vlib_main_t * vm,
 	    }
 
 	  next0 = error0 ?
-	    IP_GTPU_BYPASS_NEXT_DROP : IP_GTPU_BYPASS_NEXT_GTPU;
+	    IP_GTPU_BYPASS_NEXT_DROP : next_gtpu;
 	  b0->error = error0 ? error_node->errors[error0] : 0;
 
 	  /* gtpu-input node expect current at GTPU header */
@@ -1022,7 +1139,7 @@ ip_gtpu_bypass_inline (vlib_main_t * vm,
 	    }
 
 	  next1 = error1 ?
-	    IP_GTPU_BYPASS_NEXT_DROP : IP_GTPU_BYPASS_NEXT_GTPU;
+	    IP_GTPU_BYPASS_NEXT_DROP : next_gtpu;
 	  b1->error = error1 ? error_node->errors[error1] : 0;
 
 	  /* gtpu-input node expect current at GTPU header */
@@ -1132,7 +1249,7 @@ ip_gtpu_bypass_inline (vlib_main_t * vm,
 	    }
 
 	  next0 = error0 ?
-	    IP_GTPU_BYPASS_NEXT_DROP : IP_GTPU_BYPASS_NEXT_GTPU;
+	    IP_GTPU_BYPASS_NEXT_DROP : next_gtpu;
 	  b0->error = error0 ? error_node->errors[error0] : 0;
 
 	  /* gtpu-input node expect current at GTPU header */
@@ -1168,6 +1285,7 @@ VLIB_REGISTER_NODE (ip4_gtpu_bypass_node) = {
   .next_nodes = {
     [IP_GTPU_BYPASS_NEXT_DROP] = "error-drop",
     [IP_GTPU_BYPASS_NEXT_GTPU] = "gtpu4-input",
+    [IP_GTPU_BYPASS_NEXT_HANDOFF] = "gtpu4-handoff",
   },
 
   .format_buffer = format_ip4_header,
@@ -1197,6 +1315,7 @@ VLIB_REGISTER_NODE (ip6_gtpu_bypass_node) = {
   .next_nodes = {
     [IP_GTPU_BYPASS_NEXT_DROP] = "error-drop",
     [IP_GTPU_BYPASS_NEXT_GTPU] = "gtpu6-input",
+    [IP_GTPU_BYPASS_NEXT_HANDOFF] = "gtpu6-handoff",
   },
 
   .format_buffer = format_ip6_header,
@@ -302,8 +302,6 @@ gtpu_encap_inline (vlib_main_t * vm,
 	    }
 	  else /* ipv6 */
 	    {
-              int bogus = 0;
-
 	      ip6_0 = vlib_buffer_get_current(b0);
 	      ip6_1 = vlib_buffer_get_current(b1);
 	      ip6_2 = vlib_buffer_get_current(b2);
@@ -385,23 +383,11 @@ gtpu_encap_inline (vlib_main_t * vm,
 					     - GTPU_V1_HDR_LEN);
 	      gtpu3->length = new_l3;
 
-	      /* IPv6 UDP checksum is mandatory */
-	      udp0->checksum = ip6_tcp_udp_icmp_compute_checksum(vm, b0,
-								 ip6_0, &bogus);
-	      if (udp0->checksum == 0)
-		udp0->checksum = 0xffff;
-	      udp1->checksum = ip6_tcp_udp_icmp_compute_checksum(vm, b1,
-								 ip6_1, &bogus);
-	      if (udp1->checksum == 0)
-		udp1->checksum = 0xffff;
-	      udp2->checksum = ip6_tcp_udp_icmp_compute_checksum(vm, b2,
-								 ip6_2, &bogus);
-	      if (udp2->checksum == 0)
-		udp2->checksum = 0xffff;
-	      udp3->checksum = ip6_tcp_udp_icmp_compute_checksum(vm, b3,
-								 ip6_3, &bogus);
-	      if (udp3->checksum == 0)
-		udp3->checksum = 0xffff;
+	      /* IPv6 UDP checksum is mandatory, leave it to the NIC */
+	      gtpu6_encap_udp_checksum (b0, t0, ip6_0, udp0);
+	      gtpu6_encap_udp_checksum (b1, t1, ip6_1, udp1);
+	      gtpu6_encap_udp_checksum (b2, t2, ip6_2, udp2);
+	      gtpu6_encap_udp_checksum (b3, t3, ip6_3, udp3);
 
 	    }
 
@@ -577,8 +563,6 @@ gtpu_encap_inline (vlib_main_t * vm,
 
 	  else /* ip6 path */
 	    {
-              int bogus = 0;
-
 	      ip6_0 = vlib_buffer_get_current(b0);
 	      /* Copy the fixed header */
 	      copy_dst0 = (u64 *) ip6_0;
@@ -601,15 +585,12 @@ gtpu_encap_inline (vlib_main_t * vm,
 	      /* Fix GTPU length */
 	      gtpu0 = (gtpu_header_t *)(udp0+1);
 	      new_l0 = clib_host_to_net_u16 (vlib_buffer_length_in_chain(vm, b0)
-					     - sizeof (*ip4_0) - sizeof(*udp0)
+					     - sizeof (*ip6_0) - sizeof(*udp0)
 					     - GTPU_V1_HDR_LEN);
 	      gtpu0->length = new_l0;
 
-	      /* IPv6 UDP checksum is mandatory */
-	      udp0->checksum = ip6_tcp_udp_icmp_compute_checksum(vm, b0,
-								 ip6_0, &bogus);
-	      if (udp0->checksum == 0)
-		udp0->checksum = 0xffff;
+	      /* IPv6 UDP checksum is mandatory, leave it to the NIC */
+	      gtpu6_encap_udp_checksum (b0, t0, ip6_0, udp0);
 	    }
 
           pkts_encapsulated ++;
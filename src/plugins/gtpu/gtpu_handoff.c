@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ * @file
+ * @brief GTPU decap worker handoff
+ *
+ * All the traffic of a gNB shares one outer 5-tuple, so NIC RSS puts it
+ * on one queue and one worker. When enabled, the UDP port of GTPU is
+ * bound to these nodes instead of gtpu4/6-input, which spread packets
+ * over the workers by TEID, or by the hash of the inner IP flow, and
+ * hand them to gtpu4/6-input there.
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vnet/ip/ip.h>
+#include <gtpu/gtpu.h>
+
+typedef struct
+{
+  u32 next_worker_index;
+  u32 trace_index;
+  u32 teid;
+} gtpu_handoff_trace_t;
+
+#define foreach_gtpu_handoff_error                       \
+_(CONGESTION_DROP, "congestion drop")                    \
+_(SAME_WORKER, "same worker")                            \
+_(DO_HANDOFF, "do handoff")
+
+typedef enum
+{
+#define _(sym,str) GTPU_HANDOFF_ERROR_##sym,
+  foreach_gtpu_handoff_error
+#undef _
+    GTPU_HANDOFF_N_ERROR,
+} gtpu_handoff_error_t;
+
+static char *gtpu_handoff_error_strings[] = {
+#define _(sym,string) string,
+  foreach_gtpu_handoff_error
+#undef _
+};
+
+static u8 *
+format_gtpu_handoff_trace (u8 * s, va_list * args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  gtpu_handoff_trace_t *t = va_arg (*args, gtpu_handoff_trace_t *);
+
+  s = format (s, "GTPU_HANDOFF: teid %u next-worker %d trace index %d",
+	      t->teid, t->next_worker_index, t->trace_index);
+
+  return s;
+}
+
+/*
+ * Tunnel a packet decapsulates on, as gtpu4/6-input finds it, only to
+ * know what the payload is. 0 when there is none, gtpu4/6-input drops
+ * such packets anyway.
+ */
+static_always_inline gtpu_tunnel_t *
+gtpu_handoff_tunnel (gtpu_main_t * gtm, gtpu_header_t * gtpu, u32 is_ip4)
+{
+  if (is_ip4)
+    {
+      ip4_header_t *ip4 = (void *) ((u8 *) gtpu - sizeof (udp_header_t) -
+				    sizeof (ip4_header_t));
+      clib_bihash_kv_8_8_t kv4;
+
+      gtpu4_tunnel_make_key (&kv4, ip4->src_address.as_u32, gtpu->teid);
+      if (clib_bihash_search_inline_8_8 (&gtm->gtpu4_tunnel_by_key, &kv4))
+	return 0;
+      return pool_elt_at_index (gtm->tunnels, kv4.value);
+    }
+  else
+    {
+      ip6_header_t *ip6 = (void *) ((u8 *) gtpu - sizeof (udp_header_t) -
+				    sizeof (ip6_header_t));
+      /* the avx512 key compare loads 64 bytes */
+      union
+      {
+	clib_bihash_kv_24_8_t kv;
+	u64 as_u64[8];
+      } u;
+      clib_bihash_kv_24_8_t *kv6 = &u.kv;
+
+      gtpu6_tunnel_make_key (kv6, &ip6->src_address, gtpu->teid);
+      if (clib_bihash_search_inline_24_8 (&gtm->gtpu6_tunnel_by_key, kv6))
+	return 0;
+      return pool_elt_at_index (gtm->tunnels, kv6->value);
+    }
+}
+
+/*
+ * Hash of the inner IP flow of a GTPU packet, falling back to the TEID
+ * when the payload is not IP behind the fixed GTPU header. What the
+ * payload is comes from the decap-next of its tunnel: IP for ip4 and
+ * ip6, Ethernet, possibly VLAN tagged, for l2.
+ */
+static_always_inline u32
+gtpu_handoff_inner_hash (gtpu_main_t * gtm, vlib_buffer_t * b,
+			 gtpu_header_t * gtpu, u32 teid, u32 is_ip4)
+{
+  u32 hdr_len = GTPU_V1_HDR_LEN;
+  u16 type = 0;
+  gtpu_tunnel_t *t;
+  u8 *inner;
+  int i;
+
+  if (gtpu->ver_flags & GTPU_E_S_PN_BIT)
+    {
+      /* extension headers would need walking */
+      if ((gtpu->ver_flags & GTPU_E_BIT) && gtpu->next_ext_type)
+	return teid;
+      hdr_len = sizeof (gtpu_header_t);
+    }
+
+  t = gtpu_handoff_tunnel (gtm, gtpu, is_ip4);
+  if (!t)
+    return teid;
+
+  inner = (u8 *) gtpu + hdr_len;
+
+  switch (t->decap_next_index)
+    {
+    case GTPU_INPUT_NEXT_IP4_INPUT:
+      type = ETHERNET_TYPE_IP4;
+      break;
+
+    case GTPU_INPUT_NEXT_IP6_INPUT:
+      type = ETHERNET_TYPE_IP6;
+      break;
+
+    case GTPU_INPUT_NEXT_L2_INPUT:
+      hdr_len += sizeof (ethernet_header_t);
+      if (b->current_length < hdr_len)
+	return teid;
+      type = clib_net_to_host_u16 (((ethernet_header_t *) inner)->type);
+      inner += sizeof (ethernet_header_t);
+
+      /* up to two VLAN tags, as ethernet-input */
+      for (i = 0; i < 2 && (type == ETHERNET_TYPE_VLAN ||
+			    type == ETHERNET_TYPE_DOT1AD); i++)
+	{
+	  hdr_len += sizeof (ethernet_vlan_header_t);
+	  if (b->current_length < hdr_len)
+	    return teid;
+	  type = clib_net_to_host_u16 (((ethernet_vlan_header_t *)
+					inner)->type);
+	  inner += sizeof (ethernet_vlan_header_t);
+	}
+      break;
+    }
+
+  if (type == ETHERNET_TYPE_IP4
+      && b->current_length >= hdr_len + sizeof (ip4_header_t)
+      && (inner[0] & 0xf0) == 0x40)
+    return ip4_compute_flow_hash ((ip4_header_t *) inner,
+				  IP_FLOW_HASH_DEFAULT);
+
+  if (type == ETHERNET_TYPE_IP6
+      && b->current_length >= hdr_len + sizeof (ip6_header_t)
+      && (inner[0] & 0xf0) == 0x60)
+    return ip6_compute_flow_hash ((ip6_header_t *) inner,
+				  IP_FLOW_HASH_DEFAULT);
+
+  return teid;
+}
+
+static_always_inline u16
+gtpu_handoff_worker (gtpu_main_t * gtm, vlib_buffer_t * b,
+		     gtpu_handoff_mode_t mode, u32 * teidp, u32 is_ip4)
+{
+  /* udp leaves current_data pointing at the gtpu header */
+  gtpu_header_t *gtpu = vlib_buffer_get_current (b);
+  u32 teid = clib_net_to_host_u32 (gtpu->teid);
+  u32 hash;
+
+  *teidp = teid;
+
+  if (mode == GTPU_HANDOFF_INNER)
+    hash = gtpu_handoff_inner_hash (gtm, b, gtpu, teid, is_ip4);
+  else
+    hash = teid;
+
+  /* TEIDs are often allocated in sequence, mix them before scaling */
+  hash *= 0x9e3779b1;
+
+  return gtm->handoff_first_worker_index +
+    (((u64) hash * gtm->handoff_n_workers) >> 32);
+}
+
+static_always_inline uword
+gtpu_handoff_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
+		     vlib_frame_t * frame, u32 is_ip4)
+{
+  gtpu_main_t *gtm = &gtpu_main;
+  u32 n_enq, n_left_from, *from, do_handoff = 0, same_worker = 0;
+  u16 thread_indices[VLIB_FRAME_SIZE], *ti = thread_indices;
+  u32 teids[VLIB_FRAME_SIZE], *teid = teids;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  gtpu_handoff_mode_t mode = gtm->handoff_mode[!is_ip4];
+  u32 fq_index = gtm->handoff_fq_index[!is_ip4];
+  u32 thread_index = vm->thread_index;
+
+  from = vlib_frame_vector_args (frame);
+  n_left_from = frame->n_vectors;
+
+  vlib_get_buffers (vm, from, b, n_left_from);
+
+  while (n_left_from >= 4)
+    {
+      if (PREDICT_TRUE (n_left_from >= 8))
+	{
+	  vlib_prefetch_buffer_header (b[4], LOAD);
+	  vlib_prefetch_buffer_header (b[5], LOAD);
+	  vlib_prefetch_buffer_header (b[6], LOAD);
+	  vlib_prefetch_buffer_header (b[7], LOAD);
+	  CLIB_PREFETCH (b[4]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	  CLIB_PREFETCH (b[5]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	  CLIB_PREFETCH (b[6]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	  CLIB_PREFETCH (b[7]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      ti[0] = gtpu_handoff_worker (gtm, b[0], mode, &teid[0], is_ip4);
+      ti[1] = gtpu_handoff_worker (gtm, b[1], mode, &teid[1], is_ip4);
+      ti[2] = gtpu_handoff_worker (gtm, b[2], mode, &teid[2], is_ip4);
+      ti[3] = gtpu_handoff_worker (gtm, b[3], mode, &teid[3], is_ip4);
+
+      same_worker += (ti[0] == thread_index) + (ti[1] == thread_index) +
+	(ti[2] == thread_index) + (ti[3] == thread_index);
+
+      b += 4;
+      ti += 4;
+      teid += 4;
+      n_left_from -= 4;
+    }
+
+  while (n_left_from > 0)
+    {
+      ti[0] = gtpu_handoff_worker (gtm, b[0], mode, &teid[0], is_ip4);
+
+      same_worker += (ti[0] == thread_index);
+
+      b += 1;
+      ti += 1;
+      teid += 1;
+      n_left_from -= 1;
+    }
+
+  do_handoff = frame->n_vectors - same_worker;
+
+  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
+    {
+      u32 i;
+      b = bufs;
+      ti = thread_indices;
+      teid = teids;
+
+      for (i = 0; i < frame->n_vectors; i++)
+	{
+	  if (b[0]->flags & VLIB_BUFFER_IS_TRACED)
+	    {
+	      gtpu_handoff_trace_t *t =
+		vlib_add_trace (vm, node, b[0], sizeof (*t));
+	      t->next_worker_index = ti[0];
+	      t->trace_index = vlib_buffer_get_trace_index (b[0]);
+	      t->teid = teid[0];
+
+	      b += 1;
+	      ti += 1;
+	      teid += 1;
+	    }
+	  else
+	    break;
+	}
+    }
+
+  n_enq = vlib_buffer_enqueue_to_thread (vm, fq_index, from, thread_indices,
+					 frame->n_vectors, 1);
+
+  if (n_enq < frame->n_vectors)
+    vlib_node_increment_counter (vm, node->node_index,
+				 GTPU_HANDOFF_ERROR_CONGESTION_DROP,
+				 frame->n_vectors - n_enq);
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       GTPU_HANDOFF_ERROR_SAME_WORKER, same_worker);
+  vlib_node_increment_counter (vm, node->node_index,
+			       GTPU_HANDOFF_ERROR_DO_HANDOFF, do_handoff);
+
+  return frame->n_vectors;
+}
+
+VLIB_NODE_FN (gtpu4_handoff_node) (vlib_main_t * vm,
+				   vlib_node_runtime_t * node,
+				   vlib_frame_t * frame)
+{
+  return gtpu_handoff_inline (vm, node, frame, /* is_ip4 */ 1);
+}
+
+VLIB_NODE_FN (gtpu6_handoff_node) (vlib_main_t * vm,
+				   vlib_node_runtime_t * node,
+				   vlib_frame_t * frame)
+{
+  return gtpu_handoff_inline (vm, node, frame, /* is_ip4 */ 0);
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (gtpu4_handoff_node) = {
+  .name = "gtpu4-handoff",
+  .vector_size = sizeof (u32),
+  .format_trace = format_gtpu_handoff_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = ARRAY_LEN (gtpu_handoff_error_strings),
+  .error_strings = gtpu_handoff_error_strings,
+  .n_next_nodes = 1,
+  .next_nodes = {
+    [0] = "error-drop",
+  },
+};
+
+VLIB_REGISTER_NODE (gtpu6_handoff_node) = {
+  .name = "gtpu6-handoff",
+  .vector_size = sizeof (u32),
+  .format_trace = format_gtpu_handoff_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = ARRAY_LEN (gtpu_handoff_error_strings),
+  .error_strings = gtpu_handoff_error_strings,
+  .n_next_nodes = 1,
+  .next_nodes = {
+    [0] = "error-drop",
+  },
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
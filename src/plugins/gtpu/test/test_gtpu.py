@@ -232,6 +232,37 @@ class TestGtpu(BridgeDomain, VppTestCase):
         # payload = self.decapsulate(pkt)
         # self.assert_eq_pkts(payload, self.frame_reply)
 
+    def test_decap_many_tunnels(self):
+        """ Decapsulation from many tunnels test
+        Send frames from pg0 interleaving all unicast flood tunnels with
+        an unknown teid
+        Verify receipt of the decapsulated frames of known tunnels on pg3
+        """
+        n_rounds = 4
+        pkts = []
+        for i in range(n_rounds):
+            for src_ip4 in self.ip_range(10, 10 + self.n_ucast_tunnels):
+                for teid in (self.ucast_flood_bd, 0xdead):
+                    pkts.append(
+                        Ether(src=self.pg0.remote_mac,
+                              dst=self.pg0.local_mac) /
+                        IP(src=src_ip4, dst=self.pg0.local_ip4) /
+                        UDP(sport=self.dport, dport=self.dport, chksum=0) /
+                        GTP_U_Header(teid=teid, gtp_type=self.gtp_type,
+                                     length=150) /
+                        self.frame_request)
+
+        self.pg0.add_stream(pkts)
+
+        self.pg3.enable_capture()
+
+        self.pg_start()
+
+        # Only the frames of the unicast flood tunnels are decapsulated
+        out = self.pg3.get_capture(n_rounds * self.n_ucast_tunnels)
+        for pkt in out:
+            self.assert_eq_pkts(pkt, self.frame_request)
+
     @classmethod
     def create_gtpu_flood_test_bd(cls, teid, n_ucast_tunnels):
         # Create 10 ucast gtpu tunnels under bd
@@ -407,5 +438,314 @@ class TestGtpu(BridgeDomain, VppTestCase):
         self.logger.info(self.vapi.cli("show trace"))
 
 
+class TestGtpu6Checksum(VppTestCase):
+    """ GTPU IPv6 UDP checksum Test Case """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestGtpu6Checksum, cls).setUpClass()
+
+        try:
+            cls.dport = 2152
+
+            cls.create_pg_interfaces(range(3))
+            for pg in cls.pg_interfaces:
+                pg.admin_up()
+            cls.pg0.config_ip6()
+            cls.pg0.resolve_ndp()
+
+            # teid 21 sends checksums, teid 22 is in zero-checksum mode
+            cls.csum_teid = 21
+            cls.zero_teid = 22
+            r = cls.vapi.gtpu_add_del_tunnel(
+                is_add=True,
+                mcast_sw_if_index=0xFFFFFFFF,
+                decap_next_index=0xFFFFFFFF,
+                src_address=cls.pg0.local_ip6,
+                dst_address=cls.pg0.remote_ip6,
+                teid=cls.csum_teid)
+            cls.vapi.sw_interface_set_l2_bridge(rx_sw_if_index=r.sw_if_index,
+                                                bd_id=cls.csum_teid)
+            cls.vapi.sw_interface_set_l2_bridge(
+                rx_sw_if_index=cls.pg1.sw_if_index, bd_id=cls.csum_teid)
+
+            name = cls.vapi.cli("create gtpu tunnel src %s dst %s teid %d "
+                                "zero-checksum" % (cls.pg0.local_ip6,
+                                                   cls.pg0.remote_ip6,
+                                                   cls.zero_teid)).strip()
+            cls.vapi.cli("set interface l2 bridge %s %d" %
+                         (name, cls.zero_teid))
+            cls.vapi.sw_interface_set_l2_bridge(
+                rx_sw_if_index=cls.pg2.sw_if_index, bd_id=cls.zero_teid)
+        except Exception:
+            super(TestGtpu6Checksum, cls).tearDownClass()
+            raise
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestGtpu6Checksum, cls).tearDownClass()
+
+    @property
+    def frame(self):
+        return (Ether(src='00:00:00:00:00:02', dst='00:00:00:00:00:01') /
+                IP(src='1.2.3.4', dst='4.3.2.1') /
+                UDP(sport=10000, dport=20000) /
+                Raw(b'\xa5' * 1000))
+
+    def encapsulate(self, teid, chksum=None):
+        return (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+                IPv6(src=self.pg0.remote_ip6, dst=self.pg0.local_ip6) /
+                UDP(sport=self.dport, dport=self.dport, chksum=chksum) /
+                GTP_U_Header(teid=teid, gtp_type=0xff) /
+                self.frame)
+
+    def test_encap_checksum(self):
+        """ IPv6 encapsulation sends a valid UDP checksum """
+        out = self.send_and_expect(self.pg1, [self.frame] * 5,
+                                   self.pg0)
+        for pkt in out:
+            self.assertEqual(pkt[GTP_U_Header].teid, self.csum_teid)
+            self.assertNotEqual(pkt[UDP].chksum, 0)
+            self.assert_packet_checksums_valid(pkt)
+
+    def test_encap_zero_checksum(self):
+        """ IPv6 encapsulation in zero-checksum mode """
+        out = self.send_and_expect(self.pg2, [self.frame] * 5,
+                                   self.pg0)
+        for pkt in out:
+            self.assertEqual(pkt[GTP_U_Header].teid, self.zero_teid)
+            self.assertEqual(pkt[UDP].chksum, 0)
+
+    def test_decap_zero_checksum(self):
+        """ IPv6 zero UDP checksum only accepted in zero-checksum mode """
+        err = self.statistics.get_err_counter(
+            '/err/gtpu6-input/zero udp checksum on a tunnel not allowing it')
+
+        self.send_and_assert_no_replies(
+            self.pg0, [self.encapsulate(self.csum_teid, chksum=0)] * 5)
+        self.assertEqual(err + 5, self.statistics.get_err_counter(
+            '/err/gtpu6-input/zero udp checksum on a tunnel not allowing it'))
+
+        self.send_and_expect(self.pg0,
+                             [self.encapsulate(self.csum_teid)] * 5,
+                             self.pg1)
+        self.send_and_expect(self.pg0,
+                             [self.encapsulate(self.zero_teid, chksum=0)] * 5,
+                             self.pg2)
+
+    def test_encap_checksum_benchmark(self):
+        """ IPv6 encapsulation checksum benchmark """
+        reply = self.vapi.cli("test gtpu encap-checksum size 1400 "
+                              "buffers 16 rounds 10")
+        self.logger.info(reply)
+        for mode in ("compute", "offload", "offload+sw", "zero"):
+            self.assertIn(mode, reply)
+
+
+class TestGtpuHandoff(VppTestCase):
+    """ GTPU decap worker handoff Test Case """
+
+    worker_config = "workers 2"
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestGtpuHandoff, cls).setUpClass()
+
+        try:
+            cls.dport = 2152
+            cls.bd_id = 31
+            cls.teids = range(100, 108)
+
+            cls.create_pg_interfaces(range(3))
+            for pg in cls.pg_interfaces:
+                pg.admin_up()
+            cls.pg0.config_ip4()
+            cls.pg0.resolve_arp()
+            cls.pg2.config_ip4()
+            cls.pg2.resolve_arp()
+
+            cls.vapi.sw_interface_set_l2_bridge(
+                rx_sw_if_index=cls.pg1.sw_if_index, bd_id=cls.bd_id)
+            for teid in cls.teids:
+                r = cls.vapi.gtpu_add_del_tunnel(
+                    is_add=True,
+                    mcast_sw_if_index=0xFFFFFFFF,
+                    decap_next_index=0xFFFFFFFF,
+                    src_address=cls.pg0.local_ip4,
+                    dst_address=cls.pg0.remote_ip4,
+                    teid=teid)
+                cls.vapi.sw_interface_set_l2_bridge(
+                    rx_sw_if_index=r.sw_if_index, bd_id=cls.bd_id)
+
+            # an IP tunnel, decapsulating to ip4-input and routed to pg2
+            cls.ip_teid = 200
+            r = cls.vapi.gtpu_add_del_tunnel(
+                is_add=True,
+                mcast_sw_if_index=0xFFFFFFFF,
+                decap_next_index=2,  # GTPU_INPUT_NEXT_IP4_INPUT
+                src_address=cls.pg0.local_ip4,
+                dst_address=cls.pg0.remote_ip4,
+                teid=cls.ip_teid)
+            cls.vapi.sw_interface_set_flags(r.sw_if_index, 1)
+            cls.vapi.sw_interface_set_unnumbered(
+                sw_if_index=cls.pg0.sw_if_index,
+                unnumbered_sw_if_index=r.sw_if_index)
+        except Exception:
+            super(TestGtpuHandoff, cls).tearDownClass()
+            raise
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestGtpuHandoff, cls).tearDownClass()
+
+    def tearDown(self):
+        self.vapi.cli("set gtpu handoff ip4 disabled")
+        super(TestGtpuHandoff, self).tearDown()
+
+    def encapsulate(self, teid, inner_src):
+        return (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+                IP(src=self.pg0.remote_ip4, dst=self.pg0.local_ip4) /
+                UDP(sport=self.dport, dport=self.dport, chksum=0) /
+                GTP_U_Header(teid=teid, gtp_type=0xff) /
+                Ether(src='00:00:00:00:00:02', dst='00:00:00:00:00:01') /
+                IP(src=inner_src, dst='4.3.2.1') /
+                UDP(sport=10000, dport=20000) /
+                Raw(b'\xa5' * 100))
+
+    def encapsulate_ip(self, teid, inner_src):
+        return (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+                IP(src=self.pg0.remote_ip4, dst=self.pg0.local_ip4) /
+                UDP(sport=self.dport, dport=self.dport, chksum=0) /
+                GTP_U_Header(teid=teid, gtp_type=0xff) /
+                IP(src=inner_src, dst=self.pg2.remote_ip4) /
+                UDP(sport=10000, dport=20000) /
+                Raw(b'\xa5' * 100))
+
+    def handoff_counters(self):
+        return [self.statistics.get_err_counter(
+            '/err/gtpu4-handoff/%s' % name)
+            for name in ('same worker', 'do handoff', 'congestion drop')]
+
+    def verify_handoff(self, pkts, output=None):
+        before = self.handoff_counters()
+        self.send_and_expect(self.pg0, pkts, output or self.pg1, worker=0)
+        after = self.handoff_counters()
+        same, handoff, congestion = [a - b for a, b in zip(after, before)]
+
+        self.assertEqual(same + handoff, len(pkts))
+        self.assertGreater(same, 0)
+        self.assertGreater(handoff, 0)
+        self.assertEqual(congestion, 0)
+
+    def test_handoff_teid(self):
+        """ Handoff by TEID """
+        self.vapi.cli("set gtpu handoff ip4 teid")
+        self.assertIn("ip4: teid", self.vapi.cli("show gtpu handoff"))
+
+        self.verify_handoff([self.encapsulate(teid, '1.2.3.4')
+                             for teid in self.teids] * 4)
+
+    def test_handoff_inner_flow(self):
+        """ Handoff by inner flow hash """
+        self.vapi.cli("set gtpu handoff ip4 inner-flow")
+
+        # all on one tunnel, only the inner flows differ
+        self.verify_handoff([self.encapsulate(self.teids[0], '1.2.3.%d' % i)
+                             for i in range(1, 33)])
+
+    def test_handoff_inner_flow_ip(self):
+        """ Handoff by inner flow hash, IP decap """
+        self.vapi.cli("set gtpu handoff ip4 inner-flow")
+
+        # all on one tunnel, only the inner flows differ
+        self.verify_handoff([self.encapsulate_ip(self.ip_teid,
+                                                 '1.2.3.%d' % i)
+                             for i in range(1, 33)], self.pg2)
+
+    def test_handoff_disabled(self):
+        """ Decap without handoff """
+        before = self.handoff_counters()
+        self.send_and_expect(self.pg0,
+                             [self.encapsulate(teid, '1.2.3.4')
+                              for teid in self.teids],
+                             self.pg1, worker=0)
+        self.assertEqual(before, self.handoff_counters())
+
+
+class TestGtpuTunnelHashResize(VppTestCase):
+    """ GTPU tunnel table background growth Test Case """
+
+    # start tiny so that a few tunnels crowd the table
+    extra_vpp_punt_config = ["gtpu", "{",
+                             "tunnel-hash-buckets", "4",
+                             "tunnel-hash-max-buckets", "1024", "}"]
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestGtpuTunnelHashResize, cls).setUpClass()
+
+        try:
+            cls.dport = 2152
+            cls.bd_id = 41
+            cls.teids = range(1000, 1100)
+
+            cls.create_pg_interfaces(range(3))
+            for pg in cls.pg_interfaces:
+                pg.admin_up()
+            cls.pg0.config_ip4()
+            cls.pg0.resolve_arp()
+            cls.pg2.config_ip4()
+            cls.pg2.resolve_arp()
+
+            cls.vapi.sw_interface_set_l2_bridge(
+                rx_sw_if_index=cls.pg1.sw_if_index, bd_id=cls.bd_id)
+        except Exception:
+            super(TestGtpuTunnelHashResize, cls).tearDownClass()
+            raise
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestGtpuTunnelHashResize, cls).tearDownClass()
+
+    def tunnel_hash_buckets(self):
+        for line in self.vapi.cli("show bihash").splitlines():
+            if line.startswith("gtpu4 tunnel by key"):
+                return int(line[len("gtpu4 tunnel by key"):].split()[0])
+        return 0
+
+    def test_tunnel_hash_grows(self):
+        """ Tunnel table grows with the number of tunnels """
+        for teid in self.teids:
+            r = self.vapi.gtpu_add_del_tunnel(
+                is_add=True,
+                mcast_sw_if_index=0xFFFFFFFF,
+                decap_next_index=0xFFFFFFFF,
+                src_address=self.pg0.local_ip4,
+                dst_address=self.pg0.remote_ip4,
+                teid=teid)
+            self.vapi.sw_interface_set_l2_bridge(
+                rx_sw_if_index=r.sw_if_index, bd_id=self.bd_id)
+
+        # the resize process looks at the table every second
+        for i in range(10):
+            if self.tunnel_hash_buckets() > 4:
+                break
+            self.sleep(1, "waiting for the tunnel table to grow")
+        self.assertGreater(self.tunnel_hash_buckets(), 4)
+        self.assertLessEqual(self.tunnel_hash_buckets(), 1024)
+
+        # every tunnel is still found once the table has grown
+        pkts = [(Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+                 IP(src=self.pg0.remote_ip4, dst=self.pg0.local_ip4) /
+                 UDP(sport=self.dport, dport=self.dport, chksum=0) /
+                 GTP_U_Header(teid=teid, gtp_type=0xff) /
+                 Ether(src='00:00:00:00:00:02', dst='00:00:00:00:00:01') /
+                 IP(src='1.2.3.4', dst='4.3.2.1') /
+                 UDP(sport=10000, dport=20000) /
+                 Raw(b'\xa5' * 100))
+                for teid in self.teids]
+        self.send_and_expect(self.pg0, pkts, self.pg1)
+
+
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
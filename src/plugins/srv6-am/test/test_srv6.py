@@ -216,6 +216,13 @@ class TestSRv6(VppTestCase):
         self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
                                   self.compare_rx_tx_packet_T_Encaps)
 
+        # the policy and its SID list count every packet in the stat segment
+        for counter in ["/net/sr/policy", "/net/sr/sid-list"]:
+            c = self.statistics.get_counter("^%s$" % counter)
+            self.assertEqual(sum(t[0]['packets'] for t in c), len(pkts))
+            names = self.statistics.get_counter("^%s/names$" % counter)
+            self.assertTrue(names[0].startswith(bsid))
+
         # log the localsid counters
         self.logger.info(self.vapi.cli("show sr localsid"))
 
@@ -233,6 +240,228 @@ class TestSRv6(VppTestCase):
         # cleanup interfaces
         self.teardown_interfaces()
 
+    def test_SRv6_T_Encaps_Red(self):
+        """ Test SRv6 Transit.Encaps.Red behavior for IPv6.
+        """
+        # send traffic to one destination interface
+        # source and destination are IPv6 only
+        self.setup_interfaces(ipv6=[True, True])
+
+        # configure FIB entries
+        route = VppIpRoute(self, "a4::", 64,
+                           [VppRoutePath(self.pg1.remote_ip6,
+                                         self.pg1.sw_if_index)])
+        route.add_vpp_config()
+
+        # configure encaps IPv6 source address
+        self.vapi.cli("set sr encaps source addr a3::")
+
+        # the reduced mode is only exposed on the CLI
+        bsid = 'a3::9999:1'
+        self.sr_segments = ['a4::', 'a5::', 'a6::c7']
+        self.sr_source = 'a3::'
+        self.vapi.cli("sr policy add bsid %s next %s encap reduced" %
+                      (bsid, " next ".join(self.sr_segments)))
+
+        # log the sr policies
+        self.logger.info(self.vapi.cli("show sr policies"))
+
+        # steer IPv6 traffic to a7::/64 into SRv6 Policy
+        pol_steering = VppSRv6Steering(
+                        self,
+                        bsid=bsid,
+                        prefix="a7::", mask_width=64,
+                        traffic_type=SRv6PolicySteeringTypes.SR_STEER_IPV6,
+                        sr_policy_index=0, table_id=0,
+                        sw_if_index=0)
+        pol_steering.add_vpp_config()
+
+        # create IPv6 packets without SRH
+        count = len(self.pg_packet_sizes)
+        packet_header = self.create_packet_header_IPv6('a7::1234')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+
+        # send packets and verify received packets
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
+                                  self.compare_rx_tx_packet_T_Encaps_Red)
+
+        # remove SR steering and policy
+        pol_steering.remove_vpp_config()
+        self.vapi.cli("sr policy del bsid %s" % bsid)
+
+        # cleanup interfaces
+        self.teardown_interfaces()
+
+    def test_SRv6_T_Encaps_uSID(self):
+        """ Test SRv6 Transit.Encaps behavior with uSID compression.
+        """
+        self.setup_interfaces(ipv6=[True, True])
+
+        # configure FIB entries
+        route = VppIpRoute(self, "fc00::", 32,
+                           [VppRoutePath(self.pg1.remote_ip6,
+                                         self.pg1.sw_if_index)])
+        route.add_vpp_config()
+
+        self.vapi.cli("set sr encaps source addr a3::")
+
+        # three uSIDs of the fc00::/32 block fit in a single carrier
+        bsid = 'a3::9999:1'
+        self.sr_carriers = ['fc00:0:1:2:3::']
+        self.sr_source = 'a3::'
+        self.vapi.cli("sr policy add bsid %s next fc00:0:1:: "
+                      "next fc00:0:2:: next fc00:0:3:: encap "
+                      "usid-block fc00::/32 usid-len 16" % bsid)
+
+        self.logger.info(self.vapi.cli("show sr policies"))
+
+        pol_steering = VppSRv6Steering(
+                        self,
+                        bsid=bsid,
+                        prefix="a7::", mask_width=64,
+                        traffic_type=SRv6PolicySteeringTypes.SR_STEER_IPV6,
+                        sr_policy_index=0, table_id=0,
+                        sw_if_index=0)
+        pol_steering.add_vpp_config()
+
+        count = len(self.pg_packet_sizes)
+        packet_header = self.create_packet_header_IPv6('a7::1234')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
+                                  self.compare_rx_tx_packet_T_Encaps_uSID)
+
+        pol_steering.remove_vpp_config()
+        self.vapi.cli("sr policy del bsid %s" % bsid)
+
+        self.teardown_interfaces()
+
+    def test_SRv6_T_Encaps_uSID_block_SID(self):
+        """ Test SRv6 Transit.Encaps with uSID compression and a SID
+            equal to the uSID block.
+        """
+        self.setup_interfaces(ipv6=[True, True])
+
+        # configure FIB entries
+        route = VppIpRoute(self, "fc00::", 32,
+                           [VppRoutePath(self.pg1.remote_ip6,
+                                         self.pg1.sw_if_index)])
+        route.add_vpp_config()
+
+        self.vapi.cli("set sr encaps source addr a3::")
+
+        # fc00:: has an all-zero uSID, which would end the carrier: it is
+        # kept as a full SID and the uSIDs after it go in a new carrier
+        bsid = 'a3::9999:2'
+        self.sr_carriers = ['fc00:0:1::', 'fc00::', 'fc00:0:3:4::']
+        self.sr_source = 'a3::'
+        self.vapi.cli("sr policy add bsid %s next fc00:0:1:: next fc00:: "
+                      "next fc00:0:3:: next fc00:0:4:: encap "
+                      "usid-block fc00::/32 usid-len 16" % bsid)
+
+        self.logger.info(self.vapi.cli("show sr policies"))
+
+        pol_steering = VppSRv6Steering(
+                        self,
+                        bsid=bsid,
+                        prefix="a7::", mask_width=64,
+                        traffic_type=SRv6PolicySteeringTypes.SR_STEER_IPV6,
+                        sr_policy_index=0, table_id=0,
+                        sw_if_index=0)
+        pol_steering.add_vpp_config()
+
+        count = len(self.pg_packet_sizes)
+        packet_header = self.create_packet_header_IPv6('a7::1234')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
+                                  self.compare_rx_tx_packet_T_Encaps_uSID)
+
+        pol_steering.remove_vpp_config()
+        self.vapi.cli("sr policy del bsid %s" % bsid)
+
+        self.teardown_interfaces()
+
+    def test_SRv6_T_Encaps_Bulk(self):
+        """ Test SRv6 Transit.Encaps with the bulk steering table.
+        """
+        self.setup_interfaces(ipv6=[True, True])
+
+        # configure FIB entries
+        route = VppIpRoute(self, "a4::", 64,
+                           [VppRoutePath(self.pg1.remote_ip6,
+                                         self.pg1.sw_if_index)])
+        route.add_vpp_config()
+
+        self.vapi.cli("set sr encaps source addr a3::")
+
+        bsid = 'a3::9999:1'
+        sr_policy = VppSRv6Policy(
+            self, bsid=bsid,
+            is_encap=1,
+            sr_type=SRv6PolicyType.SR_POLICY_TYPE_DEFAULT,
+            weight=1, fib_table=0,
+            segments=['a4::', 'a5::', 'a6::c7'],
+            source='a3::')
+        sr_policy.add_vpp_config()
+        self.sr_policy = sr_policy
+
+        # a7::/64 plus a batch of host routes, in a single message
+        entries = [{'prefix': 'a7::/64', 'table_id': 0, 'bsid_addr': bsid}]
+        entries.extend({'prefix': 'b7::%x/128' % i, 'table_id': 0,
+                        'bsid_addr': bsid} for i in range(1, 1001))
+        self.vapi.sr_steering_bulk_add_del(count=len(entries),
+                                           entries=entries)
+        self.vapi.sr_steering_bulk_enable_disable(
+            sw_if_index=self.pg0.sw_if_index, enable=1)
+
+        self.assertIn("Bulk steering entries: %d" % len(entries),
+                      self.vapi.cli("show sr steering-policies"))
+
+        # a shorter rule on the same prefix, through another policy
+        bsid_48 = 'a3::9999:2'
+        sr_policy_48 = VppSRv6Policy(
+            self, bsid=bsid_48,
+            is_encap=1,
+            sr_type=SRv6PolicyType.SR_POLICY_TYPE_DEFAULT,
+            weight=1, fib_table=0,
+            segments=['a4::', 'a8::', 'a9::c7'],
+            source='a3::')
+        sr_policy_48.add_vpp_config()
+        self.vapi.cli("sr steer bulk l3 a7::/48 via bsid %s" % bsid_48)
+
+        count = len(self.pg_packet_sizes)
+
+        # the /64 must not be shadowed by the /48
+        packet_header = self.create_packet_header_IPv6('a7::1234')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
+                                  self.compare_rx_tx_packet_T_Encaps)
+
+        # the rest of the /48 goes through its own policy
+        self.sr_policy = sr_policy_48
+        packet_header = self.create_packet_header_IPv6('a7:0:0:1::1234')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
+                                  self.compare_rx_tx_packet_T_Encaps)
+
+        # deleting the policies flushes their bulk rules
+        self.vapi.sr_steering_bulk_enable_disable(
+            sw_if_index=self.pg0.sw_if_index, enable=0)
+        sr_policy.remove_vpp_config()
+        self.assertIn("Bulk steering entries: 1",
+                      self.vapi.cli("show sr steering-policies"))
+        sr_policy_48.remove_vpp_config()
+        self.assertIn("Bulk steering entries: 0",
+                      self.vapi.cli("show sr steering-policies"))
+
+        self.teardown_interfaces()
+
     @unittest.skipUnless(0, "PC to fix")
     def test_SRv6_T_Insert(self):
         """ Test SRv6 Transit.Insert behavior (IPv6 only).
@@ -406,6 +635,61 @@ class TestSRv6(VppTestCase):
         self.teardown_interfaces()
 
     @unittest.skip("VPP crashes after running this test")
+    def test_SRv6_T_Encaps_IPv4_Entropy(self):
+        """ Test SRv6 Transit.Encaps for IPv4 with flow label entropy.
+        """
+        self.setup_interfaces(ipv6=[False, True], ipv4=[True, False])
+
+        # configure FIB entries
+        route = VppIpRoute(self, "a4::", 64,
+                           [VppRoutePath(self.pg1.remote_ip6,
+                                         self.pg1.sw_if_index)])
+        route.add_vpp_config()
+
+        self.vapi.cli("set sr encaps source addr a3::")
+
+        bsid = 'a3::9999:1'
+        sr_policy = VppSRv6Policy(
+            self, bsid=bsid,
+            is_encap=1,
+            sr_type=SRv6PolicyType.SR_POLICY_TYPE_DEFAULT,
+            weight=1, fib_table=0,
+            segments=['a4::', 'a5::', 'a6::c7'],
+            source='a3::')
+        sr_policy.add_vpp_config()
+        self.sr_policy = sr_policy
+
+        self.vapi.cli("set sr policy flow-label-entropy bsid %s" % bsid)
+        self.logger.info(self.vapi.cli("show sr policies"))
+
+        pol_steering = VppSRv6Steering(
+                        self,
+                        bsid=self.sr_policy.bsid,
+                        prefix="7.1.1.0", mask_width=24,
+                        traffic_type=SRv6PolicySteeringTypes.SR_STEER_IPV4,
+                        sr_policy_index=0, table_id=0,
+                        sw_if_index=0)
+        pol_steering.add_vpp_config()
+
+        # a single inner flow
+        count = len(self.pg_packet_sizes)
+        packet_header = self.create_packet_header_IPv4('7.1.1.123')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+
+        self.flow_labels = set()
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
+                                  self.compare_rx_tx_packet_T_Encaps_Entropy)
+
+        # every packet of the flow carries the same non-zero label
+        self.assertEqual(len(self.flow_labels), 1)
+        self.assertNotEqual(self.flow_labels.pop(), 0)
+
+        pol_steering.remove_vpp_config()
+        self.sr_policy.remove_vpp_config()
+
+        self.teardown_interfaces()
+
     def test_SRv6_T_Encaps_L2(self):
         """ Test SRv6 Transit.Encaps behavior for L2.
         """
@@ -1087,6 +1371,73 @@ class TestSRv6(VppTestCase):
         # cleanup interfaces
         self.teardown_interfaces()
 
+    def test_SRv6_End_DT46(self):
+        """ Test SRv6 End.DT46 behavior.
+        """
+        # one source interface (IPv6-only, global FIB)
+        # two dual-stack destinations, in global and vrf
+        vrf_1 = 1
+        ipt4 = VppIpTable(self, vrf_1)
+        ipt4.add_vpp_config()
+        ipt6 = VppIpTable(self, vrf_1, is_ip6=1)
+        ipt6.add_vpp_config()
+        self.setup_interfaces(ipv6=[True, True, True],
+                              ipv4=[False, True, True],
+                              ipv6_table_id=[0, 0, vrf_1],
+                              ipv4_table_id=[0, 0, vrf_1])
+
+        # 4.1.1.0/24 and a4::/64 are reachable
+        #     via pg1 in table 0 (global)
+        #     and via pg2 in table vrf_1
+        for table_id, intf in [(0, self.pg1), (vrf_1, self.pg2)]:
+            VppIpRoute(self, "4.1.1.0", 24,
+                       [VppRoutePath(intf.remote_ip4, intf.sw_if_index,
+                                     nh_table_id=table_id)],
+                       table_id=table_id).add_vpp_config()
+            VppIpRoute(self, "a4::", 64,
+                       [VppRoutePath(intf.remote_ip6, intf.sw_if_index,
+                                     nh_table_id=table_id)],
+                       table_id=table_id).add_vpp_config()
+
+        # a single SID for both address families
+        localsid = VppSRv6LocalSID(
+                        self, localsid='A3::C4',
+                        behavior=SRv6LocalSIDBehaviors.SR_BEHAVIOR_DT46,
+                        nh_addr=0,
+                        end_psp=0,
+                        sw_if_index=vrf_1,
+                        vlan_index=0,
+                        fib_table=0)
+        localsid.add_vpp_config()
+        self.logger.debug(self.vapi.cli("show sr localsid"))
+
+        pkts = []
+
+        # interleave both inner address families in the same frames
+        for size in self.pg_packet_sizes:
+            packet_header = self.create_packet_header_IPv6_SRH_IPv4(
+                            '4.1.1.123',
+                            sidlist=['a3::c4', 'a2::', 'a1::'],
+                            segleft=0)
+            pkts.extend(self.create_stream(self.pg0, self.pg2,
+                                           packet_header, [size], 1))
+            packet_header = self.create_packet_header_IPv6_IPv6(
+                            'a4::1234', dst_outer='a3::c4')
+            pkts.extend(self.create_stream(self.pg0, self.pg2,
+                                           packet_header, [size], 1))
+
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg2,
+                                  self.compare_rx_tx_packet_End_DT46)
+
+        # assert nothing was received on the global table interface
+        self.pg1.assert_nothing_captured("mis-directed packet(s)")
+
+        self.logger.info(self.vapi.cli("show sr localsid"))
+
+        localsid.remove_vpp_config()
+
+        self.teardown_interfaces()
+
     def test_SRv6_End_DX2(self):
         """ Test SRv6 End.DX2 behavior.
         """
@@ -1363,6 +1714,66 @@ class TestSRv6(VppTestCase):
 
         self.logger.debug("packet verification: SUCCESS")
 
+    def compare_rx_tx_packet_T_Encaps_Red(self, tx_pkt, rx_pkt):
+        """ Compare input and output packet after passing T.Encaps.Red
+
+        :param tx_pkt: transmitted packet
+        :param rx_pkt: received packet
+        """
+        # T.Encaps.Red leaves the first SID out of the SRH:
+        # SR Policy seglist (S3, S2, S1)
+        # in: IPv6(A, B2)
+        # out: IPv6(C, S1)SRH(S3, S2; SL=2, LE=1)IPv6(A, B2)
+        rx_ip = rx_pkt.getlayer(IPv6)
+        tx_ip = tx_pkt.getlayer(IPv6)
+
+        self.assertTrue(rx_pkt.haslayer(IPv6ExtHdrSegmentRouting))
+        rx_srh = rx_pkt.getlayer(IPv6ExtHdrSegmentRouting)
+
+        self.assertEqual(rx_ip.src, self.sr_source)
+        self.assertEqual(rx_ip.dst, self.sr_segments[0])
+        self.assertEqual(rx_srh.addresses, self.sr_segments[:0:-1])
+        self.assertEqual(rx_srh.segleft, len(self.sr_segments) - 1)
+        self.assertEqual(rx_srh.lastentry, len(self.sr_segments) - 2)
+
+        tx_ip.hlim = tx_ip.hlim - 1
+
+        self.assertEqual(rx_srh.payload, tx_ip)
+
+        self.logger.debug("packet verification: SUCCESS")
+
+    def compare_rx_tx_packet_T_Encaps_uSID(self, tx_pkt, rx_pkt):
+        """ Compare input and output packet after passing T.Encaps with
+            uSID carriers
+
+        :param tx_pkt: transmitted packet
+        :param rx_pkt: received packet
+        """
+        # in: IPv6(A, B2)
+        # out: IPv6(C, carrier)IPv6(A, B2)
+        # or:  IPv6(C, S1)SRH(S3, S2, S1; SL=2)IPv6(A, B2)
+        rx_ip = rx_pkt.getlayer(IPv6)
+        tx_ip = tx_pkt.getlayer(IPv6)
+
+        self.assertEqual(rx_ip.src, self.sr_source)
+        self.assertEqual(rx_ip.dst, self.sr_carriers[0])
+
+        if len(self.sr_carriers) == 1:
+            # the carrier holds every uSID, no SRH is needed
+            self.assertFalse(rx_pkt.haslayer(IPv6ExtHdrSegmentRouting))
+            rx_payload = rx_ip.payload
+        else:
+            rx_srh = rx_pkt.getlayer(IPv6ExtHdrSegmentRouting)
+            self.assertEqual(rx_srh.addresses, self.sr_carriers[::-1])
+            self.assertEqual(rx_srh.segleft, len(self.sr_carriers) - 1)
+            rx_payload = rx_srh.payload
+
+        tx_ip.hlim = tx_ip.hlim - 1
+
+        self.assertEqual(rx_payload, tx_ip)
+
+        self.logger.debug("packet verification: SUCCESS")
+
     def compare_rx_tx_packet_T_Encaps_IPv4(self, tx_pkt, rx_pkt):
         """ Compare input and output packet after passing T.Encaps for IPv4
 
@@ -1422,6 +1833,16 @@ class TestSRv6(VppTestCase):
 
         self.logger.debug("packet verification: SUCCESS")
 
+    def compare_rx_tx_packet_T_Encaps_Entropy(self, tx_pkt, rx_pkt):
+        """ Compare input and output packet after passing T.Encaps with
+            flow label entropy, and collect the outer flow label
+
+        :param tx_pkt: transmitted packet
+        :param rx_pkt: received packet
+        """
+        self.flow_labels.add(rx_pkt.getlayer(IPv6).fl)
+        self.compare_rx_tx_packet_T_Encaps_IPv4(tx_pkt, rx_pkt)
+
     def compare_rx_tx_packet_T_Encaps_L2(self, tx_pkt, rx_pkt):
         """ Compare input and output packet after passing T.Encaps for L2
 
@@ -1750,6 +2171,19 @@ class TestSRv6(VppTestCase):
 
         self.logger.debug("packet verification: SUCCESS")
 
+    def compare_rx_tx_packet_End_DT46(self, tx_pkt, rx_pkt):
+        """ Compare input and output packet after passing End.DT46
+
+        :param tx_pkt: transmitted packet
+        :param rx_pkt: received packet
+        """
+        # End.DT46 decapsulates like End.DX4 or End.DX6, depending on
+        # the inner address family
+        if tx_pkt.haslayer(IP):
+            self.compare_rx_tx_packet_End_DX4(tx_pkt, rx_pkt)
+        else:
+            self.compare_rx_tx_packet_End_DX6(tx_pkt, rx_pkt)
+
     def compare_rx_tx_packet_End_DX2(self, tx_pkt, rx_pkt):
         """ Compare input and output packet after passing End.DX2
 
@@ -68,7 +68,7 @@ static u8 keyword_str[] = "t.m.gtp4.d";
 static u8 def_str[] =
   "Transit function with decapsulation for IPv4/GTP tunnel";
 static u8 param_str[] =
-  "<sr-prefix>/<sr-prefixlen> v6src_prefix <v6src_prefix>/<prefixlen> [nhtype <nhtype>]";
+  "<sr-prefix>/<sr-prefixlen> v6src_prefix <v6src_prefix>/<prefixlen> [nhtype <nhtype>] [echo-local]";
 
 static u8 *
 clb_format_srv6_t_m_gtp4_d (u8 * s, va_list * args)
@@ -99,6 +99,9 @@ clb_format_srv6_t_m_gtp4_d (u8 * s, va_list * args)
   else
     s = format (s, "\n");
 
+  if (ls_mem->echo_local)
+    s = format (s, "\tEcho requests answered locally\n");
+
   return s;
 }
 
@@ -158,12 +161,29 @@ clb_unformat_srv6_t_m_gtp4_d (unformat_input_t * input, va_list * args)
 
   ls_mem->nhtype = nhtype;
 
+  ls_mem->echo_local = unformat (input, "echo-local");
+
+  ls_mem->sr_policy_index = ~0;
+
   return 1;
 }
 
 static int
 clb_creation_srv6_t_m_gtp4_d (ip6_sr_policy_t * sr_policy)
 {
+  srv6_end_gtp4_param_t *ls_mem = sr_policy->plugin_mem;
+
+  /* Called once per SID list; set the counters up with the first one */
+  if (vec_len (sr_policy->segments_lists) == 1)
+    {
+      ls_mem->counter_index = sr_policy - sr_main.sr_policies;
+      srv6_mobile_counters_validate (srv6_mobile_policy_counters,
+				     ls_mem->counter_index);
+    }
+
+  srv6_mobile_resolve_sr_policy (&ls_mem->sr_prefix,
+				 &ls_mem->sr_policy_index, &ls_mem->sl_buckets);
+
   return 0;
 }
 
@@ -174,11 +194,63 @@ clb_removal_srv6_t_m_gtp4_d (ip6_sr_policy_t * sr_policy)
 
   ls_mem = (srv6_end_gtp4_param_t *) sr_policy->plugin_mem;
 
+  vec_free (ls_mem->sl_buckets);
   clib_mem_free (ls_mem);
 
   return 0;
 }
 
+/*
+ * An SR policy was added, modified or deleted: refresh every T.M.GTP4.D
+ * policy whose sr_prefix points at it.
+ */
+static void
+srv6_t_m_gtp4_d_policy_change (ip6_address_t * bsid)
+{
+  srv6_t_main_v4_decap_t *sm = &srv6_t_main_v4_decap;
+  ip6_sr_main_t *sm2 = &sr_main;
+  srv6_end_gtp4_param_t *ls_mem;
+  ip6_sr_policy_t *sr_policy;
+
+  /* *INDENT-OFF* */
+  pool_foreach (sr_policy, sm2->sr_policies,
+  ({
+    if (sr_policy->plugin == sm->behavior)
+      {
+        ls_mem = sr_policy->plugin_mem;
+        if (ip6_address_is_equal (&ls_mem->sr_prefix, bsid))
+          srv6_mobile_resolve_sr_policy (&ls_mem->sr_prefix,
+                                         &ls_mem->sr_policy_index,
+                                         &ls_mem->sl_buckets);
+      }
+  }));
+  /* *INDENT-ON* */
+}
+
+static clib_error_t *
+srv6_t_m_gtp4_d_restart_counter_command_fn (vlib_main_t * vm,
+					    unformat_input_t * input,
+					    vlib_cli_command_t * cmd)
+{
+  srv6_t_main_v4_decap_t *sm = &srv6_t_main_v4_decap;
+  u32 restart_counter;
+
+  if (!unformat (input, "%u", &restart_counter) || restart_counter > 0xff)
+    return clib_error_return (0, "expected restart counter 0-255");
+
+  sm->restart_counter = restart_counter;
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (srv6_t_m_gtp4_d_restart_counter_command, static) = {
+  .path = "set sr mobile gtpu restart-counter",
+  .short_help = "set sr mobile gtpu restart-counter <0-255>",
+  .function = srv6_t_m_gtp4_d_restart_counter_command_fn,
+};
+/* *INDENT-ON* */
+
 static clib_error_t *
 srv6_t_m_gtp4_d_init (vlib_main_t * vm)
 {
@@ -217,6 +289,10 @@ srv6_t_m_gtp4_d_init (vlib_main_t * vm)
   if (rc < 0)
     clib_error_return (0, "SRv6 Transit GTP4.D Policy function"
 		       "couldn't be registered");
+
+  sm->behavior = rc;
+  sr_policy_register_change_callback (srv6_t_m_gtp4_d_policy_change);
+
   return 0;
 }
 
@@ -139,6 +139,16 @@ clb_unformat_srv6_t_m_gtp4_dt (unformat_input_t * input, va_list * args)
 static int
 clb_creation_srv6_t_m_gtp4_dt (ip6_sr_policy_t * sr_policy)
 {
+  srv6_t_gtp4_dt_param_t *ls_mem = sr_policy->plugin_mem;
+
+  /* Called once per SID list; set the counters up with the first one */
+  if (vec_len (sr_policy->segments_lists) == 1)
+    {
+      ls_mem->counter_index = sr_policy - sr_main.sr_policies;
+      srv6_mobile_counters_validate (srv6_mobile_policy_counters,
+				     ls_mem->counter_index);
+    }
+
   return 0;
 }
 
@@ -23,6 +23,30 @@
 
 srv6_end_main_v4_t srv6_end_main_v4;
 
+/* *INDENT-OFF* */
+vlib_combined_counter_main_t
+  srv6_mobile_localsid_counters[SRV6_MOBILE_N_MSG_TYPES] = {
+#define _(s,n)						\
+  [SRV6_MOBILE_MSG_##s] = {				\
+    .name = "srv6-mobile-localsid-" n,			\
+    .stat_segment_name = "/net/srv6-mobile/localsid/" n,	\
+  },
+  foreach_srv6_mobile_msg_type
+#undef _
+};
+
+vlib_combined_counter_main_t
+  srv6_mobile_policy_counters[SRV6_MOBILE_N_MSG_TYPES] = {
+#define _(s,n)						\
+  [SRV6_MOBILE_MSG_##s] = {				\
+    .name = "srv6-mobile-policy-" n,			\
+    .stat_segment_name = "/net/srv6-mobile/policy/" n,	\
+  },
+  foreach_srv6_mobile_msg_type
+#undef _
+};
+/* *INDENT-ON* */
+
 static void
 clb_dpo_lock_srv6_end_m_gtp4_e (dpo_id_t * dpo)
 {
@@ -61,7 +85,8 @@ static u8 fn_name[] = "SRv6-End.M.GTP4.E-plugin";
 static u8 keyword_str[] = "end.m.gtp4.e";
 static u8 def_str[] =
   "Endpoint function with encapsulation for IPv4/GTP tunnel";
-static u8 param_str[] = "";
+static u8 param_str[] =
+  "v4src_position <position> [srcport-entropy (flow|teid|fixed <port>)]";
 
 static u8 *
 clb_format_srv6_end_m_gtp4_e (u8 * s, va_list * args)
@@ -70,7 +95,10 @@ clb_format_srv6_end_m_gtp4_e (u8 * s, va_list * args)
 
   s = format (s, "SRv6 End gtp4.e\n\t");
 
-  s = format (s, "IPv4 address position: %d\n", ls_mem->v4src_position);
+  s = format (s, "IPv4 address position: %d, ", ls_mem->v4src_position);
+
+  s = format (s, "UDP source port: %U\n", format_srv6_mobile_srcport,
+	      ls_mem->srcport_mode, ls_mem->srcport);
 
   return s;
 }
@@ -81,8 +109,12 @@ clb_unformat_srv6_end_m_gtp4_e (unformat_input_t * input, va_list * args)
   void **plugin_mem_p = va_arg (*args, void **);
   srv6_end_gtp4_param_t *ls_mem;
   u32 v4src_position;
+  u8 srcport_mode = SRV6_GTPU_SRCPORT_FLOW;
+  u16 srcport = 0;
 
-  if (!unformat (input, "end.m.gtp4.e v4src_position %d", &v4src_position))
+  if (!unformat (input, "end.m.gtp4.e v4src_position %d %U",
+		 &v4src_position, unformat_srv6_mobile_srcport, &srcport_mode,
+		 &srcport))
     return 0;
 
   ls_mem = clib_mem_alloc_aligned_at_offset (sizeof *ls_mem, 0, 0, 1);
@@ -90,6 +122,8 @@ clb_unformat_srv6_end_m_gtp4_e (unformat_input_t * input, va_list * args)
   *plugin_mem_p = ls_mem;
 
   ls_mem->v4src_position = v4src_position;
+  ls_mem->srcport_mode = srcport_mode;
+  ls_mem->srcport = srcport;
 
   return 1;
 }
@@ -97,6 +131,22 @@ clb_unformat_srv6_end_m_gtp4_e (unformat_input_t * input, va_list * args)
 static int
 clb_creation_srv6_end_m_gtp4_e (ip6_sr_localsid_t * localsid)
 {
+  srv6_end_main_v4_t *sm = &srv6_end_main_v4;
+  srv6_end_gtp4_param_t *ls_mem = localsid->plugin_mem;
+  ip4_header_t *ip4 = &ls_mem->cache_hdr.ip4;
+
+  /*
+   * Precompute the localsid rewrite. Length and addresses are still zero
+   * here, so the checksum only covers the fixed fields and the node
+   * folds the rest in incrementally.
+   */
+  clib_memcpy_fast (&ls_mem->cache_hdr, &sm->cache_hdr,
+		    sizeof (ip4_gtpu_header_t));
+  ip4->checksum = ip4_header_checksum (ip4);
+
+  srv6_mobile_counters_validate (srv6_mobile_localsid_counters,
+				 localsid - sr_main.localsids);
+
   return 0;
 }
 
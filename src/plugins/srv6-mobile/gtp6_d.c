@@ -134,12 +134,22 @@ clb_unformat_srv6_end_m_gtp6_d (unformat_input_t * input, va_list * args)
 
   ls_mem->nhtype = nhtype;
 
+  ls_mem->sr_policy_index = ~0;
+
   return 1;
 }
 
 static int
 clb_creation_srv6_end_m_gtp6_d (ip6_sr_localsid_t * localsid)
 {
+  srv6_end_gtp6_param_t *ls_mem = localsid->plugin_mem;
+
+  srv6_mobile_counters_validate (srv6_mobile_localsid_counters,
+				 localsid - sr_main.localsids);
+
+  srv6_mobile_resolve_sr_policy (&ls_mem->sr_prefix,
+				 &ls_mem->sr_policy_index, &ls_mem->sl_buckets);
+
   return 0;
 }
 
@@ -150,11 +160,39 @@ clb_removal_srv6_end_m_gtp6_d (ip6_sr_localsid_t * localsid)
 
   ls_mem = localsid->plugin_mem;
 
+  vec_free (ls_mem->sl_buckets);
   clib_mem_free (ls_mem);
 
   return 0;
 }
 
+/*
+ * An SR policy was added, modified or deleted: refresh every localsid
+ * of this behavior whose sr_prefix points at it.
+ */
+static void
+srv6_end_m_gtp6_d_policy_change (ip6_address_t * bsid)
+{
+  srv6_end_main_v6_decap_t *sm = &srv6_end_main_v6_decap;
+  ip6_sr_main_t *sm2 = &sr_main;
+  srv6_end_gtp6_param_t *ls_mem;
+  ip6_sr_localsid_t *ls;
+
+  /* *INDENT-OFF* */
+  pool_foreach (ls, sm2->localsids,
+  ({
+    if (ls->behavior == sm->behavior)
+      {
+        ls_mem = ls->plugin_mem;
+        if (ip6_address_is_equal (&ls_mem->sr_prefix, bsid))
+          srv6_mobile_resolve_sr_policy (&ls_mem->sr_prefix,
+                                         &ls_mem->sr_policy_index,
+                                         &ls_mem->sl_buckets);
+      }
+  }));
+  /* *INDENT-ON* */
+}
+
 static clib_error_t *
 srv6_end_m_gtp6_d_init (vlib_main_t * vm)
 {
@@ -193,6 +231,10 @@ srv6_end_m_gtp6_d_init (vlib_main_t * vm)
   if (rc < 0)
     clib_error_return (0, "SRv6 Endpoint GTP6.D LocalSID function"
 		       "couldn't be registered");
+
+  sm->behavior = rc;
+  sr_policy_register_change_callback (srv6_end_m_gtp6_d_policy_change);
+
   return 0;
 }
 
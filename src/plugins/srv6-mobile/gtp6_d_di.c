@@ -61,7 +61,8 @@ static u8 fn_name[] = "SRv6-End.M.GTP6.D.DI-plugin";
 static u8 keyword_str[] = "end.m.gtp6.d.di";
 static u8 def_str[] =
   "Endpoint function with drop-in dencapsulation for IPv6/GTP tunnel";
-static u8 param_str[] = "<sr-prefix>/<sr-prefixlen> [nhtype <nhtype>]";
+static u8 param_str[] =
+  "<sr-prefix>/<sr-prefixlen> [nhtype <nhtype>] [session-table <id>]";
 
 static u8 *
 clb_format_srv6_end_m_gtp6_d_di (u8 * s, va_list * args)
@@ -88,6 +89,9 @@ clb_format_srv6_end_m_gtp6_d_di (u8 * s, va_list * args)
   else
     s = format (s, "\n");
 
+  if (ls_mem->session_table != ~0)
+    s = format (s, "\tSession table %u\n", ls_mem->session_table);
+
   return s;
 }
 
@@ -133,12 +137,28 @@ clb_unformat_srv6_end_m_gtp6_d_di (unformat_input_t * input, va_list * args)
   ls_mem->sr_prefixlen = sr_prefixlen;
   ls_mem->nhtype = nhtype;
 
+  if (!unformat (input, "session-table %u", &ls_mem->session_table))
+    ls_mem->session_table = ~0;
+
+  ls_mem->sr_policy_index = ~0;
+
   return 1;
 }
 
 static int
 clb_creation_srv6_end_m_gtp6_d_di (ip6_sr_localsid_t * localsid)
 {
+  srv6_end_gtp6_param_t *ls_mem = localsid->plugin_mem;
+
+  srv6_mobile_counters_validate (srv6_mobile_localsid_counters,
+				 localsid - sr_main.localsids);
+
+  srv6_mobile_resolve_sr_policy (&ls_mem->sr_prefix,
+				 &ls_mem->sr_policy_index, &ls_mem->sl_buckets);
+
+  if (ls_mem->session_table != ~0)
+    srv6_mobile_session_table_init ();
+
   return 0;
 }
 
@@ -149,11 +169,39 @@ clb_removal_srv6_end_m_gtp6_d_di (ip6_sr_localsid_t * localsid)
 
   ls_mem = localsid->plugin_mem;
 
+  vec_free (ls_mem->sl_buckets);
   clib_mem_free (ls_mem);
 
   return 0;
 }
 
+/*
+ * An SR policy was added, modified or deleted: refresh every localsid
+ * of this behavior whose sr_prefix points at it.
+ */
+static void
+srv6_end_m_gtp6_d_di_policy_change (ip6_address_t * bsid)
+{
+  srv6_end_main_v6_decap_di_t *sm = &srv6_end_main_v6_decap_di;
+  ip6_sr_main_t *sm2 = &sr_main;
+  srv6_end_gtp6_param_t *ls_mem;
+  ip6_sr_localsid_t *ls;
+
+  /* *INDENT-OFF* */
+  pool_foreach (ls, sm2->localsids,
+  ({
+    if (ls->behavior == sm->behavior)
+      {
+        ls_mem = ls->plugin_mem;
+        if (ip6_address_is_equal (&ls_mem->sr_prefix, bsid))
+          srv6_mobile_resolve_sr_policy (&ls_mem->sr_prefix,
+                                         &ls_mem->sr_policy_index,
+                                         &ls_mem->sl_buckets);
+      }
+  }));
+  /* *INDENT-ON* */
+}
+
 static clib_error_t *
 srv6_end_m_gtp6_d_di_init (vlib_main_t * vm)
 {
@@ -195,6 +243,10 @@ srv6_end_m_gtp6_d_di_init (vlib_main_t * vm)
   if (rc < 0)
     clib_error_return (0, "SRv6 Endpoint GTP6.D.DI LocalSID function"
 		       "couldn't be registered");
+
+  sm->behavior = rc;
+  sr_policy_register_change_callback (srv6_end_m_gtp6_d_di_policy_change);
+
   return 0;
 }
 
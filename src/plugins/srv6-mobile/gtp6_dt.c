@@ -61,7 +61,8 @@ const static char *const *const dpo_nodes[DPO_PROTO_NUM] = {
 static u8 fn_name[] = "SRv6-End.M.GTP6.DT-plugin";
 static u8 keyword_str[] = "end.m.gtp6.dt";
 static u8 def_str[] = "Endpoint function with DT for IPv6/GTP tunnel";
-static u8 param_str[] = "fib-index <index> [local-fib-table <index>]";
+static u8 param_str[] =
+  "fib-index <index> [local-fib-table <index>] [session-table <id>]";
 
 static u8 *
 clb_format_srv6_end_m_gtp6_dt (u8 * s, va_list * args)
@@ -81,6 +82,9 @@ clb_format_srv6_end_m_gtp6_dt (u8 * s, va_list * args)
   else
     s = format (s, "\n");
 
+  if (ls_mem->session_table != ~0)
+    s = format (s, "\tSession table %u\n", ls_mem->session_table);
+
   return s;
 }
 
@@ -127,12 +131,23 @@ clb_unformat_srv6_end_m_gtp6_dt (unformat_input_t * input, va_list * args)
 
   ls_mem->type = type;
 
+  if (!unformat (input, "session-table %u", &ls_mem->session_table))
+    ls_mem->session_table = ~0;
+
   return 1;
 }
 
 static int
 clb_creation_srv6_end_m_gtp6_dt (ip6_sr_localsid_t * localsid)
 {
+  srv6_end_gtp6_dt_param_t *ls_mem = localsid->plugin_mem;
+
+  srv6_mobile_counters_validate (srv6_mobile_localsid_counters,
+				 localsid - sr_main.localsids);
+
+  if (ls_mem->session_table != ~0)
+    srv6_mobile_session_table_init ();
+
   return 0;
 }
 
@@ -61,32 +61,61 @@ static u8 fn_name[] = "SRv6-End.M.GTP6.E-plugin";
 static u8 keyword_str[] = "end.m.gtp6.e";
 static u8 def_str[] =
   "Endpoint function with encapsulation for IPv6/GTP tunnel";
-static u8 param_str[] = "";
+static u8 param_str[] = "[srcport-entropy (flow|teid|fixed <port>)]";
 
 static u8 *
 clb_format_srv6_end_m_gtp6_e (u8 * s, va_list * args)
 {
-  s = format (s, "SRv6 End format function unsupported.");
+  srv6_end_gtp6_e_param_t *ls_mem = va_arg (*args, void *);
+
+  s = format (s, "SRv6 End gtp6.e\n\t");
+
+  s = format (s, "UDP source port: %U\n", format_srv6_mobile_srcport,
+	      ls_mem->srcport_mode, ls_mem->srcport);
+
   return s;
 }
 
 static uword
 clb_unformat_srv6_end_m_gtp6_e (unformat_input_t * input, va_list * args)
 {
-  if (!unformat (input, "end.m.gtp6.e"))
+  void **plugin_mem_p = va_arg (*args, void **);
+  srv6_end_gtp6_e_param_t *ls_mem;
+  u8 srcport_mode = SRV6_GTPU_SRCPORT_FLOW;
+  u16 srcport = 0;
+
+  if (!unformat (input, "end.m.gtp6.e %U", unformat_srv6_mobile_srcport,
+		 &srcport_mode, &srcport))
     return 0;
+
+  ls_mem = clib_mem_alloc_aligned_at_offset (sizeof *ls_mem, 0, 0, 1);
+  clib_memset (ls_mem, 0, sizeof *ls_mem);
+  *plugin_mem_p = ls_mem;
+
+  ls_mem->srcport_mode = srcport_mode;
+  ls_mem->srcport = srcport;
+
   return 1;
 }
 
 static int
 clb_creation_srv6_end_m_gtp6_e (ip6_sr_localsid_t * localsid)
 {
+  srv6_mobile_counters_validate (srv6_mobile_localsid_counters,
+				 localsid - sr_main.localsids);
+
   return 0;
 }
 
 static int
 clb_removal_srv6_end_m_gtp6_e (ip6_sr_localsid_t * localsid)
 {
+  srv6_end_gtp6_e_param_t *ls_mem;
+
+  ls_mem = localsid->plugin_mem;
+
+  clib_mem_free (ls_mem);
+
   return 0;
 }
 
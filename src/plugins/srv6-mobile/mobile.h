@@ -25,6 +25,9 @@
 
 #include <vppinfra/error.h>
 #include <vppinfra/elog.h>
+#include <vppinfra/crc32.h>
+#include <vppinfra/xxhash.h>
+#include <vppinfra/bihash_8_8.h>
 
 #define SRV6_GTP_UDP_DST_PORT 2152
 
@@ -42,6 +45,10 @@
 #define SRV6_GTP6_DT6		2
 #define SRV6_GTP6_DT46		3
 
+#define SRV6_GTPU_SRCPORT_FLOW		0	/* inner 5-tuple, default */
+#define SRV6_GTPU_SRCPORT_TEID		1
+#define SRV6_GTPU_SRCPORT_FIXED		2
+
 #define SRV6_GTP4_UNKNOW	0
 #define SRV6_GTP4_DT4		1
 #define SRV6_GTP4_DT6		2
@@ -103,6 +110,109 @@ typedef struct
 #define GTPU_TYPE_END_MARKER            254
 #define GTPU_TYPE_GTPU                  255
 
+#define foreach_srv6_mobile_msg_type		\
+  _(GPDU, "g-pdu")				\
+  _(ECHO, "echo")				\
+  _(ERROR_INDICATION, "error-indication")	\
+  _(END_MARKER, "end-marker")			\
+  _(OTHER, "other")
+
+typedef enum
+{
+#define _(s,n) SRV6_MOBILE_MSG_##s,
+  foreach_srv6_mobile_msg_type
+#undef _
+    SRV6_MOBILE_N_MSG_TYPES,
+} srv6_mobile_msg_type_t;
+
+static_always_inline srv6_mobile_msg_type_t
+srv6_mobile_msg_type (u8 gtpu_type)
+{
+  switch (gtpu_type)
+    {
+    case GTPU_TYPE_GTPU:
+      return SRV6_MOBILE_MSG_GPDU;
+    case GTPU_TYPE_ECHO_REQUEST:
+    case GTPU_TYPE_ECHO_REPLY:
+      return SRV6_MOBILE_MSG_ECHO;
+    case GTPU_TYPE_ERROR_INDICATION:
+      return SRV6_MOBILE_MSG_ERROR_INDICATION;
+    case GTPU_TYPE_END_MARKER:
+      return SRV6_MOBILE_MSG_END_MARKER;
+    }
+
+  return SRV6_MOBILE_MSG_OTHER;
+}
+
+/*
+ * Per message type packet/byte counters, indexed by localsid for the
+ * End behaviors and by SR policy for the T behaviors. Exported to the
+ * stats segment as /net/srv6-mobile/{localsid,policy}/<type>.
+ */
+extern vlib_combined_counter_main_t
+  srv6_mobile_localsid_counters[SRV6_MOBILE_N_MSG_TYPES];
+extern vlib_combined_counter_main_t
+  srv6_mobile_policy_counters[SRV6_MOBILE_N_MSG_TYPES];
+
+static inline void
+srv6_mobile_counters_validate (vlib_combined_counter_main_t * cms,
+			       u32 index)
+{
+  int i;
+
+  for (i = 0; i < SRV6_MOBILE_N_MSG_TYPES; i++)
+    {
+      vlib_validate_combined_counter (&cms[i], index);
+      vlib_zero_combined_counter (&cms[i], index);
+    }
+}
+
+/*
+ * Stateful mode: localsids configured with a session-table look the
+ * G-PDU TEID up in a session table instead of relying on the SID alone.
+ */
+#define SRV6_MOBILE_SESSION_QFI_KEEP	0xff
+
+typedef struct
+{
+  ip6_address_t far_end;	/* End.M.GTP6.D.Di: SID locator, zero to keep */
+  u32 fib4_index;		/* End.M.GTP6.DT: ~0 to keep the localsid's */
+  u32 fib6_index;
+  u8 qfi;			/* QFI to encode, or SRV6_MOBILE_SESSION_QFI_KEEP */
+} srv6_mobile_session_t;
+
+typedef struct
+{
+  /* (table id << 32 | TEID in network order) -> session index */
+  clib_bihash_8_8_t session_table;
+  srv6_mobile_session_t *sessions;
+
+  u32 session_buckets;
+  uword session_memory;
+
+  u16 msg_id_base;
+} srv6_mobile_main_t;
+
+extern srv6_mobile_main_t srv6_mobile_main;
+
+void srv6_mobile_session_table_init (void);
+int srv6_mobile_session_add_del (u32 table_id, u32 teid,
+				 srv6_mobile_session_t * session, int is_add);
+
+static_always_inline srv6_mobile_session_t *
+srv6_mobile_session_lookup (u32 table_id, u32 teid_net)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+  clib_bihash_kv_8_8_t kv;
+
+  kv.key = ((u64) table_id << 32) | teid_net;
+
+  if (clib_bihash_search_inline_8_8 (&smm->session_table, &kv) < 0)
+    return NULL;
+
+  return pool_elt_at_index (smm->sessions, kv.value);
+}
+
 /* *INDENT-OFF* */
 typedef struct
 {
@@ -159,6 +269,156 @@ typedef struct
 } __attribute__ ((packed)) ip6_gtpu_header_t;
 /* *INDENT-ON* */
 
+/*
+ * Outer header template copies. node.c is built once per CPU variant,
+ * so these resolve to a single masked AVX-512 store, two (overlapping)
+ * AVX2 stores, or clib_memcpy_fast on older targets.
+ */
+static_always_inline void
+srv6_mobile_hdr_copy (void *dst, void *src, const u32 n_bytes)
+{
+#if defined (CLIB_HAVE_VEC512)
+  u64 mask = pow2_mask (n_bytes);
+
+  u8x64_mask_store (u8x64_mask_load (u8x64_splat (0), src, mask), dst,
+		    mask);
+#elif defined (CLIB_HAVE_VEC256)
+  u8x32_store_unaligned (u8x32_load_unaligned (src), dst);
+  u8x32_store_unaligned (u8x32_load_unaligned ((u8 *) src + n_bytes - 32),
+			 (u8 *) dst + n_bytes - 32);
+#else
+  clib_memcpy_fast (dst, src, n_bytes);
+#endif
+}
+
+static_always_inline void
+srv6_mobile_copy_ip4_gtpu_hdr (ip4_gtpu_header_t * dst,
+			       ip4_gtpu_header_t * src)
+{
+  STATIC_ASSERT (sizeof (ip4_gtpu_header_t) > 32
+		 && sizeof (ip4_gtpu_header_t) <= 64, "bad template size");
+  srv6_mobile_hdr_copy (dst, src, sizeof (ip4_gtpu_header_t));
+}
+
+static_always_inline void
+srv6_mobile_copy_ip6_gtpu_hdr (ip6_gtpu_header_t * dst,
+			       ip6_gtpu_header_t * src)
+{
+  STATIC_ASSERT (sizeof (ip6_gtpu_header_t) > 32
+		 && sizeof (ip6_gtpu_header_t) <= 64, "bad template size");
+  srv6_mobile_hdr_copy (dst, src, sizeof (ip6_gtpu_header_t));
+}
+
+static_always_inline void
+srv6_mobile_copy_ip6_hdr (ip6_header_t * dst, ip6_header_t * src)
+{
+  STATIC_ASSERT (sizeof (ip6_header_t) > 32
+		 && sizeof (ip6_header_t) <= 64, "bad template size");
+  srv6_mobile_hdr_copy (dst, src, sizeof (ip6_header_t));
+}
+
+/*
+ * Bit-granular field access on IPv6 addresses. The address is handled
+ * as one host-order u128 so a field at any bit position costs a couple
+ * of shifts, whatever the locator length. Positions count from the most
+ * significant bit; bits past the end of the address read as zero and
+ * are dropped on insert.
+ */
+static_always_inline u128
+srv6_mobile_addr_load (ip6_address_t * a)
+{
+  return ((u128) clib_net_to_host_u64 (a->as_u64[0]) << 64) |
+    clib_net_to_host_u64 (a->as_u64[1]);
+}
+
+static_always_inline void
+srv6_mobile_addr_store (ip6_address_t * a, u128 v)
+{
+  a->as_u64[0] = clib_host_to_net_u64 ((u64) (v >> 64));
+  a->as_u64[1] = clib_host_to_net_u64 ((u64) v);
+}
+
+static_always_inline u32
+srv6_mobile_field_get (u128 v, u32 pos, u32 n_bits)
+{
+  if (PREDICT_FALSE (pos >= 128))
+    return 0;
+
+  return (u32) ((v << pos) >> (128 - n_bits));
+}
+
+static_always_inline u128
+srv6_mobile_field_set (u128 v, u32 pos, u32 n_bits, u32 val)
+{
+  if (PREDICT_FALSE (pos >= 128))
+    return v;
+
+  return v | (((u128) val << (128 - n_bits)) >> pos);
+}
+
+#ifdef clib_crc32c_uses_intrinsics
+#define srv6_mobile_crc_u64(h, x) ((u32) crc32_u64 ((h), (x)))
+#define srv6_mobile_crc_u32(h, x) ((u32) crc32_u32 ((h), (x)))
+#else
+#define srv6_mobile_crc_u64(h, x) ((u32) clib_xxhash ((h) ^ (x)))
+#define srv6_mobile_crc_u32(h, x) ((u32) clib_xxhash ((h) ^ (x)))
+#endif
+
+/*
+ * Outer UDP source port for the E behaviors. In flow mode, IP payloads
+ * hash on the TEID and their 5-tuple (ports only when the TCP/UDP header
+ * is in the first buffer); anything else falls back to the TEID alone.
+ */
+static_always_inline u16
+srv6_mobile_gtpu_src_port (u8 mode, u16 srcport, u32 teid, void *inner,
+			   u32 len)
+{
+  u32 h = teid, ports = 0;
+
+  if (PREDICT_FALSE (mode == SRV6_GTPU_SRCPORT_FIXED))
+    return srcport;
+
+  if (mode == SRV6_GTPU_SRCPORT_FLOW && len >= sizeof (ip4_header_t))
+    {
+      u8 ver = *(u8 *) inner >> 4;
+
+      if (ver == 4)
+	{
+	  ip4_header_t *ip4 = inner;
+	  u32 ip_len = ip4_header_bytes (ip4);
+
+	  if ((ip4->protocol == IP_PROTOCOL_TCP
+	       || ip4->protocol == IP_PROTOCOL_UDP) && len >= ip_len + 4)
+	    ports = clib_mem_unaligned ((u8 *) ip4 + ip_len, u32);
+
+	  h = srv6_mobile_crc_u64 (h, clib_mem_unaligned
+				   (&ip4->src_address, u64));
+	  h = srv6_mobile_crc_u32 (h, ports ^ ip4->protocol);
+	}
+      else if (ver == 6 && len >= sizeof (ip6_header_t))
+	{
+	  ip6_header_t *ip6 = inner;
+
+	  if ((ip6->protocol == IP_PROTOCOL_TCP
+	       || ip6->protocol == IP_PROTOCOL_UDP)
+	      && len >= sizeof (ip6_header_t) + 4)
+	    ports = clib_mem_unaligned (ip6 + 1, u32);
+
+	  h = srv6_mobile_crc_u64 (h, ip6->src_address.as_u64[0]);
+	  h = srv6_mobile_crc_u64 (h, ip6->src_address.as_u64[1]);
+	  h = srv6_mobile_crc_u64 (h, ip6->dst_address.as_u64[0]);
+	  h = srv6_mobile_crc_u64 (h, ip6->dst_address.as_u64[1]);
+	  h = srv6_mobile_crc_u32 (h, ports ^ ip6->protocol);
+	}
+      else
+	h = srv6_mobile_crc_u32 (0, teid);
+    }
+  else
+    h = srv6_mobile_crc_u32 (0, teid);
+
+  return (u16) (h ^ (h >> 16));
+}
+
 #define GTPU_V1_VER   (1<<5)
 
 #define GTPU_PT_GTP   (1<<4)
@@ -180,8 +440,19 @@ typedef struct srv6_end_gtp6_param_s
 
   ip6_address_t sr_prefix;
   u32 sr_prefixlen;
+
+  u32 sr_policy_index;		/* policy bound to sr_prefix, ~0 if none */
+  u32 *sl_buckets;		/* flow-hash bucket -> SID list index */
+
+  u32 session_table;		/* End.M.GTP6.D.Di: stateful mode, ~0 if off */
 } srv6_end_gtp6_param_t;
 
+typedef struct srv6_end_gtp6_e_param_s
+{
+  u8 srcport_mode;		/* SRV6_GTPU_SRCPORT_* */
+  u16 srcport;			/* fixed source port, network order */
+} srv6_end_gtp6_e_param_t;
+
 typedef struct srv6_end_gtp6_dt_param_s
 {
   u8 type;
@@ -189,6 +460,8 @@ typedef struct srv6_end_gtp6_dt_param_s
   u32 fib4_index;
   u32 fib6_index;
   u32 local_fib_index;
+
+  u32 session_table;		/* stateful mode, ~0 if off */
 } srv6_end_gtp6_dt_param_t;
 
 typedef struct srv6_t_gtp4_dt_param_s
@@ -198,6 +471,8 @@ typedef struct srv6_t_gtp4_dt_param_s
   u32 fib4_index;
   u32 fib6_index;
   u32 local_fib_index;
+
+  u32 counter_index;		/* owning policy, for the policy counters */
 } srv6_t_gtp4_dt_param_t;
 
 typedef struct srv6_end_gtp4_param_s
@@ -211,8 +486,134 @@ typedef struct srv6_end_gtp4_param_s
   u32 v6src_prefixlen;
 
   u32 v4src_position;
+
+  u8 srcport_mode;		/* End.M.GTP4.E: SRV6_GTPU_SRCPORT_* */
+  u16 srcport;			/* fixed source port, network order */
+
+  /* End.M.GTP4.E rewrite; checksum excludes length and addresses */
+  ip4_gtpu_header_t cache_hdr;
+
+  u32 counter_index;		/* T.M.GTP4.D: owning policy, for counters */
+  u8 echo_local;		/* T.M.GTP4.D: answer echo requests here */
+
+  u32 sr_policy_index;		/* policy bound to sr_prefix, ~0 if none */
+  u32 *sl_buckets;		/* flow-hash bucket -> SID list index */
 } srv6_end_gtp4_param_t;
 
+#define SRV6_MOBILE_SL_BUCKETS_MIN_PER_SL	16
+#define SRV6_MOBILE_SL_BUCKETS_MAX		1024
+
+/*
+ * Look up the SR policy whose BSID is sr_prefix and spread its SID
+ * lists over a power-of-two bucket table in proportion to their weights,
+ * the way a load_balance DPO does, every SID list getting at least one
+ * bucket. Done from the control plane (creation and policy change
+ * callbacks) so the decap nodes never touch sr_policies_index_hash.
+ *
+ * The new table is built aside and swapped in, the old one freed once
+ * no worker can still be reading it. The SID lists the buckets point at
+ * are still only changed by the SR policy code under the barrier.
+ */
+static inline void
+srv6_mobile_resolve_sr_policy (ip6_address_t * sr_prefix,
+			       u32 * sr_policy_index, u32 ** sl_buckets)
+{
+  ip6_sr_main_t *sm2 = &sr_main;
+  ip6_sr_policy_t *sr_policy;
+  ip6_sr_sl_t *sl;
+  u32 *sl_index, *buckets = 0, *old = *sl_buckets;
+  u64 sum_weight = 0, cum_weight = 0;
+  u32 n_sls, n_buckets, n_spread, bucket = 0, end;
+  uword *p;
+
+  *sr_policy_index = ~0;
+
+  p = mhash_get (&sm2->sr_policies_index_hash, sr_prefix);
+  if (!p)
+    goto swap;
+
+  sr_policy = pool_elt_at_index (sm2->sr_policies, p[0]);
+  *sr_policy_index = p[0];
+  n_sls = vec_len (sr_policy->segments_lists);
+  if (n_sls == 0)
+    goto swap;
+
+  vec_foreach (sl_index, sr_policy->segments_lists)
+  {
+    sl = pool_elt_at_index (sm2->sid_lists, *sl_index);
+    sum_weight += clib_max (sl->weight, 1);
+  }
+
+  n_buckets = n_sls == 1 ? 1 :
+    max_pow2 (clib_max (sum_weight, n_sls *
+			SRV6_MOBILE_SL_BUCKETS_MIN_PER_SL));
+  n_buckets = clib_min (n_buckets, SRV6_MOBILE_SL_BUCKETS_MAX);
+  n_buckets = clib_max (n_buckets, max_pow2 (n_sls));
+
+  vec_validate (buckets, n_buckets - 1);
+
+  /* one bucket each, the rest in proportion to the weights */
+  n_spread = n_buckets - n_sls;
+  vec_foreach (sl_index, sr_policy->segments_lists)
+  {
+    sl = pool_elt_at_index (sm2->sid_lists, *sl_index);
+    cum_weight += clib_max (sl->weight, 1);
+    end = (sl_index - sr_policy->segments_lists) + 1 +
+      (cum_weight * n_spread) / sum_weight;
+    for (; bucket < end; bucket++)
+      buckets[bucket] = *sl_index;
+  }
+
+swap:
+  clib_atomic_store_rel_n (sl_buckets, buckets);
+  vlib_epoch_vec_free (old);
+}
+
+/*
+ * Per-flow hash of a GTP-U packet: the TEID plus, for IP payloads, the
+ * inner 5-tuple.
+ */
+static_always_inline u32
+srv6_mobile_flow_hash (u32 teid, void *inner, u8 nhtype)
+{
+  u32 a, b, c;
+
+  a = teid;
+  b = 0;
+  c = 0x9e3779b9;
+
+  if (inner && nhtype != SRV6_NHTYPE_NON_IP)
+    {
+      u8 ver = *(u8 *) inner >> 4;
+
+      if (ver == 4)
+	b = ip4_compute_flow_hash (inner, IP_FLOW_HASH_DEFAULT);
+      else if (ver == 6)
+	b = ip6_compute_flow_hash (inner, IP_FLOW_HASH_DEFAULT);
+    }
+
+  hash_v3_mix32 (a, b, c);
+  hash_v3_finalize32 (a, b, c);
+
+  return c;
+}
+
+/* Pick the SID list for a flow, ~0 if the policy is unresolved */
+static_always_inline u32
+srv6_mobile_sl_select (u32 * sl_buckets, u32 teid, void *inner, u8 nhtype)
+{
+  u32 n_buckets = vec_len (sl_buckets);
+
+  if (PREDICT_FALSE (n_buckets == 0))
+    return ~0;
+
+  if (PREDICT_TRUE (n_buckets == 1))
+    return sl_buckets[0];
+
+  return sl_buckets[srv6_mobile_flow_hash (teid, inner, nhtype) &
+		    (n_buckets - 1)];
+}
+
 typedef struct srv6_end_main_v4_s
 {
   vlib_main_t *vlib_main;
@@ -236,9 +637,16 @@ typedef struct srv6_t_main_v4_decap_s
   u32 t_m_gtp4_d_node_index;
   u32 error_node_index;
 
+  u32 behavior;			/* SR behavior number of this function */
+
+  u8 restart_counter;		/* recovery IE of local echo replies */
+
   ip6_header_t cache_hdr;
 } srv6_t_main_v4_decap_t;
 
+format_function_t format_srv6_mobile_srcport;
+unformat_function_t unformat_srv6_mobile_srcport;
+
 extern srv6_end_main_v4_t srv6_end_main_v4;
 extern srv6_t_main_v4_decap_t srv6_t_main_v4_decap;
 extern vlib_node_registration_t srv6_end_m_gtp4_e;
@@ -265,6 +673,8 @@ typedef struct srv6_end_main_v6_decap_s
   u32 end_m_gtp6_d_node_index;
   u32 error_node_index;
 
+  u32 behavior;			/* SR behavior number of this function */
+
   ip6_header_t cache_hdr;
 } srv6_end_main_v6_decap_t;
 
@@ -279,6 +689,8 @@ typedef struct srv6_end_main_v6_decap_di_s
   u32 end_m_gtp6_d_di_node_index;
   u32 error_node_index;
 
+  u32 behavior;			/* SR behavior number of this function */
+
   ip6srv_combo_header_t cache_hdr;
 } srv6_end_main_v6_decap_di_t;
 
@@ -0,0 +1,123 @@
+/*
+ * mobile_api.c - srv6 mobile api
+ *
+ * Copyright (c) 2019 Arrcus Inc and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/api_errno.h>
+#include <vnet/fib/fib_table.h>
+
+#include <vlibmemory/api.h>
+#include <vnet/ip/ip_types_api.h>
+#include <srv6-mobile/mobile.h>
+
+#include <vnet/format_fns.h>
+#include <srv6-mobile/mobile.api_enum.h>
+#include <srv6-mobile/mobile.api_types.h>
+
+#define REPLY_MSG_ID_BASE smm->msg_id_base
+#include <vlibapi/api_helper_macros.h>
+
+static int
+srv6_mobile_session_decode (vl_api_srv6_mobile_session_t * in,
+			    srv6_mobile_session_t * out)
+{
+  u32 vrf_id = ntohl (in->vrf_id);
+
+  if (in->table_id == ~0)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (in->qfi != SRV6_MOBILE_SESSION_QFI_KEEP
+      && in->qfi > GTPU_PDU_SESSION_QFI_MASK)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  clib_memset (out, 0, sizeof (*out));
+  ip6_address_decode (in->far_end, &out->far_end);
+  out->qfi = in->qfi;
+
+  out->fib4_index = out->fib6_index = ~0;
+  if (vrf_id != ~0)
+    {
+      out->fib4_index = fib_table_find (FIB_PROTOCOL_IP4, vrf_id);
+      out->fib6_index = fib_table_find (FIB_PROTOCOL_IP6, vrf_id);
+      if (out->fib4_index == ~0 && out->fib6_index == ~0)
+	return VNET_API_ERROR_NO_SUCH_FIB;
+    }
+
+  return 0;
+}
+
+static void
+vl_api_srv6_mobile_session_add_del_t_handler
+  (vl_api_srv6_mobile_session_add_del_t * mp)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+  vl_api_srv6_mobile_session_add_del_reply_t *rmp;
+  srv6_mobile_session_t *sessions = 0;
+  u32 count = ntohl (mp->count);
+  int rv = 0;
+  u32 i;
+
+  if (vl_msg_api_get_msg_length (mp) !=
+      sizeof (*mp) + count * sizeof (mp->sessions[0]))
+    {
+      rv = VNET_API_ERROR_INVALID_VALUE;
+      goto done;
+    }
+
+  /* Check the whole batch first so a bad entry leaves the table alone */
+  vec_validate (sessions, count);
+  for (i = 0; i < count; i++)
+    {
+      rv = srv6_mobile_session_decode (&mp->sessions[i], &sessions[i]);
+      if (rv)
+	goto done;
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      rv = srv6_mobile_session_add_del (ntohl (mp->sessions[i].table_id),
+					ntohl (mp->sessions[i].teid),
+					&sessions[i], mp->is_add);
+      if (rv && (mp->is_add || rv != VNET_API_ERROR_NO_SUCH_ENTRY))
+	goto done;
+      rv = 0;
+    }
+
+done:
+  vec_free (sessions);
+
+  REPLY_MACRO (VL_API_SRV6_MOBILE_SESSION_ADD_DEL_REPLY);
+}
+
+#include <srv6-mobile/mobile.api.c>
+static clib_error_t *
+srv6_mobile_api_hookup (vlib_main_t * vm)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+
+  smm->msg_id_base = setup_message_id_table ();
+  return 0;
+}
+
+VLIB_API_INIT_FUNCTION (srv6_mobile_api_hookup);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
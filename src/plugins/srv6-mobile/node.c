@@ -28,6 +28,13 @@ typedef struct
   u32 teid;
 } srv6_end_rewrite_trace_t;
 
+typedef struct
+{
+  ip4_address_t src, dst;
+  u16 seq;
+  u8 restart_counter;
+} srv6_t_echo_trace_t;
+
 static u16 srh_tagfield[256] = {
   /* 0 */
   0x0,
@@ -109,6 +116,69 @@ format_srv6_end_rewrite_trace6 (u8 * s, va_list * args)
 		 &t->sr_prefix, t->sr_prefixlen);
 }
 
+static u8 *
+format_srv6_t_echo_trace (u8 * s, va_list * args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  srv6_t_echo_trace_t *t = va_arg (*args, srv6_t_echo_trace_t *);
+
+  return format (s,
+		 "SRv6-T-echo-reply: src %U dst %U\n\tseq: %u restart counter: %u",
+		 format_ip4_address, &t->src, format_ip4_address, &t->dst,
+		 clib_net_to_host_u16 (t->seq), t->restart_counter);
+}
+
+#ifndef CLIB_MARCH_VARIANT
+u8 *
+format_srv6_mobile_srcport (u8 * s, va_list * args)
+{
+  u32 mode = va_arg (*args, u32);
+  u32 srcport = va_arg (*args, u32);
+
+  switch (mode)
+    {
+    case SRV6_GTPU_SRCPORT_FLOW:
+      return format (s, "inner flow");
+    case SRV6_GTPU_SRCPORT_TEID:
+      return format (s, "TEID");
+    case SRV6_GTPU_SRCPORT_FIXED:
+      return format (s, "fixed %d", clib_net_to_host_u16 (srcport));
+    }
+
+  return format (s, "unknown (%d)", mode);
+}
+
+/*
+ * Optional [srcport-entropy (flow|teid|fixed <port>)] of the E behaviors.
+ * The defaults are left in place when absent, a malformed one fails.
+ */
+uword
+unformat_srv6_mobile_srcport (unformat_input_t * input, va_list * args)
+{
+  u8 *mode = va_arg (*args, u8 *);
+  u16 *srcport = va_arg (*args, u16 *);
+  u32 port;
+
+  if (!unformat (input, "srcport-entropy"))
+    return 1;
+
+  if (unformat (input, "flow"))
+    *mode = SRV6_GTPU_SRCPORT_FLOW;
+  else if (unformat (input, "teid"))
+    *mode = SRV6_GTPU_SRCPORT_TEID;
+  else if (unformat (input, "fixed %u", &port) && port <= 0xffff)
+    {
+      *mode = SRV6_GTPU_SRCPORT_FIXED;
+      *srcport = clib_host_to_net_u16 (port);
+    }
+  else
+    return 0;
+
+  return 1;
+}
+#endif /* CLIB_MARCH_VARIANT */
+
 #define foreach_srv6_end_v4_error \
   _(M_GTP4_E_PACKETS, "srv6 End.M.GTP4.E packets") \
   _(M_GTP4_E_BAD_PACKETS, "srv6 End.M.GTP4.E bad packets")
@@ -117,6 +187,10 @@ format_srv6_end_rewrite_trace6 (u8 * s, va_list * args)
   _(M_GTP4_D_PACKETS, "srv6 T.M.GTP4.D packets") \
   _(M_GTP4_D_BAD_PACKETS, "srv6 T.M.GTP4.D bad packets")
 
+#define foreach_srv6_t_v4_echo_error \
+  _(M_GTP4_ECHO_REPLIES, "srv6 T.M.GTP4.D echo replies") \
+  _(M_GTP4_ECHO_BAD_PACKETS, "srv6 T.M.GTP4.D bad echo requests")
+
 #define foreach_srv6_end_v6_e_error \
   _(M_GTP6_E_PACKETS, "srv6 End.M.GTP6.E packets") \
   _(M_GTP6_E_BAD_PACKETS, "srv6 End.M.GTP6.E bad packets")
@@ -127,11 +201,13 @@ format_srv6_end_rewrite_trace6 (u8 * s, va_list * args)
 
 #define foreach_srv6_end_v6_d_di_error \
   _(M_GTP6_D_DI_PACKETS, "srv6 End.M.GTP6.D.DI packets") \
-  _(M_GTP6_D_DI_BAD_PACKETS, "srv6 End.M.GTP6.D.DI bad packets")
+  _(M_GTP6_D_DI_BAD_PACKETS, "srv6 End.M.GTP6.D.DI bad packets") \
+  _(M_GTP6_D_DI_NO_SESSION, "srv6 End.M.GTP6.D.DI no session")
 
 #define foreach_srv6_end_v6_dt_error \
   _(M_GTP6_DT_PACKETS, "srv6 End.M.GTP6.DT packets") \
-  _(M_GTP6_DT_BAD_PACKETS, "srv6 End.M.GTP6.DT bad packets")
+  _(M_GTP6_DT_BAD_PACKETS, "srv6 End.M.GTP6.DT bad packets") \
+  _(M_GTP6_DT_NO_SESSION, "srv6 End.M.GTP6.DT no session")
 
 #define foreach_srv6_t_v4_dt_error \
   _(M_GTP4_DT_PACKETS, "srv6 T.M.GTP4.DT packets") \
@@ -153,6 +229,14 @@ typedef enum
     SRV6_T_N_V4_D_ERROR,
 } srv6_t_error_v4_d_t;
 
+typedef enum
+{
+#define _(sym,str) SRV6_T_ERROR_##sym,
+  foreach_srv6_t_v4_echo_error
+#undef _
+    SRV6_T_N_V4_ECHO_ERROR,
+} srv6_t_error_v4_echo_t;
+
 typedef enum
 {
 #define _(sym,str) SRV6_END_ERROR_##sym,
@@ -205,6 +289,12 @@ static char *srv6_t_error_v4_d_strings[] = {
 #undef _
 };
 
+static char *srv6_t_error_v4_echo_strings[] = {
+#define _(sym,string) string,
+  foreach_srv6_t_v4_echo_error
+#undef _
+};
+
 static char *srv6_end_error_v6_e_strings[] = {
 #define _(sym,string) string,
   foreach_srv6_end_v6_e_error
@@ -246,6 +336,7 @@ typedef enum
 {
   SRV6_T_M_GTP4_D_NEXT_DROP,
   SRV6_T_M_GTP4_D_NEXT_LOOKUP,
+  SRV6_T_M_GTP4_D_NEXT_ECHO,
   SRV6_T_M_GTP4_D_N_NEXT,
 } srv6_T_m_gtp4_d_next_t;
 
@@ -286,6 +377,13 @@ typedef enum
   SRV6_T_M_GTP4_DT_N_NEXT,
 } srv6_t_m_gtp4_dt_next_t;
 
+typedef enum
+{
+  SRV6_T_M_GTP4_ECHO_NEXT_DROP,
+  SRV6_T_M_GTP4_ECHO_NEXT_LOOKUP,
+  SRV6_T_M_GTP4_ECHO_N_NEXT,
+} srv6_t_m_gtp4_echo_next_t;
+
 static inline u16
 hash_uword_to_u16 (uword * key)
 {
@@ -316,896 +414,866 @@ gtpu_type_get (u16 tag)
   return GTPU_TYPE_GTPU;
 }
 
-// Function for SRv6 GTP4.E function.
-VLIB_NODE_FN (srv6_end_m_gtp4_e) (vlib_main_t * vm,
-				  vlib_node_runtime_t * node,
-				  vlib_frame_t * frame)
+typedef u16 (srv6_mobile_process_fn_t) (vlib_main_t * vm,
+					vlib_node_runtime_t * node,
+					vlib_buffer_t * b0);
+
+/*
+ * Warm the localsid (or SID list, for the T.M behaviors) a buffer is
+ * bound to. The buffer header must already be in cache, since the index
+ * lives in vnet_buffer()->ip.adj_index[VLIB_TX].
+ */
+static_always_inline void
+srv6_mobile_prefetch_state (vlib_buffer_t * b, int is_policy)
 {
-  srv6_end_main_v4_t *sm = &srv6_end_main_v4;
   ip6_sr_main_t *sm2 = &sr_main;
-  u32 n_left_from, next_index, *from, *to_next;
-  u32 thread_index = vm->thread_index;
+  u32 index = vnet_buffer (b)->ip.adj_index[VLIB_TX];
 
-  u32 good_n = 0, bad_n = 0;
+  if (is_policy)
+    CLIB_PREFETCH (sm2->sid_lists + index, sizeof (ip6_sr_sl_t), LOAD);
+  else
+    CLIB_PREFETCH (sm2->localsids + index, sizeof (ip6_sr_localsid_t),
+		   LOAD);
+}
 
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
+/*
+ * The localsid / SID list of b was prefetched one iteration earlier;
+ * start pulling in the per-behavior parameters it points at.
+ */
+static_always_inline void
+srv6_mobile_prefetch_param (vlib_buffer_t * b, int is_policy)
+{
+  ip6_sr_main_t *sm2 = &sr_main;
+  u32 index = vnet_buffer (b)->ip.adj_index[VLIB_TX];
+  void *mem;
 
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
+  if (is_policy)
+    mem = pool_elt_at_index (sm2->sid_lists, index)->plugin_mem;
+  else
+    mem = pool_elt_at_index (sm2->localsids, index)->plugin_mem;
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+  CLIB_PREFETCH (mem, CLIB_CACHE_LINE_BYTES, LOAD);
+}
 
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  ip6_sr_localsid_t *ls0;
-	  srv6_end_gtp4_param_t *ls_param;
+/*
+ * Common frame loop for the mobile nodes: four buffers per iteration,
+ * buffer headers prefetched two iterations ahead, packet data plus
+ * localsid state one iteration ahead and the behavior parameters just
+ * before processing. Returns the number of buffers sent to the drop
+ * next.
+ */
+static_always_inline u32
+srv6_mobile_node_dispatch (vlib_main_t * vm, vlib_node_runtime_t * node,
+			   vlib_frame_t * frame, srv6_mobile_process_fn_t * fn,
+			   u16 drop_next, int is_policy)
+{
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 n_left_from, *from;
+  u32 bad_n = 0;
 
-	  ip6srv_combo_header_t *ip6srv0;
-	  ip6_address_t src0, dst0;
+  from = vlib_frame_vector_args (frame);
+  n_left_from = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left_from);
+  b = bufs;
+  next = nexts;
 
-	  ip4_gtpu_header_t *hdr0 = NULL;
-	  uword len0;
+  /* The first two iterations' headers are not covered by the loop. */
+  if (n_left_from >= 8)
+    {
+      vlib_prefetch_buffer_header (b[0], LOAD);
+      vlib_prefetch_buffer_header (b[1], LOAD);
+      vlib_prefetch_buffer_header (b[2], LOAD);
+      vlib_prefetch_buffer_header (b[3], LOAD);
+      vlib_prefetch_buffer_header (b[4], LOAD);
+      vlib_prefetch_buffer_header (b[5], LOAD);
+      vlib_prefetch_buffer_header (b[6], LOAD);
+      vlib_prefetch_buffer_header (b[7], LOAD);
+    }
 
-	  u32 next0 = SRV6_END_M_GTP4_E_NEXT_LOOKUP;
+  while (n_left_from >= 8)
+    {
+      /* Prefetch next iteration. */
+      if (PREDICT_TRUE (n_left_from >= 12))
+	{
+	  vlib_prefetch_buffer_header (b[8], LOAD);
+	  vlib_prefetch_buffer_header (b[9], LOAD);
+	  vlib_prefetch_buffer_header (b[10], LOAD);
+	  vlib_prefetch_buffer_header (b[11], LOAD);
+	}
 
-	  // defaults
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
+      vlib_prefetch_buffer_data (b[4], LOAD);
+      vlib_prefetch_buffer_data (b[5], LOAD);
+      vlib_prefetch_buffer_data (b[6], LOAD);
+      vlib_prefetch_buffer_data (b[7], LOAD);
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  ls0 =
-	    pool_elt_at_index (sm2->localsids,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+      srv6_mobile_prefetch_state (b[4], is_policy);
+      srv6_mobile_prefetch_state (b[5], is_policy);
+      srv6_mobile_prefetch_state (b[6], is_policy);
+      srv6_mobile_prefetch_state (b[7], is_policy);
 
-	  ls_param = (srv6_end_gtp4_param_t *) ls0->plugin_mem;
+      srv6_mobile_prefetch_param (b[0], is_policy);
+      srv6_mobile_prefetch_param (b[1], is_policy);
+      srv6_mobile_prefetch_param (b[2], is_policy);
+      srv6_mobile_prefetch_param (b[3], is_policy);
 
-	  ip6srv0 = vlib_buffer_get_current (b0);
-	  src0 = ip6srv0->ip.src_address;
-	  dst0 = ip6srv0->ip.dst_address;
+      next[0] = fn (vm, node, b[0]);
+      next[1] = fn (vm, node, b[1]);
+      next[2] = fn (vm, node, b[2]);
+      next[3] = fn (vm, node, b[3]);
 
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
+      bad_n += (next[0] == drop_next) + (next[1] == drop_next) +
+	(next[2] == drop_next) + (next[3] == drop_next);
 
-	  if ((ip6srv0->ip.protocol == IPPROTO_IPV6_ROUTE
-	       && len0 <
-	       sizeof (ip6srv_combo_header_t) + ip6srv0->sr.length * 8)
-	      || (len0 < sizeof (ip6_header_t)))
-	    {
-	      next0 = SRV6_END_M_GTP4_E_NEXT_DROP;
+      b += 4;
+      next += 4;
+      n_left_from -= 4;
+    }
 
-	      bad_n++;
-	    }
-	  else
-	    {
-	      u8 gtpu_type = 0;
-	      u16 tag = 0;
-	      u32 teid = 0;
-	      u8 *teid8p = (u8 *) & teid;
-	      u8 qfi = 0;
-	      u16 seq = 0;
-	      u32 index;
-	      u32 offset, shift;
-	      u32 hdrlen = 0;
-	      uword key;
-	      u16 port;
-	      ip4_address_t dst4;
-	      u16 ie_size = 0;
-	      u8 ie_buf[GTPU_IE_MAX_SIZ];
-	      void *p;
-	      uword plen;
-
-	      if (ip6srv0->ip.protocol == IPPROTO_IPV6_ROUTE)
-		{
-		  tag = ip6srv0->sr.tag;
-		}
+  while (n_left_from > 0)
+    {
+      next[0] = fn (vm, node, b[0]);
 
-	      offset = ls0->localsid_prefix_len / 8;
-	      shift = ls0->localsid_prefix_len % 8;
+      bad_n += (next[0] == drop_next);
 
-	      gtpu_type = gtpu_type_get (tag);
+      b += 1;
+      next += 1;
+      n_left_from -= 1;
+    }
 
-	      if (PREDICT_TRUE (shift == 0))
-		{
-		  clib_memcpy_fast (&dst4.as_u8[0], &dst0.as_u8[offset], 4);
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
 
-		  qfi = dst0.as_u8[offset + 4];
+  return bad_n;
+}
 
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      clib_memcpy_fast (&seq, &dst0.as_u8[offset + 5], 2);
-		    }
-		  else
-		    {
-		      clib_memcpy_fast (teid8p, &dst0.as_u8[offset + 5], 4);
-		    }
-		}
-	      else
-		{
-		  u8 *sp;
+static_always_inline u16
+srv6_end_m_gtp4_e_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			   vlib_buffer_t * b0)
+{
+  ip6_sr_main_t *sm2 = &sr_main;
+  u32 thread_index = vm->thread_index;
+  ip6_sr_localsid_t *ls0;
+  srv6_end_gtp4_param_t *ls_param;
+  u8 gtpu_type = 0;
 
-		  for (index = 0; index < 4; index++)
-		    {
-		      dst4.as_u8[index] = dst0.as_u8[offset + index] << shift;
-		      dst4.as_u8[index] |=
-			dst0.as_u8[offset + index + 1] >> (8 - shift);
-		    }
+  ip6srv_combo_header_t *ip6srv0;
+  ip6_address_t src0, dst0;
 
-		  qfi |= dst0.as_u8[offset + 4] << shift;
-		  qfi |= dst0.as_u8[offset + 5] >> (8 - shift);
+  ip4_gtpu_header_t *hdr0 = NULL;
+  uword len0;
 
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      sp = (u8 *) & seq;
-		      for (index = 0; index < 2; index++)
-			{
-			  sp[index] = dst0.as_u8[offset + 5 + index] << shift;
-			  sp[index] |=
-			    dst0.as_u8[offset + 6 + index] >> (8 - shift);
-			}
-		    }
-		  else
-		    {
-		      for (index = 0; index < 4; index++)
-			{
-			  *teid8p = dst0.as_u8[offset + 5 + index] << shift;
-			  *teid8p |=
-			    dst0.as_u8[offset + 6 + index] >> (8 - shift);
-			  teid8p++;
-			}
-		    }
-		}
+  u32 next0 = SRV6_END_M_GTP4_E_NEXT_LOOKUP;
 
-	      if (qfi)
-		{
-		  hdrlen =
-		    sizeof (gtpu_exthdr_t) + sizeof (gtpu_pdu_session_t);
-		}
-	      else if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		       || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		       || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		{
-		  hdrlen = sizeof (gtpu_exthdr_t);
-		}
+  ls0 =
+    pool_elt_at_index (sm2->localsids,
+		       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
 
-	      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ECHO_REPLY))
-		{
-		  hdrlen += sizeof (gtpu_recovery_ie);
-		}
+  ls_param = (srv6_end_gtp4_param_t *) ls0->plugin_mem;
 
-	      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
-		{
-		  ip6_sr_tlv_t *tlv;
-		  u16 ext_len;
+  ip6srv0 = vlib_buffer_get_current (b0);
+  src0 = ip6srv0->ip.src_address;
+  dst0 = ip6srv0->ip.dst_address;
 
-		  ext_len = ip6srv0->sr.length * 8;
+  len0 = vlib_buffer_length_in_chain (vm, b0);
 
-		  if (ext_len >
-		      sizeof (ip6_address_t) * (ip6srv0->sr.last_entry + 1))
-		    {
-		      tlv =
-			(ip6_sr_tlv_t *) ((u8 *) & ip6srv0->sr +
-					  sizeof (ip6_sr_header_t) +
-					  sizeof (ip6_address_t) *
-					  (ip6srv0->sr.last_entry + 1));
+  if ((ip6srv0->ip.protocol == IPPROTO_IPV6_ROUTE
+       && len0 <
+       sizeof (ip6srv_combo_header_t) + ip6srv0->sr.length * 8)
+      || (len0 < sizeof (ip6_header_t)))
+    {
+      next0 = SRV6_END_M_GTP4_E_NEXT_DROP;
+    }
+  else
+    {
+      u16 tag = 0;
+      u32 teid = 0;
+      u8 qfi = 0;
+      u16 seq = 0;
+      u32 pos;
+      u128 dst128;
+      u32 hdrlen = 0;
+      ip4_address_t dst4;
+      u16 ie_size = 0;
+      u8 ie_buf[GTPU_IE_MAX_SIZ];
+      void *p;
+      u32 plen;
+      ip_csum_t sum0;
+
+      if (ip6srv0->ip.protocol == IPPROTO_IPV6_ROUTE)
+	{
+	  tag = ip6srv0->sr.tag;
+	}
 
-		      if (tlv->type == SRH_TLV_USER_PLANE_CONTAINER)
-			{
-			  user_plane_sub_tlv_t *sub_tlv;
+      pos = ls0->localsid_prefix_len;
+      dst128 = srv6_mobile_addr_load (&dst0);
 
-			  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
+      gtpu_type = gtpu_type_get (tag);
 
-			  ie_size = sub_tlv->length;
-			  clib_memcpy_fast (ie_buf, sub_tlv->value, ie_size);
+      dst4.as_u32 = clib_host_to_net_u32 (srv6_mobile_field_get (dst128,
+								  pos, 32));
+      qfi = srv6_mobile_field_get (dst128, pos + 32, 8);
 
-			  hdrlen += ie_size;
-			}
-		    }
-		}
+      if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	  || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  seq = clib_host_to_net_u16 (srv6_mobile_field_get (dst128,
+							      pos + 40, 16));
+	}
+      else
+	{
+	  teid = clib_host_to_net_u32 (srv6_mobile_field_get (dst128,
+							       pos + 40, 32));
+	}
 
-	      if (ip6srv0->ip.protocol == IPPROTO_IPV6_ROUTE)
-		{
-		  vlib_buffer_advance (b0,
-				       (word) sizeof (ip6srv_combo_header_t) +
-				       ip6srv0->sr.length * 8);
-		}
-	      else
-		{
-		  vlib_buffer_advance (b0, (word) sizeof (ip6_header_t));
-		}
+      if (qfi)
+	{
+	  hdrlen =
+	    sizeof (gtpu_exthdr_t) + sizeof (gtpu_pdu_session_t);
+	}
+      else if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	       || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	       || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  hdrlen = sizeof (gtpu_exthdr_t);
+	}
 
-	      // get length of encapsulated IPv6 packet (the remaining part)
-	      p = vlib_buffer_get_current (b0);
+      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ECHO_REPLY))
+	{
+	  hdrlen += sizeof (gtpu_recovery_ie);
+	}
 
-	      plen = len0 = vlib_buffer_length_in_chain (vm, b0);
+      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
+	{
+	  ip6_sr_tlv_t *tlv;
+	  u16 ext_len;
 
-	      len0 += hdrlen;
+	  ext_len = ip6srv0->sr.length * 8;
 
-	      hdrlen += sizeof (ip4_gtpu_header_t);
+	  if (ext_len >
+	      sizeof (ip6_address_t) * (ip6srv0->sr.last_entry + 1))
+	    {
+	      tlv =
+		(ip6_sr_tlv_t *) ((u8 *) & ip6srv0->sr +
+				  sizeof (ip6_sr_header_t) +
+				  sizeof (ip6_address_t) *
+				  (ip6srv0->sr.last_entry + 1));
 
-	      // IPv4 GTP-U header creation.
-	      vlib_buffer_advance (b0, -(word) hdrlen);
+	      if (tlv->type == SRH_TLV_USER_PLANE_CONTAINER)
+		{
+		  user_plane_sub_tlv_t *sub_tlv;
 
-	      hdr0 = vlib_buffer_get_current (b0);
+		  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
 
-	      clib_memcpy_fast (hdr0, &sm->cache_hdr,
-				sizeof (ip4_gtpu_header_t));
+		  ie_size = sub_tlv->length;
+		  clib_memcpy_fast (ie_buf, sub_tlv->value, ie_size);
 
-	      hdr0->ip4.dst_address.as_u32 = dst4.as_u32;
+		  hdrlen += ie_size;
+		}
+	    }
+	}
 
-	      hdr0->gtpu.teid = teid;
-	      hdr0->gtpu.length = clib_host_to_net_u16 (len0);
+      if (ip6srv0->ip.protocol == IPPROTO_IPV6_ROUTE)
+	{
+	  vlib_buffer_advance (b0,
+			       (word) sizeof (ip6srv_combo_header_t) +
+			       ip6srv0->sr.length * 8);
+	}
+      else
+	{
+	  vlib_buffer_advance (b0, (word) sizeof (ip6_header_t));
+	}
 
-	      hdr0->gtpu.type = gtpu_type;
+      // get length of encapsulated IPv6 packet (the remaining part)
+      p = vlib_buffer_get_current (b0);
 
-	      if (qfi)
-		{
-		  u8 type = 0;
-		  gtpu_pdu_session_t *sess;
+      len0 = vlib_buffer_length_in_chain (vm, b0);
+      plen = b0->current_length;
 
-		  hdr0->gtpu.ver_flags |= GTPU_EXTHDR_FLAG;
+      len0 += hdrlen;
 
-		  hdr0->gtpu.ext->seq = 0;
+      hdrlen += sizeof (ip4_gtpu_header_t);
 
-		  hdr0->gtpu.ext->npdu_num = 0;
-		  hdr0->gtpu.ext->nextexthdr = GTPU_EXTHDR_PDU_SESSION;
+      // IPv4 GTP-U header creation.
+      vlib_buffer_advance (b0, -(word) hdrlen);
 
-		  type = qfi & SRV6_PDU_SESSION_U_BIT_MASK;
+      hdr0 = vlib_buffer_get_current (b0);
 
-		  qfi =
-		    ((qfi & SRV6_PDU_SESSION_QFI_MASK) >> 2) |
-		    ((qfi & SRV6_PDU_SESSION_R_BIT_MASK) << 5);
+      srv6_mobile_copy_ip4_gtpu_hdr (hdr0, &ls_param->cache_hdr);
 
-		  sess =
-		    (gtpu_pdu_session_t *) (((char *) hdr0) +
-					    sizeof (ip4_gtpu_header_t) +
-					    sizeof (gtpu_exthdr_t));
-		  sess->exthdrlen = 1;
-		  sess->type = type;
-		  sess->spare = 0;
-		  sess->u.val = qfi;
-		  sess->nextexthdr = 0;
-		}
+      hdr0->ip4.dst_address.as_u32 = dst4.as_u32;
 
-	      if (gtpu_type == GTPU_TYPE_ECHO_REPLY
-		  || gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		{
-		  hdr0->gtpu.ver_flags |= GTPU_SEQ_FLAG;
-		  hdr0->gtpu.ext->seq = seq;
-		  hdr0->gtpu.ext->npdu_num = 0;
-		  hdr0->gtpu.ext->nextexthdr = 0;
+      hdr0->gtpu.teid = teid;
+      hdr0->gtpu.length = clib_host_to_net_u16 (len0);
 
-		  if (gtpu_type == GTPU_TYPE_ECHO_REPLY)
-		    {
-		      gtpu_recovery_ie *recovery;
-
-		      recovery =
-			(gtpu_recovery_ie *) ((u8 *) hdr0 +
-					      (hdrlen -
-					       sizeof (gtpu_recovery_ie)));
-		      recovery->type = GTPU_RECOVERY_IE_TYPE;
-		      recovery->restart_counter = 0;
-		    }
-		  else if (gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      if (ie_size)
-			{
-			  u8 *ie_ptr;
+      hdr0->gtpu.type = gtpu_type;
 
-			  ie_ptr = (u8 *) ((u8 *) hdr0 + (hdrlen - ie_size));
-			  clib_memcpy_fast (ie_ptr, ie_buf, ie_size);
-			}
-		    }
-		}
+      if (qfi)
+	{
+	  u8 type = 0;
+	  gtpu_pdu_session_t *sess;
 
-	      offset = ls_param->v4src_position / 8;
-	      shift = ls_param->v4src_position % 8;
+	  hdr0->gtpu.ver_flags |= GTPU_EXTHDR_FLAG;
 
-	      if (PREDICT_TRUE (shift == 0))
-		{
-		  for (index = 0; index < 4; index++)
-		    {
-		      hdr0->ip4.src_address.as_u8[index] =
-			src0.as_u8[offset + index];
-		    }
-		}
-	      else
-		{
-		  for (index = 0; index < 4; index++)
-		    {
-		      hdr0->ip4.src_address.as_u8[index] =
-			src0.as_u8[offset + index] << shift;
-		      hdr0->ip4.src_address.as_u8[index] |=
-			src0.as_u8[offset + index + 1] >> (8 - shift);
-		    }
-		}
+	  hdr0->gtpu.ext->seq = 0;
 
-	      key = hash_memory (p, plen < 40 ? plen : 40, 0);
-	      port = hash_uword_to_u16 (&key);
-	      hdr0->udp.src_port = port;
+	  hdr0->gtpu.ext->npdu_num = 0;
+	  hdr0->gtpu.ext->nextexthdr = GTPU_EXTHDR_PDU_SESSION;
 
-	      hdr0->udp.length = clib_host_to_net_u16 (len0 +
-						       sizeof (udp_header_t) +
-						       sizeof
-						       (gtpu_header_t));
+	  type = qfi & SRV6_PDU_SESSION_U_BIT_MASK;
 
-	      hdr0->ip4.length = clib_host_to_net_u16 (len0 +
-						       sizeof
-						       (ip4_gtpu_header_t));
+	  qfi =
+	    ((qfi & SRV6_PDU_SESSION_QFI_MASK) >> 2) |
+	    ((qfi & SRV6_PDU_SESSION_R_BIT_MASK) << 5);
 
-	      hdr0->ip4.checksum = ip4_header_checksum (&hdr0->ip4);
+	  sess =
+	    (gtpu_pdu_session_t *) (((char *) hdr0) +
+				    sizeof (ip4_gtpu_header_t) +
+				    sizeof (gtpu_exthdr_t));
+	  sess->exthdrlen = 1;
+	  sess->type = type;
+	  sess->spare = 0;
+	  sess->u.val = qfi;
+	  sess->nextexthdr = 0;
+	}
 
-	      good_n++;
+      if (gtpu_type == GTPU_TYPE_ECHO_REPLY
+	  || gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  hdr0->gtpu.ver_flags |= GTPU_SEQ_FLAG;
+	  hdr0->gtpu.ext->seq = seq;
+	  hdr0->gtpu.ext->npdu_num = 0;
+	  hdr0->gtpu.ext->nextexthdr = 0;
 
-	      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
-		  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	  if (gtpu_type == GTPU_TYPE_ECHO_REPLY)
+	    {
+	      gtpu_recovery_ie *recovery;
+
+	      recovery =
+		(gtpu_recovery_ie *) ((u8 *) hdr0 +
+				      (hdrlen -
+				       sizeof (gtpu_recovery_ie)));
+	      recovery->type = GTPU_RECOVERY_IE_TYPE;
+	      recovery->restart_counter = 0;
+	    }
+	  else if (gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	    {
+	      if (ie_size)
 		{
-		  srv6_end_rewrite_trace_t *tr =
-		    vlib_add_trace (vm, node, b0, sizeof (*tr));
-		  clib_memcpy (tr->src.as_u8, hdr0->ip4.src_address.as_u8,
-			       sizeof (tr->src.as_u8));
-		  clib_memcpy (tr->dst.as_u8, hdr0->ip4.dst_address.as_u8,
-			       sizeof (tr->dst.as_u8));
-		  tr->teid = hdr0->gtpu.teid;
+		  u8 *ie_ptr;
+
+		  ie_ptr = (u8 *) ((u8 *) hdr0 + (hdrlen - ie_size));
+		  clib_memcpy_fast (ie_ptr, ie_buf, ie_size);
 		}
 	    }
-
-	  vlib_increment_combined_counter
-	    (((next0 ==
-	       SRV6_END_M_GTP4_E_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters) :
-	      &(sm2->sr_ls_valid_counters)), thread_index,
-	     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
-
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      hdr0->ip4.src_address.as_u32 =
+	clib_host_to_net_u32 (srv6_mobile_field_get
+			      (srv6_mobile_addr_load (&src0),
+			       ls_param->v4src_position, 32));
+
+      hdr0->udp.src_port =
+	srv6_mobile_gtpu_src_port (ls_param->srcport_mode, ls_param->srcport,
+				   teid, p, plen);
+
+      hdr0->udp.length = clib_host_to_net_u16 (len0 +
+					       sizeof (udp_header_t) +
+					       sizeof
+					       (gtpu_header_t));
+
+      hdr0->ip4.length = clib_host_to_net_u16 (len0 +
+					       sizeof
+					       (ip4_gtpu_header_t));
+
+      sum0 = hdr0->ip4.checksum;
+      sum0 = ip_csum_update (sum0, 0, hdr0->ip4.length, ip4_header_t,
+			     length);
+      sum0 = ip_csum_update (sum0, 0, hdr0->ip4.dst_address.as_u32,
+			     ip4_header_t, dst_address);
+      sum0 = ip_csum_update (sum0, 0, hdr0->ip4.src_address.as_u32,
+			     ip4_header_t, src_address);
+      hdr0->ip4.checksum = ip_csum_fold (sum0);
+
+      ASSERT (hdr0->ip4.checksum == ip4_header_checksum (&hdr0->ip4));
+
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
+	  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  srv6_end_rewrite_trace_t *tr =
+	    vlib_add_trace (vm, node, b0, sizeof (*tr));
+	  clib_memcpy (tr->src.as_u8, hdr0->ip4.src_address.as_u8,
+		       sizeof (tr->src.as_u8));
+	  clib_memcpy (tr->dst.as_u8, hdr0->ip4.dst_address.as_u8,
+		       sizeof (tr->dst.as_u8));
+	  tr->teid = hdr0->gtpu.teid;
+	}
     }
 
+  vlib_increment_combined_counter
+    (((next0 ==
+       SRV6_END_M_GTP4_E_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters) :
+      &(sm2->sr_ls_valid_counters)), thread_index,
+     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
+
+  if (PREDICT_TRUE (next0 != SRV6_END_M_GTP4_E_NEXT_DROP))
+    vlib_increment_combined_counter
+      (&srv6_mobile_localsid_counters[srv6_mobile_msg_type (gtpu_type)],
+       thread_index, ls0 - sm2->localsids, 1,
+       vlib_buffer_length_in_chain (vm, b0));
+
+  return next0;
+}
+
+// Function for SRv6 GTP4.E function.
+VLIB_NODE_FN (srv6_end_m_gtp4_e) (vlib_main_t * vm,
+				  vlib_node_runtime_t * node,
+				  vlib_frame_t * frame)
+{
+  srv6_end_main_v4_t *sm = &srv6_end_main_v4;
+  u32 bad_n;
+
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_end_m_gtp4_e_process,
+			       SRV6_END_M_GTP4_E_NEXT_DROP, 0);
+
   vlib_node_increment_counter (vm, sm->end_m_gtp4_e_node_index,
 			       SRV6_END_ERROR_M_GTP4_E_BAD_PACKETS, bad_n);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp4_e_node_index,
-			       SRV6_END_ERROR_M_GTP4_E_PACKETS, good_n);
+			       SRV6_END_ERROR_M_GTP4_E_PACKETS,
+			       frame->n_vectors - bad_n);
 
   return frame->n_vectors;
 }
 
-// Function for SRv6 GTP4.D function.
-VLIB_NODE_FN (srv6_t_m_gtp4_d) (vlib_main_t * vm,
-				vlib_node_runtime_t * node,
-				vlib_frame_t * frame)
+static_always_inline u16
+srv6_t_m_gtp4_d_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			 vlib_buffer_t * b0)
 {
   srv6_t_main_v4_decap_t *sm = &srv6_t_main_v4_decap;
   ip6_sr_main_t *sm2 = &sr_main;
-  u32 n_left_from, next_index, *from, *to_next;
+  u32 thread_index = vm->thread_index;
+  ip6_sr_sl_t *sl0;
+  srv6_end_gtp4_param_t *ls_param;
+  u8 gtpu_type = 0;
+  ip4_header_t *ip4;
 
-  u32 good_n = 0, bad_n = 0;
+  uword len0;
 
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
+  u32 next0 = SRV6_T_M_GTP4_D_NEXT_LOOKUP;
 
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
+  sl0 =
+    pool_elt_at_index (sm2->sid_lists,
+		       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+
+  ls_param = (srv6_end_gtp4_param_t *) sl0->plugin_mem;
+
+  len0 = vlib_buffer_length_in_chain (vm, b0);
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+  ip4 = vlib_buffer_get_current (b0);
 
-      while (n_left_from > 0 && n_left_to_next > 0)
+  if (ip4->protocol != IP_PROTOCOL_UDP
+      || len0 < sizeof (ip4_gtpu_header_t))
+    {
+      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
+    }
+  else
+    {
+      ip6_sr_sl_t *sl = NULL;
+      u32 sl_index;
+      u32 hdr_len;
+
+      ip4_gtpu_header_t *hdr;
+      ip4_address_t src, dst;
+      ip6_header_t *encap = NULL;
+      ip6_address_t seg;
+      ip6_address_t src6;
+      u32 teid;
+      u8 qfi = 0;
+      u8 *qfip = NULL;
+      u16 seq = 0;
+      u32 pos;
+      u128 seg128;
+      ip6srv_combo_header_t *ip6srv;
+      gtpu_pdu_session_t *sess = NULL;
+      int ie_size = 0;
+      u16 tlv_siz = 0;
+      u8 ie_buf[GTPU_IE_MAX_SIZ];
+
+      // Decap from GTP-U.
+      hdr = (ip4_gtpu_header_t *) ip4;
+
+      hdr_len = sizeof (ip4_gtpu_header_t);
+
+      teid = hdr->gtpu.teid;
+
+      gtpu_type = hdr->gtpu.type;
+
+      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+			 && ls_param->echo_local))
+	{
+	  // Path management stays on this hop.
+	  next0 = SRV6_T_M_GTP4_D_NEXT_ECHO;
+	  goto DONE;
+	}
+
+      if (hdr->gtpu.ver_flags & (GTPU_EXTHDR_FLAG | GTPU_SEQ_FLAG))
 	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  ip6_sr_sl_t *sl0;
-	  srv6_end_gtp4_param_t *ls_param;
-	  ip4_header_t *ip4;
+	  // Extention header.
+	  hdr_len += sizeof (gtpu_exthdr_t);
 
-	  uword len0;
+	  seq = hdr->gtpu.ext->seq;
 
-	  u32 next0 = SRV6_T_M_GTP4_D_NEXT_LOOKUP;
+	  if (hdr->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
+	    {
+	      // PDU Session Container.
+	      sess =
+		(gtpu_pdu_session_t *) (((char *) hdr) + hdr_len);
+	      qfi = sess->u.val & ~GTPU_PDU_SESSION_P_BIT_MASK;
+	      qfip = (u8 *) & qfi;
 
-	  // defaults
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
+	      hdr_len += sizeof (gtpu_pdu_session_t);
 
-	  b0 = vlib_get_buffer (vm, bi0);
+	      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
+		{
+		  hdr_len += sizeof (gtpu_paging_policy_t);
+		}
+	    }
+	}
 
-	  sl0 =
-	    pool_elt_at_index (sm2->sid_lists,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+      src = hdr->ip4.src_address;
+      dst = hdr->ip4.dst_address;
 
-	  ls_param = (srv6_end_gtp4_param_t *) sl0->plugin_mem;
+      pos = ls_param->sr_prefixlen;
+      seg128 = srv6_mobile_addr_load (&ls_param->sr_prefix);
 
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
+      seg128 = srv6_mobile_field_set (seg128, pos, 32,
+				      clib_net_to_host_u32 (dst.as_u32));
 
-	  ip4 = vlib_buffer_get_current (b0);
+      if (qfip)
+	{
+	  qfi =
+	    ((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
+	    ((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
 
-	  if (ip4->protocol != IP_PROTOCOL_UDP
-	      || len0 < sizeof (ip4_gtpu_header_t))
+	  if (sess->type)
 	    {
-	      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
-
-	      bad_n++;
+	      qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
 	    }
-	  else
+
+	  seg128 = srv6_mobile_field_set (seg128, pos + 32, 8, qfi);
+	}
+
+      if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	  || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  seg128 = srv6_mobile_field_set (seg128, pos + 40, 16,
+					  clib_net_to_host_u16 (seq));
+	}
+      else
+	{
+	  seg128 = srv6_mobile_field_set (seg128, pos + 40, 32,
+					  clib_net_to_host_u32 (teid));
+	}
+
+      srv6_mobile_addr_store (&seg, seg128);
+
+      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
+	{
+	  u16 payload_len;
+
+	  payload_len = clib_net_to_host_u16 (hdr->gtpu.length);
+	  if (payload_len != 0)
 	    {
-	      uword *p;
-	      ip6_sr_policy_t *sr_policy = NULL;
-	      ip6_sr_sl_t *sl = NULL;
-	      u32 *sl_index;
-	      u32 hdr_len;
-
-	      ip4_gtpu_header_t *hdr;
-	      ip4_address_t src, dst;
-	      u8 *srcp, *dstp;
-	      ip6_header_t *encap = NULL;
-	      ip6_address_t seg;
-	      ip6_address_t src6;
-	      u8 gtpu_type;
-	      u32 teid;
-	      u8 *teidp;
-	      u8 qfi = 0;
-	      u8 *qfip = NULL;
-	      u16 seq = 0;
-	      u8 *seqp;
-	      u32 offset, shift, index;
-	      ip6srv_combo_header_t *ip6srv;
-	      gtpu_pdu_session_t *sess = NULL;
-	      int ie_size = 0;
-	      u16 tlv_siz = 0;
-	      u8 ie_buf[GTPU_IE_MAX_SIZ];
-
-	      // Decap from GTP-U.
-	      hdr = (ip4_gtpu_header_t *) ip4;
-
-	      hdr_len = sizeof (ip4_gtpu_header_t);
-
-	      teid = hdr->gtpu.teid;
-	      teidp = (u8 *) & teid;
-
-	      seqp = (u8 *) & seq;
-
-	      gtpu_type = hdr->gtpu.type;
-
-	      if (hdr->gtpu.ver_flags & (GTPU_EXTHDR_FLAG | GTPU_SEQ_FLAG))
+	      ie_size =
+		payload_len - (hdr_len - sizeof (ip4_gtpu_header_t));
+	      if (ie_size > 0)
 		{
-		  // Extention header.
-		  hdr_len += sizeof (gtpu_exthdr_t);
+		  u8 *ies;
 
-		  seq = hdr->gtpu.ext->seq;
-
-		  if (hdr->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
-		    {
-		      // PDU Session Container.
-		      sess =
-			(gtpu_pdu_session_t *) (((char *) hdr) + hdr_len);
-		      qfi = sess->u.val & ~GTPU_PDU_SESSION_P_BIT_MASK;
-		      qfip = (u8 *) & qfi;
-
-		      hdr_len += sizeof (gtpu_pdu_session_t);
-
-		      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
-			{
-			  hdr_len += sizeof (gtpu_paging_policy_t);
-			}
-		    }
+		  ies = (u8 *) ((u8 *) hdr + hdr_len);
+		  clib_memcpy_fast (ie_buf, ies, ie_size);
+		  hdr_len += ie_size;
 		}
+	    }
+	}
 
-	      src = hdr->ip4.src_address;
-	      srcp = (u8 *) & src;
+      src6 = ls_param->v6src_prefix;
+      srv6_mobile_addr_store (&src6, srv6_mobile_field_set
+			      (srv6_mobile_addr_load (&src6),
+			       ls_param->v6src_prefixlen, 32,
+			       clib_net_to_host_u32 (src.as_u32)));
 
-	      dst = hdr->ip4.dst_address;
-	      dstp = (u8 *) & dst;
+      vlib_buffer_advance (b0, (word) hdr_len);
 
-	      seg = ls_param->sr_prefix;
+      // Encap to SRv6.
+      if (PREDICT_TRUE (gtpu_type == GTPU_TYPE_GTPU))
+	{
+	  encap = vlib_buffer_get_current (b0);
+	}
 
-	      offset = ls_param->sr_prefixlen / 8;
-	      shift = ls_param->sr_prefixlen % 8;
+      len0 = vlib_buffer_length_in_chain (vm, b0);
 
-	      if (PREDICT_TRUE (shift == 0))
-		{
-		  clib_memcpy_fast (&seg.as_u8[offset], dstp, 4);
+      sl_index = srv6_mobile_sl_select (ls_param->sl_buckets, teid, encap,
+					ls_param->nhtype);
+      if (PREDICT_TRUE (sl_index != ~0))
+	sl = pool_elt_at_index (sm2->sid_lists, sl_index);
 
-		  if (qfip)
-		    {
-		      qfi =
-			((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
-			((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
+      if (sl)
+	{
+	  hdr_len = sizeof (ip6srv_combo_header_t);
+	  hdr_len +=
+	    (vec_len (sl->segments) - sl->is_reduced) * sizeof (ip6_address_t);
+	  hdr_len += sizeof (ip6_address_t);
+	}
+      else
+	{
+	  hdr_len = sizeof (ip6_header_t);
 
-		      if (sess->type)
-			{
-			  qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
-			}
+	  if (PREDICT_FALSE (gtpu_type != GTPU_TYPE_GTPU))
+	    {
+	      hdr_len += sizeof (ip6_sr_header_t);
+	      hdr_len += sizeof (ip6_address_t);
+	    }
+	}
 
-		      seg.as_u8[offset + 4] = qfi;
-		    }
+      if (ie_size)
+	{
+	  tlv_siz =
+	    sizeof (ip6_sr_tlv_t) + sizeof (user_plane_sub_tlv_t) +
+	    ie_size;
 
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      clib_memcpy_fast (&seg.as_u8[offset + 5], seqp, 2);
-		    }
-		  else
-		    {
-		      clib_memcpy_fast (&seg.as_u8[offset + 5], teidp, 4);
-		    }
-		}
-	      else
-		{
-		  for (index = 0; index < 4; index++)
-		    {
-		      seg.as_u8[offset + index] |= dstp[index] >> shift;
-		      seg.as_u8[offset + index + 1] |=
-			dstp[index] << (8 - shift);
-		    }
+	  tlv_siz = (tlv_siz & ~0x07) + (tlv_siz & 0x07 ? 0x08 : 0x0);
+	  hdr_len += tlv_siz;
+	}
 
-		  if (qfip)
-		    {
-		      qfi =
-			((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
-			((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
+      vlib_buffer_advance (b0, -(word) hdr_len);
+      ip6srv = vlib_buffer_get_current (b0);
 
-		      if (sess->type)
-			{
-			  qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
-			}
+      if (sl)
+	{
+	  clib_memcpy_fast (ip6srv, sl->rewrite,
+			    vec_len (sl->rewrite));
 
-		      seg.as_u8[offset + 4] |= qfi >> shift;
-		      seg.as_u8[offset + 5] |= qfi << (8 - shift);
-		    }
-
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      for (index = 0; index < 2; index++)
-			{
-			  seg.as_u8[offset + 5 + index] |=
-			    seqp[index] >> shift;
-			  seg.as_u8[offset + 6 + index] |=
-			    seqp[index] << (8 - shift);
-			}
-		    }
-		  else
-		    {
-		      for (index = 0; index < 4; index++)
-			{
-			  seg.as_u8[offset + index + 5] |=
-			    teidp[index] >> shift;
-			  seg.as_u8[offset + index + 6] |=
-			    teidp[index] << (8 - shift);
-			}
-		    }
-		}
-
-	      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
-		{
-		  u16 payload_len;
+	  if (vec_len (sl->segments) > 1)
+	    {
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-		  payload_len = clib_net_to_host_u16 (hdr->gtpu.length);
-		  if (payload_len != 0)
-		    {
-		      ie_size =
-			payload_len - (hdr_len - sizeof (ip4_gtpu_header_t));
-		      if (ie_size > 0)
-			{
-			  u8 *ies;
-
-			  ies = (u8 *) ((u8 *) hdr + hdr_len);
-			  clib_memcpy_fast (ie_buf, ies, ie_size);
-			  hdr_len += ie_size;
-			}
-		    }
-		}
+	      ip6srv->sr.segments_left += 1;
+	      ip6srv->sr.last_entry += 1;
 
-	      src6 = ls_param->v6src_prefix;
+	      ip6srv->sr.length += sizeof (ip6_address_t) / 8;
+	      ip6srv->sr.segments[0] = seg;
 
-	      offset = ls_param->v6src_prefixlen / 8;
-	      shift = ls_param->v6src_prefixlen % 8;
+	      clib_memcpy_fast (&ip6srv->sr.segments[1],
+				(u8 *) (sl->rewrite +
+					sizeof (ip6_header_t) +
+					sizeof (ip6_sr_header_t)),
+				(vec_len (sl->segments) - sl->is_reduced) *
+				sizeof (ip6_address_t));
+	    }
+	  else
+	    {
+	      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
 
-	      if (PREDICT_TRUE (shift == 0))
-		{
-		  clib_memcpy_fast (&src6.as_u8[offset], srcp, 4);
-		}
-	      else
-		{
-		  for (index = 0; index < 4; index++)
-		    {
-		      src6.as_u8[offset + index] |= srcp[offset] >> shift;
-		      src6.as_u8[offset + index + 1] |=
-			srcp[offset] << (8 - shift);
-		    }
-		}
+	      ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
 
-	      vlib_buffer_advance (b0, (word) hdr_len);
+	      ip6srv->sr.segments_left = 1;
+	      ip6srv->sr.last_entry = 0;
 
-	      // Encap to SRv6.
-	      if (PREDICT_TRUE (gtpu_type == GTPU_TYPE_GTPU))
-		{
-		  encap = vlib_buffer_get_current (b0);
-		}
+	      ip6srv->sr.length =
+		((sizeof (ip6_sr_header_t) +
+		  sizeof (ip6_address_t)) / 8) - 1;
+	      ip6srv->sr.flags = 0;
 
-	      len0 = vlib_buffer_length_in_chain (vm, b0);
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-	      p =
-		mhash_get (&sm2->sr_policies_index_hash,
-			   &ls_param->sr_prefix);
-	      if (p)
+	      ip6srv->sr.segments[0] = seg;
+	      if (vec_len (sl->segments))
 		{
-		  sr_policy = pool_elt_at_index (sm2->sr_policies, p[0]);
+		  ip6srv->sr.segments[1] = sl->segments[0];
+		  ip6srv->sr.length += sizeof (ip6_address_t) / 8;
+		  ip6srv->sr.last_entry++;
 		}
+	    }
 
-	      if (sr_policy)
+	  if (PREDICT_TRUE (encap != NULL))
+	    {
+	      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
 		{
-		  vec_foreach (sl_index, sr_policy->segments_lists)
-		  {
-		    sl = pool_elt_at_index (sm2->sid_lists, *sl_index);
-		    if (sl != NULL)
-		      break;
-		  }
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) == 6)
+		    ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
+		  else
+		    ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
 		}
-
-	      if (sl)
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
 		{
-		  hdr_len = sizeof (ip6srv_combo_header_t);
-		  hdr_len += vec_len (sl->segments) * sizeof (ip6_address_t);
-		  hdr_len += sizeof (ip6_address_t);
+		  ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 4)
+		    {
+		      // Bad encap packet.
+		      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
+		      goto DONE;
+		    }
 		}
-	      else
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
 		{
-		  hdr_len = sizeof (ip6_header_t);
-
-		  if (PREDICT_FALSE (gtpu_type != GTPU_TYPE_GTPU))
+		  ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 6)
 		    {
-		      hdr_len += sizeof (ip6_sr_header_t);
-		      hdr_len += sizeof (ip6_address_t);
+		      // Bad encap packet.
+		      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
+		      goto DONE;
 		    }
 		}
-
-	      if (ie_size)
+	      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
 		{
-		  tlv_siz =
-		    sizeof (ip6_sr_tlv_t) + sizeof (user_plane_sub_tlv_t) +
-		    ie_size;
-
-		  tlv_siz = (tlv_siz & ~0x07) + (tlv_siz & 0x07 ? 0x08 : 0x0);
-		  hdr_len += tlv_siz;
+		  ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
 		}
+	    }
+	  else
+	    {
+	      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
+	    }
+	}
+      else
+	{
+	  srv6_mobile_copy_ip6_hdr (&ip6srv->ip, &sm->cache_hdr);
 
-	      vlib_buffer_advance (b0, -(word) hdr_len);
-	      ip6srv = vlib_buffer_get_current (b0);
-
-	      if (sl)
-		{
-		  clib_memcpy_fast (ip6srv, sl->rewrite,
-				    vec_len (sl->rewrite));
-
-		  if (vec_len (sl->segments) > 1)
-		    {
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
-
-		      ip6srv->sr.segments_left += 1;
-		      ip6srv->sr.last_entry += 1;
-
-		      ip6srv->sr.length += sizeof (ip6_address_t) / 8;
-		      ip6srv->sr.segments[0] = seg;
-
-		      clib_memcpy_fast (&ip6srv->sr.segments[1],
-					(u8 *) (sl->rewrite +
-						sizeof (ip6_header_t) +
-						sizeof (ip6_sr_header_t)),
-					vec_len (sl->segments) *
-					sizeof (ip6_address_t));
-		    }
-		  else
-		    {
-		      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
-
-		      ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
+	  ip6srv->ip.dst_address = seg;
 
-		      ip6srv->sr.segments_left = 1;
-		      ip6srv->sr.last_entry = 0;
+	  if (PREDICT_FALSE (gtpu_type != GTPU_TYPE_GTPU))
+	    {
+	      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
 
-		      ip6srv->sr.length =
-			((sizeof (ip6_sr_header_t) +
-			  sizeof (ip6_address_t)) / 8) - 1;
-		      ip6srv->sr.flags = 0;
+	      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
 
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-		      ip6srv->sr.segments[0] = seg;
-		      if (vec_len (sl->segments))
-			{
-			  ip6srv->sr.segments[1] = sl->segments[0];
-			  ip6srv->sr.length += sizeof (ip6_address_t) / 8;
-			  ip6srv->sr.last_entry++;
-			}
-		    }
+	      ip6srv->sr.segments_left = 0;
+	      ip6srv->sr.last_entry = 0;
 
-		  if (PREDICT_TRUE (encap != NULL))
-		    {
-		      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
-			{
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) == 6)
-			    ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
-			  else
-			    ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
-			{
-			  ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 4)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
-			{
-			  ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 6)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
-			{
-			  ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
-			}
-		    }
+	      ip6srv->sr.length = sizeof (ip6_address_t) / 8;
+	      ip6srv->sr.segments[0] = seg;
+	    }
+	  else
+	    {
+	      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
+		{
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) == 6)
+		    ip6srv->ip.protocol = IP_PROTOCOL_IPV6;
 		  else
-		    {
-		      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
-		    }
+		    ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
 		}
-	      else
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
 		{
-		  clib_memcpy_fast (ip6srv, &sm->cache_hdr,
-				    sizeof (ip6_header_t));
-
-		  ip6srv->ip.dst_address = seg;
-
-		  if (PREDICT_FALSE (gtpu_type != GTPU_TYPE_GTPU))
+		  ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 4)
 		    {
-		      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
-
-		      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
-
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
-
-		      ip6srv->sr.segments_left = 0;
-		      ip6srv->sr.last_entry = 0;
-
-		      ip6srv->sr.length = sizeof (ip6_address_t) / 8;
-		      ip6srv->sr.segments[0] = seg;
+		      // Bad encap packet.
+		      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
+		      goto DONE;
 		    }
-		  else
+		}
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
+		{
+		  ip6srv->ip.protocol = IP_PROTOCOL_IPV6;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 6)
 		    {
-		      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
-			{
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) == 6)
-			    ip6srv->ip.protocol = IP_PROTOCOL_IPV6;
-			  else
-			    ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
-			{
-			  ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 4)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
-			{
-			  ip6srv->ip.protocol = IP_PROTOCOL_IPV6;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 6)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
-			{
-			  ip6srv->ip.protocol = IP_PROTOCOL_IP6_ETHERNET;
-			}
+		      // Bad encap packet.
+		      next0 = SRV6_T_M_GTP4_D_NEXT_DROP;
+		      goto DONE;
 		    }
 		}
-
-	      ip6srv->ip.src_address = src6;
-
-	      if (PREDICT_FALSE (ie_size))
+	      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
 		{
-		  ip6_sr_tlv_t *tlv;
-		  user_plane_sub_tlv_t *sub_tlv;
+		  ip6srv->ip.protocol = IP_PROTOCOL_IP6_ETHERNET;
+		}
+	    }
+	}
 
-		  tlv =
-		    (ip6_sr_tlv_t *) ((u8 *) ip6srv + (hdr_len - tlv_siz));
-		  tlv->type = SRH_TLV_USER_PLANE_CONTAINER;
-		  tlv->length = (u8) (tlv_siz - sizeof (ip6_sr_tlv_t));
-		  clib_memset (tlv->value, 0, tlv->length);
+      ip6srv->ip.src_address = src6;
 
-		  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
-		  sub_tlv->type = USER_PLANE_SUB_TLV_IE;
-		  sub_tlv->length = (u8) ie_size;
-		  clib_memcpy_fast (sub_tlv->value, ie_buf, ie_size);
+      if (PREDICT_FALSE (ie_size))
+	{
+	  ip6_sr_tlv_t *tlv;
+	  user_plane_sub_tlv_t *sub_tlv;
 
-		  ip6srv->sr.length += (u8) (tlv_siz / 8);
-		}
+	  tlv =
+	    (ip6_sr_tlv_t *) ((u8 *) ip6srv + (hdr_len - tlv_siz));
+	  tlv->type = SRH_TLV_USER_PLANE_CONTAINER;
+	  tlv->length = (u8) (tlv_siz - sizeof (ip6_sr_tlv_t));
+	  clib_memset (tlv->value, 0, tlv->length);
 
-	      ip6srv->ip.payload_length =
-		clib_host_to_net_u16 (len0 + hdr_len - sizeof (ip6_header_t));
+	  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
+	  sub_tlv->type = USER_PLANE_SUB_TLV_IE;
+	  sub_tlv->length = (u8) ie_size;
+	  clib_memcpy_fast (sub_tlv->value, ie_buf, ie_size);
 
-	      good_n++;
+	  ip6srv->sr.length += (u8) (tlv_siz / 8);
+	}
 
-	      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
-		  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
-		{
-		  srv6_end_rewrite_trace_t *tr =
-		    vlib_add_trace (vm, node, b0, sizeof (*tr));
-		  clib_memcpy (tr->src.as_u8, ip6srv->ip.src_address.as_u8,
-			       sizeof (tr->src.as_u8));
-		  clib_memcpy (tr->dst.as_u8, ip6srv->ip.dst_address.as_u8,
-			       sizeof (tr->dst.as_u8));
-		}
-	    }
+      ip6srv->ip.payload_length =
+	clib_host_to_net_u16 (len0 + hdr_len - sizeof (ip6_header_t));
 
-	DONE:
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
+	  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  srv6_end_rewrite_trace_t *tr =
+	    vlib_add_trace (vm, node, b0, sizeof (*tr));
+	  clib_memcpy (tr->src.as_u8, ip6srv->ip.src_address.as_u8,
+		       sizeof (tr->src.as_u8));
+	  clib_memcpy (tr->dst.as_u8, ip6srv->ip.dst_address.as_u8,
+		       sizeof (tr->dst.as_u8));
 	}
-
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
     }
 
+DONE:
+  if (PREDICT_TRUE (next0 != SRV6_T_M_GTP4_D_NEXT_DROP))
+    vlib_increment_combined_counter
+      (&srv6_mobile_policy_counters[srv6_mobile_msg_type (gtpu_type)],
+       thread_index, ls_param->counter_index, 1,
+       vlib_buffer_length_in_chain (vm, b0));
+
+  return next0;
+}
+
+// Function for SRv6 GTP4.D function.
+VLIB_NODE_FN (srv6_t_m_gtp4_d) (vlib_main_t * vm,
+				vlib_node_runtime_t * node,
+				vlib_frame_t * frame)
+{
+  srv6_t_main_v4_decap_t *sm = &srv6_t_main_v4_decap;
+  u32 bad_n;
+
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_t_m_gtp4_d_process,
+			       SRV6_T_M_GTP4_D_NEXT_DROP, 1);
+
   vlib_node_increment_counter (vm, sm->t_m_gtp4_d_node_index,
 			       SRV6_T_ERROR_M_GTP4_D_BAD_PACKETS, bad_n);
 
   vlib_node_increment_counter (vm, sm->t_m_gtp4_d_node_index,
-			       SRV6_T_ERROR_M_GTP4_D_PACKETS, good_n);
+			       SRV6_T_ERROR_M_GTP4_D_PACKETS,
+			       frame->n_vectors - bad_n);
 
   return frame->n_vectors;
 }
@@ -1231,1734 +1299,1641 @@ VLIB_REGISTER_NODE (srv6_t_m_gtp4_d) =
     SRV6_T_M_GTP4_D_N_NEXT,.next_nodes =
   {
   [SRV6_T_M_GTP4_D_NEXT_DROP] =
-      "error-drop",[SRV6_T_M_GTP4_D_NEXT_LOOKUP] = "ip6-lookup",}
+      "error-drop",[SRV6_T_M_GTP4_D_NEXT_LOOKUP] =
+      "ip6-lookup",[SRV6_T_M_GTP4_D_NEXT_ECHO] = "srv6-t-m-gtp4-echo",}
 ,};
 
-// Function for SRv6 GTP6.E function
-VLIB_NODE_FN (srv6_end_m_gtp6_e) (vlib_main_t * vm,
-				  vlib_node_runtime_t * node,
-				  vlib_frame_t * frame)
+/*
+ * Answer a GTP-U echo request in place: swap the addresses, keep the
+ * sequence number, drop any request IEs and append our recovery IE.
+ */
+static_always_inline u16
+srv6_t_m_gtp4_echo_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			    vlib_buffer_t * b0)
+{
+  srv6_t_main_v4_decap_t *sm = &srv6_t_main_v4_decap;
+  ip4_gtpu_header_t *hdr0;
+  gtpu_recovery_ie *recovery;
+  ip4_address_t src0;
+  u16 seq0 = 0;
+  u16 sport0;
+  u16 len0;
+
+  hdr0 = vlib_buffer_get_current (b0);
+
+  if (PREDICT_FALSE ((b0->flags & VLIB_BUFFER_NEXT_PRESENT)
+		     || b0->current_length < sizeof (ip4_gtpu_header_t)
+		     || ip4_is_fragment (&hdr0->ip4)))
+    return SRV6_T_M_GTP4_ECHO_NEXT_DROP;
+
+  if (hdr0->gtpu.ver_flags & (GTPU_EXTHDR_FLAG | GTPU_SEQ_FLAG))
+    {
+      if (b0->current_length <
+	  sizeof (ip4_gtpu_header_t) + sizeof (gtpu_exthdr_t))
+	return SRV6_T_M_GTP4_ECHO_NEXT_DROP;
+
+      seq0 = hdr0->gtpu.ext->seq;
+    }
+
+  len0 = sizeof (ip4_gtpu_header_t) + sizeof (gtpu_exthdr_t) +
+    sizeof (gtpu_recovery_ie);
+
+  src0 = hdr0->ip4.src_address;
+  hdr0->ip4.src_address = hdr0->ip4.dst_address;
+  hdr0->ip4.dst_address = src0;
+  hdr0->ip4.ip_version_and_header_length = 0x45;
+  hdr0->ip4.flags_and_fragment_offset = 0;
+  hdr0->ip4.ttl = 64;
+  hdr0->ip4.length = clib_host_to_net_u16 (len0);
+  hdr0->ip4.checksum = ip4_header_checksum (&hdr0->ip4);
+
+  sport0 = hdr0->udp.src_port;
+  hdr0->udp.src_port = clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT);
+  hdr0->udp.dst_port = sport0;
+  hdr0->udp.length = clib_host_to_net_u16 (len0 - sizeof (ip4_header_t));
+  hdr0->udp.checksum = 0;
+
+  hdr0->gtpu.ver_flags = GTPU_V1_VER | GTPU_PT_GTP | GTPU_SEQ_FLAG;
+  hdr0->gtpu.type = GTPU_TYPE_ECHO_REPLY;
+  hdr0->gtpu.length = clib_host_to_net_u16 (sizeof (gtpu_exthdr_t) +
+					    sizeof (gtpu_recovery_ie));
+  hdr0->gtpu.teid = 0;
+  hdr0->gtpu.ext->seq = seq0;
+  hdr0->gtpu.ext->npdu_num = 0;
+  hdr0->gtpu.ext->nextexthdr = 0;
+
+  recovery = (gtpu_recovery_ie *) (hdr0->gtpu.ext + 1);
+  recovery->type = GTPU_RECOVERY_IE_TYPE;
+  recovery->restart_counter = sm->restart_counter;
+
+  b0->current_length = len0;
+  vnet_buffer (b0)->sw_if_index[VLIB_TX] = ~0;
+
+  if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+    {
+      srv6_t_echo_trace_t *tr = vlib_add_trace (vm, node, b0, sizeof (*tr));
+      tr->src = hdr0->ip4.src_address;
+      tr->dst = hdr0->ip4.dst_address;
+      tr->seq = seq0;
+      tr->restart_counter = sm->restart_counter;
+    }
+
+  return SRV6_T_M_GTP4_ECHO_NEXT_LOOKUP;
+}
+
+// Function for T.M.GTP4.D local echo replies.
+VLIB_NODE_FN (srv6_t_m_gtp4_echo) (vlib_main_t * vm,
+				   vlib_node_runtime_t * node,
+				   vlib_frame_t * frame)
+{
+  u32 bad_n;
+
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_t_m_gtp4_echo_process,
+			       SRV6_T_M_GTP4_ECHO_NEXT_DROP, 1);
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       SRV6_T_ERROR_M_GTP4_ECHO_BAD_PACKETS, bad_n);
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       SRV6_T_ERROR_M_GTP4_ECHO_REPLIES,
+			       frame->n_vectors - bad_n);
+
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (srv6_t_m_gtp4_echo) =
+{
+  .name = "srv6-t-m-gtp4-echo",.vector_size = sizeof (u32),.format_trace =
+    format_srv6_t_echo_trace,.type = VLIB_NODE_TYPE_INTERNAL,.n_errors =
+    ARRAY_LEN (srv6_t_error_v4_echo_strings),.error_strings =
+    srv6_t_error_v4_echo_strings,.n_next_nodes =
+    SRV6_T_M_GTP4_ECHO_N_NEXT,.next_nodes =
+  {
+  [SRV6_T_M_GTP4_ECHO_NEXT_DROP] =
+      "error-drop",[SRV6_T_M_GTP4_ECHO_NEXT_LOOKUP] = "ip4-lookup",}
+,};
+
+static_always_inline u16
+srv6_end_m_gtp6_e_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			   vlib_buffer_t * b0)
 {
   srv6_end_main_v6_t *sm = &srv6_end_main_v6;
   ip6_sr_main_t *sm2 = &sr_main;
-  u32 n_left_from, next_index, *from, *to_next;
   u32 thread_index = vm->thread_index;
+  ip6_sr_localsid_t *ls0;
+  srv6_end_gtp6_e_param_t *ls_param;
+  u8 gtpu_type = 0;
 
-  u32 good_n = 0, bad_n = 0;
+  ip6srv_combo_header_t *ip6srv0;
+  ip6_address_t dst0, src0, seg0;
 
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
+  ip6_gtpu_header_t *hdr0 = NULL;
+  uword len0;
+  u16 tag;
+  void *p;
+  u32 plen;
 
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
+  u32 next0 = SRV6_END_M_GTP6_E_NEXT_LOOKUP;
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+  ls0 =
+    pool_elt_at_index (sm2->localsids,
+		       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
 
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  ip6_sr_localsid_t *ls0;
+  ls_param = (srv6_end_gtp6_e_param_t *) ls0->plugin_mem;
 
-	  ip6srv_combo_header_t *ip6srv0;
-	  ip6_address_t dst0, src0, seg0;
+  ip6srv0 = vlib_buffer_get_current (b0);
+  dst0 = ip6srv0->ip.dst_address;
+  src0 = ip6srv0->ip.src_address;
+  seg0 = ip6srv0->sr.segments[0];
 
-	  ip6_gtpu_header_t *hdr0 = NULL;
-	  uword len0;
-	  uword key;
-	  u16 port;
-	  u16 tag;
-	  void *p;
-	  uword plen;
+  tag = ip6srv0->sr.tag;
 
-	  u32 next0 = SRV6_END_M_GTP6_E_NEXT_LOOKUP;
+  len0 = vlib_buffer_length_in_chain (vm, b0);
 
-	  // defaults
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
+  if ((ip6srv0->ip.protocol != IPPROTO_IPV6_ROUTE)
+      || (len0 <
+	  sizeof (ip6srv_combo_header_t) + 8 * ip6srv0->sr.length))
+    {
+      next0 = SRV6_END_M_GTP6_E_NEXT_DROP;
+    }
+  else
+    {
+      // we need to be sure there is enough space before
+      // ip6srv0 header, there is some extra space
+      // in the pre_data area for this kind of
+      // logic
+
+      u32 teid = 0;
+      u8 qfi = 0;
+      u16 seq = 0;
+      u32 pos;
+      u128 dst128;
+      u32 hdrlen = 0;
+      u16 ie_size = 0;
+      u8 ie_buf[GTPU_IE_MAX_SIZ];
+
+      pos = ls0->localsid_prefix_len + 8;
+      dst128 = srv6_mobile_addr_load (&dst0);
+
+      gtpu_type = gtpu_type_get (tag);
+
+      if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	  || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  seq = clib_host_to_net_u16 (srv6_mobile_field_get (dst128,
+							      pos, 16));
+	}
+      else
+	{
+	  teid = clib_host_to_net_u32 (srv6_mobile_field_get (dst128,
+							       pos, 32));
+	}
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  ls0 =
-	    pool_elt_at_index (sm2->localsids,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+      qfi = srv6_mobile_field_get (dst128, pos + 32, 8);
 
-	  ip6srv0 = vlib_buffer_get_current (b0);
-	  dst0 = ip6srv0->ip.dst_address;
-	  src0 = ip6srv0->ip.src_address;
-	  seg0 = ip6srv0->sr.segments[0];
+      if (qfi)
+	{
+	  hdrlen =
+	    sizeof (gtpu_exthdr_t) + sizeof (gtpu_pdu_session_t);
+	}
+      else if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	       || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	       || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  hdrlen = sizeof (gtpu_exthdr_t);
+	}
 
-	  tag = ip6srv0->sr.tag;
+      if (gtpu_type == GTPU_TYPE_ECHO_REPLY)
+	{
+	  hdrlen += sizeof (gtpu_recovery_ie);
+	}
 
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
+      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
+	{
+	  ip6_sr_tlv_t *tlv;
+	  u16 ext_len;
 
-	  if ((ip6srv0->ip.protocol != IPPROTO_IPV6_ROUTE)
-	      || (len0 <
-		  sizeof (ip6srv_combo_header_t) + 8 * ip6srv0->sr.length))
-	    {
-	      next0 = SRV6_END_M_GTP6_E_NEXT_DROP;
+	  ext_len = ip6srv0->sr.length * 8;
 
-	      bad_n++;
-	    }
-	  else
+	  if (ext_len >
+	      sizeof (ip6_address_t) * (ip6srv0->sr.last_entry + 1))
 	    {
-	      // we need to be sure there is enough space before
-	      // ip6srv0 header, there is some extra space
-	      // in the pre_data area for this kind of
-	      // logic
-
-	      u32 teid = 0;
-	      u8 *teid8p = (u8 *) & teid;
-	      u8 qfi = 0;
-	      u16 seq = 0;
-	      u8 gtpu_type = 0;
-	      u16 index;
-	      u16 offset, shift;
-	      u32 hdrlen = 0;
-	      u16 ie_size = 0;
-	      u8 ie_buf[GTPU_IE_MAX_SIZ];
-
-	      index = ls0->localsid_prefix_len;
-	      index += 8;
-	      offset = index / 8;
-	      shift = index % 8;
-
-	      gtpu_type = gtpu_type_get (tag);
-
-	      if (PREDICT_TRUE (shift == 0))
-		{
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      clib_memcpy_fast (&seq, &dst0.as_u8[offset], 2);
-		    }
-		  else
-		    {
-		      clib_memcpy_fast (teid8p, &dst0.as_u8[offset], 4);
-		    }
+	      tlv =
+		(ip6_sr_tlv_t *) ((u8 *) & ip6srv0->sr +
+				  sizeof (ip6_sr_header_t) +
+				  sizeof (ip6_address_t) *
+				  (ip6srv0->sr.last_entry + 1));
 
-		  qfi = dst0.as_u8[offset + 4];
-		}
-	      else
+	      if (tlv->type == SRH_TLV_USER_PLANE_CONTAINER)
 		{
-		  u8 *sp;
-
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      sp = (u8 *) & seq;
-		      for (index = 0; index < 2; index++)
-			{
-			  sp[index] = dst0.as_u8[offset + index] << shift;
-			  sp[index] |=
-			    dst0.as_u8[offset + index + 1] >> (8 - shift);
-			}
-		    }
-		  else
-		    {
-		      for (index = 0; index < 4; index++)
-			{
-			  *teid8p = dst0.as_u8[offset + index] << shift;
-			  *teid8p |=
-			    dst0.as_u8[offset + index + 1] >> (8 - shift);
-			  teid8p++;
-			}
-		    }
+		  user_plane_sub_tlv_t *sub_tlv;
 
-		  qfi |= dst0.as_u8[offset + 4] << shift;
-		  qfi |= dst0.as_u8[offset + 5] >> (8 - shift);
-		}
+		  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
 
-	      if (qfi)
-		{
-		  hdrlen =
-		    sizeof (gtpu_exthdr_t) + sizeof (gtpu_pdu_session_t);
-		}
-	      else if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		       || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		       || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		{
-		  hdrlen = sizeof (gtpu_exthdr_t);
-		}
+		  ie_size = sub_tlv->length;
+		  clib_memcpy_fast (ie_buf, sub_tlv->value, ie_size);
 
-	      if (gtpu_type == GTPU_TYPE_ECHO_REPLY)
-		{
-		  hdrlen += sizeof (gtpu_recovery_ie);
+		  hdrlen += ie_size;
 		}
+	    }
+	}
 
-	      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
-		{
-		  ip6_sr_tlv_t *tlv;
-		  u16 ext_len;
+      vlib_buffer_advance (b0,
+			   (word) sizeof (ip6srv_combo_header_t) +
+			   ip6srv0->sr.length * 8);
 
-		  ext_len = ip6srv0->sr.length * 8;
+      // get length of encapsulated IPv6 packet (the remaining part)
+      p = vlib_buffer_get_current (b0);
 
-		  if (ext_len >
-		      sizeof (ip6_address_t) * (ip6srv0->sr.last_entry + 1))
-		    {
-		      tlv =
-			(ip6_sr_tlv_t *) ((u8 *) & ip6srv0->sr +
-					  sizeof (ip6_sr_header_t) +
-					  sizeof (ip6_address_t) *
-					  (ip6srv0->sr.last_entry + 1));
+      len0 = vlib_buffer_length_in_chain (vm, b0);
+      plen = b0->current_length;
 
-		      if (tlv->type == SRH_TLV_USER_PLANE_CONTAINER)
-			{
-			  user_plane_sub_tlv_t *sub_tlv;
+      len0 += hdrlen;
 
-			  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
+      hdrlen += sizeof (ip6_gtpu_header_t);
 
-			  ie_size = sub_tlv->length;
-			  clib_memcpy_fast (ie_buf, sub_tlv->value, ie_size);
+      vlib_buffer_advance (b0, -(word) hdrlen);
 
-			  hdrlen += ie_size;
-			}
-		    }
-		}
+      hdr0 = vlib_buffer_get_current (b0);
 
-	      vlib_buffer_advance (b0,
-				   (word) sizeof (ip6srv_combo_header_t) +
-				   ip6srv0->sr.length * 8);
+      srv6_mobile_copy_ip6_gtpu_hdr (hdr0, &sm->cache_hdr);
 
-	      // get length of encapsulated IPv6 packet (the remaining part)
-	      p = vlib_buffer_get_current (b0);
+      hdr0->gtpu.teid = teid;
+      hdr0->gtpu.length = clib_host_to_net_u16 (len0);
 
-	      plen = len0 = vlib_buffer_length_in_chain (vm, b0);
+      hdr0->gtpu.type = gtpu_type;
 
-	      len0 += hdrlen;
+      if (qfi)
+	{
+	  u8 type = 0;
+	  gtpu_pdu_session_t *sess;
 
-	      hdrlen += sizeof (ip6_gtpu_header_t);
+	  hdr0->gtpu.ver_flags |= GTPU_EXTHDR_FLAG;
 
-	      vlib_buffer_advance (b0, -(word) hdrlen);
+	  hdr0->gtpu.ext->seq = 0;
+	  hdr0->gtpu.ext->npdu_num = 0;
+	  hdr0->gtpu.ext->nextexthdr = GTPU_EXTHDR_PDU_SESSION;
 
-	      hdr0 = vlib_buffer_get_current (b0);
+	  type = qfi & SRV6_PDU_SESSION_U_BIT_MASK;
 
-	      clib_memcpy_fast (hdr0, &sm->cache_hdr,
-				sizeof (ip6_gtpu_header_t));
+	  qfi =
+	    ((qfi & SRV6_PDU_SESSION_QFI_MASK) >> 2) |
+	    ((qfi & SRV6_PDU_SESSION_R_BIT_MASK) << 5);
 
-	      hdr0->gtpu.teid = teid;
-	      hdr0->gtpu.length = clib_host_to_net_u16 (len0);
+	  sess =
+	    (gtpu_pdu_session_t *) (((char *) hdr0) +
+				    sizeof (ip6_gtpu_header_t) +
+				    sizeof (gtpu_exthdr_t));
+	  sess->exthdrlen = 1;
+	  sess->type = type;
+	  sess->spare = 0;
+	  sess->u.val = qfi;
+	  sess->nextexthdr = 0;
+	}
 
-	      hdr0->gtpu.type = gtpu_type;
+      if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	  || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  hdr0->gtpu.ver_flags |= GTPU_SEQ_FLAG;
+	  hdr0->gtpu.ext->seq = seq;
+	  hdr0->gtpu.ext->npdu_num = 0;
+	  hdr0->gtpu.ext->nextexthdr = 0;
 
-	      if (qfi)
+	  if (gtpu_type == GTPU_TYPE_ECHO_REPLY)
+	    {
+	      gtpu_recovery_ie *recovery;
+
+	      recovery =
+		(gtpu_recovery_ie *) ((u8 *) hdr0 +
+				      (hdrlen -
+				       sizeof (gtpu_recovery_ie)));
+	      recovery->type = GTPU_RECOVERY_IE_TYPE;
+	      recovery->restart_counter = 0;
+	    }
+	  else if (gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	    {
+	      if (ie_size)
 		{
-		  u8 type = 0;
-		  gtpu_pdu_session_t *sess;
-
-		  hdr0->gtpu.ver_flags |= GTPU_EXTHDR_FLAG;
-
-		  hdr0->gtpu.ext->seq = 0;
-		  hdr0->gtpu.ext->npdu_num = 0;
-		  hdr0->gtpu.ext->nextexthdr = GTPU_EXTHDR_PDU_SESSION;
-
-		  type = qfi & SRV6_PDU_SESSION_U_BIT_MASK;
-
-		  qfi =
-		    ((qfi & SRV6_PDU_SESSION_QFI_MASK) >> 2) |
-		    ((qfi & SRV6_PDU_SESSION_R_BIT_MASK) << 5);
-
-		  sess =
-		    (gtpu_pdu_session_t *) (((char *) hdr0) +
-					    sizeof (ip6_gtpu_header_t) +
-					    sizeof (gtpu_exthdr_t));
-		  sess->exthdrlen = 1;
-		  sess->type = type;
-		  sess->spare = 0;
-		  sess->u.val = qfi;
-		  sess->nextexthdr = 0;
-		}
+		  u8 *ie_ptr;
 
-	      if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		  || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		{
-		  hdr0->gtpu.ver_flags |= GTPU_SEQ_FLAG;
-		  hdr0->gtpu.ext->seq = seq;
-		  hdr0->gtpu.ext->npdu_num = 0;
-		  hdr0->gtpu.ext->nextexthdr = 0;
+		  ie_ptr = (u8 *) ((u8 *) hdr0 + (hdrlen - ie_size));
+		  clib_memcpy_fast (ie_ptr, ie_buf, ie_size);
+		}
+	    }
+	}
 
-		  if (gtpu_type == GTPU_TYPE_ECHO_REPLY)
-		    {
-		      gtpu_recovery_ie *recovery;
-
-		      recovery =
-			(gtpu_recovery_ie *) ((u8 *) hdr0 +
-					      (hdrlen -
-					       sizeof (gtpu_recovery_ie)));
-		      recovery->type = GTPU_RECOVERY_IE_TYPE;
-		      recovery->restart_counter = 0;
-		    }
-		  else if (gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      if (ie_size)
-			{
-			  u8 *ie_ptr;
+      hdr0->udp.length = clib_host_to_net_u16 (len0 +
+					       sizeof (udp_header_t) +
+					       sizeof
+					       (gtpu_header_t));
 
-			  ie_ptr = (u8 *) ((u8 *) hdr0 + (hdrlen - ie_size));
-			  clib_memcpy_fast (ie_ptr, ie_buf, ie_size);
-			}
-		    }
-		}
+      clib_memcpy_fast (hdr0->ip6.src_address.as_u8, src0.as_u8,
+			sizeof (ip6_address_t));
+      clib_memcpy_fast (hdr0->ip6.dst_address.as_u8, &seg0.as_u8,
+			sizeof (ip6_address_t));
 
-	      hdr0->udp.length = clib_host_to_net_u16 (len0 +
-						       sizeof (udp_header_t) +
+      hdr0->ip6.payload_length = clib_host_to_net_u16 (len0 +
+						       sizeof
+						       (udp_header_t)
+						       +
 						       sizeof
 						       (gtpu_header_t));
 
-	      clib_memcpy_fast (hdr0->ip6.src_address.as_u8, src0.as_u8,
-				sizeof (ip6_address_t));
-	      clib_memcpy_fast (hdr0->ip6.dst_address.as_u8, &seg0.as_u8,
-				sizeof (ip6_address_t));
-
-	      hdr0->ip6.payload_length = clib_host_to_net_u16 (len0 +
-							       sizeof
-							       (udp_header_t)
-							       +
-							       sizeof
-							       (gtpu_header_t));
+      // UDP source port.
+      hdr0->udp.src_port =
+	srv6_mobile_gtpu_src_port (ls_param->srcport_mode, ls_param->srcport,
+				   teid, p, plen);
 
-	      // UDP source port.
-	      key = hash_memory (p, plen < 40 ? plen : 40, 0);
-	      port = hash_uword_to_u16 (&key);
-	      hdr0->udp.src_port = port;
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
+	  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  srv6_end_rewrite_trace_t *tr =
+	    vlib_add_trace (vm, node, b0, sizeof (*tr));
+	  clib_memcpy (tr->src.as_u8, hdr0->ip6.src_address.as_u8,
+		       sizeof (ip6_address_t));
+	  clib_memcpy (tr->dst.as_u8, hdr0->ip6.dst_address.as_u8,
+		       sizeof (ip6_address_t));
+	  tr->teid = hdr0->gtpu.teid;
+	}
+    }
 
-	      good_n++;
+  vlib_increment_combined_counter
+    (((next0 ==
+       SRV6_END_M_GTP6_E_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters) :
+      &(sm2->sr_ls_valid_counters)), thread_index,
+     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
 
-	      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
-		  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
-		{
-		  srv6_end_rewrite_trace_t *tr =
-		    vlib_add_trace (vm, node, b0, sizeof (*tr));
-		  clib_memcpy (tr->src.as_u8, hdr0->ip6.src_address.as_u8,
-			       sizeof (ip6_address_t));
-		  clib_memcpy (tr->dst.as_u8, hdr0->ip6.dst_address.as_u8,
-			       sizeof (ip6_address_t));
-		  tr->teid = hdr0->gtpu.teid;
-		}
-	    }
+  if (PREDICT_TRUE (next0 != SRV6_END_M_GTP6_E_NEXT_DROP))
+    vlib_increment_combined_counter
+      (&srv6_mobile_localsid_counters[srv6_mobile_msg_type (gtpu_type)],
+       thread_index, ls0 - sm2->localsids, 1,
+       vlib_buffer_length_in_chain (vm, b0));
 
-	  vlib_increment_combined_counter
-	    (((next0 ==
-	       SRV6_END_M_GTP6_E_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters) :
-	      &(sm2->sr_ls_valid_counters)), thread_index,
-	     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
+  return next0;
+}
 
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
-	}
+// Function for SRv6 GTP6.E function
+VLIB_NODE_FN (srv6_end_m_gtp6_e) (vlib_main_t * vm,
+				  vlib_node_runtime_t * node,
+				  vlib_frame_t * frame)
+{
+  srv6_end_main_v6_t *sm = &srv6_end_main_v6;
+  u32 bad_n;
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
-    }
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_end_m_gtp6_e_process,
+			       SRV6_END_M_GTP6_E_NEXT_DROP, 0);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp6_e_node_index,
 			       SRV6_END_ERROR_M_GTP6_E_BAD_PACKETS, bad_n);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp6_e_node_index,
-			       SRV6_END_ERROR_M_GTP6_E_PACKETS, good_n);
+			       SRV6_END_ERROR_M_GTP6_E_PACKETS,
+			       frame->n_vectors - bad_n);
 
   return frame->n_vectors;
 }
 
-// Function for SRv6 GTP6.D function
-VLIB_NODE_FN (srv6_end_m_gtp6_d) (vlib_main_t * vm,
-				  vlib_node_runtime_t * node,
-				  vlib_frame_t * frame)
+static_always_inline u16
+srv6_end_m_gtp6_d_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			   vlib_buffer_t * b0)
 {
   srv6_end_main_v6_decap_t *sm = &srv6_end_main_v6_decap;
   ip6_sr_main_t *sm2 = &sr_main;
-  u32 n_left_from, next_index, *from, *to_next;
   u32 thread_index = vm->thread_index;
+  ip6_sr_localsid_t *ls0;
+  srv6_end_gtp6_param_t *ls_param;
 
-  u32 good_n = 0, bad_n = 0;
+  ip6_gtpu_header_t *hdr0 = NULL;
+  uword len0;
 
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
+  ip6_address_t seg0, src0;
+  u32 teid = 0;
+  u8 gtpu_type = 0;
+  u8 qfi;
+  u8 *qfip = NULL;
+  u16 seq = 0;
+  u32 pos;
+  u128 seg128;
+  u32 hdrlen;
+  ip6_header_t *encap = NULL;
+  gtpu_pdu_session_t *sess = NULL;
+  int ie_size = 0;
+  u16 tlv_siz = 0;
+  u8 ie_buf[GTPU_IE_MAX_SIZ];
 
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
-
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
-
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  ip6_sr_localsid_t *ls0;
-	  srv6_end_gtp6_param_t *ls_param;
-
-	  ip6_gtpu_header_t *hdr0 = NULL;
-	  uword len0;
-
-	  ip6_address_t seg0, src0;
-	  u32 teid = 0;
-	  u8 *teidp;
-	  u8 gtpu_type = 0;
-	  u8 qfi;
-	  u8 *qfip = NULL;
-	  u16 seq = 0;
-	  u8 *seqp;
-	  u32 offset, shift;
-	  u32 hdrlen;
-	  ip6_header_t *encap = NULL;
-	  gtpu_pdu_session_t *sess = NULL;
-	  int ie_size = 0;
-	  u16 tlv_siz = 0;
-	  u8 ie_buf[GTPU_IE_MAX_SIZ];
-
-	  u32 next0 = SRV6_END_M_GTP6_D_NEXT_LOOKUP;
-
-	  // defaults
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  ls0 =
-	    pool_elt_at_index (sm2->localsids,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
-
-	  ls_param = (srv6_end_gtp6_param_t *) ls0->plugin_mem;
-
-	  hdr0 = vlib_buffer_get_current (b0);
-
-	  hdrlen = sizeof (ip6_gtpu_header_t);
-
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
-
-	  if ((hdr0->ip6.protocol != IP_PROTOCOL_UDP)
-	      || (hdr0->udp.dst_port !=
-		  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
-	      || (len0 < sizeof (ip6_gtpu_header_t)))
-	    {
-	      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
+  u32 next0 = SRV6_END_M_GTP6_D_NEXT_LOOKUP;
 
-	      bad_n++;
-	    }
-	  else
-	    {
-	      seg0 = ls_param->sr_prefix;
-	      src0 = hdr0->ip6.src_address;
+  ls0 =
+    pool_elt_at_index (sm2->localsids,
+		       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
 
-	      gtpu_type = hdr0->gtpu.type;
+  ls_param = (srv6_end_gtp6_param_t *) ls0->plugin_mem;
 
-	      teid = hdr0->gtpu.teid;
-	      teidp = (u8 *) & teid;
+  hdr0 = vlib_buffer_get_current (b0);
 
-	      seqp = (u8 *) & seq;
+  hdrlen = sizeof (ip6_gtpu_header_t);
 
-	      if (hdr0->gtpu.ver_flags & (GTPU_EXTHDR_FLAG | GTPU_SEQ_FLAG))
-		{
-		  // Extention header.
-		  hdrlen += sizeof (gtpu_exthdr_t);
+  len0 = vlib_buffer_length_in_chain (vm, b0);
 
-		  seq = hdr0->gtpu.ext->seq;
+  if ((hdr0->ip6.protocol != IP_PROTOCOL_UDP)
+      || (hdr0->udp.dst_port !=
+	  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
+      || (len0 < sizeof (ip6_gtpu_header_t)))
+    {
+      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
+    }
+  else
+    {
+      seg0 = ls_param->sr_prefix;
+      src0 = hdr0->ip6.src_address;
 
-		  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
-		    {
-		      // PDU Session Container.
-		      sess =
-			(gtpu_pdu_session_t *) (((char *) hdr0) +
-						sizeof (ip6_gtpu_header_t) +
-						sizeof (gtpu_exthdr_t));
-		      qfi = sess->u.val & ~GTPU_PDU_SESSION_P_BIT_MASK;
-		      qfip = (u8 *) & qfi;
-
-		      hdrlen += sizeof (gtpu_pdu_session_t);
-
-		      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
-			{
-			  hdrlen += sizeof (gtpu_paging_policy_t);
-			}
-		    }
-		}
+      gtpu_type = hdr0->gtpu.type;
 
-	      offset = ls_param->sr_prefixlen / 8;
-	      shift = ls_param->sr_prefixlen % 8;
+      teid = hdr0->gtpu.teid;
 
-	      offset += 1;
-	      if (PREDICT_TRUE (shift == 0))
-		{
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      clib_memcpy_fast (&seg0.as_u8[offset], seqp, 2);
-		    }
-		  else
-		    {
-		      clib_memcpy_fast (&seg0.as_u8[offset], teidp, 4);
-		    }
+      if (hdr0->gtpu.ver_flags & (GTPU_EXTHDR_FLAG | GTPU_SEQ_FLAG))
+	{
+	  // Extention header.
+	  hdrlen += sizeof (gtpu_exthdr_t);
 
-		  if (qfip)
-		    {
-		      qfi =
-			((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
-			((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
+	  seq = hdr0->gtpu.ext->seq;
 
-		      if (sess->type)
-			{
-			  qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
-			}
+	  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
+	    {
+	      // PDU Session Container.
+	      sess =
+		(gtpu_pdu_session_t *) (((char *) hdr0) +
+					sizeof (ip6_gtpu_header_t) +
+					sizeof (gtpu_exthdr_t));
+	      qfi = sess->u.val & ~GTPU_PDU_SESSION_P_BIT_MASK;
+	      qfip = (u8 *) & qfi;
 
-		      seg0.as_u8[offset + 4] = qfi;
-		    }
-		}
-	      else
+	      hdrlen += sizeof (gtpu_pdu_session_t);
+
+	      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
 		{
-		  int idx;
+		  hdrlen += sizeof (gtpu_paging_policy_t);
+		}
+	    }
+	}
 
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      for (idx = 0; idx < 2; idx++)
-			{
-			  seg0.as_u8[offset + idx] |= seqp[idx] >> shift;
-			  seg0.as_u8[offset + idx + 1] |=
-			    seqp[idx] << (8 - shift);
-			}
-		    }
-		  else
-		    {
-		      for (idx = 0; idx < 4; idx++)
-			{
-			  seg0.as_u8[offset + idx] |= teidp[idx] >> shift;
-			  seg0.as_u8[offset + idx + 1] |=
-			    teidp[idx] << (8 - shift);
-			}
-		    }
+      pos = ls_param->sr_prefixlen + 8;
+      seg128 = srv6_mobile_addr_load (&seg0);
 
-		  if (qfip)
-		    {
-		      qfi =
-			((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
-			((qfi & ~GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
+      if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	  || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  seg128 = srv6_mobile_field_set (seg128, pos, 16,
+					  clib_net_to_host_u16 (seq));
+	}
+      else
+	{
+	  seg128 = srv6_mobile_field_set (seg128, pos, 32,
+					  clib_net_to_host_u32 (teid));
+	}
 
-		      if (sess->type)
-			{
-			  qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
-			}
+      if (qfip)
+	{
+	  qfi =
+	    ((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
+	    ((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
 
-		      seg0.as_u8[offset + 4] |= qfi >> shift;
-		      seg0.as_u8[offset + 5] |= qfi << (8 - shift);
-		    }
-		}
+	  if (sess->type)
+	    {
+	      qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
+	    }
+
+	  seg128 = srv6_mobile_field_set (seg128, pos + 32, 8, qfi);
+	}
+
+      srv6_mobile_addr_store (&seg0, seg128);
+
+      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
+	{
+	  u16 payload_len;
 
-	      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
+	  payload_len = clib_net_to_host_u16 (hdr0->gtpu.length);
+	  if (payload_len != 0)
+	    {
+	      ie_size =
+		payload_len - (hdrlen - sizeof (ip6_gtpu_header_t));
+	      if (ie_size > 0)
 		{
-		  u16 payload_len;
+		  u8 *ies;
 
-		  payload_len = clib_net_to_host_u16 (hdr0->gtpu.length);
-		  if (payload_len != 0)
-		    {
-		      ie_size =
-			payload_len - (hdrlen - sizeof (ip6_gtpu_header_t));
-		      if (ie_size > 0)
-			{
-			  u8 *ies;
-
-			  ies = (u8 *) ((u8 *) hdr0 + hdrlen);
-			  clib_memcpy_fast (ie_buf, ies, ie_size);
-			  hdrlen += ie_size;
-			}
-		    }
+		  ies = (u8 *) ((u8 *) hdr0 + hdrlen);
+		  clib_memcpy_fast (ie_buf, ies, ie_size);
+		  hdrlen += ie_size;
 		}
+	    }
+	}
 
-	      // jump over variable length data
-	      vlib_buffer_advance (b0, (word) hdrlen);
+      // jump over variable length data
+      vlib_buffer_advance (b0, (word) hdrlen);
 
-	      // get length of encapsulated IPv6 packet (the remaining part)
-	      len0 = vlib_buffer_length_in_chain (vm, b0);
+      // get length of encapsulated IPv6 packet (the remaining part)
+      len0 = vlib_buffer_length_in_chain (vm, b0);
 
-	      if (PREDICT_TRUE (gtpu_type == GTPU_TYPE_GTPU))
-		{
-		  encap = vlib_buffer_get_current (b0);
-		}
+      if (PREDICT_TRUE (gtpu_type == GTPU_TYPE_GTPU))
+	{
+	  encap = vlib_buffer_get_current (b0);
+	}
 
-	      uword *p;
-	      ip6srv_combo_header_t *ip6srv;
-	      ip6_sr_policy_t *sr_policy = NULL;
-	      ip6_sr_sl_t *sl = NULL;
-	      u32 *sl_index;
-	      u32 hdr_len;
-
-	      p =
-		mhash_get (&sm2->sr_policies_index_hash,
-			   &ls_param->sr_prefix);
-	      if (p)
-		{
-		  sr_policy = pool_elt_at_index (sm2->sr_policies, p[0]);
-		}
+      ip6srv_combo_header_t *ip6srv;
+      ip6_sr_sl_t *sl = NULL;
+      u32 sl_index;
+      u32 hdr_len;
 
-	      if (sr_policy)
-		{
-		  vec_foreach (sl_index, sr_policy->segments_lists)
-		  {
-		    sl = pool_elt_at_index (sm2->sid_lists, *sl_index);
-		    if (sl != NULL)
-		      break;
-		  }
-		}
+      sl_index = srv6_mobile_sl_select (ls_param->sl_buckets, teid, encap,
+					ls_param->nhtype);
+      if (PREDICT_TRUE (sl_index != ~0))
+	sl = pool_elt_at_index (sm2->sid_lists, sl_index);
 
-	      if (sl)
-		{
-		  hdr_len = sizeof (ip6srv_combo_header_t);
-		  hdr_len += vec_len (sl->segments) * sizeof (ip6_address_t);
-		  hdr_len += sizeof (ip6_address_t);
-		}
-	      else
-		{
-		  hdr_len = sizeof (ip6_header_t);
-		  if (PREDICT_FALSE (gtpu_type) != GTPU_TYPE_GTPU)
-		    {
-		      hdr_len += sizeof (ip6_sr_header_t);
-		      hdr_len += sizeof (ip6_address_t);
-		    }
-		}
+      if (sl)
+	{
+	  hdr_len = sizeof (ip6srv_combo_header_t);
+	  hdr_len +=
+	    (vec_len (sl->segments) - sl->is_reduced) * sizeof (ip6_address_t);
+	  hdr_len += sizeof (ip6_address_t);
+	}
+      else
+	{
+	  hdr_len = sizeof (ip6_header_t);
+	  if (PREDICT_FALSE (gtpu_type) != GTPU_TYPE_GTPU)
+	    {
+	      hdr_len += sizeof (ip6_sr_header_t);
+	      hdr_len += sizeof (ip6_address_t);
+	    }
+	}
 
-	      if (ie_size)
-		{
-		  tlv_siz =
-		    sizeof (ip6_sr_tlv_t) + sizeof (user_plane_sub_tlv_t) +
-		    ie_size;
+      if (ie_size)
+	{
+	  tlv_siz =
+	    sizeof (ip6_sr_tlv_t) + sizeof (user_plane_sub_tlv_t) +
+	    ie_size;
 
-		  tlv_siz = (tlv_siz & ~0x07) + (tlv_siz & 0x07 ? 0x08 : 0x0);
-		  hdr_len += tlv_siz;
-		}
+	  tlv_siz = (tlv_siz & ~0x07) + (tlv_siz & 0x07 ? 0x08 : 0x0);
+	  hdr_len += tlv_siz;
+	}
 
-	      // jump back to data[0] or pre_data if required
-	      vlib_buffer_advance (b0, -(word) hdr_len);
+      // jump back to data[0] or pre_data if required
+      vlib_buffer_advance (b0, -(word) hdr_len);
 
-	      ip6srv = vlib_buffer_get_current (b0);
+      ip6srv = vlib_buffer_get_current (b0);
 
-	      if (sl)
-		{
-		  clib_memcpy_fast (ip6srv, sl->rewrite,
-				    vec_len (sl->rewrite));
+      if (sl)
+	{
+	  clib_memcpy_fast (ip6srv, sl->rewrite,
+			    vec_len (sl->rewrite));
 
-		  if (vec_len (sl->segments) > 1)
-		    {
-		      ip6srv->ip.src_address = src0;
+	  if (vec_len (sl->segments) > 1)
+	    {
+	      ip6srv->ip.src_address = src0;
 
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-		      ip6srv->sr.segments_left += 1;
-		      ip6srv->sr.last_entry += 1;
+	      ip6srv->sr.segments_left += 1;
+	      ip6srv->sr.last_entry += 1;
 
-		      ip6srv->sr.length += sizeof (ip6_address_t) / 8;
-		      ip6srv->sr.segments[0] = seg0;
+	      ip6srv->sr.length += sizeof (ip6_address_t) / 8;
+	      ip6srv->sr.segments[0] = seg0;
 
-		      clib_memcpy_fast (&ip6srv->sr.segments[1],
-					(u8 *) (sl->rewrite +
-						sizeof (ip6_header_t) +
-						sizeof (ip6_sr_header_t)),
-					vec_len (sl->segments) *
-					sizeof (ip6_address_t));
-		    }
-		  else
-		    {
-		      ip6srv->ip.src_address = src0;
-		      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
-
-		      ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
-		      ip6srv->sr.segments_left = 1;
-		      ip6srv->sr.last_entry = 0;
-		      ip6srv->sr.length =
-			((sizeof (ip6_sr_header_t) +
-			  sizeof (ip6_address_t)) / 8) - 1;
-		      ip6srv->sr.flags = 0;
-
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
-
-		      ip6srv->sr.segments[0] = seg0;
-
-		      if (vec_len (sl->segments))
-			{
-			  ip6srv->sr.segments[1] = sl->segments[0];
-			  ip6srv->sr.last_entry++;
-			  ip6srv->sr.length += sizeof (ip6_address_t) / 8;
-			}
-		    }
+	      clib_memcpy_fast (&ip6srv->sr.segments[1],
+				(u8 *) (sl->rewrite +
+					sizeof (ip6_header_t) +
+					sizeof (ip6_sr_header_t)),
+				(vec_len (sl->segments) - sl->is_reduced) *
+				sizeof (ip6_address_t));
+	    }
+	  else
+	    {
+	      ip6srv->ip.src_address = src0;
+	      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
+
+	      ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
+	      ip6srv->sr.segments_left = 1;
+	      ip6srv->sr.last_entry = 0;
+	      ip6srv->sr.length =
+		((sizeof (ip6_sr_header_t) +
+		  sizeof (ip6_address_t)) / 8) - 1;
+	      ip6srv->sr.flags = 0;
+
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
+
+	      ip6srv->sr.segments[0] = seg0;
+
+	      if (vec_len (sl->segments))
+		{
+		  ip6srv->sr.segments[1] = sl->segments[0];
+		  ip6srv->sr.last_entry++;
+		  ip6srv->sr.length += sizeof (ip6_address_t) / 8;
+		}
+	    }
 
-		  if (PREDICT_TRUE (encap != NULL))
+	  if (PREDICT_TRUE (encap != NULL))
+	    {
+	      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
+		{
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) == 6)
+		    ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
+		  else
+		    ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
+		}
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
+		{
+		  ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 4)
 		    {
-		      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
-			{
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) == 6)
-			    ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
-			  else
-			    ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
-			{
-			  ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 4)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
-			{
-			  ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 6)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
-			{
-			  ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
-			}
+		      // Bad encap packet.
+		      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
+		      goto DONE;
 		    }
-		  else
+		}
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
+		{
+		  ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 6)
 		    {
-		      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
+		      // Bad encap packet.
+		      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
+		      goto DONE;
 		    }
 		}
-	      else
+	      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
 		{
-		  clib_memcpy_fast (ip6srv, &sm->cache_hdr,
-				    sizeof (ip6_header_t));
+		  ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
+		}
+	    }
+	  else
+	    {
+	      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
+	    }
+	}
+      else
+	{
+	  srv6_mobile_copy_ip6_hdr (&ip6srv->ip, &sm->cache_hdr);
 
-		  ip6srv->ip.src_address = src0;
-		  ip6srv->ip.dst_address = seg0;
+	  ip6srv->ip.src_address = src0;
+	  ip6srv->ip.dst_address = seg0;
 
-		  if (PREDICT_FALSE (gtpu_type) != GTPU_TYPE_GTPU)
-		    {
-		      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
+	  if (PREDICT_FALSE (gtpu_type) != GTPU_TYPE_GTPU)
+	    {
+	      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
 
-		      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
+	      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
 
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-		      ip6srv->sr.segments_left = 0;
-		      ip6srv->sr.last_entry = 0;
+	      ip6srv->sr.segments_left = 0;
+	      ip6srv->sr.last_entry = 0;
 
-		      ip6srv->sr.length = sizeof (ip6_address_t) / 8;
-		      ip6srv->sr.segments[0] = seg0;
+	      ip6srv->sr.length = sizeof (ip6_address_t) / 8;
+	      ip6srv->sr.segments[0] = seg0;
+	    }
+	  else
+	    {
+	      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
+		{
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 6)
+		    ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
+		}
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
+		{
+		  ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 4)
+		    {
+		      // Bad encap packet.
+		      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
+		      goto DONE;
 		    }
-		  else
+		}
+	      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
+		{
+		  ip6srv->ip.protocol = IP_PROTOCOL_IPV6;
+		  if ((clib_net_to_host_u32
+		       (encap->ip_version_traffic_class_and_flow_label)
+		       >> 28) != 6)
 		    {
-		      if (ls_param->nhtype == SRV6_NHTYPE_NONE)
-			{
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 6)
-			    ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
-			{
-			  ip6srv->ip.protocol = IP_PROTOCOL_IP_IN_IP;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 4)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
-			{
-			  ip6srv->ip.protocol = IP_PROTOCOL_IPV6;
-			  if ((clib_net_to_host_u32
-			       (encap->ip_version_traffic_class_and_flow_label)
-			       >> 28) != 6)
-			    {
-			      // Bad encap packet.
-			      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
-			      bad_n++;
-			      goto DONE;
-			    }
-			}
-		      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
-			{
-			  ip6srv->ip.protocol = IP_PROTOCOL_IP6_ETHERNET;
-			}
+		      // Bad encap packet.
+		      next0 = SRV6_END_M_GTP6_D_NEXT_DROP;
+		      goto DONE;
 		    }
 		}
-
-	      if (PREDICT_FALSE (ie_size))
+	      else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
 		{
-		  ip6_sr_tlv_t *tlv;
-		  user_plane_sub_tlv_t *sub_tlv;
+		  ip6srv->ip.protocol = IP_PROTOCOL_IP6_ETHERNET;
+		}
+	    }
+	}
 
-		  tlv =
-		    (ip6_sr_tlv_t *) ((u8 *) ip6srv + (hdr_len - tlv_siz));
-		  tlv->type = SRH_TLV_USER_PLANE_CONTAINER;
-		  tlv->length = (u8) (tlv_siz - sizeof (ip6_sr_tlv_t));
-		  clib_memset (tlv->value, 0, tlv->length);
+      if (PREDICT_FALSE (ie_size))
+	{
+	  ip6_sr_tlv_t *tlv;
+	  user_plane_sub_tlv_t *sub_tlv;
 
-		  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
-		  sub_tlv->type = USER_PLANE_SUB_TLV_IE;
-		  sub_tlv->length = (u8) ie_size;
-		  clib_memcpy_fast (sub_tlv->value, ie_buf, ie_size);
+	  tlv =
+	    (ip6_sr_tlv_t *) ((u8 *) ip6srv + (hdr_len - tlv_siz));
+	  tlv->type = SRH_TLV_USER_PLANE_CONTAINER;
+	  tlv->length = (u8) (tlv_siz - sizeof (ip6_sr_tlv_t));
+	  clib_memset (tlv->value, 0, tlv->length);
 
-		  ip6srv->sr.length += (u8) (tlv_siz / 8);
-		}
+	  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
+	  sub_tlv->type = USER_PLANE_SUB_TLV_IE;
+	  sub_tlv->length = (u8) ie_size;
+	  clib_memcpy_fast (sub_tlv->value, ie_buf, ie_size);
 
-	      ip6srv->ip.payload_length =
-		clib_host_to_net_u16 (len0 + hdr_len - sizeof (ip6_header_t));
+	  ip6srv->sr.length += (u8) (tlv_siz / 8);
+	}
 
-	      good_n++;
+      ip6srv->ip.payload_length =
+	clib_host_to_net_u16 (len0 + hdr_len - sizeof (ip6_header_t));
 
-	      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
-		  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
-		{
-		  srv6_end_rewrite_trace_t *tr =
-		    vlib_add_trace (vm, node, b0, sizeof (*tr));
-		  clib_memcpy (tr->src.as_u8, ip6srv->ip.src_address.as_u8,
-			       sizeof (ip6_address_t));
-		  clib_memcpy (tr->dst.as_u8, ip6srv->ip.dst_address.as_u8,
-			       sizeof (ip6_address_t));
-		  tr->teid = teid;
-		  clib_memcpy (tr->sr_prefix.as_u8, ls_param->sr_prefix.as_u8,
-			       sizeof (ip6_address_t));
-		  tr->sr_prefixlen = ls_param->sr_prefixlen;
-		}
-	    }
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
+	  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  srv6_end_rewrite_trace_t *tr =
+	    vlib_add_trace (vm, node, b0, sizeof (*tr));
+	  clib_memcpy (tr->src.as_u8, ip6srv->ip.src_address.as_u8,
+		       sizeof (ip6_address_t));
+	  clib_memcpy (tr->dst.as_u8, ip6srv->ip.dst_address.as_u8,
+		       sizeof (ip6_address_t));
+	  tr->teid = teid;
+	  clib_memcpy (tr->sr_prefix.as_u8, ls_param->sr_prefix.as_u8,
+		       sizeof (ip6_address_t));
+	  tr->sr_prefixlen = ls_param->sr_prefixlen;
+	}
+    }
 
-	DONE:
-	  vlib_increment_combined_counter
-	    (((next0 ==
-	       SRV6_END_M_GTP6_D_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters) :
-	      &(sm2->sr_ls_valid_counters)), thread_index,
-	     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
+DONE:
+  vlib_increment_combined_counter
+    (((next0 ==
+       SRV6_END_M_GTP6_D_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters) :
+      &(sm2->sr_ls_valid_counters)), thread_index,
+     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
 
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
-	}
+  if (PREDICT_TRUE (next0 != SRV6_END_M_GTP6_D_NEXT_DROP))
+    vlib_increment_combined_counter
+      (&srv6_mobile_localsid_counters[srv6_mobile_msg_type (gtpu_type)],
+       thread_index, ls0 - sm2->localsids, 1,
+       vlib_buffer_length_in_chain (vm, b0));
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
-    }
+  return next0;
+}
+
+// Function for SRv6 GTP6.D function
+VLIB_NODE_FN (srv6_end_m_gtp6_d) (vlib_main_t * vm,
+				  vlib_node_runtime_t * node,
+				  vlib_frame_t * frame)
+{
+  srv6_end_main_v6_decap_t *sm = &srv6_end_main_v6_decap;
+  u32 bad_n;
+
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_end_m_gtp6_d_process,
+			       SRV6_END_M_GTP6_D_NEXT_DROP, 0);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp6_d_node_index,
 			       SRV6_END_ERROR_M_GTP6_D_BAD_PACKETS, bad_n);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp6_d_node_index,
-			       SRV6_END_ERROR_M_GTP6_D_PACKETS, good_n);
+			       SRV6_END_ERROR_M_GTP6_D_PACKETS,
+			       frame->n_vectors - bad_n);
 
   return frame->n_vectors;
 }
 
-// Function for SRv6 GTP6.D.DI function
-VLIB_NODE_FN (srv6_end_m_gtp6_d_di) (vlib_main_t * vm,
-				     vlib_node_runtime_t * node,
-				     vlib_frame_t * frame)
+static_always_inline u16
+srv6_end_m_gtp6_d_di_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			      vlib_buffer_t * b0)
 {
   srv6_end_main_v6_decap_di_t *sm = &srv6_end_main_v6_decap_di;
   ip6_sr_main_t *sm2 = &sr_main;
-  u32 n_left_from, next_index, *from, *to_next;
   u32 thread_index = vm->thread_index;
   srv6_end_gtp6_param_t *ls_param;
-
-  u32 good_n = 0, bad_n = 0;
-
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
-
-  while (n_left_from > 0)
+  ip6_sr_localsid_t *ls0;
+
+  ip6_gtpu_header_t *hdr0 = NULL;
+  uword len0;
+
+  ip6_address_t dst0;
+  ip6_address_t src0;
+  ip6_address_t seg0;
+  u32 teid = 0;
+  u8 gtpu_type = 0;
+  u8 qfi = 0;
+  u8 *qfip = NULL;
+  u16 seq = 0;
+  u32 pos;
+  u128 seg128;
+  u32 hdrlen;
+  ip6_header_t *encap = NULL;
+  gtpu_pdu_session_t *sess;
+  srv6_mobile_session_t *session0 = NULL;
+  int ie_size = 0;
+  u16 tlv_siz = 0;
+  u8 ie_buf[GTPU_IE_MAX_SIZ];
+
+  u32 next0 = SRV6_END_M_GTP6_D_DI_NEXT_LOOKUP;
+
+  ls0 =
+    pool_elt_at_index (sm2->localsids,
+		       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+
+  ls_param = (srv6_end_gtp6_param_t *) ls0->plugin_mem;
+
+  hdr0 = vlib_buffer_get_current (b0);
+
+  hdrlen = sizeof (ip6_gtpu_header_t);
+
+  len0 = vlib_buffer_length_in_chain (vm, b0);
+
+  if ((hdr0->ip6.protocol != IP_PROTOCOL_UDP)
+      || (hdr0->udp.dst_port !=
+	  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
+      || (len0 < sizeof (ip6_gtpu_header_t)))
     {
-      u32 n_left_to_next;
-
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
-
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  ip6_sr_localsid_t *ls0;
-
-	  ip6_gtpu_header_t *hdr0 = NULL;
-	  uword len0;
-
-	  ip6_address_t dst0;
-	  ip6_address_t src0;
-	  ip6_address_t seg0;
-	  u32 teid = 0;
-	  u8 *teidp;
-	  u8 gtpu_type = 0;
-	  u8 qfi = 0;
-	  u8 *qfip = NULL;
-	  u16 seq = 0;
-	  u8 *seqp;
-	  u32 offset, shift;
-	  u32 hdrlen;
-	  ip6_header_t *encap = NULL;
-	  gtpu_pdu_session_t *sess;
-	  int ie_size = 0;
-	  u16 tlv_siz = 0;
-	  u8 ie_buf[GTPU_IE_MAX_SIZ];
-
-	  u32 next0 = SRV6_END_M_GTP6_D_DI_NEXT_LOOKUP;
-
-	  // defaults
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  ls0 =
-	    pool_elt_at_index (sm2->localsids,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
-
-	  ls_param = (srv6_end_gtp6_param_t *) ls0->plugin_mem;
-
-	  hdr0 = vlib_buffer_get_current (b0);
+      next0 = SRV6_END_M_GTP6_D_DI_NEXT_DROP;
+    }
+  else
+    {
+      dst0 = hdr0->ip6.dst_address;
+      src0 = hdr0->ip6.src_address;
 
-	  hdrlen = sizeof (ip6_gtpu_header_t);
+      gtpu_type = hdr0->gtpu.type;
 
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
+      seg0 = ls_param->sr_prefix;
+      teid = hdr0->gtpu.teid;
 
-	  if ((hdr0->ip6.protocol != IP_PROTOCOL_UDP)
-	      || (hdr0->udp.dst_port !=
-		  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
-	      || (len0 < sizeof (ip6_gtpu_header_t)))
+      if (ls_param->session_table != ~0 && gtpu_type == GTPU_TYPE_GTPU)
+	{
+	  session0 =
+	    srv6_mobile_session_lookup (ls_param->session_table, teid);
+	  if (PREDICT_FALSE (session0 == NULL))
 	    {
+	      b0->error =
+		node->errors[SRV6_END_ERROR_M_GTP6_D_DI_NO_SESSION];
 	      next0 = SRV6_END_M_GTP6_D_DI_NEXT_DROP;
-
-	      bad_n++;
+	      goto DONE;
 	    }
-	  else
-	    {
-	      dst0 = hdr0->ip6.dst_address;
-	      src0 = hdr0->ip6.src_address;
 
-	      gtpu_type = hdr0->gtpu.type;
-
-	      seg0 = ls_param->sr_prefix;
-	      teid = hdr0->gtpu.teid;
-	      teidp = (u8 *) & teid;
+	  if (!ip6_address_is_zero (&session0->far_end))
+	    seg0 = session0->far_end;
+	}
 
-	      seqp = (u8 *) & seq;
+      if (hdr0->gtpu.ver_flags & (GTPU_EXTHDR_FLAG | GTPU_SEQ_FLAG))
+	{
+	  // Extention header.
+	  hdrlen += sizeof (gtpu_exthdr_t);
 
-	      if (hdr0->gtpu.ver_flags & (GTPU_EXTHDR_FLAG | GTPU_SEQ_FLAG))
-		{
-		  // Extention header.
-		  hdrlen += sizeof (gtpu_exthdr_t);
+	  seq = hdr0->gtpu.ext->seq;
 
-		  seq = hdr0->gtpu.ext->seq;
+	  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
+	    {
+	      // PDU Session Container.
+	      sess =
+		(gtpu_pdu_session_t *) (((char *) hdr0) + hdrlen);
+	      qfi = sess->u.val & ~GTPU_PDU_SESSION_P_BIT_MASK;
+	      qfip = &qfi;
 
-		  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
-		    {
-		      // PDU Session Container.
-		      sess =
-			(gtpu_pdu_session_t *) (((char *) hdr0) + hdrlen);
-		      qfi = sess->u.val & ~GTPU_PDU_SESSION_P_BIT_MASK;
-		      qfip = &qfi;
-
-		      hdrlen += sizeof (gtpu_pdu_session_t);
-
-		      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
-			{
-			  hdrlen += sizeof (gtpu_paging_policy_t);
-			}
-		    }
-		}
+	      if (session0
+		  && session0->qfi != SRV6_MOBILE_SESSION_QFI_KEEP)
+		qfi = (qfi & ~GTPU_PDU_SESSION_QFI_MASK) | session0->qfi;
 
-	      offset = ls_param->sr_prefixlen / 8;
-	      shift = ls_param->sr_prefixlen % 8;
+	      hdrlen += sizeof (gtpu_pdu_session_t);
 
-	      offset += 1;
-	      if (PREDICT_TRUE (shift == 0))
+	      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
 		{
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      clib_memcpy_fast (&seg0.as_u8[offset], seqp, 2);
-		    }
-		  else
-		    {
-		      clib_memcpy_fast (&seg0.as_u8[offset], teidp, 4);
-		    }
+		  hdrlen += sizeof (gtpu_paging_policy_t);
+		}
+	    }
+	}
 
-		  if (qfip)
-		    {
-		      qfi =
-			((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
-			((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
+      pos = ls_param->sr_prefixlen + 8;
+      seg128 = srv6_mobile_addr_load (&seg0);
 
-		      if (sess->type)
-			{
-			  qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
-			}
+      if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
+	  || gtpu_type == GTPU_TYPE_ECHO_REPLY
+	  || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
+	{
+	  seg128 = srv6_mobile_field_set (seg128, pos, 16,
+					  clib_net_to_host_u16 (seq));
+	}
+      else
+	{
+	  seg128 = srv6_mobile_field_set (seg128, pos, 32,
+					  clib_net_to_host_u32 (teid));
+	}
 
-		      seg0.as_u8[offset + 4] = qfi;
-		    }
-		}
-	      else
-		{
-		  int idx;
+      if (qfip)
+	{
+	  qfi =
+	    ((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
+	    ((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
 
-		  if (gtpu_type == GTPU_TYPE_ECHO_REQUEST
-		      || gtpu_type == GTPU_TYPE_ECHO_REPLY
-		      || gtpu_type == GTPU_TYPE_ERROR_INDICATION)
-		    {
-		      for (idx = 0; idx < 2; idx++)
-			{
-			  seg0.as_u8[offset + idx] |= seqp[idx] >> shift;
-			  seg0.as_u8[offset + idx + 1] |=
-			    seqp[idx] << (8 - shift);
-			}
-		    }
-		  else
-		    {
-		      for (idx = 0; idx < 4; idx++)
-			{
-			  seg0.as_u8[offset + idx] |= teidp[idx] >> shift;
-			  seg0.as_u8[offset + idx + 1] |=
-			    teidp[idx] << (8 - shift);
-			}
-		    }
+	  if (sess->type)
+	    {
+	      qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
+	    }
 
-		  if (qfip)
-		    {
-		      qfi =
-			((qfi & GTPU_PDU_SESSION_QFI_MASK) << 2) |
-			((qfi & GTPU_PDU_SESSION_R_BIT_MASK) >> 5);
+	  seg128 = srv6_mobile_field_set (seg128, pos + 32, 8, qfi);
+	}
 
-		      if (sess->type)
-			{
-			  qfi |= SRV6_PDU_SESSION_U_BIT_MASK;
-			}
+      srv6_mobile_addr_store (&seg0, seg128);
 
-		      seg0.as_u8[offset + 4] |= qfi >> shift;
-		      seg0.as_u8[offset + 5] |= qfi << (8 - shift);
-		    }
-		}
+      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
+	{
+	  u16 payload_len;
 
-	      if (PREDICT_FALSE (gtpu_type == GTPU_TYPE_ERROR_INDICATION))
+	  payload_len = clib_net_to_host_u16 (hdr0->gtpu.length);
+	  if (payload_len != 0)
+	    {
+	      ie_size =
+		payload_len - (hdrlen - sizeof (ip6_gtpu_header_t));
+	      if (ie_size > 0)
 		{
-		  u16 payload_len;
+		  u8 *ies;
 
-		  payload_len = clib_net_to_host_u16 (hdr0->gtpu.length);
-		  if (payload_len != 0)
-		    {
-		      ie_size =
-			payload_len - (hdrlen - sizeof (ip6_gtpu_header_t));
-		      if (ie_size > 0)
-			{
-			  u8 *ies;
-
-			  ies = (u8 *) ((u8 *) hdr0 + hdrlen);
-			  clib_memcpy_fast (ie_buf, ies, ie_size);
-			  hdrlen += ie_size;
-			}
-		    }
+		  ies = (u8 *) ((u8 *) hdr0 + hdrlen);
+		  clib_memcpy_fast (ie_buf, ies, ie_size);
+		  hdrlen += ie_size;
 		}
+	    }
+	}
 
-	      // jump over variable length data
-	      vlib_buffer_advance (b0, (word) hdrlen);
+      // jump over variable length data
+      vlib_buffer_advance (b0, (word) hdrlen);
 
-	      // get length of encapsulated IPv6 packet (the remaining part)
-	      len0 = vlib_buffer_length_in_chain (vm, b0);
+      // get length of encapsulated IPv6 packet (the remaining part)
+      len0 = vlib_buffer_length_in_chain (vm, b0);
 
-	      if (PREDICT_TRUE (gtpu_type == GTPU_TYPE_GTPU))
-		{
-		  encap = vlib_buffer_get_current (b0);
-		}
+      if (PREDICT_TRUE (gtpu_type == GTPU_TYPE_GTPU))
+	{
+	  encap = vlib_buffer_get_current (b0);
+	}
 
-	      uword *p;
-	      ip6srv_combo_header_t *ip6srv;
-	      ip6_sr_policy_t *sr_policy = NULL;
-	      ip6_sr_sl_t *sl = NULL;
-	      u32 *sl_index;
-	      u32 hdr_len;
-
-	      p =
-		mhash_get (&sm2->sr_policies_index_hash,
-			   &ls_param->sr_prefix);
-	      if (p)
-		{
-		  sr_policy = pool_elt_at_index (sm2->sr_policies, p[0]);
-		}
+      ip6srv_combo_header_t *ip6srv;
+      ip6_sr_sl_t *sl = NULL;
+      u32 sl_index;
+      u32 hdr_len;
 
-	      if (sr_policy)
-		{
-		  vec_foreach (sl_index, sr_policy->segments_lists)
-		  {
-		    sl = pool_elt_at_index (sm2->sid_lists, *sl_index);
-		    if (sl != NULL)
-		      break;
-		  }
-		}
+      sl_index = srv6_mobile_sl_select (ls_param->sl_buckets, teid, encap,
+					ls_param->nhtype);
+      if (PREDICT_TRUE (sl_index != ~0))
+	sl = pool_elt_at_index (sm2->sid_lists, sl_index);
 
-	      hdr_len = sizeof (ip6srv_combo_header_t);
+      hdr_len = sizeof (ip6srv_combo_header_t);
 
-	      if (sl)
-		hdr_len += vec_len (sl->segments) * sizeof (ip6_address_t);
+      if (sl)
+	hdr_len +=
+	  (vec_len (sl->segments) - sl->is_reduced) * sizeof (ip6_address_t);
 
-	      hdr_len += sizeof (ip6_address_t) * 2;
+      hdr_len += sizeof (ip6_address_t) * 2;
 
-	      if (ie_size)
-		{
-		  tlv_siz =
-		    sizeof (ip6_sr_tlv_t) + sizeof (user_plane_sub_tlv_t) +
-		    ie_size;
+      if (ie_size)
+	{
+	  tlv_siz =
+	    sizeof (ip6_sr_tlv_t) + sizeof (user_plane_sub_tlv_t) +
+	    ie_size;
 
-		  tlv_siz = (tlv_siz & ~0x07) + (tlv_siz & 0x07 ? 0x08 : 0x0);
-		  hdr_len += tlv_siz;
-		}
+	  tlv_siz = (tlv_siz & ~0x07) + (tlv_siz & 0x07 ? 0x08 : 0x0);
+	  hdr_len += tlv_siz;
+	}
 
-	      // jump back to data[0] or pre_data if required
-	      vlib_buffer_advance (b0, -(word) hdr_len);
+      // jump back to data[0] or pre_data if required
+      vlib_buffer_advance (b0, -(word) hdr_len);
 
-	      ip6srv = vlib_buffer_get_current (b0);
+      ip6srv = vlib_buffer_get_current (b0);
 
-	      if (sl)
-		{
-		  clib_memcpy_fast (ip6srv, sl->rewrite,
-				    vec_len (sl->rewrite));
+      if (sl)
+	{
+	  clib_memcpy_fast (ip6srv, sl->rewrite,
+			    vec_len (sl->rewrite));
 
-		  if (vec_len (sl->segments) > 1)
-		    {
-		      ip6srv->ip.src_address = src0;
+	  if (vec_len (sl->segments) > 1)
+	    {
+	      ip6srv->ip.src_address = src0;
 
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-		      ip6srv->sr.segments_left += 2;
-		      ip6srv->sr.last_entry += 2;
+	      ip6srv->sr.segments_left += 2;
+	      ip6srv->sr.last_entry += 2;
 
-		      ip6srv->sr.length += ((sizeof (ip6_address_t) * 2) / 8);
+	      ip6srv->sr.length += ((sizeof (ip6_address_t) * 2) / 8);
 
-		      ip6srv->sr.segments[0] = dst0;
-		      ip6srv->sr.segments[1] = seg0;
+	      ip6srv->sr.segments[0] = dst0;
+	      ip6srv->sr.segments[1] = seg0;
 
-		      clib_memcpy_fast (&ip6srv->sr.segments[2],
-					(u8 *) (sl->rewrite +
-						sizeof (ip6_header_t) +
-						sizeof (ip6_sr_header_t)),
-					vec_len (sl->segments) *
-					sizeof (ip6_address_t));
-		    }
-		  else
-		    {
-		      ip6srv->ip.src_address = src0;
-		      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
-
-		      ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
-		      ip6srv->sr.segments_left = 2;
-		      ip6srv->sr.last_entry = 1;
-		      ip6srv->sr.length =
-			((sizeof (ip6_sr_header_t) +
-			  2 * sizeof (ip6_address_t)) / 8) - 1;
-		      ip6srv->sr.flags = 0;
-
-		      ip6srv->sr.tag =
-			clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
-
-		      ip6srv->sr.segments[0] = dst0;
-		      ip6srv->sr.segments[1] = seg0;
-
-		      if (vec_len (sl->segments))
-			{
-			  ip6srv->sr.segments[2] = sl->segments[0];
-			  ip6srv->sr.last_entry++;
-			  ip6srv->sr.length += sizeof (ip6_address_t) / 8;
-			}
-		    }
-		}
-	      else
-		{
-		  clib_memcpy_fast (ip6srv, &sm->cache_hdr,
-				    sizeof (ip6_header_t));
+	      clib_memcpy_fast (&ip6srv->sr.segments[2],
+				(u8 *) (sl->rewrite +
+					sizeof (ip6_header_t) +
+					sizeof (ip6_sr_header_t)),
+				(vec_len (sl->segments) - sl->is_reduced) *
+				sizeof (ip6_address_t));
+	    }
+	  else
+	    {
+	      ip6srv->ip.src_address = src0;
+	      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
 
-		  ip6srv->ip.src_address = src0;
-		  ip6srv->ip.dst_address = seg0;
+	      ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
+	      ip6srv->sr.segments_left = 2;
+	      ip6srv->sr.last_entry = 1;
+	      ip6srv->sr.length =
+		((sizeof (ip6_sr_header_t) +
+		  2 * sizeof (ip6_address_t)) / 8) - 1;
+	      ip6srv->sr.flags = 0;
 
-		  ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
-		  ip6srv->sr.segments_left = 1;
-		  ip6srv->sr.last_entry = 0;
-		  ip6srv->sr.length =
-		    ((sizeof (ip6_sr_header_t) +
-		      sizeof (ip6_address_t)) / 8) - 1;
-		  ip6srv->sr.flags = 0;
+	      ip6srv->sr.tag =
+		clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-		  ip6srv->sr.tag =
-		    clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
+	      ip6srv->sr.segments[0] = dst0;
+	      ip6srv->sr.segments[1] = seg0;
 
-		  ip6srv->sr.segments[0] = dst0;
+	      if (vec_len (sl->segments))
+		{
+		  ip6srv->sr.segments[2] = sl->segments[0];
+		  ip6srv->sr.last_entry++;
+		  ip6srv->sr.length += sizeof (ip6_address_t) / 8;
 		}
+	    }
+	}
+      else
+	{
+	  srv6_mobile_copy_ip6_hdr (&ip6srv->ip, &sm->cache_hdr.ip);
 
-	      if (PREDICT_FALSE (ie_size))
-		{
-		  ip6_sr_tlv_t *tlv;
-		  user_plane_sub_tlv_t *sub_tlv;
+	  ip6srv->ip.src_address = src0;
+	  ip6srv->ip.dst_address = seg0;
 
-		  tlv =
-		    (ip6_sr_tlv_t *) ((u8 *) ip6srv + (hdr_len - tlv_siz));
-		  tlv->type = SRH_TLV_USER_PLANE_CONTAINER;
-		  tlv->length = (u8) (tlv_siz - sizeof (ip6_sr_tlv_t));
-		  clib_memset (tlv->value, 0, tlv->length);
+	  ip6srv->sr.type = ROUTING_HEADER_TYPE_SR;
+	  ip6srv->sr.segments_left = 1;
+	  ip6srv->sr.last_entry = 0;
+	  ip6srv->sr.length =
+	    ((sizeof (ip6_sr_header_t) +
+	      sizeof (ip6_address_t)) / 8) - 1;
+	  ip6srv->sr.flags = 0;
 
-		  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
-		  sub_tlv->length = (u8) (ie_size);
-		  clib_memcpy_fast (sub_tlv->value, ie_buf, ie_size);
+	  ip6srv->sr.tag =
+	    clib_host_to_net_u16 (srh_tagfield[gtpu_type]);
 
-		  ip6srv->sr.length += (u8) (tlv_siz / 8);
-		}
+	  ip6srv->sr.segments[0] = dst0;
+	}
 
-	      ip6srv->ip.payload_length =
-		clib_host_to_net_u16 (len0 + hdr_len - sizeof (ip6_header_t));
-	      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
+      if (PREDICT_FALSE (ie_size))
+	{
+	  ip6_sr_tlv_t *tlv;
+	  user_plane_sub_tlv_t *sub_tlv;
 
-	      if (PREDICT_TRUE (encap != NULL))
-		{
-		  if (ls_param->nhtype == SRV6_NHTYPE_NONE)
-		    {
-		      if ((clib_net_to_host_u32
-			   (encap->ip_version_traffic_class_and_flow_label) >>
-			   28) == 6)
-			ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
-		      else
-			ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
-		    }
-		  else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
-		    {
-		      ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
-		      if ((clib_net_to_host_u32
-			   (encap->ip_version_traffic_class_and_flow_label) >>
-			   28) != 4)
-			{
-			  // Bad encap packet.
-			  next0 = SRV6_END_M_GTP6_D_DI_NEXT_DROP;
-			  bad_n++;
-			  goto DONE;
-			}
-		    }
-		  else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
-		    {
-		      ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
-		      if ((clib_net_to_host_u32
-			   (encap->ip_version_traffic_class_and_flow_label) >>
-			   28) != 6)
-			{
-			  // Bad encap packet.
-			  next0 = SRV6_END_M_GTP6_D_DI_NEXT_DROP;
-			  bad_n++;
-			  goto DONE;
-			}
-		    }
-		  else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
-		    {
-		      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
-		    }
-		}
+	  tlv =
+	    (ip6_sr_tlv_t *) ((u8 *) ip6srv + (hdr_len - tlv_siz));
+	  tlv->type = SRH_TLV_USER_PLANE_CONTAINER;
+	  tlv->length = (u8) (tlv_siz - sizeof (ip6_sr_tlv_t));
+	  clib_memset (tlv->value, 0, tlv->length);
+
+	  sub_tlv = (user_plane_sub_tlv_t *) tlv->value;
+	  sub_tlv->length = (u8) (ie_size);
+	  clib_memcpy_fast (sub_tlv->value, ie_buf, ie_size);
+
+	  ip6srv->sr.length += (u8) (tlv_siz / 8);
+	}
+
+      ip6srv->ip.payload_length =
+	clib_host_to_net_u16 (len0 + hdr_len - sizeof (ip6_header_t));
+      ip6srv->ip.protocol = IP_PROTOCOL_IPV6_ROUTE;
+
+      if (PREDICT_TRUE (encap != NULL))
+	{
+	  if (ls_param->nhtype == SRV6_NHTYPE_NONE)
+	    {
+	      if ((clib_net_to_host_u32
+		   (encap->ip_version_traffic_class_and_flow_label) >>
+		   28) == 6)
+		ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
 	      else
+		ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
+	    }
+	  else if (ls_param->nhtype == SRV6_NHTYPE_IPV4)
+	    {
+	      ip6srv->sr.protocol = IP_PROTOCOL_IP_IN_IP;
+	      if ((clib_net_to_host_u32
+		   (encap->ip_version_traffic_class_and_flow_label) >>
+		   28) != 4)
 		{
-		  ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
+		  // Bad encap packet.
+		  next0 = SRV6_END_M_GTP6_D_DI_NEXT_DROP;
+		  goto DONE;
 		}
-
-	      good_n++;
-
-	      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
-		  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	    }
+	  else if (ls_param->nhtype == SRV6_NHTYPE_IPV6)
+	    {
+	      ip6srv->sr.protocol = IP_PROTOCOL_IPV6;
+	      if ((clib_net_to_host_u32
+		   (encap->ip_version_traffic_class_and_flow_label) >>
+		   28) != 6)
 		{
-		  srv6_end_rewrite_trace_t *tr =
-		    vlib_add_trace (vm, node, b0, sizeof (*tr));
-		  clib_memcpy (tr->src.as_u8, ip6srv->ip.src_address.as_u8,
-			       sizeof (ip6_address_t));
-		  clib_memcpy (tr->dst.as_u8, ip6srv->ip.dst_address.as_u8,
-			       sizeof (ip6_address_t));
-		  tr->teid = teid;
-		  clib_memcpy (tr->sr_prefix.as_u8, ls_param->sr_prefix.as_u8,
-			       sizeof (ip6_address_t));
-		  tr->sr_prefixlen = ls_param->sr_prefixlen;
+		  // Bad encap packet.
+		  next0 = SRV6_END_M_GTP6_D_DI_NEXT_DROP;
+		  goto DONE;
 		}
 	    }
-
-	DONE:
-	  vlib_increment_combined_counter
-	    (((next0 ==
-	       SRV6_END_M_GTP6_D_DI_NEXT_DROP) ?
-	      &(sm2->sr_ls_invalid_counters) : &(sm2->sr_ls_valid_counters)),
-	     thread_index, ls0 - sm2->localsids, 1,
-	     vlib_buffer_length_in_chain (vm, b0));
-
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
+	  else if (ls_param->nhtype == SRV6_NHTYPE_NON_IP)
+	    {
+	      ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
+	    }
+	}
+      else
+	{
+	  ip6srv->sr.protocol = IP_PROTOCOL_IP6_ETHERNET;
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
+	  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  srv6_end_rewrite_trace_t *tr =
+	    vlib_add_trace (vm, node, b0, sizeof (*tr));
+	  clib_memcpy (tr->src.as_u8, ip6srv->ip.src_address.as_u8,
+		       sizeof (ip6_address_t));
+	  clib_memcpy (tr->dst.as_u8, ip6srv->ip.dst_address.as_u8,
+		       sizeof (ip6_address_t));
+	  tr->teid = teid;
+	  clib_memcpy (tr->sr_prefix.as_u8, ls_param->sr_prefix.as_u8,
+		       sizeof (ip6_address_t));
+	  tr->sr_prefixlen = ls_param->sr_prefixlen;
+	}
     }
 
+DONE:
+  vlib_increment_combined_counter
+    (((next0 ==
+       SRV6_END_M_GTP6_D_DI_NEXT_DROP) ?
+      &(sm2->sr_ls_invalid_counters) : &(sm2->sr_ls_valid_counters)),
+     thread_index, ls0 - sm2->localsids, 1,
+     vlib_buffer_length_in_chain (vm, b0));
+
+  if (PREDICT_TRUE (next0 != SRV6_END_M_GTP6_D_DI_NEXT_DROP))
+    vlib_increment_combined_counter
+      (&srv6_mobile_localsid_counters[srv6_mobile_msg_type (gtpu_type)],
+       thread_index, ls0 - sm2->localsids, 1,
+       vlib_buffer_length_in_chain (vm, b0));
+
+  return next0;
+}
+
+// Function for SRv6 GTP6.D.DI function
+VLIB_NODE_FN (srv6_end_m_gtp6_d_di) (vlib_main_t * vm,
+				     vlib_node_runtime_t * node,
+				     vlib_frame_t * frame)
+{
+  srv6_end_main_v6_decap_di_t *sm = &srv6_end_main_v6_decap_di;
+  u32 bad_n;
+
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_end_m_gtp6_d_di_process,
+			       SRV6_END_M_GTP6_D_DI_NEXT_DROP, 0);
+
   vlib_node_increment_counter (vm, sm->end_m_gtp6_d_di_node_index,
 			       SRV6_END_ERROR_M_GTP6_D_DI_BAD_PACKETS, bad_n);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp6_d_di_node_index,
-			       SRV6_END_ERROR_M_GTP6_D_DI_PACKETS, good_n);
+			       SRV6_END_ERROR_M_GTP6_D_DI_PACKETS,
+			       frame->n_vectors - bad_n);
 
   return frame->n_vectors;
 }
 
-// Function for SRv6 GTP6.DT function
-VLIB_NODE_FN (srv6_end_m_gtp6_dt) (vlib_main_t * vm,
-				   vlib_node_runtime_t * node,
-				   vlib_frame_t * frame)
+static_always_inline u16
+srv6_end_m_gtp6_dt_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			    vlib_buffer_t * b0)
 {
-  srv6_end_main_v6_dt_t *sm = &srv6_end_main_v6_dt;
   ip6_sr_main_t *sm2 = &sr_main;
-  u32 n_left_from, next_index, *from, *to_next;
   u32 thread_index = vm->thread_index;
+  srv6_end_gtp6_dt_param_t *ls_param;
+  ip6_sr_localsid_t *ls0;
+  u8 gtpu_type = 0;
 
-  u32 good_n = 0, bad_n = 0;
-
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
-
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
+  ip6_gtpu_header_t *hdr0 = NULL;
+  ip4_header_t *ip4 = NULL;
+  ip6_header_t *ip6 = NULL;
+  ip6_address_t src, dst;
+  u32 teid;
+  u32 hdrlen;
+  u32 len0;
+  u32 fib4_index, fib6_index;
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+  u32 next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
 
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  srv6_end_gtp6_dt_param_t *ls_param;
-	  ip6_sr_localsid_t *ls0;
+  ls0 =
+    pool_elt_at_index (sm2->localsids,
+		       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
 
-	  ip6_gtpu_header_t *hdr0 = NULL;
-	  ip4_header_t *ip4 = NULL;
-	  ip6_header_t *ip6 = NULL;
-	  ip6_address_t src, dst;
-	  u32 teid;
-	  u32 hdrlen;
-	  u32 len0;
+  ls_param = (srv6_end_gtp6_dt_param_t *) ls0->plugin_mem;
 
-	  u32 next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
+  hdr0 = vlib_buffer_get_current (b0);
 
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
+  hdrlen = sizeof (ip6_gtpu_header_t);
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  ls0 =
-	    pool_elt_at_index (sm2->localsids,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+  len0 = vlib_buffer_length_in_chain (vm, b0);
 
-	  ls_param = (srv6_end_gtp6_dt_param_t *) ls0->plugin_mem;
+  if ((hdr0->ip6.protocol != IP_PROTOCOL_UDP)
+      || (hdr0->udp.dst_port !=
+	  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
+      || (len0 < sizeof (ip6_gtpu_header_t)))
+    {
+      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
+    }
+  else
+    {
+      clib_memcpy_fast (src.as_u8, hdr0->ip6.src_address.as_u8,
+			sizeof (ip6_address_t));
+      clib_memcpy_fast (dst.as_u8, hdr0->ip6.dst_address.as_u8,
+			sizeof (ip6_address_t));
 
-	  hdr0 = vlib_buffer_get_current (b0);
+      teid = hdr0->gtpu.teid;
+      gtpu_type = hdr0->gtpu.type;
 
-	  hdrlen = sizeof (ip6_gtpu_header_t);
+      fib4_index = ls_param->fib4_index;
+      fib6_index = ls_param->fib6_index;
 
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
+      if (ls_param->session_table != ~0 && gtpu_type == GTPU_TYPE_GTPU)
+	{
+	  srv6_mobile_session_t *session0;
 
-	  if ((hdr0->ip6.protocol != IP_PROTOCOL_UDP)
-	      || (hdr0->udp.dst_port !=
-		  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
-	      || (len0 < sizeof (ip6_gtpu_header_t)))
+	  session0 =
+	    srv6_mobile_session_lookup (ls_param->session_table, teid);
+	  if (PREDICT_FALSE (session0 == NULL))
 	    {
+	      b0->error = node->errors[SRV6_END_ERROR_M_GTP6_DT_NO_SESSION];
 	      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
-
-	      bad_n++;
+	      goto DONE;
 	    }
-	  else
+
+	  if (session0->fib4_index != ~0)
+	    fib4_index = session0->fib4_index;
+	  if (session0->fib6_index != ~0)
+	    fib6_index = session0->fib6_index;
+	}
+
+      if (hdr0->gtpu.ver_flags & GTPU_EXTHDR_FLAG)
+	{
+	  hdrlen += sizeof (gtpu_exthdr_t);
+	  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
 	    {
-	      clib_memcpy_fast (src.as_u8, hdr0->ip6.src_address.as_u8,
-				sizeof (ip6_address_t));
-	      clib_memcpy_fast (dst.as_u8, hdr0->ip6.dst_address.as_u8,
-				sizeof (ip6_address_t));
+	      gtpu_pdu_session_t *sess;
 
-	      teid = hdr0->gtpu.teid;
+	      sess =
+		(gtpu_pdu_session_t *) (((char *) hdr0) +
+					sizeof (ip6_gtpu_header_t) +
+					sizeof (gtpu_exthdr_t));
 
-	      if (hdr0->gtpu.ver_flags & GTPU_EXTHDR_FLAG)
+	      hdrlen += sizeof (gtpu_pdu_session_t);
+	      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
 		{
-		  hdrlen += sizeof (gtpu_exthdr_t);
-		  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
-		    {
-		      gtpu_pdu_session_t *sess;
-
-		      sess =
-			(gtpu_pdu_session_t *) (((char *) hdr0) +
-						sizeof (ip6_gtpu_header_t) +
-						sizeof (gtpu_exthdr_t));
-
-		      hdrlen += sizeof (gtpu_pdu_session_t);
-		      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
-			{
-			  hdrlen += sizeof (gtpu_paging_policy_t);
-			}
-		    }
+		  hdrlen += sizeof (gtpu_paging_policy_t);
 		}
+	    }
+	}
 
-	      if (ls_param->type == SRV6_GTP6_DT4)
-		{
-		  vlib_buffer_advance (b0, (word) hdrlen);
-		  ip4 = vlib_buffer_get_current (b0);
-		  if ((ip4->ip_version_and_header_length & 0xf0) != 0x40)
-		    {
-		      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
-		      bad_n++;
-		      goto DONE;
-		    }
+      if (ls_param->type == SRV6_GTP6_DT4)
+	{
+	  vlib_buffer_advance (b0, (word) hdrlen);
+	  ip4 = vlib_buffer_get_current (b0);
+	  if ((ip4->ip_version_and_header_length & 0xf0) != 0x40)
+	    {
+	      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
+	      goto DONE;
+	    }
 
-		  next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP4;
-		  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-		    ls_param->fib4_index;
-		}
-	      else if (ls_param->type == SRV6_GTP6_DT6)
-		{
-		  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
-		  if ((clib_net_to_host_u32
-		       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
-		      != 6)
-		    {
-		      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
-		      bad_n++;
-		      goto DONE;
-		    }
+	  next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP4;
+	  vnet_buffer (b0)->sw_if_index[VLIB_TX] = fib4_index;
+	}
+      else if (ls_param->type == SRV6_GTP6_DT6)
+	{
+	  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
+	  if ((clib_net_to_host_u32
+	       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
+	      != 6)
+	    {
+	      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
+	      goto DONE;
+	    }
 
-		  next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP6;
-		  if ((ip6->dst_address.as_u8[0] == 0xff)
-		      && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
-		    {
-		      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			ls_param->local_fib_index;
-		    }
-		  else
-		    {
-		      vlib_buffer_advance (b0, (word) hdrlen);
-		      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			ls_param->fib6_index;
-		    }
-		}
-	      else if (ls_param->type == SRV6_GTP6_DT46)
+	  next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP6;
+	  if ((ip6->dst_address.as_u8[0] == 0xff)
+	      && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
+	    {
+	      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
+		ls_param->local_fib_index;
+	    }
+	  else
+	    {
+	      vlib_buffer_advance (b0, (word) hdrlen);
+	      vnet_buffer (b0)->sw_if_index[VLIB_TX] = fib6_index;
+	    }
+	}
+      else if (ls_param->type == SRV6_GTP6_DT46)
+	{
+	  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
+	  if ((clib_net_to_host_u32
+	       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
+	      == 6)
+	    {
+	      next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP6;
+	      if ((ip6->dst_address.as_u8[0] == 0xff)
+		  && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
 		{
-		  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
-		  if ((clib_net_to_host_u32
-		       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
-		      == 6)
-		    {
-		      next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP6;
-		      if ((ip6->dst_address.as_u8[0] == 0xff)
-			  && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
-			{
-			  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			    ls_param->local_fib_index;
-			}
-		      else
-			{
-			  vlib_buffer_advance (b0, (word) hdrlen);
-			  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			    ls_param->fib6_index;
-			}
-		    }
-		  else
-		    if ((clib_net_to_host_u32
-			 (ip6->ip_version_traffic_class_and_flow_label) >> 28)
-			== 4)
-		    {
-		      vlib_buffer_advance (b0, (word) hdrlen);
-		      next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP4;
-		      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			ls_param->fib4_index;
-		    }
-		  else
-		    {
-		      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
-		      bad_n++;
-		      goto DONE;
-		    }
+		  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
+		    ls_param->local_fib_index;
 		}
 	      else
 		{
-		  next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
-		  bad_n++;
-		  goto DONE;
+		  vlib_buffer_advance (b0, (word) hdrlen);
+		  vnet_buffer (b0)->sw_if_index[VLIB_TX] = fib6_index;
 		}
+	    }
+	  else
+	    if ((clib_net_to_host_u32
+		 (ip6->ip_version_traffic_class_and_flow_label) >> 28)
+		== 4)
+	    {
+	      vlib_buffer_advance (b0, (word) hdrlen);
+	      next0 = SRV6_END_M_GTP6_DT_NEXT_LOOKUP4;
+	      vnet_buffer (b0)->sw_if_index[VLIB_TX] = fib4_index;
+	    }
+	  else
+	    {
+	      next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
+	      goto DONE;
+	    }
+	}
+      else
+	{
+	  next0 = SRV6_END_M_GTP6_DT_NEXT_DROP;
+	  goto DONE;
+	}
 
-	      good_n++;
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
+	  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  srv6_end_rewrite_trace_t *tr =
+	    vlib_add_trace (vm, node, b0, sizeof (*tr));
+	  clib_memcpy (tr->src.as_u8, src.as_u8,
+		       sizeof (ip6_address_t));
+	  clib_memcpy (tr->dst.as_u8, dst.as_u8,
+		       sizeof (ip6_address_t));
+	  tr->teid = teid;
+	}
+    }
 
-	      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
-		  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
-		{
-		  srv6_end_rewrite_trace_t *tr =
-		    vlib_add_trace (vm, node, b0, sizeof (*tr));
-		  clib_memcpy (tr->src.as_u8, src.as_u8,
-			       sizeof (ip6_address_t));
-		  clib_memcpy (tr->dst.as_u8, dst.as_u8,
-			       sizeof (ip6_address_t));
-		  tr->teid = teid;
-		}
-	    }
+DONE:
+  vlib_increment_combined_counter
+    (((next0 ==
+       SRV6_END_M_GTP6_DT_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters)
+      : &(sm2->sr_ls_valid_counters)), thread_index,
+     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
 
-	DONE:
-	  vlib_increment_combined_counter
-	    (((next0 ==
-	       SRV6_END_M_GTP6_DT_NEXT_DROP) ? &(sm2->sr_ls_invalid_counters)
-	      : &(sm2->sr_ls_valid_counters)), thread_index,
-	     ls0 - sm2->localsids, 1, vlib_buffer_length_in_chain (vm, b0));
+  if (PREDICT_TRUE (next0 != SRV6_END_M_GTP6_DT_NEXT_DROP))
+    vlib_increment_combined_counter
+      (&srv6_mobile_localsid_counters[srv6_mobile_msg_type (gtpu_type)],
+       thread_index, ls0 - sm2->localsids, 1,
+       vlib_buffer_length_in_chain (vm, b0));
 
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
-	}
+  return next0;
+}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
-    }
+// Function for SRv6 GTP6.DT function
+VLIB_NODE_FN (srv6_end_m_gtp6_dt) (vlib_main_t * vm,
+				   vlib_node_runtime_t * node,
+				   vlib_frame_t * frame)
+{
+  srv6_end_main_v6_dt_t *sm = &srv6_end_main_v6_dt;
+  u32 bad_n;
+
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_end_m_gtp6_dt_process,
+			       SRV6_END_M_GTP6_DT_NEXT_DROP, 0);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp6_dt_node_index,
 			       SRV6_END_ERROR_M_GTP6_DT_BAD_PACKETS, bad_n);
 
   vlib_node_increment_counter (vm, sm->end_m_gtp6_dt_node_index,
-			       SRV6_END_ERROR_M_GTP6_DT_PACKETS, good_n);
+			       SRV6_END_ERROR_M_GTP6_DT_PACKETS,
+			       frame->n_vectors - bad_n);
 
   return frame->n_vectors;
 }
 
-// Function for SRv6 GTP4.DT function
-VLIB_NODE_FN (srv6_t_m_gtp4_dt) (vlib_main_t * vm,
-				 vlib_node_runtime_t * node,
-				 vlib_frame_t * frame)
+static_always_inline u16
+srv6_t_m_gtp4_dt_process (vlib_main_t * vm, vlib_node_runtime_t * node,
+			  vlib_buffer_t * b0)
 {
-  srv6_t_main_v4_dt_t *sm = &srv6_t_main_v4_dt;
   ip6_sr_main_t *sm2 = &sr_main;
-  u32 n_left_from, next_index, *from, *to_next;
+  u32 thread_index = vm->thread_index;
+  srv6_t_gtp4_dt_param_t *ls_param;
+  ip6_sr_sl_t *ls0;
+  u8 gtpu_type = 0;
 
-  u32 good_n = 0, bad_n = 0;
+  ip4_gtpu_header_t *hdr0 = NULL;
+  ip4_header_t *ip4 = NULL;
+  ip6_header_t *ip6 = NULL;
+  ip6_address_t src, dst;
+  u32 teid;
+  u32 hdrlen;
+  u32 len0;
 
-  from = vlib_frame_vector_args (frame);
-  n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
+  u32 next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
 
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
+  ls0 =
+    pool_elt_at_index (sm2->sid_lists,
+		       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
 
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+  ls_param = (srv6_t_gtp4_dt_param_t *) ls0->plugin_mem;
 
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  srv6_t_gtp4_dt_param_t *ls_param;
-	  ip6_sr_sl_t *ls0;
+  hdr0 = vlib_buffer_get_current (b0);
 
-	  ip4_gtpu_header_t *hdr0 = NULL;
-	  ip4_header_t *ip4 = NULL;
-	  ip6_header_t *ip6 = NULL;
-	  ip6_address_t src, dst;
-	  u32 teid;
-	  u32 hdrlen;
-	  u32 len0;
+  hdrlen = sizeof (ip4_gtpu_header_t);
 
-	  u32 next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
+  len0 = vlib_buffer_length_in_chain (vm, b0);
 
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
+  if ((hdr0->ip4.protocol != IP_PROTOCOL_UDP)
+      || (hdr0->udp.dst_port !=
+	  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
+      || (len0 < sizeof (ip4_gtpu_header_t)))
+    {
+      next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
+    }
+  else
+    {
+      clib_memcpy_fast (src.as_u8, hdr0->ip4.src_address.as_u8,
+			sizeof (ip4_address_t));
+      clib_memcpy_fast (dst.as_u8, hdr0->ip4.dst_address.as_u8,
+			sizeof (ip4_address_t));
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  ls0 =
-	    pool_elt_at_index (sm2->sid_lists,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+      teid = hdr0->gtpu.teid;
+      gtpu_type = hdr0->gtpu.type;
 
-	  ls_param = (srv6_t_gtp4_dt_param_t *) ls0->plugin_mem;
+      if (hdr0->gtpu.ver_flags & GTPU_EXTHDR_FLAG)
+	{
+	  hdrlen += sizeof (gtpu_exthdr_t);
+	  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
+	    {
+	      gtpu_pdu_session_t *sess;
 
-	  hdr0 = vlib_buffer_get_current (b0);
+	      sess =
+		(gtpu_pdu_session_t *) (((char *) hdr0) +
+					sizeof (ip6_gtpu_header_t) +
+					sizeof (gtpu_exthdr_t));
 
-	  hdrlen = sizeof (ip4_gtpu_header_t);
+	      hdrlen += sizeof (gtpu_pdu_session_t);
+	      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
+		{
+		  hdrlen += sizeof (gtpu_paging_policy_t);
+		}
+	    }
+	}
 
-	  len0 = vlib_buffer_length_in_chain (vm, b0);
+      if (ls_param->type == SRV6_GTP4_DT4)
+	{
+	  vlib_buffer_advance (b0, (word) hdrlen);
+	  ip4 = vlib_buffer_get_current (b0);
+	  if ((ip4->ip_version_and_header_length & 0xf0) != 0x40)
+	    {
+	      next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
+	      goto DONE;
+	    }
 
-	  if ((hdr0->ip4.protocol != IP_PROTOCOL_UDP)
-	      || (hdr0->udp.dst_port !=
-		  clib_host_to_net_u16 (SRV6_GTP_UDP_DST_PORT))
-	      || (len0 < sizeof (ip4_gtpu_header_t)))
+	  next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP4;
+	  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
+	    ls_param->fib4_index;
+	}
+      else if (ls_param->type == SRV6_GTP4_DT6)
+	{
+	  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
+	  if ((clib_net_to_host_u32
+	       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
+	      != 6)
 	    {
 	      next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
+	      goto DONE;
+	    }
 
-	      bad_n++;
+	  next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP6;
+	  if ((ip6->dst_address.as_u8[0] == 0xff)
+	      && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
+	    {
+	      next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP4;
+	      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
+		ls_param->local_fib_index;
 	    }
 	  else
 	    {
-	      clib_memcpy_fast (src.as_u8, hdr0->ip4.src_address.as_u8,
-				sizeof (ip4_address_t));
-	      clib_memcpy_fast (dst.as_u8, hdr0->ip4.dst_address.as_u8,
-				sizeof (ip4_address_t));
-
-	      teid = hdr0->gtpu.teid;
-
-	      if (hdr0->gtpu.ver_flags & GTPU_EXTHDR_FLAG)
-		{
-		  hdrlen += sizeof (gtpu_exthdr_t);
-		  if (hdr0->gtpu.ext->nextexthdr == GTPU_EXTHDR_PDU_SESSION)
-		    {
-		      gtpu_pdu_session_t *sess;
-
-		      sess =
-			(gtpu_pdu_session_t *) (((char *) hdr0) +
-						sizeof (ip6_gtpu_header_t) +
-						sizeof (gtpu_exthdr_t));
-
-		      hdrlen += sizeof (gtpu_pdu_session_t);
-		      if (sess->u.val & GTPU_PDU_SESSION_P_BIT_MASK)
-			{
-			  hdrlen += sizeof (gtpu_paging_policy_t);
-			}
-		    }
-		}
-
-	      if (ls_param->type == SRV6_GTP4_DT4)
+	      vlib_buffer_advance (b0, (word) hdrlen);
+	      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
+		ls_param->fib6_index;
+	    }
+	}
+      else if (ls_param->type == SRV6_GTP4_DT46)
+	{
+	  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
+	  if ((clib_net_to_host_u32
+	       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
+	      == 6)
+	    {
+	      next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP6;
+	      if ((ip6->dst_address.as_u8[0] == 0xff)
+		  && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
 		{
-		  vlib_buffer_advance (b0, (word) hdrlen);
-		  ip4 = vlib_buffer_get_current (b0);
-		  if ((ip4->ip_version_and_header_length & 0xf0) != 0x40)
-		    {
-		      next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
-		      bad_n++;
-		      goto DONE;
-		    }
-
 		  next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP4;
 		  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-		    ls_param->fib4_index;
-		}
-	      else if (ls_param->type == SRV6_GTP4_DT6)
-		{
-		  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
-		  if ((clib_net_to_host_u32
-		       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
-		      != 6)
-		    {
-		      next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
-		      bad_n++;
-		      goto DONE;
-		    }
-
-		  next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP6;
-		  if ((ip6->dst_address.as_u8[0] == 0xff)
-		      && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
-		    {
-		      next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP4;
-		      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			ls_param->local_fib_index;
-		    }
-		  else
-		    {
-		      vlib_buffer_advance (b0, (word) hdrlen);
-		      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			ls_param->fib6_index;
-		    }
-		}
-	      else if (ls_param->type == SRV6_GTP4_DT46)
-		{
-		  ip6 = (ip6_header_t *) ((u8 *) hdr0 + hdrlen);
-		  if ((clib_net_to_host_u32
-		       (ip6->ip_version_traffic_class_and_flow_label) >> 28)
-		      == 6)
-		    {
-		      next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP6;
-		      if ((ip6->dst_address.as_u8[0] == 0xff)
-			  && ((ip6->dst_address.as_u8[1] & 0xc0) == 0x80))
-			{
-			  next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP4;
-			  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			    ls_param->local_fib_index;
-			}
-		      else
-			{
-			  vlib_buffer_advance (b0, (word) hdrlen);
-			  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			    ls_param->fib6_index;
-			}
-		    }
-		  else
-		    if ((clib_net_to_host_u32
-			 (ip6->ip_version_traffic_class_and_flow_label) >> 28)
-			== 4)
-		    {
-		      vlib_buffer_advance (b0, (word) hdrlen);
-		      next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP4;
-		      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
-			ls_param->fib4_index;
-		    }
-		  else
-		    {
-		      next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
-		      bad_n++;
-		      goto DONE;
-		    }
+		    ls_param->local_fib_index;
 		}
 	      else
 		{
-		  next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
-		  bad_n++;
-		  goto DONE;
-		}
-
-	      good_n++;
-
-	      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
-		  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
-		{
-		  srv6_end_rewrite_trace_t *tr =
-		    vlib_add_trace (vm, node, b0, sizeof (*tr));
-		  clib_memcpy (tr->src.as_u8, src.as_u8,
-			       sizeof (ip6_address_t));
-		  clib_memcpy (tr->dst.as_u8, dst.as_u8,
-			       sizeof (ip6_address_t));
-		  tr->teid = teid;
+		  vlib_buffer_advance (b0, (word) hdrlen);
+		  vnet_buffer (b0)->sw_if_index[VLIB_TX] =
+		    ls_param->fib6_index;
 		}
 	    }
-
-	DONE:
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
+	  else
+	    if ((clib_net_to_host_u32
+		 (ip6->ip_version_traffic_class_and_flow_label) >> 28)
+		== 4)
+	    {
+	      vlib_buffer_advance (b0, (word) hdrlen);
+	      next0 = SRV6_T_M_GTP4_DT_NEXT_LOOKUP4;
+	      vnet_buffer (b0)->sw_if_index[VLIB_TX] =
+		ls_param->fib4_index;
+	    }
+	  else
+	    {
+	      next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
+	      goto DONE;
+	    }
+	}
+      else
+	{
+	  next0 = SRV6_T_M_GTP4_DT_NEXT_DROP;
+	  goto DONE;
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
+	  PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  srv6_end_rewrite_trace_t *tr =
+	    vlib_add_trace (vm, node, b0, sizeof (*tr));
+	  clib_memcpy (tr->src.as_u8, src.as_u8,
+		       sizeof (ip6_address_t));
+	  clib_memcpy (tr->dst.as_u8, dst.as_u8,
+		       sizeof (ip6_address_t));
+	  tr->teid = teid;
+	}
     }
 
+DONE:
+  if (PREDICT_TRUE (next0 != SRV6_T_M_GTP4_DT_NEXT_DROP))
+    vlib_increment_combined_counter
+      (&srv6_mobile_policy_counters[srv6_mobile_msg_type (gtpu_type)],
+       thread_index, ls_param->counter_index, 1,
+       vlib_buffer_length_in_chain (vm, b0));
+
+  return next0;
+}
+
+// Function for SRv6 GTP4.DT function
+VLIB_NODE_FN (srv6_t_m_gtp4_dt) (vlib_main_t * vm,
+				 vlib_node_runtime_t * node,
+				 vlib_frame_t * frame)
+{
+  srv6_t_main_v4_dt_t *sm = &srv6_t_main_v4_dt;
+  u32 bad_n;
+
+  bad_n =
+    srv6_mobile_node_dispatch (vm, node, frame, srv6_t_m_gtp4_dt_process,
+			       SRV6_T_M_GTP4_DT_NEXT_DROP, 1);
+
   vlib_node_increment_counter (vm, sm->t_m_gtp4_dt_node_index,
 			       SRV6_T_ERROR_M_GTP4_DT_BAD_PACKETS, bad_n);
 
   vlib_node_increment_counter (vm, sm->t_m_gtp4_dt_node_index,
-			       SRV6_T_ERROR_M_GTP4_DT_PACKETS, good_n);
+			       SRV6_T_ERROR_M_GTP4_DT_PACKETS,
+			       frame->n_vectors - bad_n);
 
   return frame->n_vectors;
 }
@@ -0,0 +1,253 @@
+/*
+ * session.c
+ *
+ * Copyright (c) 2019 Arrcus Inc and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/fib/fib_table.h>
+#include <srv6-mobile/mobile.h>
+
+#include <vppinfra/bihash_template.c>
+
+srv6_mobile_main_t srv6_mobile_main;
+
+#define SRV6_MOBILE_SESSION_DEFAULT_BUCKETS	(64 << 10)
+#define SRV6_MOBILE_SESSION_DEFAULT_MEMORY	(256 << 20)
+
+/*
+ * The table is only created once a localsid or an entry asks for it, so
+ * the stateless behaviors do not pay for the memory.
+ */
+void
+srv6_mobile_session_table_init (void)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+
+  if (smm->session_table.buckets)
+    return;
+
+  if (!smm->session_buckets)
+    smm->session_buckets = SRV6_MOBILE_SESSION_DEFAULT_BUCKETS;
+  if (!smm->session_memory)
+    smm->session_memory = SRV6_MOBILE_SESSION_DEFAULT_MEMORY;
+
+  clib_bihash_init_8_8 (&smm->session_table, "srv6-mobile sessions",
+			smm->session_buckets, smm->session_memory);
+}
+
+int
+srv6_mobile_session_add_del (u32 table_id, u32 teid,
+			     srv6_mobile_session_t * session, int is_add)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+  srv6_mobile_session_t *s;
+  clib_bihash_kv_8_8_t kv;
+
+  if (table_id == ~0)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  srv6_mobile_session_table_init ();
+
+  kv.key = ((u64) table_id << 32) | clib_host_to_net_u32 (teid);
+
+  if (clib_bihash_search_8_8 (&smm->session_table, &kv, &kv) == 0)
+    {
+      s = pool_elt_at_index (smm->sessions, kv.value);
+
+      if (is_add)
+	{
+	  /*
+	   * Update in place. The copy is not atomic, this is only safe
+	   * because the API and CLI handlers calling us are not mp-safe
+	   * and run with the workers stopped at the barrier, as do the
+	   * pool_get and pool_put below.
+	   */
+	  clib_memcpy_fast (s, session, sizeof (*s));
+	  return 0;
+	}
+
+      clib_bihash_add_del_8_8 (&smm->session_table, &kv, 0 /* is_add */ );
+      pool_put (smm->sessions, s);
+      return 0;
+    }
+
+  if (!is_add)
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+
+  pool_get (smm->sessions, s);
+  clib_memcpy_fast (s, session, sizeof (*s));
+
+  kv.value = s - smm->sessions;
+  if (clib_bihash_add_del_8_8 (&smm->session_table, &kv, 1 /* is_add */ ))
+    {
+      pool_put (smm->sessions, s);
+      return VNET_API_ERROR_TABLE_TOO_BIG;
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+srv6_mobile_session_command_fn (vlib_main_t * vm, unformat_input_t * input,
+				vlib_cli_command_t * cmd)
+{
+  srv6_mobile_session_t session;
+  u32 table_id = ~0, teid = ~0, vrf = ~0, qfi;
+  int is_add = 1;
+  int rv;
+
+  clib_memset (&session, 0, sizeof (session));
+  session.qfi = SRV6_MOBILE_SESSION_QFI_KEEP;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "add"))
+	is_add = 1;
+      else if (unformat (input, "del"))
+	is_add = 0;
+      else if (unformat (input, "table %u", &table_id))
+	;
+      else if (unformat (input, "teid %u", &teid))
+	;
+      else if (unformat (input, "far-end %U", unformat_ip6_address,
+			 &session.far_end))
+	;
+      else if (unformat (input, "qfi %u", &qfi))
+	{
+	  if (qfi > GTPU_PDU_SESSION_QFI_MASK)
+	    return clib_error_return (0, "qfi %u out of range", qfi);
+	  session.qfi = qfi;
+	}
+      else if (unformat (input, "vrf %u", &vrf))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (table_id == ~0 || teid == ~0)
+    return clib_error_return (0, "table and teid must be specified");
+
+  session.fib4_index = session.fib6_index = ~0;
+  if (vrf != ~0)
+    {
+      session.fib4_index = fib_table_find (FIB_PROTOCOL_IP4, vrf);
+      session.fib6_index = fib_table_find (FIB_PROTOCOL_IP6, vrf);
+      if (session.fib4_index == ~0 && session.fib6_index == ~0)
+	return clib_error_return (0, "vrf %u does not exist", vrf);
+    }
+
+  rv = srv6_mobile_session_add_del (table_id, teid, &session, is_add);
+  if (rv)
+    return clib_error_return (0, "session %s failed (%d)",
+			      is_add ? "add" : "del", rv);
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (srv6_mobile_session_command, static) = {
+  .path = "sr mobile session",
+  .short_help = "sr mobile session [add|del] table <id> teid <teid> "
+    "[far-end <ip6-address>] [qfi <qfi>] [vrf <table-id>]",
+  .function = srv6_mobile_session_command_fn,
+};
+/* *INDENT-ON* */
+
+static int
+srv6_mobile_session_show_walk (clib_bihash_kv_8_8_t * kv, void *arg)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+  vlib_main_t *vm = arg;
+  srv6_mobile_session_t *s;
+
+  s = pool_elt_at_index (smm->sessions, kv->value);
+
+  vlib_cli_output (vm, "table %u teid %u far-end %U qfi %d fib %d/%d",
+		   kv->key >> 32,
+		   clib_net_to_host_u32 ((u32) kv->key),
+		   format_ip6_address, &s->far_end,
+		   s->qfi == SRV6_MOBILE_SESSION_QFI_KEEP ? -1 : s->qfi,
+		   (i32) s->fib4_index, (i32) s->fib6_index);
+
+  return BIHASH_WALK_CONTINUE;
+}
+
+static clib_error_t *
+srv6_mobile_show_sessions_command_fn (vlib_main_t * vm,
+				      unformat_input_t * input,
+				      vlib_cli_command_t * cmd)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+  int verbose = 0;
+
+  if (unformat (input, "verbose"))
+    verbose = 1;
+
+  if (!smm->session_table.buckets)
+    {
+      vlib_cli_output (vm, "no sessions");
+      return 0;
+    }
+
+  vlib_cli_output (vm, "%d sessions", pool_elts (smm->sessions));
+
+  if (verbose)
+    vlib_cli_output (vm, "%U", format_bihash_8_8, &smm->session_table,
+		     0 /* verbose */ );
+
+  clib_bihash_foreach_key_value_pair_8_8 (&smm->session_table,
+					  srv6_mobile_session_show_walk, vm);
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (srv6_mobile_show_sessions_command, static) = {
+  .path = "show sr mobile sessions",
+  .short_help = "show sr mobile sessions [verbose]",
+  .function = srv6_mobile_show_sessions_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+srv6_mobile_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  srv6_mobile_main_t *smm = &srv6_mobile_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "session-buckets %u", &smm->session_buckets))
+	;
+      else if (unformat (input, "session-memory %U",
+			 unformat_memory_size, &smm->session_memory))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (srv6_mobile_config, "srv6-mobile");
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -90,6 +90,91 @@ class TestSRv6EndMGTP4E(VppTestCase):
             self.assertEqual(pkt[IP].src, self.ip4_src)
             self.assertEqual(pkt[GTP_U_Header].teid, 0xbbbbbbbb)
 
+    def test_srv6_mobile_unaligned(self):
+        """ test_srv6_mobile with a /52 locator """
+        prefix = int(IPv6Address(u"aaaa:aaaa:aaaa:a000::"))
+        ip4_dst = int(IPv4Address(str(self.ip4_dst)))
+        ip4_src = int(IPv4Address(str(self.ip4_src)))
+
+        # 52bit prefix + 32bit IPv4 DA + 8bit QFI + 32bit TEID + 4bit
+        dst = prefix | (ip4_dst << 44) | (0x12345678 << 4)
+        # 76bit prefix + 32bit IPv4 SA + 20bit
+        src = (0xcc << 120) | (ip4_src << 20)
+
+        pkts = list()
+        for i in range(2):
+            pkts.append(Ether() /
+                        IPv6(dst=str(IPv6Address(dst)),
+                             src=str(IPv6Address(src))) /
+                        IPv6ExtHdrSegmentRouting() /
+                        IPv6(dst="A::1", src="B::{:x}".format(i + 1)) /
+                        UDP(sport=1000, dport=23))
+
+        self.vapi.cli(
+            "sr localsid prefix aaaa:aaaa:aaaa:a000::/52 "
+            "behavior end.m.gtp4.e v4src_position 76")
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        capture = self.pg1.get_capture(len(pkts))
+
+        for pkt in capture:
+            self.logger.info(pkt.show2(dump=True))
+            self.assertEqual(pkt[IP].dst, self.ip4_dst)
+            self.assertEqual(pkt[IP].src, self.ip4_src)
+            self.assertEqual(pkt[GTP_U_Header].teid, 0x12345678)
+
+    def test_srv6_mobile_srcport(self):
+        """ test_srv6_mobile with a fixed UDP source port """
+        ip4_dst = IPv4Address(str(self.ip4_dst))
+        dst = b'\xee' * 4 + ip4_dst.packed + \
+            b'\x11' + b'\xbb' * 4 + b'\x11' * 3
+        ip4_src = IPv4Address(str(self.ip4_src))
+        src = b'\xcc' * 8 + ip4_src.packed + \
+            b'\xdd' * 2 + b'\x11' * 2
+
+        pkts = list()
+        for i in range(4):
+            pkts.append(Ether() /
+                        IPv6(dst=str(IPv6Address(dst)),
+                             src=str(IPv6Address(src))) /
+                        IPv6ExtHdrSegmentRouting() /
+                        IPv6(dst="A::1", src="B::{:x}".format(i + 1)) /
+                        UDP(sport=1000 + i, dport=23))
+
+        self.vapi.cli(
+            "sr localsid prefix eeee:eeee::/32 behavior end.m.gtp4.e "
+            "v4src_position 64 srcport-entropy fixed 4321")
+        self.logger.info(self.vapi.cli("show sr localsids"))
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        capture = self.pg1.get_capture(len(pkts))
+
+        for pkt in capture:
+            self.assertEqual(pkt[UDP].sport, 4321)
+            self.assertEqual(pkt[GTP_U_Header].teid, 0xbbbbbbbb)
+
+    def test_srv6_mobile_srcport_invalid(self):
+        """ test_srv6_mobile rejects an out of range UDP source port """
+        reply = self.vapi.cli(
+            "sr localsid prefix dddd:dddd::/32 behavior end.m.gtp4.e "
+            "v4src_position 64 srcport-entropy fixed 70000")
+        self.assertIn("unknown input", reply)
+        reply = self.vapi.cli(
+            "sr localsid prefix dddd:dddd::/32 behavior end.m.gtp6.e "
+            "srcport-entropy fixed 70000")
+        self.assertIn("unknown input", reply)
+        reply = self.vapi.cli(
+            "sr localsid prefix dddd:dddd::/32 behavior end.m.gtp6.e "
+            "srcport-entropy random")
+        self.assertIn("unknown input", reply)
+        self.assertNotIn("dddd:dddd::", self.vapi.cli("show sr localsids"))
+
 
 class TestSRv6TMGTP4D(VppTestCase):
     """ SRv6 T.M.GTP4.D (GTP-U -> SRv6) """
@@ -177,6 +262,45 @@ class TestSRv6TMGTP4D(VppTestCase):
                 str(pkt[IPv6ExtHdrSegmentRouting].addresses[0]),
                 "d4:0:101:101::c800:0")
 
+    def test_srv6_mobile_echo_local(self):
+        """ test_srv6_mobile with echo requests answered locally """
+        pkts = list()
+        for i in range(3):
+            pkts.append(Ether(dst=self.pg0.local_mac,
+                              src=self.pg0.remote_mac) /
+                        IP(dst="3.3.3.3", src=self.pg0.remote_ip4) /
+                        UDP(sport=3000 + i, dport=2152) /
+                        GTP_U_Header(gtp_type=1, S=1, seq=100 + i))
+
+        self.vapi.cli("set sr encaps source addr A1::1")
+        self.vapi.cli("set sr mobile gtpu restart-counter 7")
+        self.vapi.cli("sr policy add bsid D6:: next D2:: next D3::")
+        self.vapi.cli(
+            "sr policy add bsid D7:: behavior t.m.gtp4.d "
+            "D6::/32 v6src_prefix C1::/64 echo-local")
+        self.vapi.cli("sr steer l3 3.3.3.3/32 via bsid D7::")
+
+        self.logger.info(self.vapi.cli("show sr policies"))
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        capture = self.pg0.get_capture(len(pkts))
+        self.pg1.assert_nothing_captured()
+
+        for i, pkt in enumerate(capture):
+            self.logger.info(pkt.show2(dump=True))
+            self.assertEqual(pkt[IP].src, "3.3.3.3")
+            self.assertEqual(pkt[IP].dst, self.pg0.remote_ip4)
+            self.assertEqual(pkt[UDP].sport, 2152)
+            self.assertEqual(pkt[UDP].dport, 3000 + i)
+            self.assertEqual(pkt[GTP_U_Header].gtp_type, 2)
+            self.assertEqual(pkt[GTP_U_Header].seq, 100 + i)
+            # recovery IE, type 14
+            self.assertEqual(raw(pkt[GTP_U_Header].payload)[:2],
+                             b'\x0e\x07')
+
 
 class TestSRv6EndMGTP6E(VppTestCase):
     """ SRv6 End.M.GTP6.E """
@@ -322,6 +446,7 @@ class TestSRv6EndMGTP6D(VppTestCase):
         self.logger.info(self.vapi.cli("show sr policies"))
 
         self.vapi.cli("clear errors")
+        gpdu = self.gpdu_packets()
 
         self.pg0.add_stream(pkts)
         self.pg_enable_capture(self.pg_interfaces)
@@ -338,3 +463,336 @@ class TestSRv6EndMGTP6D(VppTestCase):
                 str(pkt[IPv6ExtHdrSegmentRouting].addresses[0])))
             self.assertEqual(
                 str(pkt[IPv6ExtHdrSegmentRouting].addresses[0]), "d4::c800:0")
+
+        self.assertEqual(self.gpdu_packets() - gpdu, len(pkts))
+
+    def gpdu_packets(self):
+        c = self.statistics.get_counter("/net/srv6-mobile/localsid/g-pdu")
+        return sum(ls['packets'] for thread in c for ls in thread)
+
+    def test_srv6_mobile_multi_sl(self):
+        """ test_srv6_mobile with a multi-path SR policy """
+        pkts = list()
+        for i in range(64):
+            pkts.append(Ether() /
+                        IPv6(dst="2003::1", src=str(self.ip6_src)) /
+                        UDP(sport=2152, dport=2152) /
+                        GTP_U_Header(gtp_type="g_pdu", teid=300 + i) /
+                        IPv6(dst="A::1", src="B::{:x}".format(i + 1)) /
+                        UDP(sport=1000 + i, dport=23))
+
+        self.vapi.cli("set sr encaps source addr A1::1")
+        self.vapi.cli("sr policy add bsid D6:: next D2:: next D3::")
+        self.vapi.cli(
+            "sr localsid prefix 2003::/64 behavior end.m.gtp6.d D6::/64")
+        # added after the localsid, picked up through the policy change
+        self.vapi.cli("sr policy mod bsid D6:: add sl next D7:: next D3::")
+        self.vapi.cli("ip route add D2::/64 via {}".format(self.ip6_nhop))
+        self.vapi.cli("ip route add D7::/64 via {}".format(self.ip6_nhop))
+
+        self.logger.info(self.vapi.cli("show sr policies"))
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        capture = self.pg1.get_capture(len(pkts))
+
+        paths = set()
+        for pkt in capture:
+            paths.add(pkt[IPv6].dst)
+        self.assertEqual(paths, {"d2::", "d7::"})
+
+    def test_srv6_mobile_session(self):
+        """ test_srv6_mobile with an End.M.GTP6.D.Di session table """
+        err = "/err/srv6-end-m-gtp6-d-di/srv6 End.M.GTP6.D.DI no session"
+
+        pkts = list()
+        for teid in (400, 401):
+            pkts.append(Ether() /
+                        IPv6(dst="2004::1", src=str(self.ip6_src)) /
+                        UDP(sport=2152, dport=2152) /
+                        GTP_U_Header(gtp_type="g_pdu", teid=teid) /
+                        IPv6(dst="A::1", src="B::1") /
+                        UDP(sport=1000, dport=23))
+
+        self.vapi.cli(
+            "sr localsid prefix 2004::/64 behavior end.m.gtp6.d.di D4::/64 "
+            "session-table 5")
+        self.vapi.srv6_mobile_session_add_del(
+            is_add=True, count=1,
+            sessions=[{'table_id': 5, 'teid': 400, 'far_end': "D8::",
+                       'qfi': 0xff, 'vrf_id': 0xffffffff}])
+        self.vapi.cli("ip route add D8::/64 via {}".format(self.ip6_nhop))
+
+        self.logger.info(self.vapi.cli("show sr mobile sessions"))
+        no_session = self.statistics.get_err_counter(err)
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        # only the known TEID is forwarded, towards the session's far end
+        capture = self.pg1.get_capture(1)
+
+        self.assertEqual(
+            capture[0][IPv6].dst,
+            str(IPv6Address(int(IPv6Address(u"d8::")) | (400 << 24))))
+        self.assertEqual(self.statistics.get_err_counter(err) - no_session,
+                         1)
+
+
+class TestSRv6MobileBurst(VppTestCase):
+    """ SRv6 mobile nodes with full frames """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestSRv6MobileBurst, cls).setUpClass()
+        try:
+            cls.create_pg_interfaces(range(2))
+            cls.pg_if_i = cls.pg_interfaces[0]
+            cls.pg_if_o = cls.pg_interfaces[1]
+
+            cls.pg_if_i.config_ip4()
+            cls.pg_if_i.config_ip6()
+            cls.pg_if_o.config_ip4()
+            cls.pg_if_o.config_ip6()
+
+            cls.ip4_dst = cls.pg_if_o.remote_ip4
+            cls.ip6_nhop = cls.pg_if_o.remote_ip6
+
+            for pg_if in cls.pg_interfaces:
+                pg_if.admin_up()
+                pg_if.resolve_arp()
+                pg_if.resolve_ndp(timeout=5)
+
+        except Exception:
+            super(TestSRv6MobileBurst, cls).tearDownClass()
+            raise
+
+    def send_burst(self, pkts, node, counter, output=None):
+        """ Send a burst not aligned to the quad loop through node.
+
+        Every packet must be counted by the node and forwarded out of
+        output (pg1 by default). The node's clocks/packet are only
+        logged, the pg timing is too noisy to assert on.
+        """
+        err = "/err/{}/{}".format(node, counter)
+        if output is None:
+            output = self.pg1
+
+        self.vapi.cli("clear runtime")
+        before = self.statistics.get_err_counter(err)
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        capture = output.get_capture(len(pkts))
+
+        self.assertEqual(self.statistics.get_err_counter(err) - before,
+                         len(pkts))
+        self.logger.info(self.vapi.cli("show runtime {}".format(node)))
+
+        return capture
+
+    def gtpu4_packets(self, ip4_dst, inner):
+        pkts = list()
+        for i in range(259):
+            pkts.append(Ether(dst=self.pg0.local_mac,
+                              src=self.pg0.remote_mac) /
+                        IP(dst=ip4_dst, src=self.pg0.remote_ip4) /
+                        UDP(sport=2152, dport=2152) /
+                        GTP_U_Header(gtp_type="g_pdu", teid=200) /
+                        inner(i))
+        return pkts
+
+    def gtpu6_packets(self, ip6_dst, inner):
+        pkts = list()
+        for i in range(259):
+            pkts.append(Ether() /
+                        IPv6(dst=ip6_dst, src="2002::1") /
+                        UDP(sport=2152, dport=2152) /
+                        GTP_U_Header(gtp_type="g_pdu", teid=200) /
+                        inner(i))
+        return pkts
+
+    def inner_ip6(self, i):
+        return (IPv6(dst="A::1", src="B::{:x}".format(i + 1)) /
+                UDP(sport=1000 + i, dport=23))
+
+    def inner_ip4(self, i):
+        return (IP(dst=self.ip4_dst, src="10.0.{}.{}".format(i >> 8,
+                                                             i & 0xff)) /
+                UDP(sport=1000 + i, dport=23))
+
+    def test_srv6_end_m_gtp4_e_burst(self):
+        """ End.M.GTP4.E burst not aligned to the quad loop """
+        ip4_dst = IPv4Address(str(self.ip4_dst))
+        dst = b'\xaa' * 4 + ip4_dst.packed + \
+            b'\x11' + b'\xbb' * 4 + b'\x11' * 3
+        src = b'\xcc' * 8 + IPv4Address("192.168.192.10").packed + \
+            b'\xdd' * 2 + b'\x11' * 2
+
+        pkts = list()
+        for i in range(259):
+            pkts.append(Ether() /
+                        IPv6(dst=str(IPv6Address(dst)),
+                             src=str(IPv6Address(src))) /
+                        IPv6ExtHdrSegmentRouting() /
+                        self.inner_ip6(i))
+
+        self.vapi.cli(
+            "sr localsid address {} behavior end.m.gtp4.e v4src_position 64"
+            .format(str(IPv6Address(dst))))
+
+        capture = self.send_burst(pkts, "srv6-end-m-gtp4-e",
+                                  "srv6 End.M.GTP4.E packets")
+
+        for pkt in capture:
+            self.assertEqual(pkt[IP].dst, self.ip4_dst)
+            self.assertEqual(pkt[IP].src, "192.168.192.10")
+            self.assertEqual(pkt[GTP_U_Header].teid, 0xbbbbbbbb)
+
+    def test_srv6_t_m_gtp4_d_burst(self):
+        """ T.M.GTP4.D burst not aligned to the quad loop """
+        pkts = self.gtpu4_packets("1.1.1.1", self.inner_ip6)
+
+        self.vapi.cli("set sr encaps source addr A1::1")
+        self.vapi.cli("sr policy add bsid E4:: next E2:: next E3::")
+        self.vapi.cli(
+            "sr policy add bsid E5:: behavior t.m.gtp4.d "
+            "E4::/32 v6src_prefix C1::/64 nhtype ipv6")
+        self.vapi.cli("sr steer l3 1.1.1.1/32 via bsid E5::")
+        self.vapi.cli("ip route add E2::/32 via {}".format(self.ip6_nhop))
+
+        capture = self.send_burst(pkts, "srv6-t-m-gtp4-d",
+                                  "srv6 T.M.GTP4.D packets")
+
+        for pkt in capture:
+            self.assertEqual(pkt[IPv6].dst, "e2::")
+            self.assertEqual(
+                str(pkt[IPv6ExtHdrSegmentRouting].addresses[0]),
+                "e4:0:101:101::c800:0")
+
+    def test_srv6_t_m_gtp4_echo_burst(self):
+        """ T.M.GTP4.D echo-local burst not aligned to the quad loop """
+        pkts = list()
+        for i in range(259):
+            pkts.append(Ether(dst=self.pg0.local_mac,
+                              src=self.pg0.remote_mac) /
+                        IP(dst="7.7.7.7", src=self.pg0.remote_ip4) /
+                        UDP(sport=3000 + i, dport=2152) /
+                        GTP_U_Header(gtp_type=1, S=1, seq=i))
+
+        self.vapi.cli("set sr encaps source addr A1::1")
+        self.vapi.cli("sr policy add bsid E6:: next E2:: next E3::")
+        self.vapi.cli(
+            "sr policy add bsid E7:: behavior t.m.gtp4.d "
+            "E6::/32 v6src_prefix C1::/64 echo-local")
+        self.vapi.cli("sr steer l3 7.7.7.7/32 via bsid E7::")
+
+        capture = self.send_burst(pkts, "srv6-t-m-gtp4-echo",
+                                  "srv6 T.M.GTP4.D echo replies",
+                                  output=self.pg0)
+
+        for i, pkt in enumerate(capture):
+            self.assertEqual(pkt[IP].src, "7.7.7.7")
+            self.assertEqual(pkt[IP].dst, self.pg0.remote_ip4)
+            self.assertEqual(pkt[UDP].dport, 3000 + i)
+            self.assertEqual(pkt[GTP_U_Header].gtp_type, 2)
+            self.assertEqual(pkt[GTP_U_Header].seq, i)
+
+    def test_srv6_t_m_gtp4_dt_burst(self):
+        """ T.M.GTP4.DT4 burst not aligned to the quad loop """
+        pkts = self.gtpu4_packets("6.6.6.6", self.inner_ip4)
+
+        self.vapi.cli(
+            "sr policy add bsid E9:: behavior t.m.gtp4.dt4 fib-table 0")
+        self.vapi.cli("sr steer l3 6.6.6.6/32 via bsid E9::")
+
+        capture = self.send_burst(pkts, "srv6-t-m-gtp4-dt",
+                                  "srv6 T.M.GTP4.DT packets")
+
+        for pkt in capture:
+            self.assertEqual(pkt[IP].dst, self.ip4_dst)
+            self.assertEqual(pkt[UDP].dport, 23)
+            self.assertNotIn(GTP_U_Header, pkt)
+
+    def test_srv6_end_m_gtp6_e_burst(self):
+        """ End.M.GTP6.E burst not aligned to the quad loop """
+        # 64bit prefix + 8bit + 32bit TEID + 24bit
+        dst = str(IPv6Address(b'\xab' * 8 + b'\x00' +
+                              b'\xbb' * 4 + b'\x00' * 3))
+
+        pkts = list()
+        for i in range(259):
+            pkts.append(Ether() /
+                        IPv6(dst=dst, src="2002::1") /
+                        IPv6ExtHdrSegmentRouting(segleft=1,
+                                                 lastentry=0,
+                                                 tag=0,
+                                                 addresses=["a1::1"]) /
+                        self.inner_ip6(i))
+
+        self.vapi.cli(
+            "sr localsid prefix {}/64 behavior end.m.gtp6.e".format(dst))
+        self.vapi.cli("ip route add a1::/64 via {}".format(self.ip6_nhop))
+
+        capture = self.send_burst(pkts, "srv6-end-m-gtp6-e",
+                                  "srv6 End.M.GTP6.E packets")
+
+        for pkt in capture:
+            self.assertEqual(pkt[IPv6].dst, "a1::1")
+            self.assertEqual(pkt[GTP_U_Header].teid, 0xbbbbbbbb)
+
+    def test_srv6_end_m_gtp6_d_burst(self):
+        """ End.M.GTP6.D burst not aligned to the quad loop """
+        pkts = self.gtpu6_packets("2001::1", self.inner_ip6)
+
+        self.vapi.cli("set sr encaps source addr A1::1")
+        self.vapi.cli("sr policy add bsid D4:: next D2:: next D3::")
+        self.vapi.cli(
+            "sr localsid prefix 2001::/64 behavior end.m.gtp6.d D4::/64")
+        self.vapi.cli("ip route add D2::/64 via {}".format(self.ip6_nhop))
+
+        capture = self.send_burst(pkts, "srv6-end-m-gtp6-d",
+                                  "srv6 End.M.GTP6.D packets")
+
+        for pkt in capture:
+            self.assertEqual(
+                str(pkt[IPv6ExtHdrSegmentRouting].addresses[0]), "d4::c800:0")
+
+    def test_srv6_end_m_gtp6_d_di_burst(self):
+        """ End.M.GTP6.D.Di burst not aligned to the quad loop """
+        pkts = self.gtpu6_packets("2005::1", self.inner_ip6)
+
+        self.vapi.cli(
+            "sr localsid prefix 2005::/64 behavior end.m.gtp6.d.di F4::/64")
+        self.vapi.cli("ip route add F4::/64 via {}".format(self.ip6_nhop))
+
+        capture = self.send_burst(pkts, "srv6-end-m-gtp6-d-di",
+                                  "srv6 End.M.GTP6.D.DI packets")
+
+        for pkt in capture:
+            self.assertEqual(
+                pkt[IPv6].dst,
+                str(IPv6Address(int(IPv6Address(u"f4::")) | (200 << 24))))
+            self.assertEqual(
+                str(pkt[IPv6ExtHdrSegmentRouting].addresses[0]), "2005::1")
+
+    def test_srv6_end_m_gtp6_dt_burst(self):
+        """ End.M.GTP6.DT4 burst not aligned to the quad loop """
+        pkts = self.gtpu6_packets("2006::1", self.inner_ip4)
+
+        self.vapi.cli(
+            "sr localsid prefix 2006::/64 behavior end.m.gtp6.dt4 "
+            "fib-table 0")
+
+        capture = self.send_burst(pkts, "srv6-end-m-gtp6-dt",
+                                  "srv6 End.M.GTP6.DT packets")
+
+        for pkt in capture:
+            self.assertEqual(pkt[IP].dst, self.ip4_dst)
+            self.assertEqual(pkt[UDP].dport, 23)
+            self.assertNotIn(GTP_U_Header, pkt)
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/bihash_resize.h>
+/* for the BIHASH_RESIZE_* states */
+#include <vppinfra/bihash_8_8.h>
+#include <vppinfra/bihash_template.h>
+
+vlib_bihash_resize_main_t vlib_bihash_resize_main = {
+  .n_buckets_per_step = 1024,
+};
+
+/* how often to look for crowded tables, and to step while resizing */
+#define BIHASH_RESIZE_IDLE_INTERVAL 1.0
+#define BIHASH_RESIZE_STEP_INTERVAL 1e-3
+
+void
+vlib_bihash_resize_register (void *h, vlib_bihash_resize_step_fn_t * step,
+			     vlib_bihash_resize_finish_fn_t * finish)
+{
+  vlib_bihash_resize_main_t *brm = &vlib_bihash_resize_main;
+  vlib_bihash_resize_table_t *t;
+
+  vec_add2 (brm->tables, t, 1);
+  t->h = h;
+  t->step = step;
+  t->finish = finish;
+  t->n_resizes = 0;
+}
+
+/*
+ * Stop growing a table. A resize in progress stays where it is, the
+ * table keeps working but the memory of the old bucket array is lost.
+ */
+void
+vlib_bihash_resize_unregister (void *h)
+{
+  vlib_bihash_resize_main_t *brm = &vlib_bihash_resize_main;
+  vlib_bihash_resize_table_t *t;
+
+  vec_foreach (t, brm->tables)
+  {
+    if (t->h == h)
+      {
+	vec_del1 (brm->tables, t - brm->tables);
+	return;
+      }
+  }
+}
+
+static uword
+bihash_resize_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
+		       vlib_frame_t * f)
+{
+  vlib_bihash_resize_main_t *brm = &vlib_bihash_resize_main;
+  vlib_bihash_resize_table_t *t;
+  f64 timeout = BIHASH_RESIZE_IDLE_INTERVAL;
+  int state, busy;
+
+  while (1)
+    {
+      vlib_process_wait_for_event_or_clock (vm, timeout);
+      vlib_process_get_events (vm, 0);
+
+      busy = 0;
+      vec_foreach (t, brm->tables)
+      {
+	state = t->step (t->h, brm->n_buckets_per_step);
+
+	/* all buckets moved, readers must not see the switch */
+	if (state == BIHASH_RESIZE_READY)
+	  {
+	    vlib_worker_thread_barrier_sync (vm);
+	    t->finish (t->h);
+	    vlib_worker_thread_barrier_release (vm);
+	    t->n_resizes++;
+	  }
+
+	busy |= (state != BIHASH_RESIZE_IDLE);
+      }
+
+      timeout = busy ? BIHASH_RESIZE_STEP_INTERVAL :
+	BIHASH_RESIZE_IDLE_INTERVAL;
+    }
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (bihash_resize_process_node, static) = {
+  .function = bihash_resize_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "bihash-resize-process",
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
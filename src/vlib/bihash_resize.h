@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef included_vlib_bihash_resize_h
+#define included_vlib_bihash_resize_h
+
+/**
+ * @file
+ * @brief Background growth of bihash tables.
+ *
+ * Tables initialized with a max_nbuckets and registered here have their
+ * bucket array doubled by the bihash-resize process whenever they get
+ * crowded, a bounded number of buckets per suspend, while the workers
+ * keep using them. Only the final switch to the new bucket array runs
+ * under the worker barrier.
+ */
+
+#include <vlib/vlib.h>
+
+typedef int (vlib_bihash_resize_step_fn_t) (void *h, u32 n_buckets);
+typedef void (vlib_bihash_resize_finish_fn_t) (void *h);
+
+typedef struct
+{
+  /** the clib_bihash_<type>_t */
+  void *h;
+
+  /** clib_bihash_resize_step/finish of its type */
+  vlib_bihash_resize_step_fn_t *step;
+  vlib_bihash_resize_finish_fn_t *finish;
+
+  /** number of times the table doubled */
+  u32 n_resizes;
+} vlib_bihash_resize_table_t;
+
+typedef struct
+{
+  /** registered tables */
+  vlib_bihash_resize_table_t *tables;
+
+  /** buckets moved or reclaimed per table and per step */
+  u32 n_buckets_per_step;
+} vlib_bihash_resize_main_t;
+
+extern vlib_bihash_resize_main_t vlib_bihash_resize_main;
+
+void vlib_bihash_resize_register (void *h,
+				  vlib_bihash_resize_step_fn_t * step,
+				  vlib_bihash_resize_finish_fn_t * finish);
+void vlib_bihash_resize_unregister (void *h);
+
+/**
+ * Register a table, e.g.
+ * vlib_bihash_resize_register_type (&tm->table, 8_8)
+ */
+#define vlib_bihash_resize_register_type(h, type)			\
+  vlib_bihash_resize_register						\
+    (h, (vlib_bihash_resize_step_fn_t *) clib_bihash_resize_step_##type,\
+     (vlib_bihash_resize_finish_fn_t *) clib_bihash_resize_finish_##type)
+
+#endif /* included_vlib_bihash_resize_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
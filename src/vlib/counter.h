@@ -326,6 +326,14 @@ void vlib_free_combined_counter (vlib_combined_counter_main_t * cm);
 */
 #define vlib_counter_len(cm) vec_len((cm)->maxi)
 
+/** Name an element of a stat segment name vector
+    @param vector_name - (char *) stat segment name of the vector, e.g.
+    the counter name followed by "/names"
+    @param index - (u32) index of the element, usually the counter index
+    @param name - (u8 *) vector holding the name, 0 to clear the element
+*/
+void vlib_stats_set_name (char *vector_name, u32 index, u8 * name);
+
 #endif /* included_vlib_counter_h */
 
 /*
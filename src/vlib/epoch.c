@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vlib/vlib.h>
+
+vlib_epoch_main_t vlib_epoch_main;
+
+void
+vlib_epoch_defer (vlib_epoch_callback_t * fn, uword data)
+{
+  vlib_epoch_main_t *em = &vlib_epoch_main;
+  vlib_epoch_deferred_t *d;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  /*
+   * Everything deferred until the next reclaim shares one epoch, started
+   * by the reclaim, so a burst of updates does not make the workers
+   * write their epoch out once per update.
+   */
+  clib_fifo_add2 (em->deferred, d);
+  d->epoch = em->epoch + 1;
+  d->fn = fn;
+  d->data = data;
+  em->epoch_pending = 1;
+  em->n_deferred++;
+}
+
+static void
+vlib_epoch_free_cb (uword data)
+{
+  clib_mem_free ((void *) data);
+}
+
+void
+vlib_epoch_free (void *p)
+{
+  vlib_epoch_defer (vlib_epoch_free_cb, pointer_to_uword (p));
+}
+
+static void
+vlib_epoch_vec_free_cb (uword data)
+{
+  void *v = uword_to_pointer (data, void *);
+  vec_free (v);
+}
+
+void
+vlib_epoch_vec_free (void *v)
+{
+  if (v)
+    vlib_epoch_defer (vlib_epoch_vec_free_cb, pointer_to_uword (v));
+}
+
+/* Oldest epoch announced by all the workers */
+static u64
+vlib_epoch_min_quiescent (void)
+{
+  u64 min = vlib_epoch_main.epoch;
+  u32 i;
+
+  for (i = 1; i < vec_len (vlib_mains); i++)
+    {
+      u64 epoch = __atomic_load_n (&vlib_mains[i]->epoch, __ATOMIC_ACQUIRE);
+      min = clib_min (min, epoch);
+    }
+
+  return min;
+}
+
+void
+vlib_epoch_reclaim (vlib_main_t * vm)
+{
+  vlib_epoch_main_t *em = &vlib_epoch_main;
+  vlib_epoch_deferred_t d;
+  u64 min;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  /*
+   * The unlinks preceding the deferred calls must be visible before the
+   * workers can see the new epoch, hence the release.
+   */
+  if (em->epoch_pending)
+    {
+      __atomic_store_n (&em->epoch, em->epoch + 1, __ATOMIC_RELEASE);
+      em->epoch_pending = 0;
+    }
+
+  min = vlib_epoch_min_quiescent ();
+
+  while (clib_fifo_elts (em->deferred))
+    {
+      if (clib_fifo_head (em->deferred)->epoch > min)
+	break;
+
+      /* the call may defer more */
+      clib_fifo_sub1 (em->deferred, d);
+      d.fn (d.data);
+      em->n_reclaimed++;
+    }
+}
+
+static clib_error_t *
+show_epoch_command_fn (vlib_main_t * vm, unformat_input_t * input,
+		       vlib_cli_command_t * cmd)
+{
+  vlib_epoch_main_t *em = &vlib_epoch_main;
+  u32 i;
+
+  vlib_cli_output (vm, "epoch %llu, deferred %llu, reclaimed %llu, "
+		   "pending %u", em->epoch, em->n_deferred, em->n_reclaimed,
+		   clib_fifo_elts (em->deferred));
+
+  for (i = 1; i < vec_len (vlib_mains); i++)
+    vlib_cli_output (vm, "  thread %u: epoch %llu", i,
+		     vlib_mains[i]->epoch);
+
+  return 0;
+}
+
+/*?
+ * Show the current reclamation epoch, the number of deferred frees and
+ * the epoch each worker last announced.
+ *
+ * @cliexpar
+ * @cliexstart{show epoch}
+ * epoch 12, deferred 1000, reclaimed 1000, pending 0
+ *   thread 1: epoch 12
+ * @cliexend
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_epoch_command, static) = {
+  .path = "show epoch",
+  .short_help = "show epoch",
+  .function = show_epoch_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+test_epoch_command_fn (vlib_main_t * vm, unformat_input_t * input,
+		       vlib_cli_command_t * cmd)
+{
+  u32 n_frees = 0, i;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "defer %u", &n_frees))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  for (i = 0; i < n_frees; i++)
+    if (i & 1)
+      vlib_epoch_free (clib_mem_alloc (64));
+    else
+      {
+	u8 *v = 0;
+	vec_validate (v, i);
+	vlib_epoch_vec_free (v);
+      }
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (test_epoch_command, static) = {
+  .path = "test epoch",
+  .short_help = "test epoch [defer <n>]",
+  .function = test_epoch_command_fn,
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
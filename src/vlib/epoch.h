@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef included_vlib_epoch_h
+#define included_vlib_epoch_h
+
+/**
+ * @file
+ * @brief Epoch based deferred reclamation.
+ *
+ * Workers hold no reference to shared data between two iterations of
+ * their dispatch loop. At the top of each iteration they copy the global
+ * epoch to vm->epoch, announcing they are past everything the main
+ * thread unpublished before that epoch started.
+ *
+ * Instead of taking the worker barrier, the main thread can unlink an
+ * object from what the workers see (swap a pointer, delete a hash
+ * entry...) and then pass its free to vlib_epoch_defer(). The free runs
+ * on the main thread once every worker has announced the epoch following
+ * the unlink, e.g. to return an element to a pool:
+ *
+ * @code
+ * static void
+ * foo_put (uword index)
+ * {
+ *   pool_put_index (foo_main.foos, index);
+ * }
+ *
+ *   clib_bihash_add_del_8_8 (&fm->foo_by_key, &kv, 0);
+ *   vlib_epoch_defer (foo_put, index);
+ * @endcode
+ *
+ * This only covers frees: the workers may still see the old and the new
+ * state side by side, updates which must look atomic to them still need
+ * the barrier. Nor does it protect references held by process nodes
+ * across a suspend.
+ */
+
+typedef void (vlib_epoch_callback_t) (uword data);
+
+typedef struct
+{
+  /** epoch every worker must have announced before the call */
+  u64 epoch;
+  vlib_epoch_callback_t *fn;
+  uword data;
+} vlib_epoch_deferred_t;
+
+typedef struct
+{
+  /** current epoch, advanced by the main thread only */
+  volatile u64 epoch;
+
+  /** fifo of the deferred calls, in epoch order */
+  vlib_epoch_deferred_t *deferred;
+
+  /** calls deferred since the epoch last advanced */
+  u8 epoch_pending;
+
+  /** statistics */
+  u64 n_deferred;
+  u64 n_reclaimed;
+} vlib_epoch_main_t;
+
+extern vlib_epoch_main_t vlib_epoch_main;
+
+/**
+ * Announce the calling worker is quiescent, holding no reference to
+ * shared data. Called from the top of the dispatch loop.
+ */
+static_always_inline void
+vlib_epoch_quiescent (vlib_main_t * vm)
+{
+  u64 epoch = __atomic_load_n (&vlib_epoch_main.epoch, __ATOMIC_ACQUIRE);
+
+  /* keep the cache line clean while nothing is pending */
+  if (PREDICT_FALSE (vm->epoch != epoch))
+    __atomic_store_n (&vm->epoch, epoch, __ATOMIC_RELEASE);
+}
+
+/**
+ * Call fn (data) on the main thread once no worker can hold a reference
+ * to anything unlinked before this call. Main thread only.
+ */
+void vlib_epoch_defer (vlib_epoch_callback_t * fn, uword data);
+
+/** clib_mem_free (p), deferred */
+void vlib_epoch_free (void *p);
+
+/** vec_free (v), deferred */
+void vlib_epoch_vec_free (void *v);
+
+/** Run the deferred calls whose epoch every worker has announced */
+void vlib_epoch_reclaim (vlib_main_t * vm);
+
+#endif /* included_vlib_epoch_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -1155,6 +1155,26 @@ dispatch_pcap_trace (vlib_main_t * vm,
     }
 }
 
+static_always_inline void
+vlib_node_histogram_update (vlib_node_main_t * nm, u32 node_index,
+			    u64 n_clocks, uword n_vectors)
+{
+  vlib_node_histogram_t *h;
+  uword b;
+
+  /* nodes created since the histograms were enabled */
+  if (PREDICT_FALSE (node_index >= vec_len (nm->histograms)))
+    return;
+
+  h = nm->histograms + node_index;
+
+  b = n_clocks ? min_log2 (n_clocks) : 0;
+  h->clocks[clib_min (b, VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS - 1)]++;
+
+  b = n_vectors ? 1 + min_log2 (n_vectors) : 0;
+  h->vectors[clib_min (b, VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS - 1)]++;
+}
+
 static_always_inline u64
 dispatch_node (vlib_main_t * vm,
 	       vlib_node_runtime_t * node,
@@ -1259,6 +1279,10 @@ dispatch_node (vlib_main_t * vm,
 				      pmc_delta[0] /* PMC0 */ ,
 				      pmc_delta[1] /* PMC1 */ );
 
+  if (PREDICT_FALSE (nm->histograms != 0))
+    vlib_node_histogram_update (nm, node->node_index, t - last_time_stamp,
+				n);
+
   /* When in interrupt mode and vector rate crosses threshold switch to
      polling mode. */
   if (PREDICT_FALSE ((dispatch_state == VLIB_NODE_STATE_INTERRUPT)
@@ -1778,6 +1802,7 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
       if (!is_main)
 	{
 	  vlib_worker_thread_barrier_check ();
+	  vlib_epoch_quiescent (vm);
 	  if (PREDICT_FALSE (vm->check_frame_queues +
 			     frame_queue_check_counter))
 	    {
@@ -1949,6 +1974,10 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 		}
 	      _vec_len (nm->data_from_advancing_timing_wheel) = 0;
 	    }
+
+	  /* Run the frees the workers are done with */
+	  if (PREDICT_FALSE (clib_fifo_elts (vlib_epoch_main.deferred)))
+	    vlib_epoch_reclaim (vm);
 	}
       vlib_increment_main_loop_counter (vm);
       /* Record time stamp in case there are no enabled nodes and above
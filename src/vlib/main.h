@@ -239,6 +239,9 @@ typedef struct vlib_main_t
     (struct vlib_main_t *);
   clib_spinlock_t worker_thread_main_loop_callback_lock;
 
+  /* Last epoch the (worker) thread was quiescent in, see vlib/epoch.h */
+  volatile u64 epoch;
+
   /* debugging */
   volatile int parked_at_barrier;
 
@@ -362,6 +362,9 @@ register_node (vlib_main_t * vm, vlib_node_registration_t * r)
 
   vec_add1 (nm->nodes, n);
 
+  if (nm->histograms)
+    vec_validate (nm->histograms, n->index);
+
   /* Name is always a vector so it can be formatted with %v. */
   if (clib_mem_is_heap_object (vec_header (r->name, 0)))
     n->name = vec_dup ((u8 *) r->name);
@@ -635,6 +638,29 @@ vlib_node_get_nodes (vlib_main_t * vm, u32 max_threads, int include_stats,
   *stat_vmsp = stat_vms;
 }
 
+void
+vlib_node_histograms_enable_disable (vlib_main_t * vm, int enable)
+{
+  vlib_node_main_t *nm;
+  uword i;
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  for (i = 0; i < vec_len (vlib_mains); i++)
+    {
+      if (!vlib_mains[i])
+	continue;
+
+      nm = &vlib_mains[i]->node_main;
+      if (enable)
+	vec_validate (nm->histograms, vec_len (nm->nodes) - 1);
+      else
+	vec_free (nm->histograms);
+    }
+
+  vlib_worker_thread_barrier_release (vm);
+}
+
 clib_error_t *
 vlib_node_main_init (vlib_main_t * vm)
 {
@@ -695,6 +695,19 @@ vlib_timing_wheel_data_get_index (u32 d)
   return d / 2;
 }
 
+/* log2 of the clocks per call, the last bucket collects the slower */
+#define VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS 32
+
+/* empty calls, then 1 + log2 of the vector size */
+#define VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS 10
+
+/* Number of dispatches of a node, by duration and by vector size */
+typedef struct
+{
+  u64 clocks[VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS];
+  u64 vectors[VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS];
+} vlib_node_histogram_t;
+
 typedef struct
 {
   /* Public nodes. */
@@ -762,6 +775,9 @@ typedef struct
   /* Time of last node runtime stats clear. */
   f64 time_last_runtime_stats_clear;
 
+  /* Dispatch histograms by node index, when enabled. */
+  vlib_node_histogram_t *histograms;
+
   /* Node registrations added by constructors */
   vlib_node_registration_t *node_registrations;
 
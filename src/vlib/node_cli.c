@@ -522,6 +522,7 @@ clear_node_runtime (vlib_main_t * vm,
 	  r = vlib_node_get_runtime (stat_vm, n->index);
 	  r->max_clock = 0;
 	}
+      vec_zero (nm->histograms);
       /* Note: input/output rates computed using vlib_global_main */
       nm->time_last_runtime_stats_clear = vlib_time_now (vm);
     }
@@ -779,6 +780,188 @@ VLIB_CLI_COMMAND (set_node_fn_command, static) = {
 };
 /* *INDENT-ON* */
 
+static u8 *
+format_vlib_node_histogram_bucket (u8 * s, va_list * args)
+{
+  int is_vectors = va_arg (*args, int);
+  u32 b = va_arg (*args, u32);
+
+  if (is_vectors)
+    {
+      if (b <= 1)
+	return format (s, "%u", b);
+      if (b == VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS - 1)
+	return format (s, ">=%u", 1 << (b - 1));
+      return format (s, "%u-%u", 1 << (b - 1), (1 << b) - 1);
+    }
+
+  if (b == 0)
+    return format (s, "0-1");
+  if (b == VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS - 1)
+    return format (s, ">=%llu", 1ULL << b);
+  return format (s, "%llu-%llu", 1ULL << b, (1ULL << (b + 1)) - 1);
+}
+
+/* bucket holding the given percentile of the calls */
+static u32
+node_histogram_percentile (u64 * buckets, u32 n_buckets, u32 percent)
+{
+  u64 total = 0, sum = 0;
+  u32 b;
+
+  for (b = 0; b < n_buckets; b++)
+    total += buckets[b];
+
+  for (b = 0; b < n_buckets; b++)
+    {
+      sum += buckets[b];
+      if (sum * 100 >= total * percent)
+	break;
+    }
+
+  return clib_min (b, n_buckets - 1);
+}
+
+static void
+show_node_histogram (vlib_main_t * vm, vlib_node_histogram_t * h)
+{
+  u32 b;
+
+  vlib_cli_output (vm, "  %-20s%15s", "Clocks", "Calls");
+  for (b = 0; b < VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS; b++)
+    if (h->clocks[b])
+      vlib_cli_output (vm, "  %-20U%15llu",
+		       format_vlib_node_histogram_bucket, 0, b, h->clocks[b]);
+
+  vlib_cli_output (vm, "  %-20s%15s", "Vectors", "Calls");
+  for (b = 0; b < VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS; b++)
+    if (h->vectors[b])
+      vlib_cli_output (vm, "  %-20U%15llu",
+		       format_vlib_node_histogram_bucket, 1, b,
+		       h->vectors[b]);
+}
+
+static clib_error_t *
+show_node_histograms (vlib_main_t * vm, unformat_input_t * input,
+		      vlib_cli_command_t * cmd)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  vlib_node_histogram_t *h;
+  u32 node_index = ~0, i, n, b, p50, p99, v99;
+  u64 calls;
+
+  if (nm->histograms == 0)
+    return clib_error_return (0, "node histograms are not enabled");
+
+  if (unformat_check_input (input) != UNFORMAT_END_OF_INPUT &&
+      !unformat (input, "%U", unformat_vlib_node, vm, &node_index))
+    return clib_error_return (0, "unknown node '%U'",
+			      format_unformat_error, input);
+
+  for (i = 0; i < vec_len (vlib_mains); i++)
+    {
+      vlib_node_histogram_t *histograms;
+
+      if (!vlib_mains[i])
+	continue;
+
+      histograms = vlib_mains[i]->node_main.histograms;
+      vlib_cli_output (vm, "Thread %u (%s):", i,
+		       vlib_worker_threads[i].name);
+
+      if (node_index != ~0)
+	{
+	  if (node_index < vec_len (histograms))
+	    show_node_histogram (vm, histograms + node_index);
+	  continue;
+	}
+
+      vlib_cli_output (vm, "%-40s%15s%15s%15s%15s", "Name", "Calls",
+		       "p50 Clocks", "p99 Clocks", "p99 Vectors");
+
+      vec_foreach_index (n, histograms)
+      {
+	h = histograms + n;
+	calls = 0;
+	for (b = 0; b < VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS; b++)
+	  calls += h->clocks[b];
+	if (calls == 0 || n >= vec_len (nm->nodes))
+	  continue;
+
+	p50 = node_histogram_percentile (h->clocks,
+					 VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS,
+					 50);
+	p99 = node_histogram_percentile (h->clocks,
+					 VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS,
+					 99);
+	v99 = node_histogram_percentile (h->vectors,
+					 VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS,
+					 99);
+	vlib_cli_output (vm, "%-40v%15llu%15U%15U%15U",
+			 nm->nodes[n]->name, calls,
+			 format_vlib_node_histogram_bucket, 0, p50,
+			 format_vlib_node_histogram_bucket, 0, p99,
+			 format_vlib_node_histogram_bucket, 1, v99);
+      }
+    }
+
+  return 0;
+}
+
+/*?
+ * Show the histograms of the dispatches of the nodes, by clocks per call
+ * and by vector size in log2 buckets. Without a node name, the bucket
+ * holding the median and the 99th percentile of each node is shown.
+ * The histograms are kept once enabled with
+ * '<em>set node histograms enable</em>', cleared with
+ * '<em>clear runtime</em>' and, with per-node-counters on, exported to
+ * the stats segment as /sys/node/clocks_histogram and
+ * /sys/node/vectors_histogram.
+ *
+ * @cliexpar
+ * @cliexstart{show node histograms ip4-lookup}
+ * Thread 0 (vpp_main):
+ *   Clocks                        Calls
+ *   256-511                          12
+ *   512-1023                          3
+ *   Vectors                       Calls
+ *   1                                14
+ *   2-3                               1
+ * @cliexend
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_node_histograms_command, static) = {
+  .path = "show node histograms",
+  .short_help = "show node histograms [<node-name>]",
+  .function = show_node_histograms,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+set_node_histograms (vlib_main_t * vm, unformat_input_t * input,
+		     vlib_cli_command_t * cmd)
+{
+  int enable = -1;
+
+  if (unformat (input, "enable"))
+    enable = 1;
+  else if (unformat (input, "disable"))
+    enable = 0;
+  else
+    return clib_error_return (0, "expected enable or disable");
+
+  vlib_node_histograms_enable_disable (vm, enable);
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (set_node_histograms_command, static) = {
+  .path = "set node histograms",
+  .short_help = "set node histograms enable|disable",
+  .function = set_node_histograms,
+};
+/* *INDENT-ON* */
+
 /* Dummy function to get us linked in. */
 void
 vlib_node_cli_reference (void)
@@ -1134,6 +1134,9 @@ void vlib_start_process (vlib_main_t * vm, uword process_index);
 /* Sync up runtime and main node stats. */
 void vlib_node_sync_stats (vlib_main_t * vm, vlib_node_t * n);
 
+/* Start or stop keeping the dispatch histograms of all the nodes. */
+void vlib_node_histograms_enable_disable (vlib_main_t * vm, int enable);
+
 /* Node graph initialization function. */
 clib_error_t *vlib_node_main_init (vlib_main_t * vm);
 
@@ -63,4 +63,10 @@ vlib_stats_delete_cm (void *notused)
 {
 }
 
+void vlib_stats_set_name (char *, u32, u8 *) __attribute__ ((weak));
+void
+vlib_stats_set_name (char *notused, u32 notused2, u8 * notused3)
+{
+}
+
 #endif
@@ -1213,6 +1213,10 @@ vlib_worker_thread_node_refork (void)
   nm_clone->processes = vec_dup_aligned (nm->processes,
 					 CLIB_CACHE_LINE_BYTES);
   nm_clone->node_by_error = nm->node_by_error;
+
+  /* Count the nodes added since the histograms were enabled */
+  if (nm_clone->histograms)
+    vec_validate (nm_clone->histograms, vec_len (nm_clone->nodes) - 1);
 }
 
 void
@@ -0,0 +1,558 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/devices/devices.h>
+#include <vnet/devices/rx_rebalance.h>
+
+vnet_rx_rebalance_main_t vnet_rx_rebalance_main;
+
+static char *vnet_rx_rebalance_policy_names[] = {
+#define _(sym, str) str,
+  foreach_vnet_rx_rebalance_policy
+#undef _
+};
+
+u8 *
+format_vnet_rx_rebalance_policy (u8 * s, va_list * args)
+{
+  vnet_rx_rebalance_policy_t policy = va_arg (*args, int);
+
+  if (policy >= VNET_RX_REBALANCE_N_POLICY)
+    return format (s, "unknown");
+
+  return format (s, "%s", vnet_rx_rebalance_policy_names[policy]);
+}
+
+uword
+unformat_vnet_rx_rebalance_policy (unformat_input_t * input, va_list * args)
+{
+  vnet_rx_rebalance_policy_t *policy =
+    va_arg (*args, vnet_rx_rebalance_policy_t *);
+
+  if (0)
+    ;
+#define _(sym, str)							\
+  else if (unformat (input, str))					\
+    *policy = VNET_RX_REBALANCE_POLICY_##sym;
+  foreach_vnet_rx_rebalance_policy
+#undef _
+  else
+    return 0;
+
+  return 1;
+}
+
+/* rx packets counted by thread_index for sw_if_index since the last call */
+static u64
+rx_rebalance_rx_packets_delta (vnet_rx_rebalance_main_t * rm,
+			       u32 thread_index, u32 sw_if_index)
+{
+  vnet_interface_main_t *im = &vnet_get_main ()->interface_main;
+  vlib_combined_counter_main_t *cm =
+    im->combined_sw_if_counters + VNET_INTERFACE_COUNTER_RX;
+  vlib_counter_t *counters = cm->counters[thread_index];
+  u64 *last, packets, delta;
+
+  if (sw_if_index >= vec_len (counters))
+    return 0;
+
+  vec_validate (rm->last_rx_packets[thread_index], sw_if_index);
+  last = vec_elt_at_index (rm->last_rx_packets[thread_index], sw_if_index);
+  packets = counters[sw_if_index].packets;
+
+  /* the counters may have been cleared */
+  delta = packets >= last[0] ? packets - last[0] : packets;
+  last[0] = packets;
+  return delta;
+}
+
+static void
+rx_rebalance_sample (vnet_rx_rebalance_main_t * rm, f64 dt)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_rx_rebalance_queue_t *rq;
+  vnet_rx_rebalance_worker_t *w;
+  vnet_hw_interface_t *hw;
+  u32 t, q, first_queue;
+  vlib_main_t *vm;
+
+  for (t = vdm->first_worker_thread_index;
+       t <= vdm->last_worker_thread_index; t++)
+    {
+      u64 vectors, calls;
+
+      vm = vlib_mains[t];
+      w = vec_elt_at_index (rm->workers, t);
+      vectors = vm->internal_node_vectors;
+      calls = vm->internal_node_calls;
+
+      w->vector_rate = calls > w->last_calls ?
+	(f64) (vectors - w->last_vectors) / (calls - w->last_calls) : 0;
+      w->loops_per_second = vm->loops_per_second;
+      w->rx_pps = 0;
+      w->n_queues = 0;
+      w->last_vectors = vectors;
+      w->last_calls = calls;
+    }
+
+  vec_reset_length (rm->queues);
+
+  /* *INDENT-OFF* */
+  pool_foreach (hw, vnm->interface_main.hw_interfaces,
+  ({
+    first_queue = vec_len (rm->queues);
+
+    vec_foreach_index (q, hw->input_node_thread_index_by_queue)
+      {
+	t = hw->input_node_thread_index_by_queue[q];
+	if (q >= vec_len (hw->rx_mode_by_queue) ||
+	    hw->rx_mode_by_queue[q] == VNET_HW_INTERFACE_RX_MODE_UNKNOWN ||
+	    t < vdm->first_worker_thread_index ||
+	    t > vdm->last_worker_thread_index)
+	  continue;
+
+	vec_add2 (rm->queues, rq, 1);
+	rq->hw_if_index = hw->hw_if_index;
+	rq->queue_id = q;
+	rq->thread_index = t;
+	rm->n_queues_by_thread[t]++;
+	rm->workers[t].n_queues++;
+      }
+
+    /*
+     * The rx counters are per thread, not per queue: the queues of the
+     * interface sharing a worker get an even share of its rate.
+     */
+    for (rq = rm->queues + first_queue; rq < vec_end (rm->queues); rq++)
+      {
+	t = rq->thread_index;
+	if (rm->n_queues_by_thread[t])
+	  {
+	    rm->queue_pps_by_thread[t] =
+	      rx_rebalance_rx_packets_delta (rm, t, hw->sw_if_index) / dt /
+	      rm->n_queues_by_thread[t];
+	    rm->n_queues_by_thread[t] = 0;
+	  }
+	rq->rx_pps = rm->queue_pps_by_thread[t];
+	rm->workers[t].rx_pps += rq->rx_pps;
+      }
+  }));
+  /* *INDENT-ON* */
+}
+
+static f64
+rx_rebalance_load (vnet_rx_rebalance_main_t * rm,
+		   vnet_rx_rebalance_worker_t * w)
+{
+  switch (rm->policy)
+    {
+    case VNET_RX_REBALANCE_POLICY_VECTOR_RATE:
+      return w->vector_rate;
+    case VNET_RX_REBALANCE_POLICY_RX_PACKETS:
+      return w->rx_pps;
+    case VNET_RX_REBALANCE_POLICY_QUEUES:
+      return w->n_queues;
+    default:
+      ASSERT (0);
+    }
+  return 0;
+}
+
+static int
+rx_rebalance_is_imbalanced (vnet_rx_rebalance_main_t * rm,
+			    vnet_rx_rebalance_worker_t * hot,
+			    vnet_rx_rebalance_worker_t * cold)
+{
+  f64 hot_load = rx_rebalance_load (rm, hot);
+  f64 cold_load = rx_rebalance_load (rm, cold);
+
+  switch (rm->policy)
+    {
+    case VNET_RX_REBALANCE_POLICY_VECTOR_RATE:
+      if (hot_load < VNET_RX_REBALANCE_MIN_VECTOR_RATE)
+	return 0;
+      break;
+    case VNET_RX_REBALANCE_POLICY_RX_PACKETS:
+      if (hot_load == 0)
+	return 0;
+      break;
+    case VNET_RX_REBALANCE_POLICY_QUEUES:
+      /* a move must not just swap the two */
+      return hot_load >= cold_load + 2;
+    default:
+      ASSERT (0);
+    }
+
+  return (hot_load - cold_load) * 100 >= hot_load * rm->threshold;
+}
+
+/*
+ * The queue of the hot worker whose rate is closest to half of the
+ * difference between the two workers, without moving the problem to the
+ * cold one. None when the hot worker owes its load to a single queue.
+ */
+static vnet_rx_rebalance_queue_t *
+rx_rebalance_pick_queue (vnet_rx_rebalance_main_t * rm, u32 hot, u32 cold)
+{
+  vnet_rx_rebalance_queue_t *rq, *best = 0;
+  f64 diff = rm->workers[hot].rx_pps - rm->workers[cold].rx_pps;
+  f64 best_dist = 0, dist;
+
+  vec_foreach (rq, rm->queues)
+  {
+    if (rq->thread_index != hot)
+      continue;
+
+    if (rm->policy == VNET_RX_REBALANCE_POLICY_QUEUES)
+      {
+	/* traffic blind, but disturb the quietest */
+	if (!best || rq->rx_pps < best->rx_pps)
+	  best = rq;
+	continue;
+      }
+
+    if (rq->rx_pps == 0 || rq->rx_pps >= diff)
+      continue;
+
+    dist = clib_abs (rq->rx_pps - diff / 2);
+    if (!best || dist < best_dist)
+      {
+	best = rq;
+	best_dist = dist;
+      }
+  }
+
+  return best;
+}
+
+static void
+rx_rebalance_move (vnet_rx_rebalance_main_t * rm,
+		   vnet_rx_rebalance_queue_t * rq, u32 thread_index)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_device_main_t *vdm = &vnet_device_main;
+  clib_error_t *error;
+
+  error = set_hw_interface_rx_placement (rq->hw_if_index, rq->queue_id,
+					 thread_index -
+					 vdm->first_worker_thread_index, 0);
+  if (error)
+    {
+      vlib_log_err (rm->log_class, "moving %U queue %u failed: %U",
+		    format_vnet_hw_if_index_name, vnm, rq->hw_if_index,
+		    rq->queue_id, format_clib_error, error);
+      clib_error_free (error);
+      return;
+    }
+
+  vlib_log_notice (rm->log_class, "moved %U queue %u from thread %u "
+		   "(%.2f pps) to thread %u", format_vnet_hw_if_index_name,
+		   vnm, rq->hw_if_index, rq->queue_id, rq->thread_index,
+		   rq->rx_pps, thread_index);
+  rm->n_moves++;
+}
+
+static void
+rx_rebalance_run (vnet_rx_rebalance_main_t * rm)
+{
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_rx_rebalance_queue_t *rq;
+  u32 t, hot = ~0, cold = ~0;
+  f64 load;
+
+  for (t = vdm->first_worker_thread_index;
+       t <= vdm->last_worker_thread_index; t++)
+    {
+      load = rx_rebalance_load (rm, rm->workers + t);
+      if (hot == ~0 || load > rx_rebalance_load (rm, rm->workers + hot))
+	hot = t;
+      if (cold == ~0 || load < rx_rebalance_load (rm, rm->workers + cold))
+	cold = t;
+    }
+
+  if (rm->holddown)
+    {
+      rm->holddown--;
+      return;
+    }
+
+  if (hot == cold ||
+      !rx_rebalance_is_imbalanced (rm, rm->workers + hot,
+				   rm->workers + cold))
+    {
+      rm->n_imbalanced = 0;
+      return;
+    }
+
+  if (++rm->n_imbalanced < rm->hysteresis)
+    return;
+
+  rq = rx_rebalance_pick_queue (rm, hot, cold);
+  if (!rq)
+    return;
+
+  rx_rebalance_move (rm, rq, cold);
+  rm->n_imbalanced = 0;
+  rm->holddown = rm->hysteresis;
+}
+
+static uword
+rx_rebalance_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
+		      vlib_frame_t * f)
+{
+  vnet_rx_rebalance_main_t *rm = &vnet_rx_rebalance_main;
+  f64 now;
+
+  while (1)
+    {
+      if (rm->enabled)
+	vlib_process_wait_for_event_or_clock (vm, rm->interval);
+      else
+	vlib_process_wait_for_event (vm);
+
+      /* (re)configured, start sampling over */
+      if (vlib_process_get_events (vm, 0) != ~0)
+	rm->last_sample_time = 0;
+
+      if (!rm->enabled)
+	continue;
+
+      now = vlib_time_now (vm);
+      if (rm->last_sample_time == 0)
+	{
+	  rx_rebalance_sample (rm, 1);
+	  rm->last_sample_time = now;
+	  continue;
+	}
+
+      rx_rebalance_sample (rm, now - rm->last_sample_time);
+      rm->last_sample_time = now;
+      rx_rebalance_run (rm);
+    }
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (rx_rebalance_process_node, static) = {
+  .function = rx_rebalance_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "rx-rebalance-process",
+};
+/* *INDENT-ON* */
+
+int
+vnet_rx_rebalance_enable_disable (u8 enable,
+				  vnet_rx_rebalance_policy_t policy,
+				  f64 interval, u32 threshold,
+				  u32 hysteresis)
+{
+  vnet_rx_rebalance_main_t *rm = &vnet_rx_rebalance_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+
+  if (enable)
+    {
+      if (vdm->first_worker_thread_index == 0)
+	return VNET_API_ERROR_UNSUPPORTED;
+
+      if (policy >= VNET_RX_REBALANCE_N_POLICY || interval <= 0 ||
+	  threshold > 100 || hysteresis == 0)
+	return VNET_API_ERROR_INVALID_VALUE;
+
+      rm->policy = policy;
+      rm->interval = interval;
+      rm->threshold = threshold;
+      rm->hysteresis = hysteresis;
+    }
+
+  rm->enabled = enable;
+  rm->n_imbalanced = 0;
+  rm->holddown = 0;
+
+  vlib_process_signal_event (vlib_get_main (),
+			     rx_rebalance_process_node.index, 0, 0);
+  return 0;
+}
+
+static clib_error_t *
+set_interface_rx_rebalance_command_fn (vlib_main_t * vm,
+				       unformat_input_t * input,
+				       vlib_cli_command_t * cmd)
+{
+  vnet_rx_rebalance_main_t *rm = &vnet_rx_rebalance_main;
+  vnet_rx_rebalance_policy_t policy = rm->policy;
+  u32 threshold = rm->threshold, hysteresis = rm->hysteresis;
+  f64 interval = rm->interval;
+  u8 enable = 1;
+  int rv;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "disable"))
+	enable = 0;
+      else if (unformat (input, "policy %U",
+			 unformat_vnet_rx_rebalance_policy, &policy))
+	;
+      else if (unformat (input, "interval %f", &interval))
+	;
+      else if (unformat (input, "threshold %u", &threshold))
+	;
+      else if (unformat (input, "hysteresis %u", &hysteresis))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  rv = vnet_rx_rebalance_enable_disable (enable, policy, interval,
+					 threshold, hysteresis);
+  switch (rv)
+    {
+    case 0:
+      break;
+    case VNET_API_ERROR_UNSUPPORTED:
+      return clib_error_return (0, "rx rebalancing needs worker threads");
+    case VNET_API_ERROR_INVALID_VALUE:
+      return clib_error_return (0, "invalid interval, threshold or "
+				"hysteresis");
+    default:
+      return clib_error_return (0, "failed: %d", rv);
+    }
+
+  return 0;
+}
+
+/*?
+ * Move the rx queues between the workers according to their load.
+ * Every '<em>interval</em>' seconds the load of each worker is sampled
+ * according to the '<em>policy</em>':
+ * - '<em>vector-rate</em>' (default): vectors per internal node call.
+ *   A worker below a vector rate of 16 is not considered busy.
+ * - '<em>rx-packets</em>': packets per second received by its queues.
+ * - '<em>queues</em>': number of rx queues placed on it, ignoring the
+ *   threshold.
+ *
+ * When the load of the least busy worker stays below that of the busiest
+ * one by more than '<em>threshold</em>' percent for '<em>hysteresis</em>'
+ * intervals in a row, the queue of the busiest worker which best evens
+ * out their rx rates is moved to the least busy one, then no other move
+ * is made for '<em>hysteresis</em>' intervals. Placements made with
+ * '<em>set interface rx-placement</em>' are subject to rebalancing too.
+ *
+ * @cliexpar
+ * @cliexcmd{set interface rx-rebalance policy rx-packets interval 2 threshold 30}
+ * @cliexcmd{set interface rx-rebalance disable}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (set_interface_rx_rebalance_command, static) = {
+  .path = "set interface rx-rebalance",
+  .short_help = "set interface rx-rebalance [disable] "
+    "[policy vector-rate|rx-packets|queues] [interval <sec>] "
+    "[threshold <percent>] [hysteresis <n>]",
+  .function = set_interface_rx_rebalance_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+show_interface_rx_rebalance_command_fn (vlib_main_t * vm,
+					unformat_input_t * input,
+					vlib_cli_command_t * cmd)
+{
+  vnet_rx_rebalance_main_t *rm = &vnet_rx_rebalance_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_rx_rebalance_queue_t *rq;
+  vnet_rx_rebalance_worker_t *w;
+  u32 t;
+
+  vlib_cli_output (vm, "rx rebalancing %s, policy %U, interval %.2fs, "
+		   "threshold %u%%, hysteresis %u, moves %llu",
+		   rm->enabled ? "enabled" : "disabled",
+		   format_vnet_rx_rebalance_policy, rm->policy, rm->interval,
+		   rm->threshold, rm->hysteresis, rm->n_moves);
+
+  if (!rm->enabled || rm->last_sample_time == 0 ||
+      vdm->first_worker_thread_index == 0)
+    return 0;
+
+  for (t = vdm->first_worker_thread_index;
+       t <= vdm->last_worker_thread_index; t++)
+    {
+      w = vec_elt_at_index (rm->workers, t);
+      vlib_cli_output (vm, "Thread %u (%s): vector rate %.2f, "
+		       "loops/sec %.2f, rx %.2f pps, queues %u", t,
+		       vlib_worker_threads[t].name, w->vector_rate,
+		       w->loops_per_second, w->rx_pps, w->n_queues);
+      vec_foreach (rq, rm->queues)
+	if (rq->thread_index == t)
+	vlib_cli_output (vm, "  %U queue %u: %.2f pps",
+			 format_vnet_hw_if_index_name, vnm, rq->hw_if_index,
+			 rq->queue_id, rq->rx_pps);
+    }
+
+  return 0;
+}
+
+/*?
+ * Show the rx rebalancing configuration and the loads sampled last.
+ *
+ * @cliexpar
+ * @cliexstart{show interface rx-rebalance}
+ * rx rebalancing enabled, policy rx-packets, interval 2.00s, threshold 30%, hysteresis 3, moves 1
+ * Thread 1 (vpp_wk_0): vector rate 3.52, loops/sec 1103311.52, rx 52110.00 pps, queues 1
+ *   tap0 queue 0: 52110.00 pps
+ * Thread 2 (vpp_wk_1): vector rate 3.31, loops/sec 1123908.87, rx 49821.00 pps, queues 1
+ *   tap0 queue 1: 49821.00 pps
+ * @cliexend
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_interface_rx_rebalance_command, static) = {
+  .path = "show interface rx-rebalance",
+  .short_help = "show interface rx-rebalance",
+  .function = show_interface_rx_rebalance_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+rx_rebalance_init (vlib_main_t * vm)
+{
+  vnet_rx_rebalance_main_t *rm = &vnet_rx_rebalance_main;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+
+  rm->policy = VNET_RX_REBALANCE_POLICY_VECTOR_RATE;
+  rm->interval = VNET_RX_REBALANCE_DEFAULT_INTERVAL;
+  rm->threshold = VNET_RX_REBALANCE_DEFAULT_THRESHOLD;
+  rm->hysteresis = VNET_RX_REBALANCE_DEFAULT_HYSTERESIS;
+
+  vec_validate (rm->workers, tm->n_vlib_mains - 1);
+  vec_validate (rm->last_rx_packets, tm->n_vlib_mains - 1);
+  vec_validate (rm->n_queues_by_thread, tm->n_vlib_mains - 1);
+  vec_validate (rm->queue_pps_by_thread, tm->n_vlib_mains - 1);
+
+  rm->log_class = vlib_log_register_class ("interface", "rx-rebalance");
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (rx_rebalance_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef included_vnet_devices_rx_rebalance_h
+#define included_vnet_devices_rx_rebalance_h
+
+/**
+ * @file
+ * @brief Load-aware placement of the rx queues on the workers.
+ *
+ * When enabled, a process samples the load of each worker and the rx
+ * rate of each queue placed on them every interval. When the busiest
+ * and the least busy workers stay apart by more than the threshold for
+ * hysteresis intervals in a row, the queue of the busiest worker which
+ * best evens out their rx rates is moved to the least busy one, as with
+ * "set interface rx-placement". No other move is made for the next
+ * hysteresis intervals.
+ */
+
+#include <vnet/vnet.h>
+
+#define foreach_vnet_rx_rebalance_policy			\
+  _(VECTOR_RATE, "vector-rate")					\
+  _(RX_PACKETS, "rx-packets")					\
+  _(QUEUES, "queues")
+
+/**
+ * What the load of a worker is:
+ * - vector-rate: vectors per internal node call, how busy it is
+ * - rx-packets: packets per second received by its queues
+ * - queues: number of rx queues placed on it, traffic blind
+ */
+typedef enum
+{
+#define _(sym, str) VNET_RX_REBALANCE_POLICY_##sym,
+  foreach_vnet_rx_rebalance_policy
+#undef _
+    VNET_RX_REBALANCE_N_POLICY,
+} vnet_rx_rebalance_policy_t;
+
+/* below this vector rate a worker is not busy enough to need help */
+#define VNET_RX_REBALANCE_MIN_VECTOR_RATE 16
+
+typedef struct
+{
+  /* counters at the last sample */
+  u64 last_vectors;
+  u64 last_calls;
+
+  /* over the last interval */
+  f64 vector_rate;
+  f64 loops_per_second;
+  f64 rx_pps;
+  u32 n_queues;
+} vnet_rx_rebalance_worker_t;
+
+typedef struct
+{
+  u32 hw_if_index;
+  u16 queue_id;
+  u32 thread_index;
+  f64 rx_pps;
+} vnet_rx_rebalance_queue_t;
+
+typedef struct
+{
+  /* configuration */
+  u8 enabled;
+  vnet_rx_rebalance_policy_t policy;
+  f64 interval;
+  u32 threshold;
+  u32 hysteresis;
+
+  /* intervals the workers were seen imbalanced in a row */
+  u32 n_imbalanced;
+
+  /* intervals to wait after a move */
+  u32 holddown;
+
+  f64 last_sample_time;
+
+  /* per thread index */
+  vnet_rx_rebalance_worker_t *workers;
+
+  /* rx packets counter at the last sample, per thread and sw_if_index */
+  u64 **last_rx_packets;
+
+  /* queues placed on the workers at the last sample */
+  vnet_rx_rebalance_queue_t *queues;
+
+  /* scratch, per thread index */
+  u32 *n_queues_by_thread;
+  f64 *queue_pps_by_thread;
+
+  u64 n_moves;
+
+  u32 process_node_index;
+  vlib_log_class_t log_class;
+} vnet_rx_rebalance_main_t;
+
+extern vnet_rx_rebalance_main_t vnet_rx_rebalance_main;
+
+#define VNET_RX_REBALANCE_DEFAULT_INTERVAL 5.0
+#define VNET_RX_REBALANCE_DEFAULT_THRESHOLD 25
+#define VNET_RX_REBALANCE_DEFAULT_HYSTERESIS 3
+
+/**
+ * Enable or reconfigure the rebalancing.
+ * @param interval seconds between two samples
+ * @param threshold minimum difference between the loads of the busiest
+ *        and the least busy workers, in percent of the former
+ * @param hysteresis number of intervals the imbalance must last
+ */
+int vnet_rx_rebalance_enable_disable (u8 enable,
+				      vnet_rx_rebalance_policy_t policy,
+				      f64 interval, u32 threshold,
+				      u32 hysteresis);
+
+format_function_t format_vnet_rx_rebalance_policy;
+unformat_function_t unformat_vnet_rx_rebalance_policy;
+
+#endif /* included_vnet_devices_rx_rebalance_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
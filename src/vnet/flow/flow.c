@@ -17,6 +17,7 @@
 #include <vnet/ip/ip.h>
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/flow/flow.h>
+#include <vnet/flow/flow_sw.h>
 
 vnet_flow_main_t flow_main;
 
@@ -109,8 +110,16 @@ vnet_flow_enable (vnet_main_t * vnm, u32 flow_index, u32 hw_if_index)
   hi = vnet_get_hw_interface (vnm, hw_if_index);
   dev_class = vnet_get_device_class (vnm, hi->dev_class_index);
 
+  /* no offload, the software engine matches the flow instead */
   if (dev_class->flow_ops_function == 0)
-    return VNET_FLOW_ERROR_NOT_SUPPORTED;
+    {
+      rv = vnet_flow_sw_add (vnm, f, hw_if_index, &private_data);
+      if (rv)
+	return rv;
+
+      hash_set (f->private_data, hw_if_index, private_data);
+      return 0;
+    }
 
   if (f->actions & VNET_FLOW_ACTION_REDIRECT_TO_NODE)
     {
@@ -153,8 +162,11 @@ vnet_flow_disable (vnet_main_t * vnm, u32 flow_index, u32 hw_if_index)
   hi = vnet_get_hw_interface (vnm, hw_if_index);
   dev_class = vnet_get_device_class (vnm, hi->dev_class_index);
 
-  rv = dev_class->flow_ops_function (vnm, VNET_FLOW_DEV_OP_DEL_FLOW,
-				     hi->dev_instance, flow_index, p);
+  if (dev_class->flow_ops_function == 0)
+    rv = vnet_flow_sw_del (vnm, hw_if_index, p[0]);
+  else
+    rv = dev_class->flow_ops_function (vnm, VNET_FLOW_DEV_OP_DEL_FLOW,
+				       hi->dev_instance, flow_index, p);
 
   if (rv)
     return rv;
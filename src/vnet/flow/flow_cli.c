@@ -18,6 +18,7 @@
 #include <vnet/ip/ip.h>
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/flow/flow.h>
+#include <vnet/flow/flow_sw.h>
 
 static format_function_t format_flow;
 
@@ -165,6 +166,9 @@ show_flow_entry (vlib_main_t * vm, unformat_input_t * input,
 	  if (dev_class->format_flow)
 	    vlib_cli_output (vm,  "  %U\n", dev_class->format_flow,
 			     hi->dev_instance, f->index, private_data);
+	  else if (dev_class->flow_ops_function == 0)
+	    vlib_cli_output (vm,  "  %U\n", format_vnet_flow_sw_rule,
+			     private_data);
          }));
       /* *INDENT-ON* */
       return 0;
@@ -245,7 +249,13 @@ show_flow_interface (vlib_main_t * vm, unformat_input_t * input,
   hi = vnet_get_hw_interface (vnm, hw_if_index);
   dev_class = vnet_get_device_class (vnm, hi->dev_class_index);
   if (dev_class->format_flow == 0)
-    return clib_error_return (0, "not supported");
+    {
+      if (dev_class->flow_ops_function)
+	return clib_error_return (0, "not supported");
+
+      vlib_cli_output (vm, "%U", format_vnet_flow_sw_interface, hw_if_index);
+      return 0;
+    }
 
   vlib_cli_output (vm, "%U", dev_class->format_flow, hi->dev_instance, ~0, 0);
   return 0;
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ip/ip.h>
+#include <vnet/udp/udp.h>
+#include <vnet/feature/feature.h>
+#include <vnet/flow/flow_sw.h>
+
+vnet_flow_sw_main_t vnet_flow_sw_main;
+
+/* GTPv1-C, not registered with the udp dispatch */
+#define FLOW_SW_UDP_DST_PORT_GTPC 2123
+
+static void
+flow_sw_set_ip4 (vnet_flow_sw_key_t * key, vnet_flow_sw_key_t * mask,
+		 ip4_address_and_mask_t * src, ip4_address_and_mask_t * dst)
+{
+  ip46_address_set_ip4 (&key->src, &src->addr);
+  ip46_address_set_ip4 (&mask->src, &src->mask);
+  ip46_address_set_ip4 (&key->dst, &dst->addr);
+  ip46_address_set_ip4 (&mask->dst, &dst->mask);
+}
+
+static void
+flow_sw_set_ip6 (vnet_flow_sw_key_t * key, vnet_flow_sw_key_t * mask,
+		 ip6_address_and_mask_t * src, ip6_address_and_mask_t * dst)
+{
+  key->src.ip6 = src->addr;
+  mask->src.ip6 = src->mask;
+  key->dst.ip6 = dst->addr;
+  mask->dst.ip6 = dst->mask;
+}
+
+static void
+flow_sw_set_ports (vnet_flow_sw_key_t * key, vnet_flow_sw_key_t * mask,
+		   ip_port_and_mask_t * src, ip_port_and_mask_t * dst)
+{
+  key->src_port = clib_host_to_net_u16 (src->port);
+  mask->src_port = clib_host_to_net_u16 (src->mask);
+  key->dst_port = clib_host_to_net_u16 (dst->port);
+  mask->dst_port = clib_host_to_net_u16 (dst->mask);
+}
+
+/*
+ * Translate a flow into the (unmasked) key of its rule and the profile
+ * it is matched with. The tunnel types imply their udp port unless the
+ * flow gives one.
+ */
+static int
+flow_sw_rule_from_flow (vnet_flow_t * f, vnet_flow_sw_key_t * key,
+			vnet_flow_sw_profile_t * p)
+{
+  vnet_flow_sw_key_t *mask = &p->mask;
+  ip4_address_t ip4_exact = {.as_u32 = ~0 };
+  u16 dst_port = 0;
+  int i;
+
+  clib_memset (key, 0, sizeof (*key));
+  clib_memset (p, 0, sizeof (*p));
+  p->id_offset = VNET_FLOW_SW_NO_ID_OFFSET;
+
+  switch (f->type)
+    {
+    case VNET_FLOW_TYPE_IP4_N_TUPLE_TAGGED:
+      p->flags |= VNET_FLOW_SW_PROFILE_F_TAGGED;
+      /* fall through */
+    case VNET_FLOW_TYPE_IP4_N_TUPLE:
+    case VNET_FLOW_TYPE_IP4_GTPC:
+    case VNET_FLOW_TYPE_IP4_GTPU:
+      flow_sw_set_ip4 (key, mask, &f->ip4_n_tuple.src_addr,
+		       &f->ip4_n_tuple.dst_addr);
+      flow_sw_set_ports (key, mask, &f->ip4_n_tuple.src_port,
+			 &f->ip4_n_tuple.dst_port);
+      key->protocol = f->ip4_n_tuple.protocol;
+      break;
+
+    case VNET_FLOW_TYPE_IP6_N_TUPLE_TAGGED:
+      p->flags |= VNET_FLOW_SW_PROFILE_F_TAGGED;
+      /* fall through */
+    case VNET_FLOW_TYPE_IP6_N_TUPLE:
+    case VNET_FLOW_TYPE_IP6_GTPC:
+    case VNET_FLOW_TYPE_IP6_GTPU:
+      p->flags |= VNET_FLOW_SW_PROFILE_F_IP6;
+      flow_sw_set_ip6 (key, mask, &f->ip6_n_tuple.src_addr,
+		       &f->ip6_n_tuple.dst_addr);
+      flow_sw_set_ports (key, mask, &f->ip6_n_tuple.src_port,
+			 &f->ip6_n_tuple.dst_port);
+      key->protocol = f->ip6_n_tuple.protocol;
+      break;
+
+    case VNET_FLOW_TYPE_IP4_L2TPV3OIP:
+      flow_sw_set_ip4 (key, mask, &f->ip4_l2tpv3oip.src_addr,
+		       &f->ip4_l2tpv3oip.dst_addr);
+      key->protocol = f->ip4_l2tpv3oip.protocol;
+      /* the session id starts the l2tpv3 over ip header */
+      p->id_offset = 0;
+      key->id = clib_host_to_net_u32 (f->ip4_l2tpv3oip.session_id);
+      mask->id = ~0;
+      break;
+
+    case VNET_FLOW_TYPE_IP4_VXLAN:
+    case VNET_FLOW_TYPE_IP6_VXLAN:
+      if (f->type == VNET_FLOW_TYPE_IP4_VXLAN)
+	{
+	  ip46_address_set_ip4 (&key->src, &f->ip4_vxlan.src_addr);
+	  ip46_address_set_ip4 (&key->dst, &f->ip4_vxlan.dst_addr);
+	  ip46_address_set_ip4 (&mask->src, &ip4_exact);
+	  ip46_address_set_ip4 (&mask->dst, &ip4_exact);
+	  dst_port = f->ip4_vxlan.dst_port;
+	  key->id = f->ip4_vxlan.vni;
+	}
+      else
+	{
+	  p->flags |= VNET_FLOW_SW_PROFILE_F_IP6;
+	  key->src.ip6 = f->ip6_vxlan.src_addr;
+	  key->dst.ip6 = f->ip6_vxlan.dst_addr;
+	  clib_memset (&mask->src, 0xff, sizeof (mask->src));
+	  clib_memset (&mask->dst, 0xff, sizeof (mask->dst));
+	  dst_port = f->ip6_vxlan.dst_port;
+	  key->id = f->ip6_vxlan.vni;
+	}
+      key->protocol = IP_PROTOCOL_UDP;
+      key->dst_port = clib_host_to_net_u16 (dst_port);
+      mask->dst_port = ~0;
+      /* 24 bit vni after the flags and reserved bytes */
+      p->id_offset = sizeof (udp_header_t) + sizeof (u32);
+      key->id = clib_host_to_net_u32 (key->id << 8);
+      mask->id = clib_host_to_net_u32 (0xffffff00);
+      break;
+
+    default:
+      return VNET_FLOW_ERROR_NOT_SUPPORTED;
+    }
+
+  switch (f->type)
+    {
+    case VNET_FLOW_TYPE_IP4_GTPC:
+    case VNET_FLOW_TYPE_IP6_GTPC:
+      dst_port = FLOW_SW_UDP_DST_PORT_GTPC;
+      key->id = clib_host_to_net_u32 (f->type == VNET_FLOW_TYPE_IP4_GTPC ?
+				      f->ip4_gtpc.teid : f->ip6_gtpc.teid);
+      break;
+    case VNET_FLOW_TYPE_IP4_GTPU:
+    case VNET_FLOW_TYPE_IP6_GTPU:
+      dst_port = UDP_DST_PORT_GTPU;
+      key->id = clib_host_to_net_u32 (f->type == VNET_FLOW_TYPE_IP4_GTPU ?
+				      f->ip4_gtpu.teid : f->ip6_gtpu.teid);
+      break;
+    default:
+      dst_port = 0;
+      break;
+    }
+
+  if (dst_port)
+    {
+      /* teid follows the gtp flags, type and length */
+      if (key->protocol != IP_PROTOCOL_UDP)
+	return VNET_FLOW_ERROR_NOT_SUPPORTED;
+      if (mask->dst_port == 0)
+	{
+	  key->dst_port = clib_host_to_net_u16 (dst_port);
+	  mask->dst_port = ~0;
+	}
+      p->id_offset = sizeof (udp_header_t) + sizeof (u32);
+      mask->id = ~0;
+    }
+
+  mask->protocol = ~0;
+
+  for (i = 0; i < ARRAY_LEN (key->as_u64); i++)
+    key->as_u64[i] &= mask->as_u64[i];
+
+  return 0;
+}
+
+static u32
+flow_sw_profile_get (vnet_flow_sw_main_t * fsm, vnet_flow_sw_profile_t * tmpl)
+{
+  vnet_flow_sw_profile_t *p;
+
+  /* *INDENT-OFF* */
+  pool_foreach (p, fsm->profiles,
+  ({
+    if (p->flags == tmpl->flags && p->id_offset == tmpl->id_offset &&
+        !memcmp (&p->mask, &tmpl->mask, sizeof (p->mask)))
+      return p - fsm->profiles;
+  }));
+  /* *INDENT-ON* */
+
+  if (pool_elts (fsm->profiles) >= (u16) ~ 0)
+    return ~0;
+
+  pool_get (fsm->profiles, p);
+  *p = *tmpl;
+  p->n_rules = 0;
+  return p - fsm->profiles;
+}
+
+static void
+flow_sw_profile_put (vnet_flow_sw_main_t * fsm, u32 profile_index)
+{
+  vnet_flow_sw_profile_t *p = pool_elt_at_index (fsm->profiles,
+						  profile_index);
+
+  if (p->n_rules == 0)
+    pool_put (fsm->profiles, p);
+}
+
+/*
+ * Flow ops run with the worker barrier held, as for the device drivers,
+ * so the per-interface profile vectors read by flow-sw-input can be
+ * resized in place.
+ */
+int
+vnet_flow_sw_add (vnet_main_t * vnm, vnet_flow_t * f, u32 hw_if_index,
+		  uword * private_data)
+{
+  vnet_flow_sw_main_t *fsm = &vnet_flow_sw_main;
+  vlib_main_t *vm = vlib_get_main ();
+  vnet_hw_interface_t *hi = vnet_get_hw_interface (vnm, hw_if_index);
+  vnet_flow_sw_interface_t *itf;
+  vnet_flow_sw_profile_t tmpl;
+  vnet_flow_sw_key_t key;
+  vnet_flow_sw_rule_t *r;
+  clib_bihash_kv_48_8_t kv;
+  u32 profile_index, rule_index, i;
+  int rv;
+
+  if (f->actions == 0 ||
+      (f->actions & (VNET_FLOW_ACTION_REDIRECT_TO_QUEUE |
+		     VNET_FLOW_ACTION_RSS)))
+    return VNET_FLOW_ERROR_NOT_SUPPORTED;
+
+  if ((rv = flow_sw_rule_from_flow (f, &key, &tmpl)))
+    return rv;
+
+  if (fsm->rule_table.nbuckets == 0)
+    clib_bihash_init_48_8 (&fsm->rule_table, "flow sw rules",
+			   VNET_FLOW_SW_TABLE_BUCKETS,
+			   VNET_FLOW_SW_TABLE_MEMORY);
+
+  profile_index = flow_sw_profile_get (fsm, &tmpl);
+  if (profile_index == ~0)
+    return VNET_FLOW_ERROR_INTERNAL;
+
+  key.profile_index = profile_index;
+  key.sw_if_index = hi->sw_if_index;
+  clib_memcpy_fast (kv.key, key.as_u64, sizeof (kv.key));
+
+  if (!clib_bihash_search_48_8 (&fsm->rule_table, &kv, &kv))
+    {
+      flow_sw_profile_put (fsm, profile_index);
+      return VNET_FLOW_ERROR_ALREADY_EXISTS;
+    }
+
+  pool_get_zero (fsm->rules, r);
+  rule_index = r - fsm->rules;
+  r->flow_index = f->index;
+  r->hw_if_index = hw_if_index;
+  r->key = key;
+  r->actions = f->actions;
+  r->mark_flow_id = f->mark_flow_id;
+  r->buffer_advance = f->buffer_advance;
+  r->next_index = ~0;
+  if (f->actions & VNET_FLOW_ACTION_REDIRECT_TO_NODE)
+    r->next_index = vlib_node_add_next (vm, vnet_flow_sw_input_node.index,
+					f->redirect_node_index);
+
+  vlib_validate_combined_counter (&fsm->rule_counters, rule_index);
+  vlib_zero_combined_counter (&fsm->rule_counters, rule_index);
+
+  vec_validate (fsm->interfaces, hi->sw_if_index);
+  itf = vec_elt_at_index (fsm->interfaces, hi->sw_if_index);
+
+  vec_foreach_index (i, itf->profile_indices)
+    if (itf->profile_indices[i] == profile_index)
+    break;
+  if (i == vec_len (itf->profile_indices))
+    {
+      vec_add1 (itf->profile_indices, profile_index);
+      vec_add1 (itf->profile_n_rules, 0);
+    }
+  itf->profile_n_rules[i]++;
+  pool_elt_at_index (fsm->profiles, profile_index)->n_rules++;
+
+  kv.value = rule_index;
+  clib_bihash_add_del_48_8 (&fsm->rule_table, &kv, 1 /* is_add */ );
+
+  if (vec_len (itf->profile_indices) == 1 && itf->profile_n_rules[0] == 1)
+    vnet_feature_enable_disable ("device-input", "flow-sw-input",
+				 hi->sw_if_index, 1, 0, 0);
+
+  *private_data = rule_index;
+  return 0;
+}
+
+int
+vnet_flow_sw_del (vnet_main_t * vnm, u32 hw_if_index, uword private_data)
+{
+  vnet_flow_sw_main_t *fsm = &vnet_flow_sw_main;
+  vnet_flow_sw_interface_t *itf;
+  vnet_flow_sw_rule_t *r;
+  clib_bihash_kv_48_8_t kv;
+  u32 profile_index, sw_if_index, i;
+
+  if (pool_is_free_index (fsm->rules, private_data))
+    return VNET_FLOW_ERROR_NO_SUCH_ENTRY;
+
+  r = pool_elt_at_index (fsm->rules, private_data);
+  profile_index = r->key.profile_index;
+  sw_if_index = r->key.sw_if_index;
+
+  clib_memcpy_fast (kv.key, r->key.as_u64, sizeof (kv.key));
+  clib_bihash_add_del_48_8 (&fsm->rule_table, &kv, 0 /* is_add */ );
+
+  itf = vec_elt_at_index (fsm->interfaces, sw_if_index);
+  vec_foreach_index (i, itf->profile_indices)
+    if (itf->profile_indices[i] == profile_index)
+    break;
+  ASSERT (i < vec_len (itf->profile_indices));
+  if (--itf->profile_n_rules[i] == 0)
+    {
+      vec_delete (itf->profile_indices, 1, i);
+      vec_delete (itf->profile_n_rules, 1, i);
+    }
+  pool_elt_at_index (fsm->profiles, profile_index)->n_rules--;
+  flow_sw_profile_put (fsm, profile_index);
+
+  if (vec_len (itf->profile_indices) == 0)
+    vnet_feature_enable_disable ("device-input", "flow-sw-input",
+				 sw_if_index, 0, 0, 0);
+
+  pool_put (fsm->rules, r);
+  return 0;
+}
+
+u8 *
+format_vnet_flow_sw_rule (u8 * s, va_list * args)
+{
+  vnet_flow_sw_main_t *fsm = &vnet_flow_sw_main;
+  u32 rule_index = va_arg (*args, u32);
+  vlib_counter_t c;
+
+  if (pool_is_free_index (fsm->rules, rule_index))
+    return format (s, "no such software rule");
+
+  vlib_get_combined_counter (&fsm->rule_counters, rule_index, &c);
+  s = format (s, "software rule %u profile %u matched %llu packets %llu bytes",
+	      rule_index, fsm->rules[rule_index].key.profile_index,
+	      c.packets, c.bytes);
+  return s;
+}
+
+u8 *
+format_vnet_flow_sw_interface (u8 * s, va_list * args)
+{
+  vnet_flow_sw_main_t *fsm = &vnet_flow_sw_main;
+  u32 hw_if_index = va_arg (*args, u32);
+  vnet_flow_sw_rule_t *r;
+  u32 n_rules = 0;
+
+  s = format (s, "software flow engine");
+
+  /* *INDENT-OFF* */
+  pool_foreach (r, fsm->rules,
+  ({
+    if (r->hw_if_index != hw_if_index)
+      continue;
+    s = format (s, "\n  flow %u: %U", r->flow_index,
+                format_vnet_flow_sw_rule, r - fsm->rules);
+    n_rules++;
+  }));
+  /* *INDENT-ON* */
+
+  if (n_rules == 0)
+    s = format (s, "\n  no flows enabled");
+
+  return s;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef included_vnet_flow_flow_sw_h
+#define included_vnet_flow_flow_sw_h
+
+/**
+ * @file
+ * @brief Software flow engine.
+ *
+ * Emulates the rx flow offload of vnet/flow for interfaces whose device
+ * class has no flow_ops_function (tap, af_packet, memif, virtio, pg...).
+ * Enabled flows become exact-match rules in a bihash, matched by the
+ * flow-sw-input feature on the device-input arc which then applies the
+ * MARK, BUFFER_ADVANCE, REDIRECT_TO_NODE and DROP actions the way a NIC
+ * would. Address and port masks are supported: every distinct set of
+ * masks in use on an interface is a match profile, probed in the order
+ * it was first used.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/flow/flow.h>
+#include <vppinfra/bihash_48_8.h>
+
+/**
+ * Packet fields a rule matches on, in network byte order. Also used as
+ * the mask of a profile and, once masked, as the bihash key.
+ */
+typedef union
+{
+  struct
+  {
+    ip46_address_t src;
+    ip46_address_t dst;
+    u16 src_port;
+    u16 dst_port;
+    /* gtp teid, vxlan vni or l2tpv3 session id */
+    u32 id;
+    u8 protocol;
+    u8 __pad;
+    u16 profile_index;
+    u32 sw_if_index;
+  };
+  u64 as_u64[6];
+} vnet_flow_sw_key_t;
+
+STATIC_ASSERT_SIZEOF (vnet_flow_sw_key_t, 48);
+
+#define VNET_FLOW_SW_PROFILE_F_IP6 (1 << 0)
+#define VNET_FLOW_SW_PROFILE_F_TAGGED (1 << 1)
+
+/* no tunnel id in the match */
+#define VNET_FLOW_SW_NO_ID_OFFSET ((u8) ~0)
+
+typedef struct
+{
+  /** VNET_FLOW_SW_PROFILE_F_* the packet must agree with */
+  u8 flags;
+
+  /** offset of the tunnel id from the l4 header */
+  u8 id_offset;
+
+  /** fields taking part in the match */
+  vnet_flow_sw_key_t mask;
+
+  /** number of rules using the profile, all interfaces */
+  u32 n_rules;
+} vnet_flow_sw_profile_t;
+
+typedef struct
+{
+  u32 flow_index;
+  u32 hw_if_index;
+  vnet_flow_sw_key_t key;
+
+  /* actions copied from the flow */
+  u32 actions;
+  u32 mark_flow_id;
+  i32 buffer_advance;
+  u16 next_index;
+} vnet_flow_sw_rule_t;
+
+typedef struct
+{
+  /** profiles used by the rules of the interface, probed in order */
+  u16 *profile_indices;
+  u32 *profile_n_rules;
+} vnet_flow_sw_interface_t;
+
+typedef struct
+{
+  /** rules of all interfaces, keyed on vnet_flow_sw_key_t */
+  clib_bihash_48_8_t rule_table;
+
+  vnet_flow_sw_profile_t *profiles;
+  vnet_flow_sw_rule_t *rules;
+
+  /** per sw_if_index */
+  vnet_flow_sw_interface_t *interfaces;
+
+  /** per rule packets and bytes matched */
+  vlib_combined_counter_main_t rule_counters;
+} vnet_flow_sw_main_t;
+
+#define VNET_FLOW_SW_TABLE_BUCKETS (64 * 1024)
+#define VNET_FLOW_SW_TABLE_MEMORY (256 << 20)
+
+extern vnet_flow_sw_main_t vnet_flow_sw_main;
+extern vlib_node_registration_t vnet_flow_sw_input_node;
+
+int vnet_flow_sw_add (vnet_main_t * vnm, vnet_flow_t * f, u32 hw_if_index,
+		      uword * private_data);
+int vnet_flow_sw_del (vnet_main_t * vnm, u32 hw_if_index,
+		      uword private_data);
+
+format_function_t format_vnet_flow_sw_rule;
+format_function_t format_vnet_flow_sw_interface;
+
+#endif /* included_vnet_flow_flow_sw_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
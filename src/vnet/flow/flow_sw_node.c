@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2020 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/feature/feature.h>
+#include <vnet/flow/flow_sw.h>
+
+#define foreach_flow_sw_input_error			\
+  _(MATCHED, "flow rule matched")			\
+  _(DROP, "dropped by flow rule")
+
+typedef enum
+{
+#define _(sym,str) FLOW_SW_INPUT_ERROR_##sym,
+  foreach_flow_sw_input_error
+#undef _
+    FLOW_SW_INPUT_N_ERROR,
+} flow_sw_input_error_t;
+
+typedef enum
+{
+  FLOW_SW_INPUT_NEXT_DROP,
+  FLOW_SW_INPUT_N_NEXT,
+} flow_sw_input_next_t;
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 rule_index;
+  u32 flow_index;
+  u32 next_index;
+} flow_sw_input_trace_t;
+
+static char *flow_sw_input_error_strings[] = {
+#define _(sym,string) string,
+  foreach_flow_sw_input_error
+#undef _
+};
+
+static u8 *
+format_flow_sw_input_trace (u8 * s, va_list * args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  flow_sw_input_trace_t *t = va_arg (*args, flow_sw_input_trace_t *);
+
+  if (t->rule_index == ~0)
+    return format (s, "FLOW_SW: sw_if_index %d no match next %d",
+		   t->sw_if_index, t->next_index);
+
+  return format (s, "FLOW_SW: sw_if_index %d flow %d rule %d next %d",
+		 t->sw_if_index, t->flow_index, t->rule_index,
+		 t->next_index);
+}
+
+/* not ip, the packet cannot match any rule */
+#define FLOW_SW_PARSE_NONE ((u8) ~0)
+
+/*
+ * Extract the fields of an ethernet frame that rules match on. Returns
+ * the VNET_FLOW_SW_PROFILE_F_* of the packet and the offset of its l4
+ * header, 0 when there is none.
+ */
+static_always_inline u8
+flow_sw_parse (vlib_buffer_t * b, vnet_flow_sw_key_t * k, u16 * l4_offset)
+{
+  ethernet_header_t *e = vlib_buffer_get_current (b);
+  u16 offset = sizeof (ethernet_header_t);
+  u16 type = e->type;
+  u8 flags = 0;
+  u8 *l4;
+
+  k->as_u64[0] = k->as_u64[1] = k->as_u64[2] = 0;
+  k->as_u64[3] = k->as_u64[4] = k->as_u64[5] = 0;
+  *l4_offset = 0;
+
+  if (type == clib_host_to_net_u16 (ETHERNET_TYPE_VLAN))
+    {
+      ethernet_vlan_header_t *v = (void *) (e + 1);
+
+      type = v->type;
+      offset += sizeof (*v);
+      flags |= VNET_FLOW_SW_PROFILE_F_TAGGED;
+    }
+
+  if (type == clib_host_to_net_u16 (ETHERNET_TYPE_IP4))
+    {
+      ip4_header_t *ip4 = (void *) ((u8 *) e + offset);
+
+      if (b->current_length < offset + sizeof (ip4_header_t))
+	return FLOW_SW_PARSE_NONE;
+
+      ip46_address_set_ip4 (&k->src, &ip4->src_address);
+      ip46_address_set_ip4 (&k->dst, &ip4->dst_address);
+      k->protocol = ip4->protocol;
+
+      /* non-first fragments carry no l4 header */
+      if (ip4_get_fragment_offset (ip4))
+	return flags;
+
+      offset += ip4_header_bytes (ip4);
+    }
+  else if (type == clib_host_to_net_u16 (ETHERNET_TYPE_IP6))
+    {
+      ip6_header_t *ip6 = (void *) ((u8 *) e + offset);
+
+      if (b->current_length < offset + sizeof (ip6_header_t))
+	return FLOW_SW_PARSE_NONE;
+
+      flags |= VNET_FLOW_SW_PROFILE_F_IP6;
+      k->src.ip6 = ip6->src_address;
+      k->dst.ip6 = ip6->dst_address;
+      k->protocol = ip6->protocol;
+      offset += sizeof (ip6_header_t);
+    }
+  else
+    return FLOW_SW_PARSE_NONE;
+
+  if (b->current_length < offset + sizeof (u32))
+    return flags;
+
+  *l4_offset = offset;
+  l4 = (u8 *) e + offset;
+
+  if (k->protocol == IP_PROTOCOL_UDP || k->protocol == IP_PROTOCOL_TCP ||
+      k->protocol == IP_PROTOCOL_SCTP)
+    {
+      k->src_port = clib_mem_unaligned (l4, u16);
+      k->dst_port = clib_mem_unaligned (l4 + sizeof (u16), u16);
+    }
+
+  return flags;
+}
+
+/*
+ * Build the key a packet is looked up with in a profile. Returns 0 when
+ * the packet cannot match the profile at all.
+ */
+static_always_inline int
+flow_sw_make_key (vlib_buffer_t * b, vnet_flow_sw_key_t * k, u8 flags,
+		  u16 l4_offset, vnet_flow_sw_profile_t * p,
+		  u16 profile_index, u32 sw_if_index,
+		  clib_bihash_kv_48_8_t * kv)
+{
+  vnet_flow_sw_key_t *key = (vnet_flow_sw_key_t *) kv->key;
+  int i;
+
+  if (flags != p->flags)
+    return 0;
+
+  k->id = 0;
+  if (p->id_offset != VNET_FLOW_SW_NO_ID_OFFSET)
+    {
+      if (l4_offset == 0 ||
+	  b->current_length < l4_offset + p->id_offset + sizeof (u32))
+	return 0;
+      k->id = clib_mem_unaligned (vlib_buffer_get_current (b) + l4_offset +
+				  p->id_offset, u32);
+    }
+
+  for (i = 0; i < ARRAY_LEN (k->as_u64); i++)
+    key->as_u64[i] = k->as_u64[i] & p->mask.as_u64[i];
+  key->profile_index = profile_index;
+  key->sw_if_index = sw_if_index;
+
+  return 1;
+}
+
+static_always_inline vnet_flow_sw_interface_t *
+flow_sw_get_interface (vnet_flow_sw_main_t * fsm, u32 sw_if_index)
+{
+  if (sw_if_index >= vec_len (fsm->interfaces))
+    return 0;
+  return vec_elt_at_index (fsm->interfaces, sw_if_index);
+}
+
+VLIB_NODE_FN (vnet_flow_sw_input_node) (vlib_main_t * vm,
+					vlib_node_runtime_t * node,
+					vlib_frame_t * frame)
+{
+  vnet_flow_sw_main_t *fsm = &vnet_flow_sw_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  vnet_flow_sw_key_t fields[VLIB_FRAME_SIZE];
+  u16 l4_offsets[VLIB_FRAME_SIZE];
+  u8 flags[VLIB_FRAME_SIZE];
+  u64 hashes[VLIB_FRAME_SIZE];
+  u32 thread_index = vm->thread_index;
+  u32 n_matched = 0, n_dropped = 0;
+  u32 *from, n_left, i;
+  vnet_flow_sw_interface_t *itf = 0;
+  u32 last_sw_if_index = ~0;
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+
+  /*
+   * Parse every packet and hash its key in the first profile of its
+   * interface, prefetching the bucket so that the lookups below find it
+   * in cache.
+   */
+  for (i = 0; i < n_left; i++)
+    {
+      clib_bihash_kv_48_8_t kv;
+      u32 sw_if_index;
+      u16 pi;
+
+      if (i + 4 < n_left)
+	{
+	  vlib_prefetch_buffer_header (bufs[i + 4], LOAD);
+	  CLIB_PREFETCH (bufs[i + 4]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      flags[i] = flow_sw_parse (bufs[i], &fields[i], &l4_offsets[i]);
+      hashes[i] = 0;
+
+      sw_if_index = vnet_buffer (bufs[i])->sw_if_index[VLIB_RX];
+      if (sw_if_index != last_sw_if_index)
+	{
+	  itf = flow_sw_get_interface (fsm, sw_if_index);
+	  last_sw_if_index = sw_if_index;
+	}
+
+      if (flags[i] == FLOW_SW_PARSE_NONE || !itf ||
+	  vec_len (itf->profile_indices) == 0)
+	continue;
+
+      pi = itf->profile_indices[0];
+      if (flow_sw_make_key (bufs[i], &fields[i], flags[i], l4_offsets[i],
+			    pool_elt_at_index (fsm->profiles, pi), pi,
+			    sw_if_index, &kv))
+	{
+	  hashes[i] = clib_bihash_hash_48_8 (&kv);
+	  clib_bihash_prefetch_bucket_48_8 (&fsm->rule_table, hashes[i]);
+	}
+    }
+
+  b = bufs;
+  next = nexts;
+  last_sw_if_index = ~0;
+
+  for (i = 0; i < n_left; i++)
+    {
+      vnet_flow_sw_rule_t *r = 0;
+      /* the avx512 key compare loads 64 bytes */
+      union
+      {
+	clib_bihash_kv_48_8_t kv;
+	u64 as_u64[8];
+      } u;
+      clib_bihash_kv_48_8_t *kv = &u.kv;
+      u32 sw_if_index, j;
+
+      if (i + 4 < n_left)
+	clib_bihash_prefetch_data_48_8 (&fsm->rule_table, hashes[i + 4]);
+
+      /* not matched: carry on along the device-input arc */
+      vnet_feature_next_u16 (next, b[0]);
+
+      sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+      if (sw_if_index != last_sw_if_index)
+	{
+	  itf = flow_sw_get_interface (fsm, sw_if_index);
+	  last_sw_if_index = sw_if_index;
+	}
+
+      if (flags[i] == FLOW_SW_PARSE_NONE || !itf)
+	goto trace;
+
+      vec_foreach_index (j, itf->profile_indices)
+      {
+	u16 pi = itf->profile_indices[j];
+	int rv;
+
+	if (!flow_sw_make_key (b[0], &fields[i], flags[i], l4_offsets[i],
+			       pool_elt_at_index (fsm->profiles, pi), pi,
+			       sw_if_index, kv))
+	  continue;
+
+	if (j == 0)
+	  rv = clib_bihash_search_inline_with_hash_48_8 (&fsm->rule_table,
+							 hashes[i], kv);
+	else
+	  rv = clib_bihash_search_inline_48_8 (&fsm->rule_table, kv);
+
+	if (rv == 0)
+	  {
+	    r = pool_elt_at_index (fsm->rules, kv->value);
+	    break;
+	  }
+      }
+
+      if (!r)
+	goto trace;
+
+      n_matched++;
+      vlib_increment_combined_counter (&fsm->rule_counters, thread_index,
+				       r - fsm->rules, 1,
+				       vlib_buffer_length_in_chain (vm,
+								    b[0]));
+
+      if (r->actions & VNET_FLOW_ACTION_MARK)
+	b[0]->flow_id = r->mark_flow_id;
+
+      if (r->actions & VNET_FLOW_ACTION_BUFFER_ADVANCE)
+	vlib_buffer_advance (b[0], r->buffer_advance);
+
+      if (r->actions & VNET_FLOW_ACTION_REDIRECT_TO_NODE)
+	next[0] = r->next_index;
+
+      if (r->actions & VNET_FLOW_ACTION_DROP)
+	{
+	  next[0] = FLOW_SW_INPUT_NEXT_DROP;
+	  b[0]->error = node->errors[FLOW_SW_INPUT_ERROR_DROP];
+	  n_dropped++;
+	}
+
+    trace:
+      if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  flow_sw_input_trace_t *t = vlib_add_trace (vm, node, b[0],
+						     sizeof (*t));
+	  t->sw_if_index = sw_if_index;
+	  t->rule_index = r ? r - fsm->rules : ~0;
+	  t->flow_index = r ? r->flow_index : ~0;
+	  t->next_index = next[0];
+	}
+
+      b += 1;
+      next += 1;
+    }
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       FLOW_SW_INPUT_ERROR_MATCHED, n_matched);
+  vlib_node_increment_counter (vm, node->node_index,
+			       FLOW_SW_INPUT_ERROR_DROP, n_dropped);
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
+  return frame->n_vectors;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (vnet_flow_sw_input_node) = {
+  .name = "flow-sw-input",
+  .vector_size = sizeof (u32),
+  .format_trace = format_flow_sw_input_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+
+  .n_errors = FLOW_SW_INPUT_N_ERROR,
+  .error_strings = flow_sw_input_error_strings,
+
+  .n_next_nodes = FLOW_SW_INPUT_N_NEXT,
+  .next_nodes = {
+    [FLOW_SW_INPUT_NEXT_DROP] = "error-drop",
+  },
+};
+
+VNET_FEATURE_INIT (flow_sw_input, static) = {
+  .arc_name = "device-input",
+  .node_name = "flow-sw-input",
+  .runs_before = VNET_FEATURES ("ethernet-input"),
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -77,6 +77,9 @@ vnet_calc_ip6_checksums (vlib_main_t * vm, vlib_buffer_t * b,
     {
       uh->checksum = 0;
       uh->checksum = ip6_tcp_udp_icmp_compute_checksum (vm, b, ip6, &bogus);
+      /* zero means no checksum, which IPv6 UDP must not send (RFC 8200) */
+      if (uh->checksum == 0)
+	uh->checksum = 0xffff;
     }
 }
 
@@ -26,6 +26,9 @@
 #include <vnet/srv6/sr_packet.h>
 #include <vnet/ip/ip6_packet.h>
 #include <vnet/ethernet/ethernet.h>
+#include <vnet/fib/fib_types.h>
+
+#include <vppinfra/bihash_24_8.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -45,7 +48,8 @@
 #define SR_BEHAVIOR_DT4 9
 #define SR_BEHAVIOR_END_UN_PERF 10
 #define SR_BEHAVIOR_END_UN 11
-#define SR_BEHAVIOR_LAST 12	/* Must always be the last one */
+#define SR_BEHAVIOR_DT46 12
+#define SR_BEHAVIOR_LAST 13	/* Must always be the last one */
 
 #define SR_STEER_L2 2
 #define SR_STEER_IPV4 4
@@ -80,10 +84,25 @@ typedef struct
   dpo_id_t ip6_dpo;				/**< DPO for Encaps/Insert IPv6 */
   dpo_id_t ip4_dpo;				/**< DPO for Encaps IPv6 */
 
+  u8 is_reduced;				/**< First SID left out of the SRH */
+  u8 flow_label_entropy;		/**< Outer flow label from the inner flow hash */
+
+  u32 policy_index;			/**< SR policy the SID list belongs to */
+
   u16 plugin;
   void *plugin_mem;
 } ip6_sr_sl_t;
 
+/**
+ * @brief uSID compression of the SID lists of an SR policy
+ */
+typedef struct
+{
+  ip6_address_t block;			/**< uSID block (masked) */
+  u8 block_len;				/**< uSID block length in bits */
+  u8 usid_len;				/**< uSID length in bits (0 is off) */
+} ip6_sr_usid_t;
+
 /* SR policy types */
 #define SR_POLICY_TYPE_DEFAULT 0
 #define SR_POLICY_TYPE_SPRAY 1
@@ -107,6 +126,11 @@ typedef struct
   u32 fib_table;			/**< FIB table */
 
   u8 is_encap;				/**< Mode (0 is SRH insert, 1 Encaps) */
+  u8 is_reduced;			/**< Reduced SRH (H.Encaps.Red/H.Insert.Red) */
+
+  ip6_sr_usid_t usid;			/**< uSID compression of the SID lists */
+
+  u8 flow_label_entropy;		/**< Outer flow label from the inner flow hash */
 
   u16 plugin;
   void *plugin_mem;
@@ -114,6 +138,15 @@ typedef struct
 
 typedef int (sr_p_plugin_callback_t) (ip6_sr_policy_t * sr);
 
+/**
+ * @brief SR Policy change notification
+ *
+ * Invoked with the BindingSID of a SR policy after it has been added,
+ * modified or deleted, so that users caching policy or SID list indices
+ * can resolve them again.
+ */
+typedef void (sr_policy_change_fn_t) (ip6_address_t * bsid);
+
 /**
  * @brief SR LocalSID
  */
@@ -133,6 +166,8 @@ typedef struct
     u32 vrf_index;				/**< vrf only */
   };
 
+  u32 vrf_index_ip4;			/**< End.DT46 only, vrf_index is the IPv6 one */
+
   u32 fib_table;				/**< FIB table where localsid is registered */
 
   u32 vlan_index;				/**< VLAN tag (not an index) */
@@ -242,6 +277,20 @@ typedef struct
   u32 sr_policy;					/**< SR Policy index */
 } ip6_sr_steering_policy_t;
 
+/**
+ * @brief Bulk steering prefix lengths of one address family
+ *
+ * Bulk L3 steering rules live in a single bihash keyed on the masked
+ * destination, the FIB index, the traffic type and the mask width. A
+ * lookup probes the mask widths in use, longest first, as ip6_fib does.
+ */
+typedef struct
+{
+  uword *non_empty_dst_address_length_bitmap;
+  u8 *prefix_lengths_in_search_order;
+  i32 dst_address_length_refcounts[129];
+} sr_steer_bulk_af_t;
+
 typedef struct
 {
   ip6_address_t address;
@@ -281,6 +330,16 @@ typedef struct
   /* L2 steering ifaces - sr_policies */
   u32 *sw_iface_sr_policies;
 
+  /* Bulk L3 steering table, kept out of the FIB */
+  clib_bihash_24_8_t steer_bulk_table;
+  sr_steer_bulk_af_t steer_bulk_af[FIB_PROTOCOL_IP_MAX];
+  u32 steer_bulk_n_entries;
+  u32 steer_bulk_buckets;
+  uword steer_bulk_memory;
+
+  /* Per SR policy DPOs stacked on the bulk steering nodes */
+  dpo_id_t *steer_bulk_dpos[FIB_PROTOCOL_IP_MAX];
+
   /* Spray DPO */
   dpo_type_t sr_pr_spray_dpo_type;
 
@@ -296,10 +355,17 @@ typedef struct
   /* Find plugin function by name */
   uword *policy_plugin_functions_by_key;
 
+  /* SR Policy change listeners */
+  sr_policy_change_fn_t **policy_change_callbacks;
+
   /* Counters */
   vlib_combined_counter_main_t sr_ls_valid_counters;
   vlib_combined_counter_main_t sr_ls_invalid_counters;
 
+  /* SR policy and SID list counters, as received by the head-end */
+  vlib_combined_counter_main_t sr_policy_counters;
+  vlib_combined_counter_main_t sr_sl_counters;
+
   /* SR Policies FIBs */
   u32 fib_table_ip6;
   u32 fib_table_ip4;
@@ -342,11 +408,15 @@ sr_policy_register_function (vlib_main_t * vm, u8 * fn_name,
 extern int
 sr_policy_add (ip6_address_t * bsid, ip6_address_t * segments,
 	       u32 weight, u8 behavior, u32 fib_table, u8 is_encap,
-	       u16 plugin, void *plugin_mem);
+	       u8 is_reduced, ip6_sr_usid_t * usid, u16 plugin,
+	       void *plugin_mem);
 extern int sr_policy_mod (ip6_address_t * bsid, u32 index, u32 fib_table,
 			  u8 operation, ip6_address_t * segments,
 			  u32 sl_index, u32 weight);
 extern int sr_policy_del (ip6_address_t * bsid, u32 index);
+extern int sr_policy_set_flow_label_entropy (ip6_address_t * bsid, u32 index,
+					     u8 enable);
+extern void sr_policy_register_change_callback (sr_policy_change_fn_t * fn);
 
 extern int
 sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
@@ -359,6 +429,18 @@ sr_steering_policy (int is_del, ip6_address_t * bsid, u32 sr_policy_index,
 		    u32 table_id, ip46_address_t * prefix, u32 mask_width,
 		    u32 sw_if_index, u8 traffic_type);
 
+extern int
+sr_steering_bulk_resolve (int is_del, ip6_address_t * bsid,
+			  u32 sr_policy_index, u32 table_id,
+			  u32 mask_width, u8 traffic_type,
+			  u32 * fib_index, u32 * policy_index);
+extern int
+sr_steering_bulk_add_del (int is_del, ip6_address_t * bsid,
+			  u32 sr_policy_index, u32 table_id,
+			  ip46_address_t * prefix, u32 mask_width,
+			  u8 traffic_type);
+extern int sr_steering_bulk_enable_disable (u32 sw_if_index, int enable);
+
 extern void sr_set_source (ip6_address_t * address);
 
 extern void sr_set_hop_limit (u8 hop_limit);
@@ -52,6 +52,8 @@ _(SR_POLICY_ADD, sr_policy_add)                         \
 _(SR_POLICY_MOD, sr_policy_mod)                         \
 _(SR_POLICY_DEL, sr_policy_del)                         \
 _(SR_STEERING_ADD_DEL, sr_steering_add_del)             \
+_(SR_STEERING_BULK_ADD_DEL, sr_steering_bulk_add_del)   \
+_(SR_STEERING_BULK_ENABLE_DISABLE, sr_steering_bulk_enable_disable) \
 _(SR_SET_ENCAP_SOURCE, sr_set_encap_source)             \
 _(SR_SET_ENCAP_HOP_LIMIT, sr_set_encap_hop_limit)       \
 _(SR_LOCALSIDS_DUMP, sr_localsids_dump)                 \
@@ -109,14 +111,15 @@ vl_api_sr_policy_add_t_handler (vl_api_sr_policy_add_t * mp)
 /*
  * sr_policy_add (ip6_address_t *bsid, ip6_address_t *segments,
  *                u32 weight, u8 behavior, u32 fib_table, u8 is_encap,
- *                u16 behavior, void *plugin_mem)
+ *                u8 is_reduced, ip6_sr_usid_t *usid, u16 behavior,
+ *                void *plugin_mem)
  */
   int rv = 0;
   rv = sr_policy_add (&bsid_addr,
 		      segments,
 		      ntohl (mp->sids.weight),
-		      mp->is_spray, ntohl (mp->fib_table), mp->is_encap, 0,
-		      NULL);
+		      mp->is_spray, ntohl (mp->fib_table), mp->is_encap, 0, NULL,
+		      0, NULL);
   vec_free (segments);
 
   REPLY_MACRO (VL_API_SR_POLICY_ADD_REPLY);
@@ -231,6 +234,82 @@ static void vl_api_sr_steering_add_del_t_handler
   REPLY_MACRO (VL_API_SR_STEERING_ADD_DEL_REPLY);
 }
 
+static void vl_api_sr_steering_bulk_add_del_t_handler
+  (vl_api_sr_steering_bulk_add_del_t * mp)
+{
+  vl_api_sr_steering_bulk_add_del_reply_t *rmp;
+  vl_api_sr_steering_bulk_entry_t *e;
+  u32 count = ntohl (mp->count);
+  ip6_address_t bsid_addr;
+  u32 fib_index, policy_index;
+  fib_prefix_t *pfxs = 0;
+  u8 traffic_type;
+  int rv = 0;
+  u32 i;
+
+  if (vl_msg_api_get_msg_length (mp) !=
+      sizeof (*mp) + count * sizeof (mp->entries[0]))
+    {
+      rv = VNET_API_ERROR_INVALID_VALUE;
+      goto done;
+    }
+
+  /*
+   * Resolve the whole batch first, so that an unknown policy or table
+   * fails it before any rule is applied. A rule failing to apply past
+   * that point leaves the ones before it in place.
+   */
+  vec_resize (pfxs, count);
+  for (i = 0; i < count; i++)
+    {
+      e = &mp->entries[i];
+      ip_prefix_decode (&e->prefix, &pfxs[i]);
+      ip6_address_decode (e->bsid_addr, &bsid_addr);
+      traffic_type = (pfxs[i].fp_proto == FIB_PROTOCOL_IP4 ?
+		      SR_STEER_IPV4 : SR_STEER_IPV6);
+
+      rv = sr_steering_bulk_resolve (mp->is_del, &bsid_addr, ~0,
+				     ntohl (e->table_id), pfxs[i].fp_len,
+				     traffic_type, &fib_index, &policy_index);
+      if (rv)
+	goto done;
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      e = &mp->entries[i];
+      ip6_address_decode (e->bsid_addr, &bsid_addr);
+      traffic_type = (pfxs[i].fp_proto == FIB_PROTOCOL_IP4 ?
+		      SR_STEER_IPV4 : SR_STEER_IPV6);
+
+      rv = sr_steering_bulk_add_del (mp->is_del, &bsid_addr, ~0,
+				     ntohl (e->table_id), &pfxs[i].fp_addr,
+				     pfxs[i].fp_len, traffic_type);
+      if (rv && (!mp->is_del || rv != -4))
+	goto done;
+      rv = 0;
+    }
+
+done:
+  vec_free (pfxs);
+
+  REPLY_MACRO (VL_API_SR_STEERING_BULK_ADD_DEL_REPLY);
+}
+
+static void vl_api_sr_steering_bulk_enable_disable_t_handler
+  (vl_api_sr_steering_bulk_enable_disable_t * mp)
+{
+  vl_api_sr_steering_bulk_enable_disable_reply_t *rmp;
+  int rv = 0;
+
+  VALIDATE_SW_IF_INDEX (mp);
+
+  rv = sr_steering_bulk_enable_disable (ntohl (mp->sw_if_index), mp->enable);
+
+  BAD_SW_IF_INDEX_LABEL;
+  REPLY_MACRO (VL_API_SR_STEERING_BULK_ENABLE_DISABLE_REPLY);
+}
+
 static void send_sr_localsid_details
   (ip6_sr_localsid_t * t, vl_api_registration_t * reg, u32 context)
 {
@@ -246,7 +325,8 @@ static void send_sr_localsid_details
   rmp->vlan_index = htonl (t->vlan_index);
   ip_address_encode (&t->next_hop, IP46_TYPE_ANY, &rmp->xconnect_nh_addr);
 
-  if (t->behavior == SR_BEHAVIOR_T || t->behavior == SR_BEHAVIOR_DT6)
+  if (t->behavior == SR_BEHAVIOR_T || t->behavior == SR_BEHAVIOR_DT6
+      || t->behavior == SR_BEHAVIOR_DT46)
     rmp->xconnect_iface_or_vrf_table =
       htonl (fib_table_get_table_id (t->sw_if_index, FIB_PROTOCOL_IP6));
   else if (t->behavior == SR_BEHAVIOR_DT4)
@@ -425,6 +505,13 @@ sr_api_hookup (vlib_main_t * vm)
   foreach_vpe_api_msg;
 #undef _
 
+  /*
+   * Bulk steering only writes the bihash, which is safe against the
+   * workers; it syncs with them itself on the rare layout changes.
+   */
+  am->is_mp_safe[VL_API_SR_STEERING_BULK_ADD_DEL] = 1;
+  am->is_mp_safe[VL_API_SR_STEERING_BULK_ADD_DEL_REPLY] = 1;
+
   /*
    * Set up the (msg_name, crc, message-id) table
    */
@@ -136,6 +136,9 @@ sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
 	      rv = plugin->removal (ls);
 	    }
 
+	  vlib_stats_set_name ("/net/sr/localsid/names", ls - sm->localsids,
+			       0);
+
 	  /* Delete localsid registry */
 	  pool_put (sm->localsids, ls);
 	  mhash_unset (&sm->sr_localsids_index_hash, &key, NULL);
@@ -234,6 +237,15 @@ sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
     case SR_BEHAVIOR_DT4:
       ls->vrf_index = fib_table_find (FIB_PROTOCOL_IP4, sw_if_index);
       break;
+    case SR_BEHAVIOR_DT46:
+      ls->vrf_index = fib_table_find (FIB_PROTOCOL_IP6, sw_if_index);
+      ls->vrf_index_ip4 = fib_table_find (FIB_PROTOCOL_IP4, sw_if_index);
+      if (ls->vrf_index == ~0 || ls->vrf_index_ip4 == ~0)
+	{
+	  pool_put (sm->localsids, ls);
+	  return -7;
+	}
+      break;
     case SR_BEHAVIOR_DX2:
       ls->sw_if_index = sw_if_index;
       ls->vlan_index = vlan_index;
@@ -313,6 +325,12 @@ sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
   vlib_zero_combined_counter (&(sm->sr_ls_invalid_counters),
 			      ls - sm->localsids);
 
+  /* Name the counters after the SID in the stat segment */
+  u8 *name = format (0, "%U/%u", format_ip6_address, &ls->localsid,
+		     ls->localsid_prefix_len);
+  vlib_stats_set_name ("/net/sr/localsid/names", ls - sm->localsids, name);
+  vec_free (name);
+
   return 0;
 }
 
@@ -385,6 +403,8 @@ sr_cli_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	    behavior = SR_BEHAVIOR_DT6;
 	  else if (unformat (input, "end.dt4 %u", &sw_if_index))
 	    behavior = SR_BEHAVIOR_DT4;
+	  else if (unformat (input, "end.dt46 %u", &sw_if_index))
+	    behavior = SR_BEHAVIOR_DT46;
 	  else if (unformat (input, "un %u", &usid_size))
 	    behavior = SR_BEHAVIOR_END_UN_PERF;
 	  else if (unformat (input, "un.flex %u", &usid_size))
@@ -428,6 +448,10 @@ sr_cli_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	break;
     }
 
+  if (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    return clib_error_return (0, "unknown input '%U'",
+			      format_unformat_error, input);
+
   if (!behavior && end_psp)
     behavior = SR_BEHAVIOR_END;
 
@@ -500,6 +524,10 @@ sr_cli_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
     case -6:
       return clib_error_return (0,
 				"Error on the plugin based localsid creation.");
+    case -7:
+      return clib_error_return (0,
+				"End.DT46 needs table %u in both IPv4 and IPv6",
+				sw_if_index);
     default:
       return clib_error_return (0, "BUG: sr localsid returns %d", rv);
     }
@@ -531,7 +559,9 @@ VLIB_CLI_COMMAND (sr_localsid_command, static) = {
     "\tEnd.DT6\t-> Endpoint with decapsulation and specific IPv6 table lookup.\n"
     "\t\tParameters: '<ip6_fib_table>'\n"
     "\tEnd.DT4\t-> Endpoint with decapsulation and specific IPv4 table lookup.\n"
-    "\t\tParameters: '<ip4_fib_table>'\n",
+    "\t\tParameters: '<ip4_fib_table>'\n"
+    "\tEnd.DT46\t-> Endpoint with decapsulation and specific IP table lookup.\n"
+    "\t\tParameters: '<fib_table>'\n",
   .function = sr_cli_localsid_command_fn,
 };
 /* *INDENT-ON* */
@@ -641,6 +671,14 @@ show_sr_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
 			   fib_table_get_table_id (ls->vrf_index,
 						   FIB_PROTOCOL_IP4));
 	  break;
+	case SR_BEHAVIOR_DT46:
+	  vlib_cli_output (vm,
+			   "\tAddress: \t%U/%u\n\tBehavior: \tDT46 (Endpoint with decapsulation and specific IP table lookup)"
+			   "\n\tTable: \t%u", format_ip6_address,
+			   &ls->localsid, ls->localsid_prefix_len,
+			   fib_table_get_table_id (ls->vrf_index,
+						   FIB_PROTOCOL_IP6));
+	  break;
 	default:
 	  if (ls->behavior >= SR_BEHAVIOR_LAST)
 	    {
@@ -725,6 +763,7 @@ typedef struct
 _(NO_INNER_HEADER, "(SR-Error) No inner IP header")                 \
 _(NO_MORE_SEGMENTS, "(SR-Error) No more segments")                  \
 _(NO_SRH, "(SR-Error) No SR header")                                \
+_(BAD_SRH, "(SR-Error) Segments left beyond last entry")            \
 _(NO_PSP, "(SR-Error) PSP Not available (segments left > 0)")       \
 _(NOT_LS, "(SR-Error) Decaps not available (segments left > 0)")    \
 _(L2, "(SR-Error) SRv6 decapsulated a L2 frame without dest")
@@ -803,6 +842,9 @@ format_sr_localsid_trace (u8 * s, va_list * args)
     case SR_BEHAVIOR_DT4:
       s = format (s, "\tBehavior: Decapsulation with IPv4 Table lookup\n");
       break;
+    case SR_BEHAVIOR_DT46:
+      s = format (s, "\tBehavior: Decapsulation with IP Table lookup\n");
+      break;
     case SR_BEHAVIOR_DX2:
       s = format (s, "\tBehavior: Decapsulation with L2 xconnect\n");
       break;
@@ -843,7 +885,13 @@ end_srh_processing (vlib_node_runtime_t * node,
 
   if (PREDICT_TRUE (sr0 && sr0->type == ROUTING_HEADER_TYPE_SR))
     {
-      if (sr0->segments_left == 1 && psp)
+      /* A reduced SRH omits the active SID, so SL may be last_entry + 1 */
+      if (PREDICT_FALSE (sr0->segments_left > sr0->last_entry + 1))
+	{
+	  *next0 = SR_LOCALSID_NEXT_ERROR;
+	  b0->error = node->errors[SR_LOCALSID_ERROR_BAD_SRH];
+	}
+      else if (sr0->segments_left == 1 && psp)
 	{
 	  u32 new_l0, sr_len;
 	  u64 *copy_dst0, *copy_src0;
@@ -978,7 +1026,13 @@ end_un_srh_processing (vlib_node_runtime_t * node,
 
   if (PREDICT_TRUE (sr0 && sr0->type == ROUTING_HEADER_TYPE_SR))
     {
-      if (sr0->segments_left == 1 && psp)
+      /* A reduced SRH omits the active SID, so SL may be last_entry + 1 */
+      if (PREDICT_FALSE (sr0->segments_left > sr0->last_entry + 1))
+	{
+	  *next0 = SR_LOCALSID_NEXT_ERROR;
+	  b0->error = node->errors[SR_LOCALSID_ERROR_BAD_SRH];
+	}
+      else if (sr0->segments_left == 1 && psp)
 	{
 	  u32 new_l0, sr_len;
 	  u64 *copy_dst0, *copy_src0;
@@ -1110,7 +1164,8 @@ end_decaps_srh_processing (vlib_node_runtime_t * node,
 	  *next0 = SR_LOCALSID_NEXT_IP6_REWRITE;
 	  return;
 	}
-      else if (ls0->behavior == SR_BEHAVIOR_DT6)
+      else if (ls0->behavior == SR_BEHAVIOR_DT6 ||
+	       ls0->behavior == SR_BEHAVIOR_DT46)
 	{
 	  vlib_buffer_advance (b0, total_size);
 	  vnet_buffer (b0)->sw_if_index[VLIB_TX] = ls0->vrf_index;
@@ -1133,6 +1188,13 @@ end_decaps_srh_processing (vlib_node_runtime_t * node,
 	  *next0 = SR_LOCALSID_NEXT_IP4_LOOKUP;
 	  return;
 	}
+      else if (ls0->behavior == SR_BEHAVIOR_DT46)
+	{
+	  vlib_buffer_advance (b0, total_size);
+	  vnet_buffer (b0)->sw_if_index[VLIB_TX] = ls0->vrf_index_ip4;
+	  *next0 = SR_LOCALSID_NEXT_IP4_LOOKUP;
+	  return;
+	}
       break;
     case IP_PROTOCOL_IP6_ETHERNET:
       /* L2 encaps */
@@ -1150,291 +1212,264 @@ end_decaps_srh_processing (vlib_node_runtime_t * node,
   return;
 }
 
+#define SR_LOCALSID_D_MAX_GROUPS 16
+
 /**
- * @brief SR LocalSID graph node. Supports all default SR Endpoint variants with decaps
+ * @brief Enqueue the decapsulated packets grouped by next node and table
+ *
+ * A frame mixing IPv4 and IPv6, or several VRFs, is handed over as one run
+ * per (next, table): ip4-lookup and ip6-lookup then walk one mtrie/bihash
+ * at a time. The grouping is stable. Frames with more groups than we track
+ * are enqueued in arrival order.
  */
-static uword
-sr_localsid_d_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
-		  vlib_frame_t * from_frame)
+static_always_inline void
+sr_localsid_d_enqueue (vlib_main_t * vm, vlib_node_runtime_t * node,
+		       u32 * from, vlib_buffer_t ** bufs, u16 * nexts,
+		       u32 n_vectors)
 {
-  u32 n_left_from, next_index, *from, *to_next;
-  ip6_sr_main_t *sm = &sr_main;
-  from = vlib_frame_vector_args (from_frame);
-  n_left_from = from_frame->n_vectors;
-  next_index = node->cached_next_index;
-  u32 thread_index = vm->thread_index;
-
-  while (n_left_from > 0)
+  u64 keys[SR_LOCALSID_D_MAX_GROUPS];
+  u16 offsets[SR_LOCALSID_D_MAX_GROUPS];
+  u8 groups[VLIB_FRAME_SIZE];
+  u32 sorted[VLIB_FRAME_SIZE];
+  u16 sorted_nexts[VLIB_FRAME_SIZE];
+  u32 i, g, last = 0, n_groups = 0;
+  u16 n, offset;
+  u64 key;
+
+  for (i = 0; i < n_vectors; i++)
     {
-      u32 n_left_to_next;
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
+      key = ((u64) nexts[i] << 32) |
+	vnet_buffer (bufs[i])->sw_if_index[VLIB_TX];
 
-      /* Quad - Loop */
-      while (n_left_from >= 8 && n_left_to_next >= 4)
+      if (PREDICT_TRUE (n_groups && keys[last] == key))
+	g = last;
+      else
 	{
-	  u32 bi0, bi1, bi2, bi3;
-	  vlib_buffer_t *b0, *b1, *b2, *b3;
-	  ip6_header_t *ip0, *ip1, *ip2, *ip3;
-	  ip6_sr_header_t *sr0, *sr1, *sr2, *sr3;
-	  u32 next0, next1, next2, next3;
-	  next0 = next1 = next2 = next3 = SR_LOCALSID_NEXT_IP6_LOOKUP;
-	  ip6_sr_localsid_t *ls0, *ls1, *ls2, *ls3;
-
-	  /* Prefetch next iteration. */
-	  {
-	    vlib_buffer_t *p4, *p5, *p6, *p7;
-
-	    p4 = vlib_get_buffer (vm, from[4]);
-	    p5 = vlib_get_buffer (vm, from[5]);
-	    p6 = vlib_get_buffer (vm, from[6]);
-	    p7 = vlib_get_buffer (vm, from[7]);
-
-	    /* Prefetch the buffer header and packet for the N+4 loop iteration */
-	    vlib_prefetch_buffer_header (p4, LOAD);
-	    vlib_prefetch_buffer_header (p5, LOAD);
-	    vlib_prefetch_buffer_header (p6, LOAD);
-	    vlib_prefetch_buffer_header (p7, LOAD);
-
-	    CLIB_PREFETCH (p4->data, CLIB_CACHE_LINE_BYTES, STORE);
-	    CLIB_PREFETCH (p5->data, CLIB_CACHE_LINE_BYTES, STORE);
-	    CLIB_PREFETCH (p6->data, CLIB_CACHE_LINE_BYTES, STORE);
-	    CLIB_PREFETCH (p7->data, CLIB_CACHE_LINE_BYTES, STORE);
-	  }
-
-	  to_next[0] = bi0 = from[0];
-	  to_next[1] = bi1 = from[1];
-	  to_next[2] = bi2 = from[2];
-	  to_next[3] = bi3 = from[3];
-	  from += 4;
-	  to_next += 4;
-	  n_left_from -= 4;
-	  n_left_to_next -= 4;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  b1 = vlib_get_buffer (vm, bi1);
-	  b2 = vlib_get_buffer (vm, bi2);
-	  b3 = vlib_get_buffer (vm, bi3);
+	  for (g = 0; g < n_groups; g++)
+	    if (keys[g] == key)
+	      break;
 
-	  ls0 =
-	    pool_elt_at_index (sm->localsids,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
-	  ls1 =
-	    pool_elt_at_index (sm->localsids,
-			       vnet_buffer (b1)->ip.adj_index[VLIB_TX]);
-	  ls2 =
-	    pool_elt_at_index (sm->localsids,
-			       vnet_buffer (b2)->ip.adj_index[VLIB_TX]);
-	  ls3 =
-	    pool_elt_at_index (sm->localsids,
-			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
-
-	  ip0 = vlib_buffer_get_current (b0);
-	  ip1 = vlib_buffer_get_current (b1);
-	  ip2 = vlib_buffer_get_current (b2);
-	  ip3 = vlib_buffer_get_current (b3);
-
-	  sr0 =
-	    ip6_ext_header_find (vm, b0, ip0, IP_PROTOCOL_IPV6_ROUTE, NULL);
-	  sr1 =
-	    ip6_ext_header_find (vm, b1, ip1, IP_PROTOCOL_IPV6_ROUTE, NULL);
-	  sr2 =
-	    ip6_ext_header_find (vm, b2, ip2, IP_PROTOCOL_IPV6_ROUTE, NULL);
-	  sr3 =
-	    ip6_ext_header_find (vm, b3, ip3, IP_PROTOCOL_IPV6_ROUTE, NULL);
-
-	  end_decaps_srh_processing (node, b0, ip0, sr0, ls0, &next0);
-	  end_decaps_srh_processing (node, b1, ip1, sr1, ls1, &next1);
-	  end_decaps_srh_processing (node, b2, ip2, sr2, ls2, &next2);
-	  end_decaps_srh_processing (node, b3, ip3, sr3, ls3, &next3);
-
-	  if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	  if (g == n_groups)
 	    {
-	      sr_localsid_trace_t *tr =
-		vlib_add_trace (vm, node, b0, sizeof (*tr));
-	      tr->num_segments = 0;
-	      clib_memcpy (tr->localsid.as_u8, ls0->localsid.as_u8,
-			   sizeof (tr->localsid.as_u8));
-	      tr->behavior = ls0->behavior;
-	      if (ip0 == vlib_buffer_get_current (b0))
+	      if (PREDICT_FALSE (n_groups == SR_LOCALSID_D_MAX_GROUPS))
 		{
-		  if (ip0->protocol == IP_PROTOCOL_IPV6_ROUTE
-		      && sr0->type == ROUTING_HEADER_TYPE_SR)
-		    {
-		      clib_memcpy (tr->sr, sr0->segments, sr0->length * 8);
-		      tr->num_segments =
-			sr0->length * 8 / sizeof (ip6_address_t);
-		      tr->segments_left = sr0->segments_left;
-		    }
+		  vlib_buffer_enqueue_to_next (vm, node, from, nexts,
+					       n_vectors);
+		  return;
 		}
-	      else
-		tr->num_segments = 0xFF;
+	      keys[n_groups] = key;
+	      offsets[n_groups++] = 0;
 	    }
+	  last = g;
+	}
 
-	  if (PREDICT_FALSE (b1->flags & VLIB_BUFFER_IS_TRACED))
-	    {
-	      sr_localsid_trace_t *tr =
-		vlib_add_trace (vm, node, b1, sizeof (*tr));
-	      tr->num_segments = 0;
-	      clib_memcpy (tr->localsid.as_u8, ls1->localsid.as_u8,
-			   sizeof (tr->localsid.as_u8));
-	      tr->behavior = ls1->behavior;
-	      if (ip1 == vlib_buffer_get_current (b1))
-		{
-		  if (ip1->protocol == IP_PROTOCOL_IPV6_ROUTE
-		      && sr1->type == ROUTING_HEADER_TYPE_SR)
-		    {
-		      clib_memcpy (tr->sr, sr1->segments, sr1->length * 8);
-		      tr->num_segments =
-			sr1->length * 8 / sizeof (ip6_address_t);
-		      tr->segments_left = sr1->segments_left;
-		    }
-		}
-	      else
-		tr->num_segments = 0xFF;
-	    }
+      groups[i] = g;
+      offsets[g]++;
+    }
 
-	  if (PREDICT_FALSE (b2->flags & VLIB_BUFFER_IS_TRACED))
-	    {
-	      sr_localsid_trace_t *tr =
-		vlib_add_trace (vm, node, b2, sizeof (*tr));
-	      tr->num_segments = 0;
-	      clib_memcpy (tr->localsid.as_u8, ls2->localsid.as_u8,
-			   sizeof (tr->localsid.as_u8));
-	      tr->behavior = ls2->behavior;
-	      if (ip2 == vlib_buffer_get_current (b2))
-		{
-		  if (ip2->protocol == IP_PROTOCOL_IPV6_ROUTE
-		      && sr2->type == ROUTING_HEADER_TYPE_SR)
-		    {
-		      clib_memcpy (tr->sr, sr2->segments, sr2->length * 8);
-		      tr->num_segments =
-			sr2->length * 8 / sizeof (ip6_address_t);
-		      tr->segments_left = sr2->segments_left;
-		    }
-		}
-	      else
-		tr->num_segments = 0xFF;
-	    }
+  if (n_groups == 1)
+    {
+      vlib_buffer_enqueue_to_next (vm, node, from, nexts, n_vectors);
+      return;
+    }
 
-	  if (PREDICT_FALSE (b3->flags & VLIB_BUFFER_IS_TRACED))
-	    {
-	      sr_localsid_trace_t *tr =
-		vlib_add_trace (vm, node, b3, sizeof (*tr));
-	      tr->num_segments = 0;
-	      clib_memcpy (tr->localsid.as_u8, ls3->localsid.as_u8,
-			   sizeof (tr->localsid.as_u8));
-	      tr->behavior = ls3->behavior;
-	      if (ip3 == vlib_buffer_get_current (b3))
-		{
-		  if (ip3->protocol == IP_PROTOCOL_IPV6_ROUTE
-		      && sr3->type == ROUTING_HEADER_TYPE_SR)
-		    {
-		      clib_memcpy (tr->sr, sr3->segments, sr3->length * 8);
-		      tr->num_segments =
-			sr3->length * 8 / sizeof (ip6_address_t);
-		      tr->segments_left = sr3->segments_left;
-		    }
-		}
-	      else
-		tr->num_segments = 0xFF;
-	    }
+  /* Turn the group sizes into offsets, then scatter */
+  for (g = 0, offset = 0; g < n_groups; g++)
+    {
+      n = offsets[g];
+      offsets[g] = offset;
+      offset += n;
+    }
 
-	  vlib_increment_combined_counter
-	    (((next0 ==
-	       SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
-	      &(sm->sr_ls_valid_counters)), thread_index, ls0 - sm->localsids,
-	     1, vlib_buffer_length_in_chain (vm, b0));
+  for (i = 0; i < n_vectors; i++)
+    {
+      g = groups[i];
+      sorted[offsets[g]] = from[i];
+      sorted_nexts[offsets[g]++] = nexts[i];
+    }
 
-	  vlib_increment_combined_counter
-	    (((next1 ==
-	       SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
-	      &(sm->sr_ls_valid_counters)), thread_index, ls1 - sm->localsids,
-	     1, vlib_buffer_length_in_chain (vm, b1));
+  vlib_buffer_enqueue_to_next (vm, node, sorted, sorted_nexts, n_vectors);
+}
 
-	  vlib_increment_combined_counter
-	    (((next2 ==
-	       SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
-	      &(sm->sr_ls_valid_counters)), thread_index, ls2 - sm->localsids,
-	     1, vlib_buffer_length_in_chain (vm, b2));
+static_always_inline void
+sr_localsid_d_trace (vlib_main_t * vm, vlib_node_runtime_t * node,
+		     vlib_buffer_t * b0, ip6_header_t * ip0,
+		     ip6_sr_header_t * sr0, ip6_sr_localsid_t * ls0)
+{
+  sr_localsid_trace_t *tr = vlib_add_trace (vm, node, b0, sizeof (*tr));
+  tr->num_segments = 0;
+  clib_memcpy (tr->localsid.as_u8, ls0->localsid.as_u8,
+	       sizeof (tr->localsid.as_u8));
+  tr->behavior = ls0->behavior;
+  if (ip0 == vlib_buffer_get_current (b0))
+    {
+      if (ip0->protocol == IP_PROTOCOL_IPV6_ROUTE
+	  && sr0->type == ROUTING_HEADER_TYPE_SR)
+	{
+	  clib_memcpy (tr->sr, sr0->segments, sr0->length * 8);
+	  tr->num_segments = sr0->length * 8 / sizeof (ip6_address_t);
+	  tr->segments_left = sr0->segments_left;
+	}
+    }
+  else
+    tr->num_segments = 0xFF;
+}
 
-	  vlib_increment_combined_counter
-	    (((next3 ==
-	       SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
-	      &(sm->sr_ls_valid_counters)), thread_index, ls3 - sm->localsids,
-	     1, vlib_buffer_length_in_chain (vm, b3));
+/**
+ * @brief SR LocalSID graph node. Supports all default SR Endpoint variants with decaps
+ */
+static uword
+sr_localsid_d_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
+		  vlib_frame_t * from_frame)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 n_left_from, *from;
+  u32 thread_index = vm->thread_index;
 
-	  vlib_validate_buffer_enqueue_x4 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, bi1, bi2, bi3,
-					   next0, next1, next2, next3);
-	}
+  from = vlib_frame_vector_args (from_frame);
+  n_left_from = from_frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left_from);
+  b = bufs;
+  next = nexts;
 
-      /* Single loop for potentially the last three packets */
-      while (n_left_from > 0 && n_left_to_next > 0)
-	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  ip6_header_t *ip0;
-	  ip6_sr_header_t *sr0;
-	  u32 next0 = SR_LOCALSID_NEXT_IP6_LOOKUP;
-	  ip6_sr_localsid_t *ls0;
+  /* Quad - Loop */
+  while (n_left_from >= 8)
+    {
+      ip6_header_t *ip0, *ip1, *ip2, *ip3;
+      ip6_sr_header_t *sr0, *sr1, *sr2, *sr3;
+      u32 next0, next1, next2, next3;
+      next0 = next1 = next2 = next3 = SR_LOCALSID_NEXT_IP6_LOOKUP;
+      ip6_sr_localsid_t *ls0, *ls1, *ls2, *ls3;
+
+      /* Prefetch the buffer header and packet for the N+4 loop iteration */
+      vlib_prefetch_buffer_header (b[4], LOAD);
+      vlib_prefetch_buffer_header (b[5], LOAD);
+      vlib_prefetch_buffer_header (b[6], LOAD);
+      vlib_prefetch_buffer_header (b[7], LOAD);
+
+      CLIB_PREFETCH (b[4]->data, CLIB_CACHE_LINE_BYTES, STORE);
+      CLIB_PREFETCH (b[5]->data, CLIB_CACHE_LINE_BYTES, STORE);
+      CLIB_PREFETCH (b[6]->data, CLIB_CACHE_LINE_BYTES, STORE);
+      CLIB_PREFETCH (b[7]->data, CLIB_CACHE_LINE_BYTES, STORE);
+
+      ls0 =
+	pool_elt_at_index (sm->localsids,
+			   vnet_buffer (b[0])->ip.adj_index[VLIB_TX]);
+      ls1 =
+	pool_elt_at_index (sm->localsids,
+			   vnet_buffer (b[1])->ip.adj_index[VLIB_TX]);
+      ls2 =
+	pool_elt_at_index (sm->localsids,
+			   vnet_buffer (b[2])->ip.adj_index[VLIB_TX]);
+      ls3 =
+	pool_elt_at_index (sm->localsids,
+			   vnet_buffer (b[3])->ip.adj_index[VLIB_TX]);
+
+      ip0 = vlib_buffer_get_current (b[0]);
+      ip1 = vlib_buffer_get_current (b[1]);
+      ip2 = vlib_buffer_get_current (b[2]);
+      ip3 = vlib_buffer_get_current (b[3]);
+
+      sr0 =
+	ip6_ext_header_find (vm, b[0], ip0, IP_PROTOCOL_IPV6_ROUTE, NULL);
+      sr1 =
+	ip6_ext_header_find (vm, b[1], ip1, IP_PROTOCOL_IPV6_ROUTE, NULL);
+      sr2 =
+	ip6_ext_header_find (vm, b[2], ip2, IP_PROTOCOL_IPV6_ROUTE, NULL);
+      sr3 =
+	ip6_ext_header_find (vm, b[3], ip3, IP_PROTOCOL_IPV6_ROUTE, NULL);
+
+      end_decaps_srh_processing (node, b[0], ip0, sr0, ls0, &next0);
+      end_decaps_srh_processing (node, b[1], ip1, sr1, ls1, &next1);
+      end_decaps_srh_processing (node, b[2], ip2, sr2, ls2, &next2);
+      end_decaps_srh_processing (node, b[3], ip3, sr3, ls3, &next3);
+
+      if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	sr_localsid_d_trace (vm, node, b[0], ip0, sr0, ls0);
+      if (PREDICT_FALSE (b[1]->flags & VLIB_BUFFER_IS_TRACED))
+	sr_localsid_d_trace (vm, node, b[1], ip1, sr1, ls1);
+      if (PREDICT_FALSE (b[2]->flags & VLIB_BUFFER_IS_TRACED))
+	sr_localsid_d_trace (vm, node, b[2], ip2, sr2, ls2);
+      if (PREDICT_FALSE (b[3]->flags & VLIB_BUFFER_IS_TRACED))
+	sr_localsid_d_trace (vm, node, b[3], ip3, sr3, ls3);
+
+      vlib_increment_combined_counter
+	(((next0 ==
+	   SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
+	  &(sm->sr_ls_valid_counters)), thread_index, ls0 - sm->localsids,
+	 1, vlib_buffer_length_in_chain (vm, b[0]));
+
+      vlib_increment_combined_counter
+	(((next1 ==
+	   SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
+	  &(sm->sr_ls_valid_counters)), thread_index, ls1 - sm->localsids,
+	 1, vlib_buffer_length_in_chain (vm, b[1]));
+
+      vlib_increment_combined_counter
+	(((next2 ==
+	   SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
+	  &(sm->sr_ls_valid_counters)), thread_index, ls2 - sm->localsids,
+	 1, vlib_buffer_length_in_chain (vm, b[2]));
+
+      vlib_increment_combined_counter
+	(((next3 ==
+	   SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
+	  &(sm->sr_ls_valid_counters)), thread_index, ls3 - sm->localsids,
+	 1, vlib_buffer_length_in_chain (vm, b[3]));
+
+      next[0] = next0;
+      next[1] = next1;
+      next[2] = next2;
+      next[3] = next3;
+
+      b += 4;
+      next += 4;
+      n_left_from -= 4;
+    }
 
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
+  /* Single loop for potentially the last three packets */
+  while (n_left_from > 0)
+    {
+      ip6_header_t *ip0;
+      ip6_sr_header_t *sr0;
+      u32 next0 = SR_LOCALSID_NEXT_IP6_LOOKUP;
+      ip6_sr_localsid_t *ls0;
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  ip0 = vlib_buffer_get_current (b0);
+      ip0 = vlib_buffer_get_current (b[0]);
 
-	  /* Lookup the SR End behavior based on IP DA (adj) */
-	  ls0 =
-	    pool_elt_at_index (sm->localsids,
-			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+      /* Lookup the SR End behavior based on IP DA (adj) */
+      ls0 =
+	pool_elt_at_index (sm->localsids,
+			   vnet_buffer (b[0])->ip.adj_index[VLIB_TX]);
 
-	  /* Find SRH as well as previous header */
-	  sr0 =
-	    ip6_ext_header_find (vm, b0, ip0, IP_PROTOCOL_IPV6_ROUTE, NULL);
+      /* Find SRH as well as previous header */
+      sr0 =
+	ip6_ext_header_find (vm, b[0], ip0, IP_PROTOCOL_IPV6_ROUTE, NULL);
 
-	  /* SRH processing and End variants */
-	  end_decaps_srh_processing (node, b0, ip0, sr0, ls0, &next0);
+      /* SRH processing and End variants */
+      end_decaps_srh_processing (node, b[0], ip0, sr0, ls0, &next0);
 
-	  if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
-	    {
-	      sr_localsid_trace_t *tr =
-		vlib_add_trace (vm, node, b0, sizeof (*tr));
-	      tr->num_segments = 0;
-	      clib_memcpy (tr->localsid.as_u8, ls0->localsid.as_u8,
-			   sizeof (tr->localsid.as_u8));
-	      tr->behavior = ls0->behavior;
-	      if (ip0 == vlib_buffer_get_current (b0))
-		{
-		  if (ip0->protocol == IP_PROTOCOL_IPV6_ROUTE
-		      && sr0->type == ROUTING_HEADER_TYPE_SR)
-		    {
-		      clib_memcpy (tr->sr, sr0->segments, sr0->length * 8);
-		      tr->num_segments =
-			sr0->length * 8 / sizeof (ip6_address_t);
-		      tr->segments_left = sr0->segments_left;
-		    }
-		}
-	      else
-		tr->num_segments = 0xFF;
-	    }
+      if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	sr_localsid_d_trace (vm, node, b[0], ip0, sr0, ls0);
 
-	  /* Increase the counters */
-	  vlib_increment_combined_counter
-	    (((next0 ==
-	       SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
-	      &(sm->sr_ls_valid_counters)), thread_index, ls0 - sm->localsids,
-	     1, vlib_buffer_length_in_chain (vm, b0));
+      /* Increase the counters */
+      vlib_increment_combined_counter
+	(((next0 ==
+	   SR_LOCALSID_NEXT_ERROR) ? &(sm->sr_ls_invalid_counters) :
+	  &(sm->sr_ls_valid_counters)), thread_index, ls0 - sm->localsids,
+	 1, vlib_buffer_length_in_chain (vm, b[0]));
 
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index, to_next,
-					   n_left_to_next, bi0, next0);
-	}
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      next[0] = next0;
+
+      b += 1;
+      next += 1;
+      n_left_from -= 1;
     }
+
+  sr_localsid_d_enqueue (vm, node, from, bufs, nexts, from_frame->n_vectors);
+
   return from_frame->n_vectors;
 }
 
@@ -2427,7 +2462,9 @@ show_sr_localsid_behaviors_command_fn (vlib_main_t * vm,
 		   "\tEnd.DT6\t-> Endpoint with decapsulation and specific IPv6 table lookup.\n"
 		   "\t\tParameters: '<ip6_fib_table>'\n"
 		   "\tEnd.DT4\t-> Endpoint with decapsulation and specific IPv4 table lookup.\n"
-		   "\t\tParameters: '<ip4_fib_table>'\n");
+		   "\t\tParameters: '<ip4_fib_table>'\n"
+		   "\tEnd.DT46\t-> Endpoint with decapsulation and specific IP table lookup.\n"
+		   "\t\tParameters: '<fib_table>'\n");
   vlib_cli_output (vm, "Plugin behaviors:\n");
   for (i = 0; i < vec_len (plugins_vec); i++)
     {
@@ -2457,6 +2494,11 @@ sr_localsids_init (vlib_main_t * vm)
   ip6_sr_main_t *sm = &sr_main;
   mhash_init (&sm->sr_localsids_index_hash, sizeof (uword),
 	      sizeof (sr_localsid_key_t));
+  /* Export the localsid counters to the stat segment */
+  sm->sr_ls_valid_counters.name = "SR localsid valid";
+  sm->sr_ls_valid_counters.stat_segment_name = "/net/sr/localsid/valid";
+  sm->sr_ls_invalid_counters.name = "SR localsid invalid";
+  sm->sr_ls_invalid_counters.stat_segment_name = "/net/sr/localsid/invalid";
   /* Init SR behaviors DPO type */
   sr_localsid_dpo_type = dpo_register_new_type (&sr_loc_vft, sr_loc_nodes);
   /* Init SR behaviors DPO type */
@@ -185,16 +185,18 @@ VLIB_CLI_COMMAND (set_sr_hop_limit_command, static) = {
  * @brief SR rewrite string computation for IPv6 encapsulation (inline)
  *
  * @param sl is a vector of IPv6 addresses composing the Segment List
+ * @param is_reduced leaves the first SID out of the SRH (H.Encaps.Red)
  *
  * @return precomputed rewrite string for encapsulation
  */
 static inline u8 *
-compute_rewrite_encaps (ip6_address_t * sl)
+compute_rewrite_encaps (ip6_address_t * sl, u8 is_reduced)
 {
   ip6_header_t *iph;
   ip6_sr_header_t *srh;
   ip6_address_t *addrp, *this_address;
   u32 header_length = 0;
+  u32 n_srh = vec_len (sl) - is_reduced;
   u8 *rs = NULL;
 
   header_length = 0;
@@ -202,7 +204,7 @@ compute_rewrite_encaps (ip6_address_t * sl)
   if (vec_len (sl) > 1)
     {
       header_length += sizeof (ip6_sr_header_t);
-      header_length += vec_len (sl) * sizeof (ip6_address_t);
+      header_length += n_srh * sizeof (ip6_address_t);
     }
 
   vec_validate (rs, header_length - 1);
@@ -223,18 +225,19 @@ compute_rewrite_encaps (ip6_address_t * sl)
       srh->protocol = IP_PROTOCOL_IPV6;
       srh->type = ROUTING_HEADER_TYPE_SR;
       srh->segments_left = vec_len (sl) - 1;
-      srh->last_entry = vec_len (sl) - 1;
+      srh->last_entry = n_srh - 1;
       srh->length = ((sizeof (ip6_sr_header_t) +
-		      (vec_len (sl) * sizeof (ip6_address_t))) / 8) - 1;
+		      (n_srh * sizeof (ip6_address_t))) / 8) - 1;
       srh->flags = 0x00;
       srh->tag = 0x0000;
-      addrp = srh->segments + vec_len (sl) - 1;
-      vec_foreach (this_address, sl)
-      {
-	clib_memcpy_fast (addrp->as_u8, this_address->as_u8,
-			  sizeof (ip6_address_t));
-	addrp--;
-      }
+      addrp = srh->segments + n_srh - 1;
+      for (this_address = sl + is_reduced; this_address < vec_end (sl);
+	   this_address++)
+	{
+	  clib_memcpy_fast (addrp->as_u8, this_address->as_u8,
+			    sizeof (ip6_address_t));
+	  addrp--;
+	}
     }
   iph->dst_address.as_u64[0] = sl->as_u64[0];
   iph->dst_address.as_u64[1] = sl->as_u64[1];
@@ -245,38 +248,41 @@ compute_rewrite_encaps (ip6_address_t * sl)
  * @brief SR rewrite string computation for SRH insertion (inline)
  *
  * @param sl is a vector of IPv6 addresses composing the Segment List
+ * @param is_reduced leaves the first SID out of the SRH (H.Insert.Red)
  *
  * @return precomputed rewrite string for SRH insertion
  */
 static inline u8 *
-compute_rewrite_insert (ip6_address_t * sl)
+compute_rewrite_insert (ip6_address_t * sl, u8 is_reduced)
 {
   ip6_sr_header_t *srh;
   ip6_address_t *addrp, *this_address;
   u32 header_length = 0;
+  u32 n_srh = vec_len (sl) + 1 - is_reduced;
   u8 *rs = NULL;
 
   header_length = 0;
   header_length += sizeof (ip6_sr_header_t);
-  header_length += (vec_len (sl) + 1) * sizeof (ip6_address_t);
+  header_length += n_srh * sizeof (ip6_address_t);
 
   vec_validate (rs, header_length - 1);
 
   srh = (ip6_sr_header_t *) rs;
   srh->type = ROUTING_HEADER_TYPE_SR;
   srh->segments_left = vec_len (sl);
-  srh->last_entry = vec_len (sl);
+  srh->last_entry = n_srh - 1;
   srh->length = ((sizeof (ip6_sr_header_t) +
-		  ((vec_len (sl) + 1) * sizeof (ip6_address_t))) / 8) - 1;
+		  (n_srh * sizeof (ip6_address_t))) / 8) - 1;
   srh->flags = 0x00;
   srh->tag = 0x0000;
-  addrp = srh->segments + vec_len (sl);
-  vec_foreach (this_address, sl)
-  {
-    clib_memcpy_fast (addrp->as_u8, this_address->as_u8,
-		      sizeof (ip6_address_t));
-    addrp--;
-  }
+  addrp = srh->segments + n_srh - 1;
+  for (this_address = sl + is_reduced; this_address < vec_end (sl);
+       this_address++)
+    {
+      clib_memcpy_fast (addrp->as_u8, this_address->as_u8,
+			sizeof (ip6_address_t));
+      addrp--;
+    }
   return rs;
 }
 
@@ -284,39 +290,121 @@ compute_rewrite_insert (ip6_address_t * sl)
  * @brief SR rewrite string computation for SRH insertion with BSID (inline)
  *
  * @param sl is a vector of IPv6 addresses composing the Segment List
+ * @param is_reduced leaves the first SID out of the SRH
  *
  * @return precomputed rewrite string for SRH insertion with BSID
  */
 static inline u8 *
-compute_rewrite_bsid (ip6_address_t * sl)
+compute_rewrite_bsid (ip6_address_t * sl, u8 is_reduced)
 {
   ip6_sr_header_t *srh;
   ip6_address_t *addrp, *this_address;
   u32 header_length = 0;
+  u32 n_srh = vec_len (sl) - is_reduced;
   u8 *rs = NULL;
 
   header_length = 0;
   header_length += sizeof (ip6_sr_header_t);
-  header_length += vec_len (sl) * sizeof (ip6_address_t);
+  header_length += n_srh * sizeof (ip6_address_t);
 
   vec_validate (rs, header_length - 1);
 
   srh = (ip6_sr_header_t *) rs;
   srh->type = ROUTING_HEADER_TYPE_SR;
   srh->segments_left = vec_len (sl) - 1;
-  srh->last_entry = vec_len (sl) - 1;
+  srh->last_entry = n_srh - 1;
   srh->length = ((sizeof (ip6_sr_header_t) +
-		  (vec_len (sl) * sizeof (ip6_address_t))) / 8) - 1;
+		  (n_srh * sizeof (ip6_address_t))) / 8) - 1;
   srh->flags = 0x00;
   srh->tag = 0x0000;
-  addrp = srh->segments + vec_len (sl) - 1;
+  addrp = srh->segments + n_srh - 1;
+  for (this_address = sl + is_reduced; this_address < vec_end (sl);
+       this_address++)
+    {
+      clib_memcpy_fast (addrp->as_u8, this_address->as_u8,
+			sizeof (ip6_address_t));
+      addrp--;
+    }
+  return rs;
+}
+
+/**
+ * @brief Packs the uSIDs of a Segment List into carrier addresses
+ *
+ * Consecutive SIDs within the uSID block are packed into as few carriers as
+ * possible, each carrier being the block followed by the uSIDs and zero
+ * padding. SIDs outside of the block, with bits set beyond the uSID, or with
+ * an all-zero uSID, are kept as regular SIDs and close the current carrier.
+ *
+ * @param sl is a vector of IPv6 addresses composing the Segment List
+ * @param usid is the uSID block and length of the SR policy
+ *
+ * @return vector of carriers and uncompressed SIDs
+ */
+static ip6_address_t *
+compress_usid_sl (ip6_address_t * sl, ip6_sr_usid_t * usid)
+{
+  ip6_address_t *packed = 0, *carrier = 0, *this_address;
+  u8 block_bytes = usid->block_len / 8;
+  u8 usid_bytes = usid->usid_len / 8;
+  u8 offset = sizeof (ip6_address_t);
+  ip6_address_t block_mask, masked;
+  u8 i, compressible, usid_bits;
+
+  ip6_address_mask_from_width (&block_mask, usid->block_len);
+
   vec_foreach (this_address, sl)
   {
-    clib_memcpy_fast (addrp->as_u8, this_address->as_u8,
-		      sizeof (ip6_address_t));
-    addrp--;
+    masked = *this_address;
+    ip6_address_mask (&masked, &block_mask);
+
+    compressible = ip6_address_is_equal (&masked, &usid->block);
+    for (i = block_bytes + usid_bytes; compressible && i < 16; i++)
+      compressible = (this_address->as_u8[i] == 0);
+
+    /* an all-zero uSID would read as the end of the carrier */
+    usid_bits = 0;
+    for (i = block_bytes; i < block_bytes + usid_bytes; i++)
+      usid_bits |= this_address->as_u8[i];
+    compressible = compressible && usid_bits;
+
+    if (!compressible)
+      {
+	vec_add1 (packed, *this_address);
+	offset = sizeof (ip6_address_t);
+	continue;
+      }
+
+    if (offset + usid_bytes > sizeof (ip6_address_t))
+      {
+	vec_add2 (packed, carrier, 1);
+	*carrier = usid->block;
+	offset = block_bytes;
+      }
+
+    clib_memcpy_fast (carrier->as_u8 + offset,
+		      this_address->as_u8 + block_bytes, usid_bytes);
+    offset += usid_bytes;
   }
-  return rs;
+
+  return packed;
+}
+
+/**
+ * @brief Names the counters of a SID list in the stat segment
+ *
+ * The name is the BindingSID of the policy followed by the SID list index,
+ * as in 'show sr policies'.
+ */
+static void
+sr_sl_set_stats_name (ip6_sr_policy_t * sr_policy, u32 sl_index)
+{
+  u8 *name;
+
+  name = format (0, "%U[%u]", format_ip6_address, &sr_policy->bsid,
+		 sl_index);
+  vlib_stats_set_name ("/net/sr/sid-list/names", sl_index, name);
+  vec_free (name);
 }
 
 /***************************  SR LB helper functions **************************/
@@ -351,17 +439,37 @@ create_sl (ip6_sr_policy_t * sr_policy, ip6_address_t * sl, u32 weight,
   segment_list->weight =
     (weight != (u32) ~ 0 ? weight : SR_SEGMENT_LIST_WEIGHT_DEFAULT);
 
-  segment_list->segments = vec_dup (sl);
+  /* With uSID the SID list holds the carriers as they go on the wire */
+  if (sr_policy->usid.usid_len)
+    segment_list->segments = compress_usid_sl (sl, &sr_policy->usid);
+  else
+    segment_list->segments = vec_dup (sl);
+  sl = segment_list->segments;
+
+  segment_list->flow_label_entropy = sr_policy->flow_label_entropy;
+  segment_list->policy_index = sr_policy - sm->sr_policies;
+
+  vlib_validate_combined_counter (&sm->sr_sl_counters,
+				  segment_list - sm->sid_lists);
+  vlib_zero_combined_counter (&sm->sr_sl_counters,
+			      segment_list - sm->sid_lists);
+  sr_sl_set_stats_name (sr_policy, segment_list - sm->sid_lists);
+
+  /* A single SID needs no SRH in reduced mode, keep the regular rewrite */
+  segment_list->is_reduced = sr_policy->is_reduced && vec_len (sl) > 1;
 
   if (is_encap)
     {
-      segment_list->rewrite = compute_rewrite_encaps (sl);
+      segment_list->rewrite =
+	compute_rewrite_encaps (sl, segment_list->is_reduced);
       segment_list->rewrite_bsid = segment_list->rewrite;
     }
   else
     {
-      segment_list->rewrite = compute_rewrite_insert (sl);
-      segment_list->rewrite_bsid = compute_rewrite_bsid (sl);
+      segment_list->rewrite =
+	compute_rewrite_insert (sl, segment_list->is_reduced);
+      segment_list->rewrite_bsid =
+	compute_rewrite_bsid (sl, segment_list->is_reduced);
     }
 
   if (sr_policy->plugin)
@@ -603,6 +711,33 @@ update_replicate (ip6_sr_policy_t * sr_policy)
     replicate_multipath_update (&sr_policy->ip4_dpo, ip4_path_vector);
 }
 
+/**
+ * @brief Notify the SR Policy change listeners
+ *
+ * @param bsid is the bindingSID of the added/modified/deleted SR Policy
+ */
+static void
+sr_policy_notify_change (ip6_address_t * bsid)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  sr_policy_change_fn_t **fn;
+
+  vec_foreach (fn, sm->policy_change_callbacks) (*fn) (bsid);
+}
+
+/**
+ * @brief Register a function to be called on every SR Policy change
+ *
+ * @param fn is the function to be called with the bindingSID of the policy
+ */
+void
+sr_policy_register_change_callback (sr_policy_change_fn_t * fn)
+{
+  ip6_sr_main_t *sm = &sr_main;
+
+  vec_add1 (sm->policy_change_callbacks, fn);
+}
+
 /******************************* SR rewrite API *******************************/
 /* Three functions for handling sr policies:
  *   -> sr_policy_add
@@ -619,16 +754,21 @@ update_replicate (ip6_sr_policy_t * sr_policy)
  * @param behavior is the behavior of the SR policy. (default//spray)
  * @param fib_table is the VRF where to install the FIB entry for the BSID
  * @param is_encap (bool) whether SR policy should behave as Encap/SRH Insertion
+ * @param is_reduced (bool) whether the first SID is left out of the SRH
+ * @param usid is the uSID block used to compress the SID lists. optional.
  *
  * @return 0 if correct, else error
  */
 int
 sr_policy_add (ip6_address_t * bsid, ip6_address_t * segments,
 	       u32 weight, u8 behavior, u32 fib_table, u8 is_encap,
-	       u16 plugin, void *ls_plugin_mem)
+	       u8 is_reduced, ip6_sr_usid_t * usid, u16 plugin,
+	       void *ls_plugin_mem)
 {
   ip6_sr_main_t *sm = &sr_main;
   ip6_sr_policy_t *sr_policy = 0;
+  ip6_address_t mask;
+  u8 *name;
   uword *p;
 
   /* Search for existing keys (BSID) */
@@ -639,6 +779,13 @@ sr_policy_add (ip6_address_t * bsid, ip6_address_t * segments,
       return -12;
     }
 
+  /* uSIDs are 16 or 32 bits long and start on a byte boundary */
+  if (usid && usid->usid_len
+      && ((usid->usid_len != 16 && usid->usid_len != 32)
+	  || (usid->block_len & 0x7)
+	  || usid->block_len + usid->usid_len > 128))
+    return -14;
+
   /* Search collision in FIB entries */
   /* Explanation: It might be possible that some other entity has already
    * created a route for the BSID. This in theory is impossible, but in
@@ -669,6 +816,13 @@ sr_policy_add (ip6_address_t * bsid, ip6_address_t * segments,
   sr_policy->type = behavior;
   sr_policy->fib_table = (fib_table != (u32) ~ 0 ? fib_table : 0);	//Is default FIB 0 ?
   sr_policy->is_encap = is_encap;
+  sr_policy->is_reduced = is_reduced;
+  if (usid && usid->usid_len)
+    {
+      sr_policy->usid = *usid;
+      ip6_address_mask_from_width (&mask, usid->block_len);
+      ip6_address_mask (&sr_policy->usid.block, &mask);
+    }
 
   if (plugin)
     {
@@ -680,6 +834,15 @@ sr_policy_add (ip6_address_t * bsid, ip6_address_t * segments,
   mhash_set (&sm->sr_policies_index_hash, bsid, sr_policy - sm->sr_policies,
 	     NULL);
 
+  vlib_validate_combined_counter (&sm->sr_policy_counters,
+				  sr_policy - sm->sr_policies);
+  vlib_zero_combined_counter (&sm->sr_policy_counters,
+			      sr_policy - sm->sr_policies);
+  name = format (0, "%U", format_ip6_address, bsid);
+  vlib_stats_set_name ("/net/sr/policy/names", sr_policy - sm->sr_policies,
+		       name);
+  vec_free (name);
+
   /* Create a segment list and add the index to the SR policy */
   create_sl (sr_policy, segments, weight, is_encap);
 
@@ -699,6 +862,8 @@ sr_policy_add (ip6_address_t * bsid, ip6_address_t * segments,
     update_lb (sr_policy);
   else if (sr_policy->type == SR_POLICY_TYPE_SPRAY)
     update_replicate (sr_policy);
+
+  sr_policy_notify_change (bsid);
   return 0;
 }
 
@@ -716,6 +881,7 @@ sr_policy_del (ip6_address_t * bsid, u32 index)
   ip6_sr_main_t *sm = &sr_main;
   ip6_sr_policy_t *sr_policy = 0;
   ip6_sr_sl_t *segment_list;
+  ip6_address_t policy_bsid;
   u32 *sl_index;
   uword *p;
 
@@ -768,6 +934,7 @@ sr_policy_del (ip6_address_t * bsid, u32 index)
     vec_free (segment_list->rewrite);
     if (!sr_policy->is_encap)
       vec_free (segment_list->rewrite_bsid);
+    vlib_stats_set_name ("/net/sr/sid-list/names", *sl_index, 0);
     pool_put_index (sm->sid_lists, *sl_index);
   }
 
@@ -785,9 +952,14 @@ sr_policy_del (ip6_address_t * bsid, u32 index)
     }
 
   /* Remove SR policy entry */
+  policy_bsid = sr_policy->bsid;
   mhash_unset (&sm->sr_policies_index_hash, &sr_policy->bsid, NULL);
+  vlib_stats_set_name ("/net/sr/policy/names", sr_policy - sm->sr_policies,
+		       0);
   pool_put (sm->sr_policies, sr_policy);
 
+  sr_policy_notify_change (&policy_bsid);
+
   /* If FIB empty unlock it */
   if (!pool_elts (sm->sr_policies) && !pool_elts (sm->steer_policies))
     {
@@ -876,6 +1048,7 @@ sr_policy_mod (ip6_address_t * bsid, u32 index, u32 fib_table,
       vec_free (segment_list->rewrite);
       if (!sr_policy->is_encap)
 	vec_free (segment_list->rewrite_bsid);
+      vlib_stats_set_name ("/net/sr/sid-list/names", sl_index, 0);
       pool_put_index (sm->sid_lists, sl_index);
       vec_del1 (sr_policy->segments_lists,
 		sl_index_iterate - sr_policy->segments_lists);
@@ -907,6 +1080,55 @@ sr_policy_mod (ip6_address_t * bsid, u32 index, u32 fib_table,
   else				/* Incorrect op. */
     return -1;
 
+  sr_policy_notify_change (&sr_policy->bsid);
+  return 0;
+}
+
+/**
+ * @brief Enables or disables the outer flow label entropy of an SR policy
+ *
+ * The encapsulation nodes then write a hash of the inner flow into the outer
+ * IPv6 flow label, so that the core can balance the traffic of the policy.
+ *
+ * @param bsid is the bindingSID of the SR Policy
+ * @param index is the index of the SR policy
+ * @param enable turns the entropy on or off
+ *
+ * @return 0 if correct, else error
+ */
+int
+sr_policy_set_flow_label_entropy (ip6_address_t * bsid, u32 index, u8 enable)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  ip6_sr_policy_t *sr_policy = 0;
+  ip6_sr_sl_t *segment_list;
+  u32 *sl_index;
+  uword *p;
+
+  if (bsid)
+    {
+      p = mhash_get (&sm->sr_policies_index_hash, bsid);
+      if (p)
+	sr_policy = pool_elt_at_index (sm->sr_policies, p[0]);
+      else
+	return -1;
+    }
+  else
+    {
+      if (pool_is_free_index (sm->sr_policies, index))
+	return -1;
+      sr_policy = pool_elt_at_index (sm->sr_policies, index);
+    }
+
+  sr_policy->flow_label_entropy = enable;
+
+  /* The encaps nodes only see the SID list */
+  vec_foreach (sl_index, sr_policy->segments_lists)
+  {
+    segment_list = pool_elt_at_index (sm->sid_lists, *sl_index);
+    segment_list->flow_label_entropy = enable;
+  }
+
   return 0;
 }
 
@@ -927,6 +1149,9 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
   ip6_address_t *segments = 0, *this_seg;
   u8 operation = 0;
   char is_encap = 1;
+  char is_reduced = 0;
+  ip6_sr_usid_t usid = { 0 };
+  u32 usid_block_len, usid_len;
   char is_spray = 0;
   u16 behavior = 0;
   void *ls_plugin_mem = 0;
@@ -965,6 +1190,15 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	is_encap = 1;
       else if (unformat (input, "insert"))
 	is_encap = 0;
+      else if (unformat (input, "reduced"))
+	is_reduced = 1;
+      else if (unformat (input, "usid-block %U/%u usid-len %u",
+			 unformat_ip6_address, &usid.block, &usid_block_len,
+			 &usid_len))
+	{
+	  usid.block_len = usid_block_len;
+	  usid.usid_len = usid_len;
+	}
       else if (unformat (input, "spray"))
 	is_spray = 1;
       else if (!behavior && unformat (input, "behavior"))
@@ -1018,7 +1252,7 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
       rv = sr_policy_add (&bsid, segments, weight,
 			  (is_spray ? SR_POLICY_TYPE_SPRAY :
 			   SR_POLICY_TYPE_DEFAULT), fib_table, is_encap,
-			  behavior, ls_plugin_mem);
+			  is_reduced, &usid, behavior, ls_plugin_mem);
 
       vec_free (segments);
     }
@@ -1056,6 +1290,11 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
 				"The SR policy could not be created.");
     case -13:
       return clib_error_return (0, "The specified FIB table does not exist.");
+    case -14:
+      return clib_error_return (0,
+				"Invalid uSID block or length. The uSID length "
+				"must be 16 or 32 and the block length a "
+				"multiple of 8.");
     case -21:
       return clib_error_return (0,
 				"The selected SR policy only contains ONE segment list. "
@@ -1078,12 +1317,17 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
 VLIB_CLI_COMMAND (sr_policy_command, static) = {
   .path = "sr policy",
   .short_help = "sr policy [add||del||mod] [bsid 2001::1||index 5] "
-    "next A:: next B:: next C:: (weight 1) (fib-table 2) (encap|insert)",
+    "next A:: next B:: next C:: (weight 1) (fib-table 2) (encap|insert) (reduced) "
+    "(usid-block B::/32 usid-len 16)",
   .long_help =
     "Manipulation of SR policies.\n"
     "A Segment Routing policy may contain several SID lists. Each SID list has\n"
     "an associated weight (default 1), which will result in wECMP (uECMP).\n"
     "Segment Routing policies might be of type encapsulation or srh insertion\n"
+    "With reduced, the first SID is only carried in the IPv6 DA and is left\n"
+    "out of the SRH (H.Encaps.Red / H.Insert.Red).\n"
+    "With a uSID block, consecutive SIDs within the block are packed into\n"
+    "uSID carriers, each carrier holding as many uSIDs as fit after the block.\n"
     "Each SR policy will be associated with a unique BindingSID.\n"
     "A BindingSID is a locally allocated SegmentID. For every packet that arrives\n"
     "with IPv6_DA:BSID such traffic will be steered into the SR policy.\n"
@@ -1096,6 +1340,56 @@ VLIB_CLI_COMMAND (sr_policy_command, static) = {
 };
 /* *INDENT-ON* */
 
+/**
+ * @brief CLI to set the outer flow label entropy of an SR policy
+ */
+static clib_error_t *
+set_sr_policy_flow_label_entropy_command_fn (vlib_main_t * vm,
+					     unformat_input_t * input,
+					     vlib_cli_command_t * cmd)
+{
+  ip6_address_t bsid;
+  u32 sr_policy_index = (u32) ~ 0;
+  char policy_set = 0;
+  u8 enable = 1;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (!policy_set
+	  && unformat (input, "bsid %U", unformat_ip6_address, &bsid))
+	policy_set = 1;
+      else if (!policy_set && unformat (input, "index %d", &sr_policy_index))
+	policy_set = 1;
+      else if (unformat (input, "disable"))
+	enable = 0;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (!policy_set)
+    return clib_error_return (0, "No SR policy BSID or index specified");
+
+  if (sr_policy_set_flow_label_entropy ((sr_policy_index != (u32) ~ 0 ?
+					 NULL : &bsid), sr_policy_index,
+					enable))
+    return clib_error_return (0, "No such SR policy");
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (set_sr_policy_flow_label_entropy_command, static) = {
+  .path = "set sr policy flow-label-entropy",
+  .short_help = "set sr policy flow-label-entropy [bsid 2001::1||index 5] "
+    "(disable)",
+  .long_help =
+    "Writes a hash of the inner flow into the outer IPv6 flow label of the\n"
+    "packets encapsulated by the SR policy.\n",
+  .function = set_sr_policy_flow_label_entropy_command_fn,
+};
+/* *INDENT-ON* */
+
 /**
  * @brief CLI to display onscreen all the SR policies
  */
@@ -1125,9 +1419,16 @@ show_sr_policies_command_fn (vlib_main_t * vm, unformat_input_t * input,
     vlib_cli_output (vm, "[%u].-\tBSID: %U",
 		     (u32) (sr_policy - sm->sr_policies),
 		     format_ip6_address, &sr_policy->bsid);
-    vlib_cli_output (vm, "\tBehavior: %s",
+    vlib_cli_output (vm, "\tBehavior: %s%s",
 		     (sr_policy->is_encap ? "Encapsulation" :
-		      "SRH insertion"));
+		      "SRH insertion"),
+		     (sr_policy->is_reduced ? " (reduced SRH)" : ""));
+    if (sr_policy->flow_label_entropy)
+      vlib_cli_output (vm, "\tFlow label: inner flow hash");
+    if (sr_policy->usid.usid_len)
+      vlib_cli_output (vm, "\tuSID block: %U/%u, uSID length: %u",
+		       format_ip6_address, &sr_policy->usid.block,
+		       sr_policy->usid.block_len, sr_policy->usid.usid_len);
     vlib_cli_output (vm, "\tType: %s",
 		     (sr_policy->type ==
 		      SR_POLICY_TYPE_DEFAULT ? "Default" : "Spray"));
@@ -1181,13 +1482,44 @@ format_sr_policy_rewrite_trace (u8 * s, va_list * args)
   return s;
 }
 
+/**
+ * @brief Writes a flow hash of the inner packet into the outer flow label
+ *
+ * Folds the 32 bit hash into the 20 bit flow label (RFC 6438) and keeps the
+ * version and traffic class of the outer header.
+ */
+static_always_inline void
+encaps_flow_label_entropy (ip6_header_t * ip0, u32 flow_hash)
+{
+  flow_hash = (flow_hash ^ (flow_hash >> 20)) & 0x000fffff;
+  ip0->ip_version_traffic_class_and_flow_label =
+    (ip0->ip_version_traffic_class_and_flow_label &
+     clib_host_to_net_u32 (0xfff00000)) | clib_host_to_net_u32 (flow_hash);
+}
+
+/**
+ * @brief Counts a packet, as received, against its SID list and SR policy
+ */
+static_always_inline void
+sr_policy_rewrite_count (vlib_main_t * vm, ip6_sr_main_t * sm,
+			 vlib_buffer_t * b0, ip6_sr_sl_t * sl0)
+{
+  u32 len0 = vlib_buffer_length_in_chain (vm, b0);
+
+  vlib_increment_combined_counter (&sm->sr_sl_counters, vm->thread_index,
+				   sl0 - sm->sid_lists, 1, len0);
+  vlib_increment_combined_counter (&sm->sr_policy_counters, vm->thread_index,
+				   sl0->policy_index, 1, len0);
+}
+
 /**
  * @brief IPv6 encapsulation processing as per RFC2473
  */
 static_always_inline void
 encaps_processing_v6 (vlib_node_runtime_t * node,
 		      vlib_buffer_t * b0,
-		      ip6_header_t * ip0, ip6_header_t * ip0_encap)
+		      ip6_header_t * ip0, ip6_header_t * ip0_encap,
+		      u8 flow_label_entropy)
 {
   u32 new_l0;
 
@@ -1198,6 +1530,11 @@ encaps_processing_v6 (vlib_node_runtime_t * node,
   ip0->payload_length = clib_host_to_net_u16 (new_l0);
   ip0->ip_version_traffic_class_and_flow_label =
     ip0_encap->ip_version_traffic_class_and_flow_label;
+
+  if (PREDICT_FALSE (flow_label_entropy))
+    encaps_flow_label_entropy (ip0,
+			       ip6_compute_flow_hash (ip0_encap,
+						      IP_FLOW_HASH_DEFAULT));
 }
 
 /**
@@ -1282,6 +1619,11 @@ sr_policy_rewrite_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
 
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
+	  sr_policy_rewrite_count (vm, sm, b1, sl1);
+	  sr_policy_rewrite_count (vm, sm, b2, sl2);
+	  sr_policy_rewrite_count (vm, sm, b3, sl3);
+
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 	  ASSERT (b1->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
@@ -1315,10 +1657,14 @@ sr_policy_rewrite_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  ip2 = vlib_buffer_get_current (b2);
 	  ip3 = vlib_buffer_get_current (b3);
 
-	  encaps_processing_v6 (node, b0, ip0, ip0_encap);
-	  encaps_processing_v6 (node, b1, ip1, ip1_encap);
-	  encaps_processing_v6 (node, b2, ip2, ip2_encap);
-	  encaps_processing_v6 (node, b3, ip3, ip3_encap);
+	  encaps_processing_v6 (node, b0, ip0, ip0_encap,
+				sl0->flow_label_entropy);
+	  encaps_processing_v6 (node, b1, ip1, ip1_encap,
+				sl1->flow_label_entropy);
+	  encaps_processing_v6 (node, b2, ip2, ip2_encap,
+				sl2->flow_label_entropy);
+	  encaps_processing_v6 (node, b3, ip3, ip3_encap,
+				sl3->flow_label_entropy);
 
 	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
 	    {
@@ -1389,6 +1735,7 @@ sr_policy_rewrite_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl0 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 
@@ -1400,7 +1747,8 @@ sr_policy_rewrite_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 
 	  ip0 = vlib_buffer_get_current (b0);
 
-	  encaps_processing_v6 (node, b0, ip0, ip0_encap);
+	  encaps_processing_v6 (node, b0, ip0, ip0_encap,
+				sl0->flow_label_entropy);
 
 	  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
 	      PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
@@ -1456,7 +1804,8 @@ VLIB_REGISTER_NODE (sr_policy_rewrite_encaps_node) = {
 static_always_inline void
 encaps_processing_v4 (vlib_node_runtime_t * node,
 		      vlib_buffer_t * b0,
-		      ip6_header_t * ip0, ip4_header_t * ip0_encap)
+		      ip6_header_t * ip0, ip4_header_t * ip0_encap,
+		      u8 flow_label_entropy)
 {
   u32 new_l0;
   ip6_sr_header_t *sr0;
@@ -1475,6 +1824,10 @@ encaps_processing_v4 (vlib_node_runtime_t * node,
   ip0->ip_version_traffic_class_and_flow_label =
     clib_host_to_net_u32 (0 | ((6 & 0xF) << 28) |
 			  ((ip0_encap->tos & 0xFF) << 20));
+  if (PREDICT_FALSE (flow_label_entropy))
+    encaps_flow_label_entropy (ip0,
+			       ip4_compute_flow_hash (ip0_encap,
+						      IP_FLOW_HASH_DEFAULT));
   if (ip0->protocol == IP_PROTOCOL_IPV6_ROUTE)
     {
       sr0 = (void *) (ip0 + 1);
@@ -1565,6 +1918,12 @@ sr_policy_rewrite_encaps_v4 (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl3 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
+
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
+	  sr_policy_rewrite_count (vm, sm, b1, sl1);
+	  sr_policy_rewrite_count (vm, sm, b2, sl2);
+	  sr_policy_rewrite_count (vm, sm, b3, sl3);
+
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 	  ASSERT (b1->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
@@ -1598,10 +1957,14 @@ sr_policy_rewrite_encaps_v4 (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  ip2 = vlib_buffer_get_current (b2);
 	  ip3 = vlib_buffer_get_current (b3);
 
-	  encaps_processing_v4 (node, b0, ip0, ip0_encap);
-	  encaps_processing_v4 (node, b1, ip1, ip1_encap);
-	  encaps_processing_v4 (node, b2, ip2, ip2_encap);
-	  encaps_processing_v4 (node, b3, ip3, ip3_encap);
+	  encaps_processing_v4 (node, b0, ip0, ip0_encap,
+				sl0->flow_label_entropy);
+	  encaps_processing_v4 (node, b1, ip1, ip1_encap,
+				sl1->flow_label_entropy);
+	  encaps_processing_v4 (node, b2, ip2, ip2_encap,
+				sl2->flow_label_entropy);
+	  encaps_processing_v4 (node, b3, ip3, ip3_encap,
+				sl3->flow_label_entropy);
 
 	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
 	    {
@@ -1673,6 +2036,7 @@ sr_policy_rewrite_encaps_v4 (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl0 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 
@@ -1684,7 +2048,8 @@ sr_policy_rewrite_encaps_v4 (vlib_main_t * vm, vlib_node_runtime_t * node,
 
 	  ip0 = vlib_buffer_get_current (b0);
 
-	  encaps_processing_v4 (node, b0, ip0, ip0_encap);
+	  encaps_processing_v4 (node, b0, ip0, ip0_encap,
+				sl0->flow_label_entropy);
 
 	  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
 	      PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
@@ -1922,6 +2287,25 @@ sr_policy_rewrite_encaps_l2 (vlib_main_t * vm, vlib_node_runtime_t * node,
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
 
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
+	  sr_policy_rewrite_count (vm, sm, b1, sl1);
+	  sr_policy_rewrite_count (vm, sm, b2, sl2);
+	  sr_policy_rewrite_count (vm, sm, b3, sl3);
+
+	  /* The flow label entropy needs the hash of the L2 frame */
+	  if (PREDICT_FALSE (sl0->flow_label_entropy
+			     && vec_len (sp0->segments_lists) == 1))
+	    vnet_buffer (b0)->ip.flow_hash = l2_flow_hash (b0);
+	  if (PREDICT_FALSE (sl1->flow_label_entropy
+			     && vec_len (sp1->segments_lists) == 1))
+	    vnet_buffer (b1)->ip.flow_hash = l2_flow_hash (b1);
+	  if (PREDICT_FALSE (sl2->flow_label_entropy
+			     && vec_len (sp2->segments_lists) == 1))
+	    vnet_buffer (b2)->ip.flow_hash = l2_flow_hash (b2);
+	  if (PREDICT_FALSE (sl3->flow_label_entropy
+			     && vec_len (sp3->segments_lists) == 1))
+	    vnet_buffer (b3)->ip.flow_hash = l2_flow_hash (b3);
+
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 	  ASSERT (b1->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
@@ -1998,6 +2382,14 @@ sr_policy_rewrite_encaps_l2 (vlib_main_t * vm, vlib_node_runtime_t * node,
 
 	  /* Which Traffic class and flow label do I set ? */
 	  //ip0->ip_version_traffic_class_and_flow_label = clib_host_to_net_u32(0|((6&0xF)<<28)|((ip0_encap->tos&0xFF)<<20));
+	  if (PREDICT_FALSE (sl0->flow_label_entropy))
+	    encaps_flow_label_entropy (ip0, vnet_buffer (b0)->ip.flow_hash);
+	  if (PREDICT_FALSE (sl1->flow_label_entropy))
+	    encaps_flow_label_entropy (ip1, vnet_buffer (b1)->ip.flow_hash);
+	  if (PREDICT_FALSE (sl2->flow_label_entropy))
+	    encaps_flow_label_entropy (ip2, vnet_buffer (b2)->ip.flow_hash);
+	  if (PREDICT_FALSE (sl3->flow_label_entropy))
+	    encaps_flow_label_entropy (ip3, vnet_buffer (b3)->ip.flow_hash);
 
 	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
 	    {
@@ -2087,9 +2479,14 @@ sr_policy_rewrite_encaps_l2 (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl0 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 
+	  if (PREDICT_FALSE (sl0->flow_label_entropy
+			     && vec_len (sp0->segments_lists) == 1))
+	    vnet_buffer (b0)->ip.flow_hash = l2_flow_hash (b0);
+
 	  en0 = vlib_buffer_get_current (b0);
 
 	  clib_memcpy_fast (((u8 *) en0) - vec_len (sl0->rewrite),
@@ -2102,6 +2499,9 @@ sr_policy_rewrite_encaps_l2 (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  ip0->payload_length =
 	    clib_host_to_net_u16 (b0->current_length - sizeof (ip6_header_t));
 
+	  if (PREDICT_FALSE (sl0->flow_label_entropy))
+	    encaps_flow_label_entropy (ip0, vnet_buffer (b0)->ip.flow_hash);
+
 	  if (ip0->protocol == IP_PROTOCOL_IPV6_ROUTE)
 	    {
 	      sr0 = (void *) (ip0 + 1);
@@ -2240,6 +2640,12 @@ sr_policy_rewrite_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl3 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
+
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
+	  sr_policy_rewrite_count (vm, sm, b1, sl1);
+	  sr_policy_rewrite_count (vm, sm, b2, sl2);
+	  sr_policy_rewrite_count (vm, sm, b3, sl3);
+
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 	  ASSERT (b1->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
@@ -2347,22 +2753,14 @@ sr_policy_rewrite_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sr3->segments->as_u64[0] = ip3->dst_address.as_u64[0];
 	  sr3->segments->as_u64[1] = ip3->dst_address.as_u64[1];
 
-	  ip0->dst_address.as_u64[0] =
-	    (sr0->segments + sr0->segments_left)->as_u64[0];
-	  ip0->dst_address.as_u64[1] =
-	    (sr0->segments + sr0->segments_left)->as_u64[1];
-	  ip1->dst_address.as_u64[0] =
-	    (sr1->segments + sr1->segments_left)->as_u64[0];
-	  ip1->dst_address.as_u64[1] =
-	    (sr1->segments + sr1->segments_left)->as_u64[1];
-	  ip2->dst_address.as_u64[0] =
-	    (sr2->segments + sr2->segments_left)->as_u64[0];
-	  ip2->dst_address.as_u64[1] =
-	    (sr2->segments + sr2->segments_left)->as_u64[1];
-	  ip3->dst_address.as_u64[0] =
-	    (sr3->segments + sr3->segments_left)->as_u64[0];
-	  ip3->dst_address.as_u64[1] =
-	    (sr3->segments + sr3->segments_left)->as_u64[1];
+	  ip0->dst_address.as_u64[0] = sl0->segments->as_u64[0];
+	  ip0->dst_address.as_u64[1] = sl0->segments->as_u64[1];
+	  ip1->dst_address.as_u64[0] = sl1->segments->as_u64[0];
+	  ip1->dst_address.as_u64[1] = sl1->segments->as_u64[1];
+	  ip2->dst_address.as_u64[0] = sl2->segments->as_u64[0];
+	  ip2->dst_address.as_u64[1] = sl2->segments->as_u64[1];
+	  ip3->dst_address.as_u64[0] = sl3->segments->as_u64[0];
+	  ip3->dst_address.as_u64[1] = sl3->segments->as_u64[1];
 
 	  ip6_ext_header_t *ip_ext;
 	  if (ip0 + 1 == (void *) sr0)
@@ -2485,6 +2883,7 @@ sr_policy_rewrite_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl0 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 
@@ -2515,10 +2914,8 @@ sr_policy_rewrite_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sr0->segments->as_u64[0] = ip0->dst_address.as_u64[0];
 	  sr0->segments->as_u64[1] = ip0->dst_address.as_u64[1];
 
-	  ip0->dst_address.as_u64[0] =
-	    (sr0->segments + sr0->segments_left)->as_u64[0];
-	  ip0->dst_address.as_u64[1] =
-	    (sr0->segments + sr0->segments_left)->as_u64[1];
+	  ip0->dst_address.as_u64[0] = sl0->segments->as_u64[0];
+	  ip0->dst_address.as_u64[1] = sl0->segments->as_u64[1];
 
 	  if (ip0 + 1 == (void *) sr0)
 	    {
@@ -2662,6 +3059,12 @@ sr_policy_rewrite_b_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl3 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
+
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
+	  sr_policy_rewrite_count (vm, sm, b1, sl1);
+	  sr_policy_rewrite_count (vm, sm, b2, sl2);
+	  sr_policy_rewrite_count (vm, sm, b3, sl3);
+
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite_bsid));
 	  ASSERT (b1->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
@@ -2760,22 +3163,14 @@ sr_policy_rewrite_b_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sr2 = ((void *) sr2) - vec_len (sl2->rewrite_bsid);
 	  sr3 = ((void *) sr3) - vec_len (sl3->rewrite_bsid);
 
-	  ip0->dst_address.as_u64[0] =
-	    (sr0->segments + sr0->segments_left)->as_u64[0];
-	  ip0->dst_address.as_u64[1] =
-	    (sr0->segments + sr0->segments_left)->as_u64[1];
-	  ip1->dst_address.as_u64[0] =
-	    (sr1->segments + sr1->segments_left)->as_u64[0];
-	  ip1->dst_address.as_u64[1] =
-	    (sr1->segments + sr1->segments_left)->as_u64[1];
-	  ip2->dst_address.as_u64[0] =
-	    (sr2->segments + sr2->segments_left)->as_u64[0];
-	  ip2->dst_address.as_u64[1] =
-	    (sr2->segments + sr2->segments_left)->as_u64[1];
-	  ip3->dst_address.as_u64[0] =
-	    (sr3->segments + sr3->segments_left)->as_u64[0];
-	  ip3->dst_address.as_u64[1] =
-	    (sr3->segments + sr3->segments_left)->as_u64[1];
+	  ip0->dst_address.as_u64[0] = sl0->segments->as_u64[0];
+	  ip0->dst_address.as_u64[1] = sl0->segments->as_u64[1];
+	  ip1->dst_address.as_u64[0] = sl1->segments->as_u64[0];
+	  ip1->dst_address.as_u64[1] = sl1->segments->as_u64[1];
+	  ip2->dst_address.as_u64[0] = sl2->segments->as_u64[0];
+	  ip2->dst_address.as_u64[1] = sl2->segments->as_u64[1];
+	  ip3->dst_address.as_u64[0] = sl3->segments->as_u64[0];
+	  ip3->dst_address.as_u64[1] = sl3->segments->as_u64[1];
 
 	  ip6_ext_header_t *ip_ext;
 	  if (ip0 + 1 == (void *) sr0)
@@ -2898,6 +3293,7 @@ sr_policy_rewrite_b_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl0 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite_bsid));
 
@@ -2926,10 +3322,8 @@ sr_policy_rewrite_b_insert (vlib_main_t * vm, vlib_node_runtime_t * node,
 
 	  sr0 = ((void *) sr0) - vec_len (sl0->rewrite_bsid);
 
-	  ip0->dst_address.as_u64[0] =
-	    (sr0->segments + sr0->segments_left)->as_u64[0];
-	  ip0->dst_address.as_u64[1] =
-	    (sr0->segments + sr0->segments_left)->as_u64[1];
+	  ip0->dst_address.as_u64[0] = sl0->segments->as_u64[0];
+	  ip0->dst_address.as_u64[1] = sl0->segments->as_u64[1];
 
 	  if (ip0 + 1 == (void *) sr0)
 	    {
@@ -3105,6 +3499,12 @@ sr_policy_rewrite_b_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl3 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
+
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
+	  sr_policy_rewrite_count (vm, sm, b1, sl1);
+	  sr_policy_rewrite_count (vm, sm, b2, sl2);
+	  sr_policy_rewrite_count (vm, sm, b3, sl3);
+
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 	  ASSERT (b1->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
@@ -3156,10 +3556,14 @@ sr_policy_rewrite_b_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  ip2 = vlib_buffer_get_current (b2);
 	  ip3 = vlib_buffer_get_current (b3);
 
-	  encaps_processing_v6 (node, b0, ip0, ip0_encap);
-	  encaps_processing_v6 (node, b1, ip1, ip1_encap);
-	  encaps_processing_v6 (node, b2, ip2, ip2_encap);
-	  encaps_processing_v6 (node, b3, ip3, ip3_encap);
+	  encaps_processing_v6 (node, b0, ip0, ip0_encap,
+				sl0->flow_label_entropy);
+	  encaps_processing_v6 (node, b1, ip1, ip1_encap,
+				sl1->flow_label_entropy);
+	  encaps_processing_v6 (node, b2, ip2, ip2_encap,
+				sl2->flow_label_entropy);
+	  encaps_processing_v6 (node, b3, ip3, ip3_encap,
+				sl3->flow_label_entropy);
 
 	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
 	    {
@@ -3231,6 +3635,7 @@ sr_policy_rewrite_b_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sl0 =
 	    pool_elt_at_index (sm->sid_lists,
 			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
+	  sr_policy_rewrite_count (vm, sm, b0, sl0);
 	  ASSERT (b0->current_data + VLIB_BUFFER_PRE_DATA_SIZE >=
 		  vec_len (sl0->rewrite));
 
@@ -3246,7 +3651,8 @@ sr_policy_rewrite_b_encaps (vlib_main_t * vm, vlib_node_runtime_t * node,
 
 	  ip0 = vlib_buffer_get_current (b0);
 
-	  encaps_processing_v6 (node, b0, ip0, ip0_encap);
+	  encaps_processing_v6 (node, b0, ip0, ip0_encap,
+				sl0->flow_label_entropy);
 
 	  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE) &&
 	      PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
@@ -3473,6 +3879,12 @@ sr_policy_rewrite_init (vlib_main_t * vm)
   mhash_init (&sm->sr_policies_index_hash, sizeof (uword),
 	      sizeof (ip6_address_t));
 
+  /* Export the policy and SID list counters to the stat segment */
+  sm->sr_policy_counters.name = "SR policy";
+  sm->sr_policy_counters.stat_segment_name = "/net/sr/policy";
+  sm->sr_sl_counters.name = "SR SID list";
+  sm->sr_sl_counters.stat_segment_name = "/net/sr/sid-list";
+
   /* Init SR VPO DPOs type */
   sr_pr_encaps_dpo_type =
     dpo_register_new_type (&sr_policy_rewrite_vft, sr_pr_encaps_nodes);
@@ -28,6 +28,8 @@
  *  - Steering of IPv6 traffic Destination Address based
  *  - Steering of IPv4 traffic Destination Address based
  *  - Steering of L2 frames, interface based (sw interface)
+ *  - Bulk steering of IPv4/IPv6 traffic, Destination Address based, from a
+ *    dedicated table rather than the FIB
  */
 
 #include <vlib/vlib.h>
@@ -37,6 +39,7 @@
 #include <vnet/srv6/sr_packet.h>
 #include <vnet/ip/ip6_packet.h>
 #include <vnet/fib/ip6_fib.h>
+#include <vnet/fib/fib_table.h>
 #include <vnet/dpo/dpo.h>
 
 #include <vppinfra/error.h>
@@ -482,6 +485,679 @@ VLIB_CLI_COMMAND (sr_steer_policy_command, static) = {
 };
 /* *INDENT-ON* */
 
+/****************************** Bulk L3 steering ******************************/
+
+#define SR_STEER_BULK_DEFAULT_BUCKETS	(64 << 10)
+#define SR_STEER_BULK_DEFAULT_MEMORY	(256 << 20)
+
+vlib_node_registration_t sr_steer_bulk_ip6_node;
+vlib_node_registration_t sr_steer_bulk_ip4_node;
+
+/**
+ * @brief Create the bulk steering table on first use
+ */
+static void
+sr_steer_bulk_table_init (void)
+{
+  ip6_sr_main_t *sm = &sr_main;
+
+  if (sm->steer_bulk_table.buckets)
+    return;
+
+  if (!sm->steer_bulk_buckets)
+    sm->steer_bulk_buckets = SR_STEER_BULK_DEFAULT_BUCKETS;
+  if (!sm->steer_bulk_memory)
+    sm->steer_bulk_memory = SR_STEER_BULK_DEFAULT_MEMORY;
+
+  clib_bihash_init_24_8 (&sm->steer_bulk_table, "sr bulk steering",
+			 sm->steer_bulk_buckets, sm->steer_bulk_memory);
+}
+
+static fib_protocol_t
+sr_steer_bulk_proto (u8 traffic_type)
+{
+  return (traffic_type == SR_STEER_IPV4 ?
+	  FIB_PROTOCOL_IP4 : FIB_PROTOCOL_IP6);
+}
+
+static_always_inline void
+sr_steer_bulk_make_key (clib_bihash_kv_24_8_t * kv, fib_protocol_t proto,
+			u32 fib_index, ip46_address_t * prefix, u32 len)
+{
+  if (proto == FIB_PROTOCOL_IP6)
+    {
+      ip6_address_t *mask = &ip6_main.fib_masks[len];
+
+      kv->key[0] = prefix->ip6.as_u64[0] & mask->as_u64[0];
+      kv->key[1] = prefix->ip6.as_u64[1] & mask->as_u64[1];
+    }
+  else
+    {
+      kv->key[0] = prefix->ip4.as_u32 & ip4_main.fib_masks[len];
+      kv->key[1] = 0;
+    }
+  kv->key[2] = ((u64) fib_index << 32) | (proto << 8) | len;
+}
+
+static void
+sr_steer_bulk_compute_search_order (sr_steer_bulk_af_t * af, u32 max_len)
+{
+  int i;
+
+  vec_reset_length (af->prefix_lengths_in_search_order);
+  /* Note: bitmap reversed so this is in fact a longest prefix match */
+  /* *INDENT-OFF* */
+  clib_bitmap_foreach (i, af->non_empty_dst_address_length_bitmap,
+  ({
+    vec_add1 (af->prefix_lengths_in_search_order, max_len - i);
+  }));
+  /* *INDENT-ON* */
+}
+
+/**
+ * @brief Account for a mask width appearing in or leaving the table
+ *
+ * The search order only changes when the first rule of a given width is
+ * added or the last one removed. Those are the only updates that need the
+ * workers stopped; everything else is a lock-free bihash write.
+ */
+static void
+sr_steer_bulk_refcount (fib_protocol_t proto, u32 len, int delta)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  sr_steer_bulk_af_t *af = &sm->steer_bulk_af[proto];
+  u32 max_len = (proto == FIB_PROTOCOL_IP6 ? 128 : 32);
+  vlib_main_t *vm = vlib_get_main ();
+
+  af->dst_address_length_refcounts[len] += delta;
+  sm->steer_bulk_n_entries += delta;
+
+  if ((delta > 0 && af->dst_address_length_refcounts[len] == 1) ||
+      (delta < 0 && af->dst_address_length_refcounts[len] == 0))
+    {
+      vlib_worker_thread_barrier_sync (vm);
+      af->non_empty_dst_address_length_bitmap =
+	clib_bitmap_set (af->non_empty_dst_address_length_bitmap,
+			 max_len - len, delta > 0);
+      sr_steer_bulk_compute_search_order (af, max_len);
+      vlib_worker_thread_barrier_release (vm);
+    }
+}
+
+/**
+ * @brief Stack the policy DPOs on the bulk steering nodes
+ *
+ * Done once per policy, the first time a bulk rule points at it.
+ */
+static void
+sr_steer_bulk_stack_policy (ip6_sr_policy_t * sr_policy)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  u32 pi = sr_policy - sm->sr_policies;
+  vlib_main_t *vm = vlib_get_main ();
+
+  if (pi < vec_len (sm->steer_bulk_dpos[FIB_PROTOCOL_IP6]) &&
+      dpo_id_is_valid (&sm->steer_bulk_dpos[FIB_PROTOCOL_IP6][pi]))
+    return;
+
+  vlib_worker_thread_barrier_sync (vm);
+
+  vec_validate (sm->steer_bulk_dpos[FIB_PROTOCOL_IP6], pi);
+  vec_validate (sm->steer_bulk_dpos[FIB_PROTOCOL_IP4], pi);
+
+  dpo_stack_from_node (sr_steer_bulk_ip6_node.index,
+		       &sm->steer_bulk_dpos[FIB_PROTOCOL_IP6][pi],
+		       &sr_policy->ip6_dpo);
+  if (sr_policy->is_encap)
+    dpo_stack_from_node (sr_steer_bulk_ip4_node.index,
+			 &sm->steer_bulk_dpos[FIB_PROTOCOL_IP4][pi],
+			 &sr_policy->ip4_dpo);
+
+  vlib_worker_thread_barrier_release (vm);
+}
+
+/**
+ * @brief Resolve and validate a bulk steering rule without applying it
+ *
+ * @param is_del
+ * @param bsid is the bindingSID of the SR Policy (alt to sr_policy_index)
+ * @param sr_policy_index is the index of the SR Policy (alt to bsid)
+ * @param table_id is the VRF of the prefix
+ * @param mask_width is the mask of the prefix
+ * @param traffic_type is SR_STEER_IPV4 or SR_STEER_IPV6
+ * @param fib_index returns the FIB index of table_id
+ * @param policy_index returns the SR Policy index, not resolved on delete
+ *
+ * @return 0 if correct, else error
+ */
+int
+sr_steering_bulk_resolve (int is_del, ip6_address_t * bsid,
+			  u32 sr_policy_index, u32 table_id,
+			  u32 mask_width, u8 traffic_type,
+			  u32 * fib_index, u32 * policy_index)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  ip6_sr_policy_t *sr_policy;
+  fib_protocol_t proto;
+  uword *p;
+
+  if (traffic_type != SR_STEER_IPV4 && traffic_type != SR_STEER_IPV6)
+    return -1;
+
+  proto = sr_steer_bulk_proto (traffic_type);
+  if (mask_width > (proto == FIB_PROTOCOL_IP6 ? 128 : 32))
+    return -1;
+
+  *fib_index = fib_table_find (proto, (table_id != (u32) ~ 0 ? table_id : 0));
+  if (*fib_index == (u32) ~ 0)
+    return -6;
+
+  *policy_index = ~0;
+  if (is_del)
+    return 0;
+
+  if (bsid)
+    {
+      p = mhash_get (&sm->sr_policies_index_hash, bsid);
+      if (!p)
+	return -2;
+      sr_policy_index = p[0];
+    }
+  else if (pool_is_free_index (sm->sr_policies, sr_policy_index))
+    return -2;
+
+  sr_policy = pool_elt_at_index (sm->sr_policies, sr_policy_index);
+  if (traffic_type == SR_STEER_IPV4 && !sr_policy->is_encap)
+    return -5;
+
+  *policy_index = sr_policy_index;
+  return 0;
+}
+
+/**
+ * @brief Add/delete a bulk L3 steering rule
+ *
+ * Unlike sr_steering_policy, the rule is not installed in the FIB. It goes
+ * in the bulk steering table, which is looked up by the sr-steer-bulk-ip4
+ * and sr-steer-bulk-ip6 features on the interfaces that enable it.
+ *
+ * @return 0 if correct, else error
+ */
+int
+sr_steering_bulk_add_del (int is_del, ip6_address_t * bsid,
+			  u32 sr_policy_index, u32 table_id,
+			  ip46_address_t * prefix, u32 mask_width,
+			  u8 traffic_type)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  clib_bihash_kv_24_8_t kv, value;
+  u32 fib_index, policy_index;
+  fib_protocol_t proto;
+  int exists, rv;
+
+  rv = sr_steering_bulk_resolve (is_del, bsid, sr_policy_index, table_id,
+				 mask_width, traffic_type, &fib_index,
+				 &policy_index);
+  if (rv)
+    return rv;
+
+  sr_steer_bulk_table_init ();
+
+  proto = sr_steer_bulk_proto (traffic_type);
+  sr_steer_bulk_make_key (&kv, proto, fib_index, prefix, mask_width);
+  exists = !clib_bihash_search_24_8 (&sm->steer_bulk_table, &kv, &value);
+
+  if (is_del)
+    {
+      if (!exists)
+	return -4;
+
+      clib_bihash_add_del_24_8 (&sm->steer_bulk_table, &kv, 0 /* is_add */ );
+      sr_steer_bulk_refcount (proto, mask_width, -1);
+      return 0;
+    }
+
+  sr_steer_bulk_stack_policy (pool_elt_at_index (sm->sr_policies,
+						 policy_index));
+
+  /* An existing rule is overwritten in place */
+  kv.value = policy_index;
+  if (clib_bihash_add_del_24_8 (&sm->steer_bulk_table, &kv, 1 /* is_add */ ))
+    return -7;
+
+  if (!exists)
+    sr_steer_bulk_refcount (proto, mask_width, 1);
+
+  return 0;
+}
+
+/**
+ * @brief Enable/disable the bulk steering lookup on an interface
+ */
+int
+sr_steering_bulk_enable_disable (u32 sw_if_index, int enable)
+{
+  ip6_sr_main_t *sm = &sr_main;
+
+  if (pool_is_free_index (sm->vnet_main->interface_main.sw_interfaces,
+			  sw_if_index))
+    return -3;
+
+  vnet_feature_enable_disable ("ip6-unicast", "sr-steer-bulk-ip6",
+			       sw_if_index, enable, 0, 0);
+  vnet_feature_enable_disable ("ip4-unicast", "sr-steer-bulk-ip4",
+			       sw_if_index, enable, 0, 0);
+
+  return 0;
+}
+
+typedef struct
+{
+  u32 policy_index;
+  clib_bihash_kv_24_8_t *kvs;
+} sr_steer_bulk_walk_ctx_t;
+
+static int
+sr_steer_bulk_collect_walk (clib_bihash_kv_24_8_t * kv, void *arg)
+{
+  sr_steer_bulk_walk_ctx_t *ctx = arg;
+
+  if (kv->value == ctx->policy_index)
+    vec_add1 (ctx->kvs, *kv);
+
+  return BIHASH_WALK_CONTINUE;
+}
+
+/**
+ * @brief Flush the bulk rules of SR policies that have been deleted
+ *
+ * Policies are deleted with the workers stopped, so the rules and the
+ * stacked DPOs can go without further synchronisation.
+ */
+static void
+sr_steer_bulk_policy_change (ip6_address_t * bsid)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  sr_steer_bulk_walk_ctx_t ctx = { 0 };
+  clib_bihash_kv_24_8_t *kv;
+  u32 pi;
+
+  vec_foreach_index (pi, sm->steer_bulk_dpos[FIB_PROTOCOL_IP6])
+  {
+    if (!dpo_id_is_valid (&sm->steer_bulk_dpos[FIB_PROTOCOL_IP6][pi]) ||
+	!pool_is_free_index (sm->sr_policies, pi))
+      continue;
+
+    ctx.policy_index = pi;
+    vec_reset_length (ctx.kvs);
+    clib_bihash_foreach_key_value_pair_24_8 (&sm->steer_bulk_table,
+					     sr_steer_bulk_collect_walk, &ctx);
+
+    vec_foreach (kv, ctx.kvs)
+    {
+      clib_bihash_add_del_24_8 (&sm->steer_bulk_table, kv, 0 /* is_add */ );
+      sr_steer_bulk_refcount ((kv->key[2] >> 8) & 0xff,
+			      kv->key[2] & 0xff, -1);
+    }
+
+    dpo_reset (&sm->steer_bulk_dpos[FIB_PROTOCOL_IP6][pi]);
+    dpo_reset (&sm->steer_bulk_dpos[FIB_PROTOCOL_IP4][pi]);
+  }
+
+  vec_free (ctx.kvs);
+}
+
+/**
+ * @brief Longest prefix match in the bulk steering table
+ *
+ * @return SR policy index, ~0 on miss
+ */
+static_always_inline u32
+sr_steer_bulk_lookup (ip6_sr_main_t * sm, fib_protocol_t proto,
+		      u32 fib_index, ip46_address_t * dst)
+{
+  sr_steer_bulk_af_t *af = &sm->steer_bulk_af[proto];
+  clib_bihash_kv_24_8_t kv, value;
+  int i, len;
+
+  for (i = 0; i < vec_len (af->prefix_lengths_in_search_order); i++)
+    {
+      len = af->prefix_lengths_in_search_order[i];
+      sr_steer_bulk_make_key (&kv, proto, fib_index, dst, len);
+      if (!clib_bihash_search_inline_2_24_8 (&sm->steer_bulk_table, &kv,
+					     &value))
+	return value.value;
+    }
+
+  return ~0;
+}
+
+#define foreach_sr_steer_bulk_error                     \
+_(STEERED, "SR steered packets")                        \
+_(MISS, "SR steering misses")
+
+typedef enum
+{
+#define _(sym,str) SR_STEER_BULK_ERROR_##sym,
+  foreach_sr_steer_bulk_error
+#undef _
+    SR_STEER_BULK_N_ERROR,
+} sr_steer_bulk_error_t;
+
+static char *sr_steer_bulk_error_strings[] = {
+#define _(sym,string) string,
+  foreach_sr_steer_bulk_error
+#undef _
+};
+
+typedef struct
+{
+  u32 fib_index;
+  u32 policy_index;
+} sr_steer_bulk_trace_t;
+
+static u8 *
+format_sr_steer_bulk_trace (u8 * s, va_list * args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  sr_steer_bulk_trace_t *t = va_arg (*args, sr_steer_bulk_trace_t *);
+
+  if (t->policy_index == (u32) ~ 0)
+    return format (s, "SR-STEER-BULK: fib %d miss", t->fib_index);
+
+  return format (s, "SR-STEER-BULK: fib %d sr policy %d", t->fib_index,
+		 t->policy_index);
+}
+
+/**
+ * @brief Bulk steering lookup, ahead of ip4-lookup/ip6-lookup
+ *
+ * Hits go straight to the SR policy load-balance, misses carry on along
+ * the feature arc.
+ */
+static_always_inline uword
+sr_steer_bulk_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
+		      vlib_frame_t * frame, fib_protocol_t proto)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 *from, n_left, n_steered = 0;
+  u32 *fib_index_by_sw_if_index;
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+  b = bufs;
+  next = nexts;
+
+  fib_index_by_sw_if_index = (proto == FIB_PROTOCOL_IP6 ?
+			      ip6_main.fib_index_by_sw_if_index :
+			      ip4_main.fib_index_by_sw_if_index);
+
+  while (n_left > 0)
+    {
+      ip46_address_t dst0;
+      u32 fib_index0, pi0;
+      dpo_id_t *dpo0;
+
+      if (n_left > 2)
+	{
+	  vlib_prefetch_buffer_header (b[2], LOAD);
+	  CLIB_PREFETCH (b[2]->data, CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      fib_index0 = vec_elt (fib_index_by_sw_if_index,
+			    vnet_buffer (b[0])->sw_if_index[VLIB_RX]);
+      fib_index0 = (vnet_buffer (b[0])->sw_if_index[VLIB_TX] == (u32) ~ 0 ?
+		    fib_index0 : vnet_buffer (b[0])->sw_if_index[VLIB_TX]);
+
+      if (proto == FIB_PROTOCOL_IP6)
+	{
+	  ip6_header_t *ip0 = vlib_buffer_get_current (b[0]);
+	  dst0.ip6 = ip0->dst_address;
+	}
+      else
+	{
+	  ip4_header_t *ip0 = vlib_buffer_get_current (b[0]);
+	  dst0.ip4 = ip0->dst_address;
+	}
+
+      pi0 = sr_steer_bulk_lookup (sm, proto, fib_index0, &dst0);
+
+      if (pi0 != (u32) ~ 0)
+	{
+	  dpo0 = vec_elt_at_index (sm->steer_bulk_dpos[proto], pi0);
+	  next[0] = dpo0->dpoi_next_node;
+	  vnet_buffer (b[0])->ip.adj_index[VLIB_TX] = dpo0->dpoi_index;
+	  vnet_buffer (b[0])->ip.flow_hash = 0;
+	  n_steered++;
+	}
+      else
+	vnet_feature_next_u16 (next, b[0]);
+
+      if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  sr_steer_bulk_trace_t *tr =
+	    vlib_add_trace (vm, node, b[0], sizeof (*tr));
+	  tr->fib_index = fib_index0;
+	  tr->policy_index = pi0;
+	}
+
+      b += 1;
+      next += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       SR_STEER_BULK_ERROR_STEERED, n_steered);
+  vlib_node_increment_counter (vm, node->node_index,
+			       SR_STEER_BULK_ERROR_MISS,
+			       frame->n_vectors - n_steered);
+
+  return frame->n_vectors;
+}
+
+static uword
+sr_steer_bulk_ip6 (vlib_main_t * vm, vlib_node_runtime_t * node,
+		   vlib_frame_t * frame)
+{
+  return sr_steer_bulk_inline (vm, node, frame, FIB_PROTOCOL_IP6);
+}
+
+static uword
+sr_steer_bulk_ip4 (vlib_main_t * vm, vlib_node_runtime_t * node,
+		   vlib_frame_t * frame)
+{
+  return sr_steer_bulk_inline (vm, node, frame, FIB_PROTOCOL_IP4);
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (sr_steer_bulk_ip6_node) = {
+  .function = sr_steer_bulk_ip6,
+  .name = "sr-steer-bulk-ip6",
+  .vector_size = sizeof (u32),
+  .format_trace = format_sr_steer_bulk_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = SR_STEER_BULK_N_ERROR,
+  .error_strings = sr_steer_bulk_error_strings,
+  .n_next_nodes = 1,
+  .next_nodes = {
+    [0] = "ip6-drop",
+  },
+};
+
+VLIB_REGISTER_NODE (sr_steer_bulk_ip4_node) = {
+  .function = sr_steer_bulk_ip4,
+  .name = "sr-steer-bulk-ip4",
+  .vector_size = sizeof (u32),
+  .format_trace = format_sr_steer_bulk_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = SR_STEER_BULK_N_ERROR,
+  .error_strings = sr_steer_bulk_error_strings,
+  .n_next_nodes = 1,
+  .next_nodes = {
+    [0] = "ip4-drop",
+  },
+};
+
+VNET_FEATURE_INIT (sr_steer_bulk_ip6, static) =
+{
+  .arc_name = "ip6-unicast",
+  .node_name = "sr-steer-bulk-ip6",
+  .runs_before = VNET_FEATURES ("ip6-lookup"),
+};
+
+VNET_FEATURE_INIT (sr_steer_bulk_ip4, static) =
+{
+  .arc_name = "ip4-unicast",
+  .node_name = "sr-steer-bulk-ip4",
+  .runs_before = VNET_FEATURES ("ip4-lookup"),
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+sr_steer_bulk_command_fn (vlib_main_t * vm, unformat_input_t * input,
+			  vlib_cli_command_t * cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  ip46_address_t prefix;
+  u32 dst_mask_width = 0;
+  u32 sw_if_index = (u32) ~ 0;
+  u8 traffic_type = 0;
+  u32 fib_table = (u32) ~ 0;
+  ip6_address_t bsid;
+  u32 sr_policy_index = (u32) ~ 0;
+  u8 sr_policy_set = 0;
+  int is_del = 0, enable = 1;
+  int rv;
+
+  clib_memset (&prefix, 0, sizeof (ip46_address_t));
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "del"))
+	is_del = 1;
+      else if (unformat (input, "disable"))
+	enable = 0;
+      else if (sw_if_index == (u32) ~ 0
+	       && unformat (input, "interface %U",
+			    unformat_vnet_sw_interface, vnm, &sw_if_index))
+	;
+      else if (!traffic_type
+	       && unformat (input, "l3 %U/%d", unformat_ip6_address,
+			    &prefix.ip6, &dst_mask_width))
+	traffic_type = SR_STEER_IPV6;
+      else if (!traffic_type
+	       && unformat (input, "l3 %U/%d", unformat_ip4_address,
+			    &prefix.ip4, &dst_mask_width))
+	traffic_type = SR_STEER_IPV4;
+      else if (!sr_policy_set
+	       && unformat (input, "via index %d", &sr_policy_index))
+	sr_policy_set = 1;
+      else if (!sr_policy_set
+	       && unformat (input, "via bsid %U",
+			    unformat_ip6_address, &bsid))
+	sr_policy_set = 1;
+      else if (fib_table == (u32) ~ 0
+	       && unformat (input, "fib-table %d", &fib_table));
+      else
+	break;
+    }
+
+  if (sw_if_index != (u32) ~ 0)
+    {
+      if (sr_steering_bulk_enable_disable (sw_if_index, enable))
+	return clib_error_return (0, "Incorrect interface.");
+      return 0;
+    }
+
+  if (!traffic_type)
+    return clib_error_return (0, "No L3 traffic specified");
+  if (!sr_policy_set && !is_del)
+    return clib_error_return (0, "No SR policy specified");
+
+  rv = sr_steering_bulk_add_del (is_del,
+				 (sr_policy_index == ~(u32) 0 ? &bsid : NULL),
+				 sr_policy_index, fib_table, &prefix,
+				 dst_mask_width, traffic_type);
+
+  switch (rv)
+    {
+    case 0:
+      break;
+    case -1:
+      return clib_error_return (0, "Incorrect API usage.");
+    case -2:
+      return clib_error_return (0,
+				"The requested SR policy could not be located. Review the BSID/index.");
+    case -4:
+      return clib_error_return (0,
+				"The requested SR steering policy could not be deleted.");
+    case -5:
+      return clib_error_return (0,
+				"The SR policy is not an encapsulation one.");
+    case -6:
+      return clib_error_return (0, "The FIB table does not exist.");
+    case -7:
+      return clib_error_return (0, "The bulk steering table is full.");
+    default:
+      return clib_error_return (0, "BUG: sr steer bulk returns %d", rv);
+    }
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (sr_steer_bulk_command, static) = {
+  .path = "sr steer bulk",
+  .short_help = "sr steer bulk (del) l3 <ip_addr/mask> "
+    "via [index <sr_policy_index>|bsid <bsid_ip6_addr>] "
+    "(fib-table <fib_table_index>) | interface <sw_if> (disable)",
+  .long_help =
+    "\tSteer L3 traffic through an existing SR policy using the bulk\n"
+    "\tsteering table instead of the FIB. The table is only looked up on\n"
+    "\tthe interfaces it is enabled on.\n"
+    "\tExamples:\n"
+    "\t\tsr steer bulk interface GigabitEthernet0/5/0\n"
+    "\t\tsr steer bulk l3 2001::/64 via bsid 2010::9999:1\n"
+    "\t\tsr steer bulk del l3 2001::/64\n",
+  .function = sr_steer_bulk_command_fn,
+};
+/* *INDENT-ON* */
+
+static int
+sr_steer_bulk_show_walk (clib_bihash_kv_24_8_t * kv, void *arg)
+{
+  ip6_sr_main_t *sm = &sr_main;
+  vlib_main_t *vm = arg;
+  ip6_sr_policy_t *pl;
+  ip46_address_t addr;
+  u32 len = kv->key[2] & 0xff;
+
+  pl = pool_elt_at_index (sm->sr_policies, kv->value);
+
+  if (((kv->key[2] >> 8) & 0xff) == FIB_PROTOCOL_IP4)
+    {
+      addr.ip4.as_u32 = kv->key[0];
+      vlib_cli_output (vm, "L3 %U/%d\t%U\tfib %d", format_ip4_address,
+		       &addr.ip4, len, format_ip6_address, &pl->bsid,
+		       kv->key[2] >> 32);
+    }
+  else
+    {
+      addr.ip6.as_u64[0] = kv->key[0];
+      addr.ip6.as_u64[1] = kv->key[1];
+      vlib_cli_output (vm, "L3 %U/%d\t%U\tfib %d", format_ip6_address,
+		       &addr.ip6, len, format_ip6_address, &pl->bsid,
+		       kv->key[2] >> 32);
+    }
+
+  return BIHASH_WALK_CONTINUE;
+}
+
 static clib_error_t *
 show_sr_steering_policies_command_fn (vlib_main_t * vm,
 				      unformat_input_t * input,
@@ -494,7 +1170,10 @@ show_sr_steering_policies_command_fn (vlib_main_t * vm,
   vnet_main_t *vnm = vnet_get_main ();
 
   ip6_sr_policy_t *pl = 0;
-  int i;
+  int i, bulk = 0;
+
+  if (unformat (input, "bulk"))
+    bulk = 1;
 
   vlib_cli_output (vm, "SR steering policies:");
   /* *INDENT-OFF* */
@@ -529,13 +1208,23 @@ show_sr_steering_policies_command_fn (vlib_main_t * vm,
 			   format_ip6_address, &pl->bsid);
 	}
     }
+  vec_free (steer_policies);
+
+  if (sm->steer_bulk_table.buckets)
+    {
+      vlib_cli_output (vm, "Bulk steering entries: %u",
+		       sm->steer_bulk_n_entries);
+      if (bulk)
+	clib_bihash_foreach_key_value_pair_24_8 (&sm->steer_bulk_table,
+						 sr_steer_bulk_show_walk, vm);
+    }
   return 0;
 }
 
 /* *INDENT-OFF* */
 VLIB_CLI_COMMAND (show_sr_steering_policies_command, static) = {
   .path = "show sr steering-policies",
-  .short_help = "show sr steering-policies",
+  .short_help = "show sr steering-policies [bulk]",
   .function = show_sr_steering_policies_command_fn,
 };
 /* *INDENT-ON* */
@@ -553,6 +1242,8 @@ sr_steering_init (vlib_main_t * vm)
 
   sm->vnet_main = vnet_get_main ();
 
+  sr_policy_register_change_callback (sr_steer_bulk_policy_change);
+
   return 0;
 }
 
@@ -560,6 +1251,28 @@ sr_steering_init (vlib_main_t * vm)
 VLIB_INIT_FUNCTION (sr_steering_init);
 /* *INDENT-ON* */
 
+static clib_error_t *
+sr_steering_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  ip6_sr_main_t *sm = &sr_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "steer-bulk-buckets %u", &sm->steer_bulk_buckets))
+	;
+      else if (unformat (input, "steer-bulk-memory %U",
+			 unformat_memory_size, &sm->steer_bulk_memory))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (sr_steering_config, "sr");
+
 /* *INDENT-OFF* */
 VNET_FEATURE_INIT (sr_pl_rewrite_encaps_l2, static) =
 {
@@ -1135,6 +1135,13 @@ static void *vl_api_sr_localsid_add_del_t_print
 		"\nTable: %u", format_ip6_address,
 		(ip6_address_t *) mp->localsid, (mp->fib_table));
       break;
+    case SR_BEHAVIOR_DT46:
+      s =
+	format (s,
+		"Address: %U\nBehavior: DT46 (Endpoint with decapsulation and specific IP table lookup)"
+		"\nTable: %u", format_ip6_address,
+		(ip6_address_t *) mp->localsid, (mp->fib_table));
+      break;
     default:
       if (mp->behavior >= SR_BEHAVIOR_LAST)
 	{
@@ -537,11 +537,67 @@ VLIB_CLI_COMMAND (show_stat_segment_command, static) =
  * total suspends
  */
 
+/*
+ * Name vectors other than the interface and node ones, e.g. the SIDs of the
+ * SR localsid counters. The strings never move once set, so only the
+ * offset of the element being changed is updated.
+ */
+void
+vlib_stats_set_name (char *vector_name, u32 index, u8 * name)
+{
+  stat_segment_main_t *sm = &stat_segment_main;
+  stat_segment_shared_header_t *shared_header = sm->shared_header;
+  stat_segment_directory_entry_t e = { 0 }, *ep;
+  u64 *offset_vector = 0;
+  u8 **names = 0;
+  u32 vector_index;
+  void *oldheap;
+
+  ASSERT (shared_header);
+
+  /* Lookup hash-table is on the main heap */
+  vector_index = lookup_hash_index ((u8 *) vector_name);
+
+  oldheap = vlib_stats_push_heap (NULL);
+  vlib_stat_segment_lock ();
+
+  if (vector_index == STAT_SEGMENT_INDEX_INVALID)
+    {
+      strncpy (e.name, vector_name, 128 - 1);
+      e.type = STAT_DIR_TYPE_NAME_VECTOR;
+      vector_index = vlib_stats_create_counter (&e, oldheap);
+      shared_header->directory_offset =
+	stat_segment_offset (shared_header, sm->directory_vector);
+    }
+
+  ep = &sm->directory_vector[vector_index];
+  if (ep->offset)
+    names = stat_segment_pointer (shared_header, ep->offset);
+  if (ep->offset_vector)
+    offset_vector = stat_segment_pointer (shared_header, ep->offset_vector);
+
+  vec_validate (names, index);
+  vec_free (names[index]);
+  if (name)
+    names[index] = format (0, "%v%c", name, 0);
+
+  vec_validate (offset_vector, vec_len (names) - 1);
+  offset_vector[index] =
+    names[index] ? stat_segment_offset (shared_header, names[index]) : 0;
+
+  ep->offset = stat_segment_offset (shared_header, names);
+  ep->offset_vector = stat_segment_offset (shared_header, offset_vector);
+
+  vlib_stat_segment_unlock ();
+  clib_mem_set_heap (oldheap);
+}
+
 static inline void
 update_node_counters (stat_segment_main_t * sm)
 {
   vlib_main_t **stat_vms = 0;
   vlib_node_t ***node_dups = 0;
+  vlib_node_histogram_t *histograms;
   int i, j;
   stat_segment_shared_header_t *shared_header = sm->shared_header;
   static u32 no_max_nodes = 0;
@@ -570,6 +626,14 @@ update_node_counters (stat_segment_main_t * sm)
 				    [STAT_COUNTER_NODE_CALLS], l - 1);
       stat_validate_counter_vector (&sm->directory_vector
 				    [STAT_COUNTER_NODE_SUSPENDS], l - 1);
+      stat_validate_counter_vector (&sm->directory_vector
+				    [STAT_COUNTER_NODE_CLOCKS_HISTOGRAM],
+				    l * VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS -
+				    1);
+      stat_validate_counter_vector (&sm->directory_vector
+				    [STAT_COUNTER_NODE_VECTORS_HISTOGRAM],
+				    l * VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS -
+				    1);
 
       vec_validate (sm->nodes, l - 1);
       stat_segment_directory_entry_t *ep;
@@ -643,6 +707,31 @@ update_node_counters (stat_segment_main_t * sm)
 	  c[n->index] =
 	    n->stats_total.suspends - n->stats_last_clear.suspends;
 	}
+
+      /* histograms, node_index * n_buckets + bucket */
+      histograms = stat_vms[j]->node_main.histograms;
+      for (i = 0; i < clib_min (vec_len (histograms), l); i++)
+	{
+	  counter_t **counters;
+
+	  counters =
+	    stat_segment_pointer (shared_header,
+				  sm->directory_vector
+				  [STAT_COUNTER_NODE_CLOCKS_HISTOGRAM].offset);
+	  clib_memcpy_fast (counters[j] +
+			    i * VLIB_NODE_HISTOGRAM_N_CLOCK_BUCKETS,
+			    histograms[i].clocks,
+			    sizeof (histograms[i].clocks));
+
+	  counters =
+	    stat_segment_pointer (shared_header,
+				  sm->directory_vector
+				  [STAT_COUNTER_NODE_VECTORS_HISTOGRAM].offset);
+	  clib_memcpy_fast (counters[j] +
+			    i * VLIB_NODE_HISTOGRAM_N_VECTOR_BUCKETS,
+			    histograms[i].vectors,
+			    sizeof (histograms[i].vectors));
+	}
       vec_free (node_dups[j]);
     }
   vec_free (node_dups);
@@ -431,6 +431,7 @@ vlib_app_num_thread_stacks_needed (void)
 typedef struct
 {
   u8 *name;
+  u32 nbuckets;
   u64 actual_virt_size;
   u64 configured_virt_size;
 } name_sort_t;
@@ -468,6 +469,7 @@ show_bihash_command_fn (vlib_main_t * vm,
 	{
 	  vec_add2 (names, this, 1);
 	  this->name = format (0, "%s%c", h->name, 0);
+	  this->nbuckets = h->nbuckets;
 	  configured_virt_size = h->memory_size;
 	  actual_virt_size = alloc_arena (h) ? h->memory_size : 0ULL;
 	  this->actual_virt_size = actual_virt_size;
@@ -479,12 +481,13 @@ show_bihash_command_fn (vlib_main_t * vm,
 
   vec_sort_with_function (names, name_sort_cmp);
 
-  vlib_cli_output (vm, "%-30s %8s %s", "Name", "Actual", "Configured");
+  vlib_cli_output (vm, "%-30s %10s %8s %s", "Name", "Buckets", "Actual",
+		   "Configured");
 
   for (i = 0; i < vec_len (names); i++)
     {
-      vlib_cli_output (vm, "%-30s %8U %U", names[i].name,
-		       format_memory_size,
+      vlib_cli_output (vm, "%-30s %10u %8U %U", names[i].name,
+		       names[i].nbuckets, format_memory_size,
 		       names[i].actual_virt_size,
 		       format_memory_size, names[i].configured_virt_size);
       vec_free (names[i].name);
@@ -492,7 +495,7 @@ show_bihash_command_fn (vlib_main_t * vm,
 
   vec_free (names);
 
-  vlib_cli_output (vm, "%-30s %8U %U", "Total",
+  vlib_cli_output (vm, "%-30s %10s %8U %U", "Total", "",
 		   format_memory_size, total_actual_virt_size,
 		   format_memory_size, total_configured_virt_size);
   return 0;
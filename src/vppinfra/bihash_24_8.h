@@ -77,6 +77,10 @@ clib_bihash_key_compare_24_8 (u64 * a, u64 * b)
 #if defined (CLIB_HAVE_VEC512)
   u64x8 v = u64x8_load_unaligned (a) ^ u64x8_load_unaligned (b);
   return (u64x8_is_zero_mask (v) & 0x7) == 0;
+#elif defined (CLIB_HAVE_VEC256)
+  u64x4 mask = { ~0ULL, ~0ULL, ~0ULL, 0 };
+  u64x4 v = u64x4_load_unaligned (a) ^ u64x4_load_unaligned (b);
+  return u64x4_is_all_zero (v & mask);
 #elif defined(CLIB_HAVE_VEC128) && defined(CLIB_HAVE_VEC128_UNALIGNED_LOAD_STORE)
   u64x2 v = { a[2] ^ b[2], 0 };
   v |= u64x2_load_unaligned (a) ^ u64x2_load_unaligned (b);
@@ -186,6 +186,36 @@ void clib_bihash_foreach_key_value_pair (clib_bihash * h,
 					 clib_bihash_foreach_key_value_pair_cb
 					 * callback, void *arg);
 
+/** Start doubling the bucket array of a bi-hash table
+
+    @param h - the bi-hash table
+    @returns 0 on success, -1 if a resize is already in progress,
+     -2 if the arena can't hold the new bucket array and, at worst,
+     twice the pages in use
+    @note buckets then move to the new array in
+     clib_bihash_resize_step
+*/
+int clib_bihash_resize_start (clib_bihash * h);
+
+/** Do a bounded amount of bi-hash table resize work
+
+    @param h - the bi-hash table
+    @param n_buckets - number of buckets to move or reclaim
+    @returns the clib_bihash_resize_state_t after the step
+    @note safe against concurrent readers and writers. Starts a resize
+     by itself if the table was initialized with max_nbuckets and too
+     many of its buckets spilled past a single page.
+*/
+int clib_bihash_resize_step (clib_bihash * h, u32 n_buckets);
+
+/** Switch a bi-hash table to its new bucket array
+
+    @param h - the bi-hash table
+    @note call once clib_bihash_resize_step returns
+     BIHASH_RESIZE_READY, while no other thread uses the table
+*/
+void clib_bihash_resize_finish (clib_bihash * h);
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
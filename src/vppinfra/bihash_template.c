@@ -124,6 +124,10 @@ void BV (clib_bihash_init2) (BVT (clib_bihash_init2_args) * a)
   h->memory_size = a->memory_size;
   h->instantiated = 0;
   h->fmt_fn = a->fmt_fn;
+  h->max_nbuckets = a->max_nbuckets ? 1 << max_log2 (a->max_nbuckets) : 0;
+  h->n_split_buckets = 0;
+  h->resize_buckets = h->resize_old_buckets = 0;
+  h->resize_state = BIHASH_RESIZE_IDLE;
 
   alloc_arena (h) = 0;
 
@@ -443,7 +447,7 @@ BVT (clib_bihash_value) *
 BV (split_and_rehash)
   (BVT (clib_bihash) * h,
    BVT (clib_bihash_value) * old_values, u32 old_log2_pages,
-   u32 new_log2_pages)
+   u32 new_log2_pages, u32 log2_nbuckets)
 {
   BVT (clib_bihash_value) * new_values, *new_v;
   int i, j, length_in_kvs;
@@ -463,7 +467,7 @@ BV (split_and_rehash)
 
       /* rehash the item onto its new home-page */
       new_hash = BV (clib_bihash_hash) (&(old_values->kvp[i]));
-      new_hash = extract_bits (new_hash, h->log2_nbuckets, new_log2_pages);
+      new_hash = extract_bits (new_hash, log2_nbuckets, new_log2_pages);
       new_v = &new_values[new_hash];
 
       /* Across the new home-page */
@@ -541,7 +545,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
   BVT (clib_bihash_value) * v, *new_v, *save_new_v, *working_copy;
   int i, limit;
   u64 new_hash;
-  u32 new_log2_pages, old_log2_pages;
+  u32 new_log2_pages, old_log2_pages, log2_nbuckets;
   u32 thread_index = os_get_thread_index ();
   int mark_bucket_linear;
   int resplit_once;
@@ -577,6 +581,17 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
 
   BV (clib_bihash_lock_bucket) (b);
 
+  log2_nbuckets = h->log2_nbuckets;
+
+  /* Moved to the new bucket array? Its buckets are locked instead */
+  if (PREDICT_FALSE (b->resized))
+    {
+      BV (clib_bihash_unlock_bucket) (b);
+      b = BV (clib_bihash_get_resized_bucket) (h, hash);
+      BV (clib_bihash_lock_bucket) (b);
+      log2_nbuckets++;
+    }
+
   /* First elt in the bucket? */
   if (BIHASH_KVP_AT_BUCKET_LEVEL == 0 && BV (clib_bihash_bucket_is_empty) (b))
     {
@@ -611,7 +626,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
       if (PREDICT_FALSE (b->linear_search))
 	limit <<= b->log2_pages;
       else
-	v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+	v += extract_bits (hash, log2_nbuckets, b->log2_pages);
     }
 
   if (is_add)
@@ -731,6 +746,8 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
 		free_backing_store:
 		  /* And free the backing storage */
 		  BV (clib_bihash_alloc_lock) (h);
+		  if (tmp_b.log2_pages > 0)
+		    h->n_split_buckets--;
 		  /* Note: v currently points into the middle of the bucket */
 		  v = BV (clib_bihash_get_value) (h, tmp_b.offset);
 		  BV (value_free) (h, v, tmp_b.log2_pages);
@@ -763,7 +780,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
   BV (clib_bihash_increment_stat) (h, BIHASH_STAT_splits, 1);
 
   new_v = BV (split_and_rehash) (h, working_copy, old_log2_pages,
-				 new_log2_pages);
+				 new_log2_pages, log2_nbuckets);
   if (new_v == 0)
     {
     try_resplit:
@@ -771,7 +788,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
       new_log2_pages++;
       /* Try re-splitting. If that fails, fall back to linear search */
       new_v = BV (split_and_rehash) (h, working_copy, old_log2_pages,
-				     new_log2_pages);
+				     new_log2_pages, log2_nbuckets);
       if (new_v == 0)
 	{
 	mark_linear:
@@ -795,7 +812,7 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
   if (mark_bucket_linear)
     limit <<= new_log2_pages;
   else
-    new_v += extract_bits (new_hash, h->log2_nbuckets, new_log2_pages);
+    new_v += extract_bits (new_hash, log2_nbuckets, new_log2_pages);
 
   for (i = 0; i < limit; i++)
     {
@@ -818,6 +835,8 @@ static_always_inline int BV (clib_bihash_add_del_inline_with_hash)
     goto try_resplit;
 
 expand_ok:
+  if (h->saved_bucket.log2_pages == 0)
+    h->n_split_buckets++;
   tmp_b.log2_pages = new_log2_pages;
   tmp_b.offset = BV (clib_bihash_get_offset) (h, save_new_v);
   tmp_b.linear_search = mark_bucket_linear;
@@ -878,6 +897,322 @@ int BV (clib_bihash_search)
   return BV (clib_bihash_search_inline_2) (h, search_key, valuep);
 }
 
+static uword BV (clib_bihash_bucket_array_size) (u32 nbuckets)
+{
+  uword size = sizeof (BVT (clib_bihash_bucket));
+
+  if (BIHASH_KVP_AT_BUCKET_LEVEL)
+    size += BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv));
+
+  return size * nbuckets;
+}
+
+/*
+ * Fill a bucket of the new array with the kvps moving into it. Nobody
+ * can see the bucket yet, so no working copy is needed. Pages are
+ * doubled until the kvps fit, up to the size of the bucket they come
+ * from, beyond which linear search is used as it was there.
+ */
+static void BV (clib_bihash_resize_fill_bucket)
+  (BVT (clib_bihash) * h, BVT (clib_bihash_bucket) * b,
+   BVT (clib_bihash_kv) * kvs, u64 * hashes, u32 max_log2_pages)
+{
+  BVT (clib_bihash_bucket) tmp_b = {.as_u64 = 0 };
+  BVT (clib_bihash_value) * v = 0, *page;
+  u32 log2_nbuckets = h->log2_nbuckets + 1;
+  u32 log2_pages, i, j, n_kvs = vec_len (kvs);
+  int linear = 0;
+
+  ASSERT (h->alloc_lock[0]);
+
+  if (BIHASH_KVP_AT_BUCKET_LEVEL)
+    {
+      clib_memset_u8 ((b + 1), 0xff,
+		      BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv)));
+      tmp_b.offset = BV (clib_bihash_get_offset) (h, (void *) (b + 1));
+      tmp_b.refcnt = 1;
+    }
+
+  if (n_kvs == 0)
+    {
+      b->as_u64 = tmp_b.as_u64;
+      return;
+    }
+
+  for (log2_pages = 0; log2_pages <= max_log2_pages; log2_pages++)
+    {
+      v = BV (value_alloc) (h, log2_pages);
+
+      for (i = 0; i < n_kvs; i++)
+	{
+	  page = v + extract_bits (hashes[i], log2_nbuckets, log2_pages);
+	  for (j = 0; j < BIHASH_KVP_PER_PAGE; j++)
+	    if (BV (clib_bihash_is_free) (&page->kvp[j]))
+	      {
+		page->kvp[j] = kvs[i];
+		break;
+	      }
+	  if (j == BIHASH_KVP_PER_PAGE)
+	    break;
+	}
+
+      if (i == n_kvs)
+	goto filled;
+
+      BV (value_free) (h, v, log2_pages);
+    }
+
+  /* pinned collisions, the old bucket had to use linear search too */
+  log2_pages = max_log2_pages;
+  v = BV (value_alloc) (h, log2_pages);
+  for (i = 0; i < n_kvs; i++)
+    v->kvp[i] = kvs[i];
+  linear = 1;
+
+filled:
+  if (BIHASH_KVP_AT_BUCKET_LEVEL && log2_pages == 0)
+    {
+      clib_memcpy_fast ((b + 1), v, sizeof (*v));
+      BV (value_free) (h, v, 0);
+    }
+  else
+    {
+      tmp_b.offset = BV (clib_bihash_get_offset) (h, v);
+      tmp_b.log2_pages = log2_pages;
+      tmp_b.linear_search = linear;
+    }
+
+  if (log2_pages > 0)
+    h->n_split_buckets++;
+
+  tmp_b.refcnt = BIHASH_KVP_AT_BUCKET_LEVEL ? n_kvs + 1 : n_kvs;
+  b->as_u64 = tmp_b.as_u64;
+}
+
+/*
+ * Split a bucket of the old array into its two halves in the new one,
+ * then flag it so that readers and writers go to the new array. The
+ * old bucket keeps pointing at its pages, readers which looked at it
+ * before the flag was set still find valid data there.
+ */
+static void BV (clib_bihash_resize_move_bucket) (BVT (clib_bihash) * h,
+						 u32 index)
+{
+  BVT (clib_bihash_bucket) * b, tmp_b;
+  BVT (clib_bihash_value) * v;
+  BVT (clib_bihash_kv) * kvs[2] = { 0 };
+  u64 *hashes[2] = { 0 };
+  u32 i, half;
+  u64 hash;
+
+  b = BV (clib_bihash_get_bucket) (h, index);
+
+  BV (clib_bihash_lock_bucket) (b);
+  BV (clib_bihash_alloc_lock) (h);
+
+  if (!BV (clib_bihash_bucket_is_empty) (b))
+    {
+      v = BV (clib_bihash_get_value) (h, b->offset);
+      for (i = 0; i < (BIHASH_KVP_PER_PAGE << b->log2_pages); i++)
+	{
+	  if (BV (clib_bihash_is_free) (&v->kvp[i]))
+	    continue;
+	  hash = BV (clib_bihash_hash) (&v->kvp[i]);
+	  half = extract_bits (hash, h->log2_nbuckets, 1);
+	  vec_add1 (kvs[half], v->kvp[i]);
+	  vec_add1 (hashes[half], hash);
+	}
+    }
+
+  for (half = 0; half < 2; half++)
+    BV (clib_bihash_resize_fill_bucket)
+      (h, BV (clib_bihash_get_resized_bucket) (h, index +
+					       (half << h->log2_nbuckets)),
+       kvs[half], hashes[half], b->log2_pages);
+
+  if (b->log2_pages > 0)
+    h->n_split_buckets--;
+
+  CLIB_MEMORY_STORE_BARRIER ();
+
+  tmp_b.as_u64 = b->as_u64;
+  tmp_b.resized = 1;
+  tmp_b.lock = 0;
+  b->as_u64 = tmp_b.as_u64;	/* unlocks the bucket */
+
+  BV (clib_bihash_alloc_unlock) (h);
+
+  for (half = 0; half < 2; half++)
+    {
+      vec_free (kvs[half]);
+      vec_free (hashes[half]);
+    }
+}
+
+/* Free the pages of a bucket of the old array, after the resize */
+static void BV (clib_bihash_resize_reclaim_bucket) (BVT (clib_bihash) * h,
+						    u32 index)
+{
+  BVT (clib_bihash_bucket) * b;
+
+  b = BV (clib_bihash_get_bucket_in) (h->resize_old_buckets,
+				      h->nbuckets >> 1, index);
+
+  ASSERT (b->resized);
+
+  if (BV (clib_bihash_bucket_is_empty) (b))
+    return;
+
+  /* single pages at the bucket level live in the array itself */
+  if (BIHASH_KVP_AT_BUCKET_LEVEL && b->log2_pages == 0)
+    return;
+
+  BV (clib_bihash_alloc_lock) (h);
+  BV (value_free) (h, BV (clib_bihash_get_value) (h, b->offset),
+		   b->log2_pages);
+  BV (clib_bihash_alloc_unlock) (h);
+}
+
+/* Hand the old bucket array over to the single page freelist */
+static void BV (clib_bihash_resize_recycle) (BVT (clib_bihash) * h)
+{
+  u8 *p = (u8 *) h->resize_old_buckets;
+  uword size = BV (clib_bihash_bucket_array_size) (h->nbuckets >> 1);
+  uword page_size = round_pow2 (sizeof (BVT (clib_bihash_value)),
+				CLIB_CACHE_LINE_BYTES);
+  uword offset;
+
+  BV (clib_bihash_alloc_lock) (h);
+  vec_validate_init_empty (h->freelists, 0, 0);
+  for (offset = 0; offset + page_size <= size; offset += page_size)
+    BV (value_free) (h, (BVT (clib_bihash_value) *) (p + offset), 0);
+  BV (clib_bihash_alloc_unlock) (h);
+
+  h->resize_old_buckets = 0;
+}
+
+/*
+ * Start doubling the bucket array. Returns -1 when not possible (a
+ * resize already in progress, a shared memory table), -2 when the
+ * arena can't hold the new array and the pages of the moved buckets.
+ */
+int BV (clib_bihash_resize_start) (BVT (clib_bihash) * h)
+{
+  uword size, pages_size;
+
+#if BIHASH_32_64_SVM
+  return -1;
+#endif
+
+  if (h->resize_state != BIHASH_RESIZE_IDLE || h->nbuckets >= (1U << 31))
+    return -1;
+
+  /* Not instantiated yet, nothing to move */
+  if (alloc_arena (h) == 0)
+    {
+      h->nbuckets <<= 1;
+      h->log2_nbuckets++;
+      return 0;
+    }
+
+  size = BV (clib_bihash_bucket_array_size) (h->nbuckets << 1);
+
+  BV (clib_bihash_alloc_lock) (h);
+
+  /*
+   * The old pages are only freed once every bucket has moved, until then
+   * each half of a moved bucket may need as many pages as the bucket had,
+   * twice the pages in use at worst. Filling a half may also leave on the
+   * freelists one block of each size below the largest one allocated so
+   * far. alloc_aligned aborts when the arena is exhausted, so don't start
+   * unless all of this fits.
+   */
+  pages_size = alloc_arena_next (h) -
+    BV (clib_bihash_bucket_array_size) (h->nbuckets);
+  pages_size = 2 * pages_size +
+    (sizeof (BVT (clib_bihash_value)) << vec_len (h->freelists));
+
+  if (alloc_arena_next (h) + size + pages_size > alloc_arena_size (h))
+    {
+      BV (clib_bihash_alloc_unlock) (h);
+      return -2;
+    }
+  h->resize_buckets = BV (alloc_aligned) (h, size);
+  BV (clib_bihash_alloc_unlock) (h);
+
+  h->resize_index = 0;
+  CLIB_MEMORY_STORE_BARRIER ();
+  h->resize_state = BIHASH_RESIZE_MOVING;
+
+  return 0;
+}
+
+/*
+ * Do up to n_buckets worth of resize work: move buckets to the new
+ * array, or free the pages of the old one once the resize is finished.
+ * When idle, starts a resize if the table has max_nbuckets set and too
+ * many of its buckets have spilled past one page. Readers and writers
+ * may run concurrently. Returns the clib_bihash_resize_state_t after
+ * the step, BIHASH_RESIZE_READY meaning that clib_bihash_resize_finish
+ * must be called.
+ */
+int BV (clib_bihash_resize_step) (BVT (clib_bihash) * h, u32 n_buckets)
+{
+  u32 last;
+
+  switch (h->resize_state)
+    {
+    case BIHASH_RESIZE_IDLE:
+      if (h->max_nbuckets > h->nbuckets && h->n_split_buckets >
+	  (h->nbuckets >> BIHASH_RESIZE_LOG2_SPLIT_RATIO))
+	BV (clib_bihash_resize_start) (h);
+      break;
+
+    case BIHASH_RESIZE_MOVING:
+      last = clib_min (h->resize_index + n_buckets, h->nbuckets);
+      while (h->resize_index < last)
+	BV (clib_bihash_resize_move_bucket) (h, h->resize_index++);
+      if (h->resize_index == h->nbuckets)
+	h->resize_state = BIHASH_RESIZE_READY;
+      break;
+
+    case BIHASH_RESIZE_READY:
+      break;
+
+    case BIHASH_RESIZE_RECLAIM:
+      last = clib_min (h->resize_index + n_buckets, h->nbuckets >> 1);
+      while (h->resize_index < last)
+	BV (clib_bihash_resize_reclaim_bucket) (h, h->resize_index++);
+      if (h->resize_index == h->nbuckets >> 1)
+	{
+	  BV (clib_bihash_resize_recycle) (h);
+	  h->resize_state = BIHASH_RESIZE_IDLE;
+	}
+      break;
+    }
+
+  return h->resize_state;
+}
+
+/*
+ * Switch to the new bucket array once all buckets have moved. Unlike
+ * the steps, this must run while no other thread uses the table, e.g.
+ * under the worker barrier: a reader could otherwise pair the new
+ * array with the old number of buckets.
+ */
+void BV (clib_bihash_resize_finish) (BVT (clib_bihash) * h)
+{
+  ASSERT (h->resize_state == BIHASH_RESIZE_READY);
+
+  h->resize_old_buckets = h->buckets;
+  h->buckets = h->resize_buckets;
+  h->resize_buckets = 0;
+  h->nbuckets <<= 1;
+  h->log2_nbuckets++;
+  h->resize_index = 0;
+  h->resize_state = BIHASH_RESIZE_RECLAIM;
+}
+
 u8 *BV (format_bihash) (u8 * s, va_list * args)
 {
   BVT (clib_bihash) * h = va_arg (*args, BVT (clib_bihash) *);
@@ -889,6 +1224,7 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
   u64 active_buckets = 0;
   u64 linear_buckets = 0;
   u64 used_bytes;
+  u32 index, n_halves;
 
   s = format (s, "Hash table %s\n", h->name ? h->name : (u8 *) "(unnamed)");
 
@@ -900,11 +1236,22 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
   for (i = 0; i < h->nbuckets; i++)
     {
       b = BV (clib_bihash_get_bucket) (h, i);
+      n_halves = 1;
+      index = i;
+
+      /* Moved by a resize in progress, show its two halves instead */
+      if (PREDICT_FALSE (b->resized))
+	{
+	  b = BV (clib_bihash_get_resized_bucket) (h, i);
+	  n_halves = 2;
+	}
+
+    next_half:
       if (BV (clib_bihash_bucket_is_empty) (b))
 	{
 	  if (verbose > 1)
-	    s = format (s, "[%d]: empty\n", i);
-	  continue;
+	    s = format (s, "[%d]: empty\n", index);
+	  goto done_half;
 	}
 
       active_buckets++;
@@ -915,7 +1262,7 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
       if (verbose)
 	{
 	  s = format
-	    (s, "[%d]: heap offset %lld, len %d, refcnt %d, linear %d\n", i,
+	    (s, "[%d]: heap offset %lld, len %d, refcnt %d, linear %d\n", index,
 	     b->offset, (1 << b->log2_pages), b->refcnt, b->linear_search);
 	}
 
@@ -950,6 +1297,14 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
 	    }
 	  v++;
 	}
+
+    done_half:
+      if (--n_halves)
+	{
+	  index = i + h->nbuckets;
+	  b = BV (clib_bihash_get_resized_bucket) (h, index);
+	  goto next_half;
+	}
     }
 
   s = format (s, "    %lld active elements %lld active buckets\n",
@@ -974,6 +1329,18 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
     }
 
   s = format (s, "    %lld linear search buckets\n", linear_buckets);
+  s = format (s, "    %u buckets, %u split past one page\n",
+	      h->nbuckets, h->n_split_buckets);
+  if (h->resize_state == BIHASH_RESIZE_MOVING)
+    s = format (s, "    resize: %u of %u buckets moved\n",
+		h->resize_index, h->nbuckets);
+  else if (h->resize_state == BIHASH_RESIZE_READY)
+    s = format (s, "    resize: all buckets moved\n");
+  else if (h->resize_state == BIHASH_RESIZE_RECLAIM)
+    s = format (s, "    resize: %u of %u old buckets reclaimed\n",
+		h->resize_index, h->nbuckets >> 1);
+  if (h->max_nbuckets)
+    s = format (s, "    grows up to %u buckets\n", h->max_nbuckets);
   used_bytes = alloc_arena_next (h);
   s = format (s,
 	      "    arena: base %llx, next %llx\n"
@@ -984,13 +1351,44 @@ u8 *BV (format_bihash) (u8 * s, va_list * args)
   return s;
 }
 
+static int BV (clib_bihash_foreach_bucket_kvp)
+  (BVT (clib_bihash) * h, BVT (clib_bihash_bucket) * b,
+   BV (clib_bihash_foreach_key_value_pair_cb) cb, void *arg)
+{
+  BVT (clib_bihash_value) * v;
+  int j, k;
+
+  if (BV (clib_bihash_bucket_is_empty) (b))
+    return BIHASH_WALK_CONTINUE;
+
+  v = BV (clib_bihash_get_value) (h, b->offset);
+  for (j = 0; j < (1 << b->log2_pages); j++)
+    {
+      for (k = 0; k < BIHASH_KVP_PER_PAGE; k++)
+	{
+	  if (BV (clib_bihash_is_free) (&v->kvp[k]))
+	    continue;
+
+	  if (BIHASH_WALK_STOP == cb (&v->kvp[k], arg))
+	    return BIHASH_WALK_STOP;
+	  /*
+	   * In case the callback deletes the last entry in the bucket...
+	   */
+	  if (BV (clib_bihash_bucket_is_empty) (b))
+	    return BIHASH_WALK_CONTINUE;
+	}
+      v++;
+    }
+
+  return BIHASH_WALK_CONTINUE;
+}
+
 void BV (clib_bihash_foreach_key_value_pair)
   (BVT (clib_bihash) * h,
    BV (clib_bihash_foreach_key_value_pair_cb) cb, void *arg)
 {
-  int i, j, k;
+  int i;
   BVT (clib_bihash_bucket) * b;
-  BVT (clib_bihash_value) * v;
 
 
 #if BIHASH_LAZY_INSTANTIATE
@@ -1001,29 +1399,20 @@ void BV (clib_bihash_foreach_key_value_pair)
   for (i = 0; i < h->nbuckets; i++)
     {
       b = BV (clib_bihash_get_bucket) (h, i);
-      if (BV (clib_bihash_bucket_is_empty) (b))
-	continue;
 
-      v = BV (clib_bihash_get_value) (h, b->offset);
-      for (j = 0; j < (1 << b->log2_pages); j++)
+      /* Moved by a resize in progress, walk its two halves instead */
+      if (PREDICT_FALSE (b->resized))
 	{
-	  for (k = 0; k < BIHASH_KVP_PER_PAGE; k++)
-	    {
-	      if (BV (clib_bihash_is_free) (&v->kvp[k]))
-		continue;
-
-	      if (BIHASH_WALK_STOP == cb (&v->kvp[k], arg))
-		return;
-	      /*
-	       * In case the callback deletes the last entry in the bucket...
-	       */
-	      if (BV (clib_bihash_bucket_is_empty) (b))
-		goto doublebreak;
-	    }
-	  v++;
+	  b = BV (clib_bihash_get_resized_bucket) (h, i);
+	  if (BIHASH_WALK_STOP ==
+	      BV (clib_bihash_foreach_bucket_kvp) (h, b, cb, arg))
+	    return;
+	  b = BV (clib_bihash_get_resized_bucket) (h, i + h->nbuckets);
 	}
-    doublebreak:
-      ;
+
+      if (BIHASH_WALK_STOP ==
+	  BV (clib_bihash_foreach_bucket_kvp) (h, b, cb, arg))
+	return;
     }
 }
 
@@ -44,6 +44,16 @@
 #define BIHASH_FREELIST_LENGTH 17
 #endif
 
+/* keys between the bucket prefetch and the search in batched lookups */
+#ifndef BIHASH_SEARCH_BATCH_PREFETCH_DISTANCE
+#define BIHASH_SEARCH_BATCH_PREFETCH_DISTANCE 4
+#endif
+
+/* keys hashed ahead of the search by clib_bihash_search_batch */
+#ifndef BIHASH_SEARCH_BATCH_SIZE
+#define BIHASH_SEARCH_BATCH_SIZE 64
+#endif
+
 /* default is 2MB, use 30 for 1GB */
 #ifndef BIHASH_LOG2_HUGEPAGE_SIZE
 #define BIHASH_LOG2_HUGEPAGE_SIZE 21
@@ -93,6 +103,8 @@ typedef struct
       u64 linear_search:1;
       u64 log2_pages:8;
       u64 refcnt:16;
+      /* moved to the new bucket array by a resize in progress */
+      u64 resized:1;
     };
     u64 as_u64;
   };
@@ -150,6 +162,23 @@ BVS (clib_bihash)
   u64 alloc_arena;		/* Base of the allocation arena */
   volatile u8 instantiated;
 
+  /*
+   * Incremental doubling of the bucket array, see
+   * clib_bihash_resize_step. resize_buckets is the new array while
+   * buckets move, resize_old_buckets the old one while its pages are
+   * reclaimed. resize_index is the next old bucket to process.
+   */
+  BVT (clib_bihash_bucket) * resize_buckets;
+  BVT (clib_bihash_bucket) * resize_old_buckets;
+  u32 resize_index;
+  u8 resize_state;
+
+  /* grow in the background up to this many buckets, 0 to disable */
+  u32 max_nbuckets;
+
+  /* buckets spilled past a single page, protected by the alloc lock */
+  u32 n_split_buckets;
+
   /**
     * A custom format function to print the Key and Value of bihash_key instead of default hexdump
     */
@@ -174,6 +203,7 @@ typedef struct
   format_function_t *fmt_fn;
   u8 instantiate_immediately;
   u8 dont_add_to_all_bihash_list;
+  u32 max_nbuckets;
 } BVT (clib_bihash_init2_args);
 
 extern void **clib_all_bihashes;
@@ -227,6 +257,21 @@ typedef enum
 } BVT (clib_bihash_stat_id);
 #endif /* BIHASH_STAT_IDS */
 
+#ifndef BIHASH_RESIZE_STATES
+#define BIHASH_RESIZE_STATES 1
+
+typedef enum
+{
+  BIHASH_RESIZE_IDLE,		/* nothing to do */
+  BIHASH_RESIZE_MOVING,		/* buckets moving to the new array */
+  BIHASH_RESIZE_READY,		/* waiting for clib_bihash_resize_finish */
+  BIHASH_RESIZE_RECLAIM,	/* freeing the pages of the old array */
+} clib_bihash_resize_state_t;
+
+/* start growing once 1 bucket in 2^N has spilled past one page */
+#define BIHASH_RESIZE_LOG2_SPLIT_RATIO 3
+#endif /* BIHASH_RESIZE_STATES */
+
 static inline void BV (clib_bihash_increment_stat) (BVT (clib_bihash) * h,
 						    int stat_id, u64 count)
 {
@@ -341,6 +386,10 @@ int BV (clib_bihash_search) (BVT (clib_bihash) * h,
 			     BVT (clib_bihash_kv) * search_v,
 			     BVT (clib_bihash_kv) * return_v);
 
+int BV (clib_bihash_resize_start) (BVT (clib_bihash) * h);
+int BV (clib_bihash_resize_step) (BVT (clib_bihash) * h, u32 n_buckets);
+void BV (clib_bihash_resize_finish) (BVT (clib_bihash) * h);
+
 #define BIHASH_WALK_STOP 0
 #define BIHASH_WALK_CONTINUE 1
 
@@ -360,17 +409,38 @@ format_function_t BV (format_bihash_lru);
 
 static inline
 BVT (clib_bihash_bucket) *
-BV (clib_bihash_get_bucket) (BVT (clib_bihash) * h, u64 hash)
+BV (clib_bihash_get_bucket_in) (BVT (clib_bihash_bucket) * buckets,
+				u32 nbuckets, u64 hash)
 {
 #if BIHASH_KVP_AT_BUCKET_LEVEL
   uword offset;
-  offset = (hash & (h->nbuckets - 1));
+  offset = (hash & (nbuckets - 1));
   offset = offset * (sizeof (BVT (clib_bihash_bucket))
 		     + (BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv))));
-  return ((BVT (clib_bihash_bucket) *) (((u8 *) h->buckets) + offset));
+  return ((BVT (clib_bihash_bucket) *) (((u8 *) buckets) + offset));
 #endif
 
-  return h->buckets + (hash & (h->nbuckets - 1));
+  return buckets + (hash & (nbuckets - 1));
+}
+
+static inline
+BVT (clib_bihash_bucket) *
+BV (clib_bihash_get_bucket) (BVT (clib_bihash) * h, u64 hash)
+{
+  return BV (clib_bihash_get_bucket_in) (h->buckets, h->nbuckets, hash);
+}
+
+/*
+ * Bucket of the hash in the new, twice as large, array of a resize in
+ * progress. Only valid once the bucket of the old array has its
+ * resized bit set.
+ */
+static inline
+BVT (clib_bihash_bucket) *
+BV (clib_bihash_get_resized_bucket) (BVT (clib_bihash) * h, u64 hash)
+{
+  return BV (clib_bihash_get_bucket_in) (h->resize_buckets,
+					 h->nbuckets << 1, hash);
 }
 
 static inline int BV (clib_bihash_search_inline_with_hash)
@@ -378,6 +448,7 @@ static inline int BV (clib_bihash_search_inline_with_hash)
 {
   BVT (clib_bihash_value) * v;
   BVT (clib_bihash_bucket) * b;
+  u32 log2_nbuckets;
   int i, limit;
 
   /* *INDENT-OFF* */
@@ -393,6 +464,13 @@ static inline int BV (clib_bihash_search_inline_with_hash)
 #endif
 
   b = BV (clib_bihash_get_bucket) (h, hash);
+  log2_nbuckets = h->log2_nbuckets;
+
+  if (PREDICT_FALSE (b->resized))
+    {
+      b = BV (clib_bihash_get_resized_bucket) (h, hash);
+      log2_nbuckets++;
+    }
 
   if (PREDICT_FALSE (BV (clib_bihash_bucket_is_empty) (b)))
     return -1;
@@ -414,7 +492,7 @@ static inline int BV (clib_bihash_search_inline_with_hash)
       if (PREDICT_FALSE (b->linear_search))
 	limit <<= b->log2_pages;
       else
-	v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+	v += extract_bits (hash, log2_nbuckets, b->log2_pages);
     }
 
   for (i = 0; i < limit; i++)
@@ -451,6 +529,7 @@ static inline void BV (clib_bihash_prefetch_data)
 {
   BVT (clib_bihash_value) * v;
   BVT (clib_bihash_bucket) * b;
+  u32 log2_nbuckets;
 
 #if BIHASH_LAZY_INSTANTIATE
   if (PREDICT_FALSE (alloc_arena (h) == 0))
@@ -458,6 +537,13 @@ static inline void BV (clib_bihash_prefetch_data)
 #endif
 
   b = BV (clib_bihash_get_bucket) (h, hash);
+  log2_nbuckets = h->log2_nbuckets;
+
+  if (PREDICT_FALSE (b->resized))
+    {
+      b = BV (clib_bihash_get_resized_bucket) (h, hash);
+      log2_nbuckets++;
+    }
 
   if (PREDICT_FALSE (BV (clib_bihash_bucket_is_empty) (b)))
     return;
@@ -465,7 +551,7 @@ static inline void BV (clib_bihash_prefetch_data)
   v = BV (clib_bihash_get_value) (h, b->offset);
 
   if (PREDICT_FALSE (b->log2_pages && b->linear_search == 0))
-    v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+    v += extract_bits (hash, log2_nbuckets, b->log2_pages);
 
   CLIB_PREFETCH (v, BIHASH_KVP_PER_PAGE * sizeof (BVT (clib_bihash_kv)),
 		 LOAD);
@@ -477,6 +563,7 @@ static inline int BV (clib_bihash_search_inline_2_with_hash)
 {
   BVT (clib_bihash_value) * v;
   BVT (clib_bihash_bucket) * b;
+  u32 log2_nbuckets;
   int i, limit;
 
 /* *INDENT-OFF* */
@@ -494,6 +581,13 @@ static inline int BV (clib_bihash_search_inline_2_with_hash)
 #endif
 
   b = BV (clib_bihash_get_bucket) (h, hash);
+  log2_nbuckets = h->log2_nbuckets;
+
+  if (PREDICT_FALSE (b->resized))
+    {
+      b = BV (clib_bihash_get_resized_bucket) (h, hash);
+      log2_nbuckets++;
+    }
 
   if (PREDICT_FALSE (BV (clib_bihash_bucket_is_empty) (b)))
     return -1;
@@ -515,7 +609,7 @@ static inline int BV (clib_bihash_search_inline_2_with_hash)
       if (PREDICT_FALSE (b->linear_search))
 	limit <<= b->log2_pages;
       else
-	v += extract_bits (hash, h->log2_nbuckets, b->log2_pages);
+	v += extract_bits (hash, log2_nbuckets, b->log2_pages);
     }
 
   for (i = 0; i < limit; i++)
@@ -541,6 +635,74 @@ static inline int BV (clib_bihash_search_inline_2)
 						     valuep);
 }
 
+/*
+ * Batched lookup of n_keys keys whose hashes are already known. The
+ * bucket of key i + 2 * BIHASH_SEARCH_BATCH_PREFETCH_DISTANCE and the
+ * kvp page of key i + BIHASH_SEARCH_BATCH_PREFETCH_DISTANCE are
+ * prefetched while key i is searched, so each stage has a few searches
+ * worth of time to come in from memory. On return found[i] is set when
+ * key_results[i] was found, in which case key_results[i] holds the
+ * matching kvp, as with clib_bihash_search_inline. Returns the number of
+ * keys found.
+ */
+static inline u32 BV (clib_bihash_search_batch_with_hash)
+  (BVT (clib_bihash) * h, u64 * hashes, BVT (clib_bihash_kv) * key_results,
+   u8 * found, u32 n_keys)
+{
+  const u32 d = BIHASH_SEARCH_BATCH_PREFETCH_DISTANCE;
+  u32 i, n_found = 0;
+
+  for (i = 0; i < clib_min (n_keys, 2 * d); i++)
+    BV (clib_bihash_prefetch_bucket) (h, hashes[i]);
+  for (i = 0; i < clib_min (n_keys, d); i++)
+    BV (clib_bihash_prefetch_data) (h, hashes[i]);
+
+  for (i = 0; i < n_keys; i++)
+    {
+      if (i + 2 * d < n_keys)
+	BV (clib_bihash_prefetch_bucket) (h, hashes[i + 2 * d]);
+      if (i + d < n_keys)
+	BV (clib_bihash_prefetch_data) (h, hashes[i + d]);
+
+      found[i] = BV (clib_bihash_search_inline_with_hash) (h, hashes[i],
+							   key_results + i)
+	== 0;
+      n_found += found[i];
+    }
+
+  return n_found;
+}
+
+/*
+ * As clib_bihash_search_batch_with_hash, hashing the keys
+ * BIHASH_SEARCH_BATCH_SIZE at a time first. The hashes of a batch don't
+ * depend on each other, so their crc32 instructions overlap in the
+ * pipeline instead of sitting on the critical path of every search.
+ */
+static inline u32 BV (clib_bihash_search_batch)
+  (BVT (clib_bihash) * h, BVT (clib_bihash_kv) * key_results, u8 * found,
+   u32 n_keys)
+{
+  u64 hashes[BIHASH_SEARCH_BATCH_SIZE];
+  u32 i, n, n_found = 0;
+
+  while (n_keys)
+    {
+      n = clib_min (n_keys, BIHASH_SEARCH_BATCH_SIZE);
+
+      for (i = 0; i < n; i++)
+	hashes[i] = BV (clib_bihash_hash) (key_results + i);
+
+      n_found += BV (clib_bihash_search_batch_with_hash) (h, hashes,
+							  key_results, found,
+							  n);
+      key_results += n;
+      found += n;
+      n_keys -= n;
+    }
+
+  return n_found;
+}
 
 #endif /* __included_bihash_template_h__ */
 
@@ -36,6 +36,9 @@ typedef struct
   u32 report_every_n;
   u32 search_iter;
   u32 noverwritten;
+  u32 batch_size;
+  u32 cache_items;
+  u32 max_nbuckets;
   int careful_delete_tests;
   int verbose;
   int non_random_keys;
@@ -472,6 +475,339 @@ test_bihash (test_main_t * tm)
   return 0;
 }
 
+static f64
+test_bihash_batch_run (test_main_t * tm, BVT (clib_bihash_kv) * kvs,
+		       u8 * found, u32 n_keys, int batched)
+{
+  BVT (clib_bihash) * h = &tm->hash;
+  u32 i, j, n, n_found = 0;
+  f64 before, delta;
+
+  before = clib_time_now (&tm->clib_time);
+
+  for (j = 0; j < tm->search_iter; j++)
+    {
+      for (i = 0; i < n_keys; i += n)
+	{
+	  n = clib_min (n_keys - i, tm->batch_size);
+
+	  if (batched)
+	    n_found += BV (clib_bihash_search_batch) (h, kvs + i, found + i,
+						      n);
+	  else
+	    {
+	      u32 k;
+	      for (k = i; k < i + n; k++)
+		n_found += BV (clib_bihash_search_inline) (h, kvs + k) == 0;
+	    }
+	}
+    }
+
+  delta = clib_time_now (&tm->clib_time) - before;
+
+  if (n_found != tm->search_iter * n_keys)
+    clib_warning ("found %u keys out of %u", n_found,
+		  tm->search_iter * n_keys);
+
+  return delta;
+}
+
+/*
+ * Check the batched lookup against the one-at-a-time one, on the keys
+ * in the table interleaved with as many keys which are not.
+ */
+static u32
+test_bihash_batch_verify (test_main_t * tm, BVT (clib_bihash_kv) * kvs)
+{
+  BVT (clib_bihash) * h = &tm->hash;
+  BVT (clib_bihash_kv) kv, *check = 0;
+  u8 *found = 0;
+  u32 i, n, n_errors = 0;
+  int rv;
+
+  vec_foreach_index (i, kvs)
+  {
+    kv.key = kvs[i].key;
+    kv.value = ~0ULL;
+    vec_add1 (check, kv);
+    kv.key = random_u64 (&tm->seed);
+    vec_add1 (check, kv);
+  }
+  vec_validate (found, vec_len (check) - 1);
+
+  for (i = 0; i < vec_len (check); i += n)
+    {
+      n = clib_min (vec_len (check) - i, tm->batch_size);
+      BV (clib_bihash_search_batch) (h, check + i, found + i, n);
+    }
+
+  vec_foreach_index (i, check)
+  {
+    kv.key = check[i].key;
+    rv = BV (clib_bihash_search) (h, &kv, &kv);
+    if (found[i] != (rv == 0) || (found[i] && check[i].value != kv.value))
+      {
+	if (n_errors++ < 10)
+	  clib_warning ("key %llx: batched found %u value %llx, single "
+			"found %u value %llx", check[i].key, found[i],
+			check[i].value, rv == 0, kv.value);
+      }
+  }
+
+  vec_free (check);
+  vec_free (found);
+
+  return n_errors;
+}
+
+/*
+ * Throughput of the one-at-a-time and batched lookups, first looping
+ * over a set of keys small enough for its buckets to stay in the cache,
+ * then over all the keys in the table, which have to come from DRAM
+ * once the table is larger than the last level cache.
+ */
+static clib_error_t *
+test_bihash_batch (test_main_t * tm)
+{
+  BVT (clib_bihash) * h;
+  BVT (clib_bihash_kv) kv, *kvs = 0;
+  u8 *found = 0;
+  u32 i, n_keys, pass, n_errors;
+  f64 single, batched, total;
+  clib_error_t *error = 0;
+
+  h = &tm->hash;
+
+#if BIHASH_32_64_SVM
+  BV (clib_bihash_master_init_svm) (h, "test", tm->nbuckets,
+				    0x30000000 /* base_addr */ ,
+				    tm->hash_memory_size);
+#else
+  BV (clib_bihash_init) (h, "test", tm->nbuckets, tm->hash_memory_size);
+#endif
+
+  fformat (stdout, "Add %d items to %d buckets\n", tm->nitems, tm->nbuckets);
+
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv.key = random_u64 (&tm->seed);
+      kv.value = i + 1;
+      BV (clib_bihash_add_del) (h, &kv, 1 /* is_add */ );
+      vec_add1 (kvs, kv);
+    }
+
+  vec_validate (found, tm->nitems - 1);
+
+  fformat (stdout, "%U", BV (format_bihash), h, 0 /* very verbose */ );
+
+  n_errors = test_bihash_batch_verify (tm, kvs);
+  if (n_errors)
+    {
+      error = clib_error_return (0, "%u batched lookup errors", n_errors);
+      goto done;
+    }
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      n_keys = pass ? tm->nitems : clib_min (tm->nitems, tm->cache_items);
+
+      /* warm up, and fault in the key vector */
+      test_bihash_batch_run (tm, kvs, found, n_keys, 1 /* batched */ );
+
+      single = test_bihash_batch_run (tm, kvs, found, n_keys, 0);
+      batched = test_bihash_batch_run (tm, kvs, found, n_keys, 1);
+      total = (f64) tm->search_iter * n_keys;
+
+      fformat (stdout, "%s, %u keys, batches of %u:\n",
+	       pass ? "DRAM resident" : "cache resident", n_keys,
+	       tm->batch_size);
+      if (single > 0 && batched > 0)
+	{
+	  fformat (stdout, "  single  %.f searches per second, "
+		   "%.2f nsec per search\n", total / single,
+		   1e9 * single / total);
+	  fformat (stdout, "  batched %.f searches per second, "
+		   "%.2f nsec per search\n", total / batched,
+		   1e9 * batched / total);
+	}
+    }
+
+done:
+  vec_free (kvs);
+  vec_free (found);
+  BV (clib_bihash_free) (h);
+
+  return error;
+}
+
+static int
+test_bihash_resize_count_cb (BVT (clib_bihash_kv) * kv, void *ctx)
+{
+  u32 *count = ctx;
+  count[0]++;
+  return BIHASH_WALK_CONTINUE;
+}
+
+static u32
+test_bihash_resize_verify (test_main_t * tm)
+{
+  BVT (clib_bihash) * h = &tm->hash;
+  BVT (clib_bihash_kv) kv;
+  u32 i, n_errors = 0, count = 0;
+
+  for (i = 0; i < vec_len (tm->keys); i++)
+    {
+      kv.key = tm->keys[i];
+      if (BV (clib_bihash_search) (h, &kv, &kv) < 0
+	  || kv.value != (u64) (i + 1))
+	n_errors++;
+    }
+
+  BV (clib_bihash_foreach_key_value_pair) (h, test_bihash_resize_count_cb,
+					   &count);
+  if (count != vec_len (tm->keys))
+    n_errors++;
+
+  return n_errors;
+}
+
+/*
+ * Grow a table from nbuckets to max-nbuckets while adding keys, one
+ * step of resize work after each add, checking every key at each
+ * change of resize state.
+ */
+static clib_error_t *
+test_bihash_resize (test_main_t * tm)
+{
+  BVT (clib_bihash_init2_args) _a, *a = &_a;
+  BVT (clib_bihash) * h;
+  BVT (clib_bihash_kv) kv;
+  u32 i, n_errors = 0, n_resizes = 0;
+  int state, last_state = BIHASH_RESIZE_IDLE;
+  f64 before, delta;
+
+  h = &tm->hash;
+
+  clib_memset (a, 0, sizeof (*a));
+  a->h = h;
+  a->name = "test";
+  a->nbuckets = tm->nbuckets;
+  a->memory_size = tm->hash_memory_size;
+  a->max_nbuckets = tm->max_nbuckets;
+  a->instantiate_immediately = 1;
+  BV (clib_bihash_init2) (a);
+
+  fformat (stdout, "Add %d items to %d buckets, growing up to %d\n",
+	   tm->nitems, tm->nbuckets, tm->max_nbuckets);
+
+  before = clib_time_now (&tm->clib_time);
+
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv.key = random_u64 (&tm->seed);
+      kv.value = i + 1;
+      BV (clib_bihash_add_del) (h, &kv, 1 /* is_add */ );
+      vec_add1 (tm->keys, kv.key);
+
+      state = BV (clib_bihash_resize_step) (h, tm->batch_size);
+      if (state == BIHASH_RESIZE_READY)
+	{
+	  BV (clib_bihash_resize_finish) (h);
+	  state = BIHASH_RESIZE_RECLAIM;
+	  n_resizes++;
+	}
+      if (state != last_state)
+	{
+	  n_errors += test_bihash_resize_verify (tm);
+	  last_state = state;
+	}
+    }
+
+  /* Run the last resize to completion */
+  while ((state = BV (clib_bihash_resize_step) (h, tm->batch_size))
+	 != BIHASH_RESIZE_IDLE)
+    if (state == BIHASH_RESIZE_READY)
+      {
+	BV (clib_bihash_resize_finish) (h);
+	n_resizes++;
+      }
+
+  delta = clib_time_now (&tm->clib_time) - before;
+  n_errors += test_bihash_resize_verify (tm);
+
+  fformat (stdout, "%u resizes in %.6f seconds, %u errors\n", n_resizes,
+	   delta, n_errors);
+  fformat (stdout, "%U", BV (format_bihash), h, 0 /* very verbose */ );
+
+  for (i = 0; i < vec_len (tm->keys); i++)
+    {
+      kv.key = tm->keys[i];
+      if (BV (clib_bihash_add_del) (h, &kv, 0 /* is_add */ ) < 0)
+	n_errors++;
+    }
+
+  fformat (stdout, "After deleting all items:\n%U", BV (format_bihash), h,
+	   0 /* very verbose */ );
+
+  BV (clib_bihash_free) (h);
+
+  if (n_errors)
+    return clib_error_return (0, "%u errors", n_errors);
+  return 0;
+}
+
+/*
+ * Fill a table with a small memory-size, then double its buckets until
+ * the arena is too small for it. The last resize must be refused, not
+ * run out of memory half way.
+ */
+static clib_error_t *
+test_bihash_resize_memory (test_main_t * tm)
+{
+  BVT (clib_bihash) * h;
+  BVT (clib_bihash_kv) kv;
+  u32 i, n_errors = 0, n_resizes = 0;
+  int rv, state;
+
+  h = &tm->hash;
+
+  BV (clib_bihash_init) (h, "test", tm->nbuckets, tm->hash_memory_size);
+
+  fformat (stdout, "Add %d items to %d buckets, %U of memory\n",
+	   tm->nitems, tm->nbuckets, format_memory_size,
+	   tm->hash_memory_size);
+
+  for (i = 0; i < tm->nitems; i++)
+    {
+      kv.key = random_u64 (&tm->seed);
+      kv.value = i + 1;
+      BV (clib_bihash_add_del) (h, &kv, 1 /* is_add */ );
+      vec_add1 (tm->keys, kv.key);
+    }
+
+  while ((rv = BV (clib_bihash_resize_start) (h)) == 0)
+    {
+      while ((state = BV (clib_bihash_resize_step) (h, tm->batch_size))
+	     != BIHASH_RESIZE_IDLE)
+	if (state == BIHASH_RESIZE_READY)
+	  BV (clib_bihash_resize_finish) (h);
+      n_resizes++;
+      n_errors += test_bihash_resize_verify (tm);
+    }
+
+  fformat (stdout, "%u resizes, then %d, %u errors\n", n_resizes, rv,
+	   n_errors);
+  fformat (stdout, "%U", BV (format_bihash), h, 0 /* very verbose */ );
+
+  BV (clib_bihash_free) (h);
+
+  if (rv != -2)
+    return clib_error_return (0, "resize start returned %d", rv);
+  if (n_errors)
+    return clib_error_return (0, "%u errors", n_errors);
+  return 0;
+}
+
 clib_error_t *
 test_bihash_main (test_main_t * tm)
 {
@@ -481,6 +817,8 @@ test_bihash_main (test_main_t * tm)
 
   tm->report_every_n = 1;
   tm->hash_memory_size = 1ULL << 30;
+  tm->batch_size = 256;
+  tm->cache_items = 4096;
 
   while (unformat_check_input (i) != UNFORMAT_END_OF_INPUT)
     {
@@ -514,11 +852,24 @@ test_bihash_main (test_main_t * tm)
 	tm->verbose = 1;
       else if (unformat (i, "stale-overwrite"))
 	which = 3;
+      else if (unformat (i, "batch-size %u", &tm->batch_size))
+	;
+      else if (unformat (i, "cache-items %u", &tm->cache_items))
+	;
+      else if (unformat (i, "batch"))
+	which = 4;
+      else if (unformat (i, "resize %u", &tm->max_nbuckets))
+	which = 5;
+      else if (unformat (i, "resize-memory"))
+	which = 6;
       else
 	return clib_error_return (0, "unknown input '%U'",
 				  format_unformat_error, i);
     }
 
+  if (tm->batch_size == 0)
+    return clib_error_return (0, "batch-size must be at least 1");
+
   /* Preallocate hash table, key vector */
   tm->key_hash = hash_create (tm->nitems, sizeof (uword));
   vec_validate (tm->keys, tm->nitems - 1);
@@ -543,6 +894,18 @@ test_bihash_main (test_main_t * tm)
       error = test_bihash_stale_overwrite (tm);
       break;
 
+    case 4:
+      error = test_bihash_batch (tm);
+      break;
+
+    case 5:
+      error = test_bihash_resize (tm);
+      break;
+
+    case 6:
+      error = test_bihash_resize_memory (tm);
+      break;
+
     default:
       return clib_error_return (0, "no such test?");
     }
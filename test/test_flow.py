@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Software flow engine tests"""
+
+import re
+import unittest
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether, Dot1Q
+from scapy.layers.inet import IP, UDP
+from scapy.layers.inet6 import IPv6
+
+from framework import VppTestCase, VppTestRunner
+
+
+class TestFlowSw(VppTestCase):
+    """ Software flow engine Test Case """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestFlowSw, cls).setUpClass()
+        cls.create_pg_interfaces(range(2))
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestFlowSw, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestFlowSw, self).setUp()
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.config_ip6()
+            i.resolve_arp()
+            i.resolve_ndp()
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.unconfig_ip6()
+            i.admin_down()
+        super(TestFlowSw, self).tearDown()
+
+    def udp4(self, dport, n=5):
+        p = (Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=dport) /
+             Raw(b'\xa5' * 100))
+        return [p] * n
+
+    def udp6(self, dport, n=5):
+        p = (Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+             IPv6(src=self.pg0.remote_ip6, dst=self.pg1.remote_ip6) /
+             UDP(sport=1234, dport=dport) /
+             Raw(b'\xa5' * 100))
+        return [p] * n
+
+    def flow_indices(self):
+        return set(int(w) for w in
+                   re.findall(r"flow-index (\d+)",
+                              self.vapi.cli("show flow entry")))
+
+    def flow_add(self, match):
+        """ add a flow, enable it on pg0 and return its index """
+        before = self.flow_indices()
+        reply = self.vapi.cli("test flow add %s" % match)
+        self.assertNotIn("error", reply)
+        index = (self.flow_indices() - before).pop()
+        reply = self.vapi.cli("test flow enable index %d %s" %
+                              (index, self.pg0.name))
+        self.assertNotIn("error", reply)
+        return index
+
+    def flow_del(self, index):
+        self.vapi.cli("test flow disable index %d %s" %
+                      (index, self.pg0.name))
+        self.vapi.cli("test flow del index %d" % index)
+
+    def test_flow_sw_drop(self):
+        """ Software flow engine drop rule """
+
+        index = self.flow_add("dst-ip %s/32 proto udp dst-port 4000 drop" %
+                              self.pg1.remote_ip4)
+
+        entry = self.vapi.cli("show flow entry index %d" % index)
+        self.assertIn("software rule", entry)
+        self.assertIn("software rule",
+                      self.vapi.cli("show flow interface %s" %
+                                    self.pg0.name))
+
+        # only the packets not matching the rule get through
+        self.send_and_assert_no_replies(self.pg0, self.udp4(4000))
+        self.send_and_expect(self.pg0, self.udp4(4001), self.pg1)
+
+        entry = self.vapi.cli("show flow entry index %d" % index)
+        self.assertIn("matched 5 packets", entry)
+        self.assertEqual(5, self.statistics.get_err_counter(
+            "/err/flow-sw-input/dropped by flow rule"))
+
+        # a vlan tagged packet does not match an untagged rule
+        p = (Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+             Dot1Q(vlan=100) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=4000))
+        self.pg0.add_stream([p])
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        entry = self.vapi.cli("show flow entry index %d" % index)
+        self.assertIn("matched 5 packets", entry)
+
+        # once disabled the flow no longer matches
+        self.flow_del(index)
+        self.assertIn("no flows enabled",
+                      self.vapi.cli("show flow interface %s" %
+                                    self.pg0.name))
+        self.send_and_expect(self.pg0, self.udp4(4000), self.pg1)
+
+    def test_flow_sw_masks(self):
+        """ Software flow engine masked rules """
+
+        # a port range and a prefix use two different profiles
+        i1 = self.flow_add("dst-ip %s/32 proto udp dst-port 4000/65520 "
+                           "drop" % self.pg1.remote_ip4)
+        i2 = self.flow_add("ip6-dst-ip %s/64 proto udp drop" %
+                           self.pg1.remote_ip6)
+
+        self.send_and_assert_no_replies(self.pg0, self.udp4(4007))
+        self.send_and_expect(self.pg0, self.udp4(4016), self.pg1)
+        self.send_and_assert_no_replies(self.pg0, self.udp6(5000))
+
+        self.assertIn("matched 5 packets",
+                      self.vapi.cli("show flow entry index %d" % i1))
+        self.assertIn("matched 5 packets",
+                      self.vapi.cli("show flow entry index %d" % i2))
+
+        self.flow_del(i1)
+        self.send_and_expect(self.pg0, self.udp4(4007), self.pg1)
+        self.send_and_assert_no_replies(self.pg0, self.udp6(5000))
+        self.flow_del(i2)
+        self.send_and_expect(self.pg0, self.udp6(5000), self.pg1)
+
+    def test_flow_sw_redirect(self):
+        """ Software flow engine redirect rule """
+
+        # skip the ethernet header and hand the packet straight to ip4
+        index = self.flow_add("dst-ip %s/32 proto udp dst-port 4000 "
+                              "mark 7 buffer-advance 14 next-node ip4-input" %
+                              self.pg1.remote_ip4)
+
+        self.send_and_expect(self.pg0, self.udp4(4000), self.pg1)
+        self.assertIn("matched 5 packets",
+                      self.vapi.cli("show flow entry index %d" % index))
+
+        self.flow_del(index)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
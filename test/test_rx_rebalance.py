@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""RX queue rebalancing tests"""
+
+import re
+import time
+import unittest
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
+from framework import VppTestCase, VppTestRunner
+
+
+class TestRxRebalance(VppTestCase):
+    """ RX queue rebalancing Test Case """
+
+    worker_config = "workers 2"
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestRxRebalance, cls).setUpClass()
+        cls.create_pg_interfaces(range(2))
+        for i in cls.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    @classmethod
+    def tearDownClass(cls):
+        for i in cls.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestRxRebalance, cls).tearDownClass()
+
+    def tearDown(self):
+        self.vapi.cli("set interface rx-rebalance disable")
+        super(TestRxRebalance, self).tearDown()
+
+    def test_rx_rebalance_config(self):
+        """ RX rebalancing configuration """
+
+        reply = self.vapi.cli("show interface rx-rebalance")
+        self.assertIn("rx rebalancing disabled, policy vector-rate", reply)
+
+        self.vapi.cli("set interface rx-rebalance policy rx-packets "
+                      "interval 2 threshold 30 hysteresis 4")
+        reply = self.vapi.cli("show interface rx-rebalance")
+        self.assertIn("rx rebalancing enabled, policy rx-packets, "
+                      "interval 2.00s, threshold 30%, hysteresis 4", reply)
+
+        reply = self.vapi.cli("set interface rx-rebalance threshold 101")
+        self.assertIn("invalid", reply)
+        reply = self.vapi.cli("set interface rx-rebalance policy foo")
+        self.assertIn("unknown input", reply)
+
+        self.vapi.cli("set interface rx-rebalance disable")
+        reply = self.vapi.cli("show interface rx-rebalance")
+        self.assertIn("rx rebalancing disabled, policy rx-packets", reply)
+
+    def test_rx_rebalance_sample(self):
+        """ RX rebalancing samples the workers """
+
+        self.vapi.cli("set interface rx-rebalance interval 0.2")
+
+        p = (Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=1234) /
+             Raw(b'\xa5' * 100))
+        self.pg0.add_stream([p] * 257, worker=0)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        self.pg1.get_capture(257)
+
+        # give the process a couple of intervals
+        time.sleep(0.5)
+
+        reply = self.vapi.cli("show interface rx-rebalance")
+        self.assertIn("Thread 1 (vpp_wk_0): vector rate", reply)
+        self.assertIn("Thread 2 (vpp_wk_1): vector rate", reply)
+
+        # pg streams have no rx queue to move
+        self.assertIn("moves 0", reply)
+
+
+@unittest.skip("Requires root")
+class TestRxRebalanceTap(VppTestCase):
+    """ RX queue rebalancing with tap interfaces Test Case """
+
+    worker_config = "workers 2"
+
+    def placement(self):
+        """ number of rx queues per worker """
+        reply = self.vapi.cli("show interface rx-placement")
+        n_queues = {}
+        for thread in reply.split("Thread ")[1:]:
+            index = int(thread.split()[0])
+            n_queues[index] = len(re.findall(r"queue \d+", thread))
+        return n_queues
+
+    def test_rx_rebalance_queues(self):
+        """ RX rebalancing by queue count """
+
+        taps = []
+        for i in range(2):
+            reply = self.vapi.tap_create_v2(id=i, use_random_mac=True,
+                                            num_rx_queues=2)
+            taps.append(reply.sw_if_index)
+
+        # crowd the first worker
+        for sw_if_index in taps:
+            for queue_id in range(2):
+                self.vapi.sw_interface_set_rx_placement(
+                    sw_if_index=sw_if_index, queue_id=queue_id,
+                    worker_id=0)
+        self.assertEqual(4, self.placement().get(1, 0))
+
+        # a queue moves every other interval with a hysteresis of 1
+        self.vapi.cli("set interface rx-rebalance policy queues "
+                      "interval 0.2 hysteresis 1")
+        for i in range(20):
+            if self.placement().get(2, 0) == 2:
+                break
+            time.sleep(0.2)
+
+        self.assertEqual({1: 2, 2: 2}, self.placement())
+        self.assertIn("moves 2", self.vapi.cli(
+            "show interface rx-rebalance"))
+
+        # balanced, nothing moves any more
+        time.sleep(1)
+        self.assertIn("moves 2", self.vapi.cli(
+            "show interface rx-rebalance"))
+
+        self.vapi.cli("set interface rx-rebalance disable")
+        for sw_if_index in taps:
+            self.vapi.tap_delete_v2(sw_if_index=sw_if_index)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
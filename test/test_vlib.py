@@ -1,7 +1,13 @@
 #!/usr/bin/env python3
 
+import re
+import time
 import unittest
 
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
 from framework import VppTestCase, VppTestRunner, running_extended_tests
 from framework import running_gcov_tests
 from vpp_ip_route import VppIpTable, VppIpRoute, VppRoutePath
@@ -186,5 +192,96 @@ class TestVlib(VppTestCase):
                 else:
                     self.logger.info(cmd + " FAIL retval " + str(r.retval))
 
+    def test_vlib_epoch(self):
+        """ Vlib epoch deferred frees """
+
+        def epoch_state():
+            reply = self.vapi.cli("show epoch")
+            m = re.search(r"epoch (\d+), deferred (\d+), reclaimed (\d+), "
+                          r"pending (\d+)", reply)
+            return [int(x) for x in m.groups()]
+
+        epoch, deferred, reclaimed, pending = epoch_state()
+
+        self.vapi.cli("test epoch defer 1000")
+
+        # the worker announces the new epoch on its next loop
+        for i in range(50):
+            state = epoch_state()
+            if state[3] == 0:
+                break
+            time.sleep(0.1)
+
+        self.assertEqual(state[1], deferred + 1000)
+        self.assertEqual(state[2], reclaimed + 1000)
+        self.assertEqual(state[3], 0)
+        self.assertGreater(state[0], epoch)
+        self.assertIn("thread 1: epoch %d" % state[0],
+                      self.vapi.cli("show epoch"))
+
+
+class TestVlibNodeHistograms(VppTestCase):
+    """ Vlib node dispatch histograms """
+
+    extra_vpp_punt_config = ["statseg", "{", "per-node-counters", "on",
+                             "update-interval", "0.2", "}"]
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestVlibNodeHistograms, cls).setUpClass()
+        cls.create_pg_interfaces(range(2))
+        for i in cls.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    @classmethod
+    def tearDownClass(cls):
+        for i in cls.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestVlibNodeHistograms, cls).tearDownClass()
+
+    def test_node_histograms(self):
+        """ Node dispatch histograms """
+
+        self.assertIn("not enabled",
+                      self.vapi.cli("show node histograms"))
+        self.vapi.cli("set node histograms enable")
+
+        p = (Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=1234) /
+             Raw(b'\xa5' * 100))
+        self.send_and_expect(self.pg0, [p] * 65, self.pg1)
+
+        reply = self.vapi.cli("show node histograms")
+        self.assertIn("ip4-lookup", reply)
+        self.assertIn("p99 Clocks", reply)
+
+        # one frame of 65 packets
+        reply = self.vapi.cli("show node histograms ip4-lookup")
+        self.assertIn("Clocks", reply)
+        self.assertTrue(re.search(r"64-127\s+1\s", reply))
+
+        # exported as node_index * n_buckets + bucket
+        time.sleep(0.5)
+        names = self.statistics.get_counter("/sys/node/names")
+        index = names.index("ip4-lookup")
+        vectors = self.statistics.get_counter("/sys/node/vectors_histogram")
+        clocks = self.statistics.get_counter("/sys/node/clocks_histogram")
+        self.assertEqual(1, sum(t[index * 10 + 7] for t in vectors))
+        self.assertEqual(1, sum(sum(t[index * 32:(index + 1) * 32])
+                                for t in clocks))
+
+        self.vapi.cli("clear runtime")
+        self.assertNotIn("ip4-lookup",
+                         self.vapi.cli("show node histograms"))
+
+        self.vapi.cli("set node histograms disable")
+        self.assertIn("not enabled",
+                      self.vapi.cli("show node histograms"))
+
+
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)